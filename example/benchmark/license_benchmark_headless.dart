@@ -0,0 +1,51 @@
+// Runs the license benchmark of the example without Windows or the Store, for
+// example on a Linux CI machine. License calls are answered by a simulated
+// backend on the platform channel after a fixed latency. From example/:
+//
+//   flutter test benchmark/license_benchmark_headless.dart \
+//       --dart-define=BENCHMARK_ITERATIONS=1000 \
+//       --dart-define=BENCHMARK_CONCURRENCY=16 \
+//       --dart-define=BENCHMARK_LATENCY_US=200
+//
+// ignore_for_file: implementation_imports, avoid_print
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:windows_store/src/messages.g.dart' as inner;
+import 'package:windows_store/windows_store.dart';
+import 'package:windows_store_example/license_benchmark.dart';
+
+const _iterations = int.fromEnvironment('BENCHMARK_ITERATIONS', defaultValue: 100);
+const _concurrency = int.fromEnvironment('BENCHMARK_CONCURRENCY', defaultValue: 8);
+const _latencyUs = int.fromEnvironment('BENCHMARK_LATENCY_US', defaultValue: 200);
+
+const _licenseChannel = 'dev.flutter.pigeon.windows_store.WindowsStoreApi.getAppLicenseAsync';
+
+void main() {
+  final binding = TestWidgetsFlutterBinding.ensureInitialized();
+
+  test('license benchmark against a simulated Store', () async {
+    final license = inner.StoreAppLicenseInner(
+      isActive: true,
+      isTrial: false,
+      skuStoreId: '9NBLGGH4R315/0010',
+      trialUniqueId: '',
+      trialTimeRemaining: 0,
+    );
+    final messenger = binding.defaultBinaryMessenger;
+    messenger.setMockMessageHandler(_licenseChannel, (message) async {
+      await Future<void>.delayed(const Duration(microseconds: _latencyUs));
+      return inner.WindowsStoreApi.pigeonChannelCodec.encodeMessage(<Object?>[license]);
+    });
+    addTearDown(() => messenger.setMockMessageHandler(_licenseChannel, null));
+
+    final benchmark = LicenseBenchmark(
+      WindowsStoreApi(),
+      const BenchmarkOptions(iterations: _iterations, concurrency: _concurrency),
+    );
+    // Milestones are relative to the construction of the benchmark, as
+    // there is no process start to measure from.
+    final report = await benchmark.run();
+    print('benchmark: simulated Store latency $_latencyUs us');
+    print(report.join('\n'));
+  }, timeout: Timeout.none);
+}
@@ -0,0 +1,131 @@
+import 'dart:math' as math;
+
+import 'package:windows_store/windows_store.dart';
+
+/// Options of the license benchmark, parsed from the entrypoint arguments:
+///
+/// * `--benchmark[=N]` runs it, with N repeated license calls (default 100).
+/// * `--benchmark-concurrency=C` also runs N calls C at a time (default 8).
+/// * `--benchmark-origin-us=T` is added by the Windows runner: the wall-clock
+///   time in microseconds the process started at, so startup milestones are
+///   measured on the same scale as the runner's.
+class BenchmarkOptions {
+  const BenchmarkOptions({
+    this.iterations = 100,
+    this.concurrency = 8,
+    this.originUs,
+  });
+
+  final int iterations;
+  final int concurrency;
+  final int? originUs;
+
+  /// Returns null unless [arguments] contain `--benchmark`.
+  static BenchmarkOptions? parse(List<String> arguments) {
+    var enabled = false;
+    var iterations = 100;
+    var concurrency = 8;
+    int? originUs;
+    for (final argument in arguments) {
+      final separator = argument.indexOf('=');
+      final name = separator < 0 ? argument : argument.substring(0, separator);
+      final value = separator < 0 ? null : int.tryParse(argument.substring(separator + 1));
+      switch (name) {
+        case '--benchmark':
+          enabled = true;
+          iterations = value ?? iterations;
+        case '--benchmark-concurrency':
+          concurrency = value ?? concurrency;
+        case '--benchmark-origin-us':
+          originUs = value;
+      }
+    }
+    if (!enabled) {
+      return null;
+    }
+    return BenchmarkOptions(
+      iterations: math.max(iterations, 1),
+      concurrency: math.max(concurrency, 1),
+      originUs: originUs,
+    );
+  }
+}
+
+/// Distribution of a set of latencies.
+class LatencyStats {
+  LatencyStats(List<Duration> latencies)
+      : _sorted = (latencies.map((latency) => latency.inMicroseconds).toList()..sort());
+
+  final List<int> _sorted;
+
+  int get count => _sorted.length;
+
+  /// Nearest-rank percentile in microseconds, [percent] in 0..100.
+  int percentileUs(double percent) {
+    if (_sorted.isEmpty) {
+      return 0;
+    }
+    final rank = (percent / 100 * _sorted.length).ceil();
+    return _sorted[(rank - 1).clamp(0, _sorted.length - 1)];
+  }
+
+  double get meanUs =>
+      _sorted.isEmpty ? 0 : _sorted.reduce((a, b) => a + b) / _sorted.length;
+
+  @override
+  String toString() {
+    String ms(num us) => (us / 1000).toStringAsFixed(3);
+    return 'n=$count min=${ms(percentileUs(0))} p50=${ms(percentileUs(50))} '
+        'p90=${ms(percentileUs(90))} p99=${ms(percentileUs(99))} max=${ms(percentileUs(100))} '
+        'mean=${ms(meanUs)} (ms)';
+  }
+}
+
+/// Times license calls through [WindowsStoreApi]: the first one, which
+/// usually reaches the Store, then [BenchmarkOptions.iterations] calls one
+/// after the other and as many again [BenchmarkOptions.concurrency] at a
+/// time.
+class LicenseBenchmark {
+  LicenseBenchmark(this.api, this.options)
+      : _originUs = options.originUs ?? DateTime.now().microsecondsSinceEpoch;
+
+  final WindowsStoreApi api;
+  final BenchmarkOptions options;
+  final int _originUs;
+  final List<String> _report = [];
+
+  /// Records that [milestone] was reached now, relative to the origin.
+  void mark(String milestone) {
+    final elapsedUs = DateTime.now().microsecondsSinceEpoch - _originUs;
+    _report.add('benchmark: ${milestone.padRight(24)} ${(elapsedUs / 1000).toStringAsFixed(2).padLeft(10)} ms');
+  }
+
+  /// Runs the license calls and returns the report, one line per milestone
+  /// or distribution.
+  Future<List<String>> run() async {
+    await api.getAppLicenseAsync();
+    mark('first license');
+
+    final sequential = <Duration>[];
+    for (var i = 0; i < options.iterations; i++) {
+      sequential.add(await _time());
+    }
+    _report.add('benchmark: sequential license ${LatencyStats(sequential)}');
+
+    final concurrent = <Duration>[];
+    var remaining = options.iterations;
+    while (remaining > 0) {
+      final wave = math.min(remaining, options.concurrency);
+      concurrent.addAll(await Future.wait([for (var i = 0; i < wave; i++) _time()]));
+      remaining -= wave;
+    }
+    _report.add('benchmark: concurrent x${options.concurrency} license ${LatencyStats(concurrent)}');
+    return _report;
+  }
+
+  Future<Duration> _time() async {
+    final stopwatch = Stopwatch()..start();
+    await api.getAppLicenseAsync();
+    return stopwatch.elapsed;
+  }
+}
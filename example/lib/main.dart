@@ -1,14 +1,25 @@
 import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
 import 'dart:async';
+import 'dart:io';
 
 import 'package:windows_store/windows_store.dart';
 
-void main() {
-  runApp(const MyApp());
+import 'license_benchmark.dart';
+
+void main(List<String> arguments) {
+  final benchmarkOptions = BenchmarkOptions.parse(arguments);
+  final benchmark = benchmarkOptions == null ? null : LicenseBenchmark(WindowsStoreApi(), benchmarkOptions);
+  benchmark?.mark('dart main');
+  runApp(MyApp(benchmark: benchmark));
 }
 
 class MyApp extends StatefulWidget {
-  const MyApp({super.key});
+  const MyApp({super.key, this.benchmark});
+
+  /// Set when started with `--benchmark`; the app then times license calls,
+  /// prints the results and exits.
+  final LicenseBenchmark? benchmark;
 
   @override
   State<MyApp> createState() => _MyAppState();
@@ -26,12 +37,27 @@ class _MyAppState extends State<MyApp> {
 
   // Platform messages are asynchronous, so we initialize in an async method.
   Future<void> initPlatformState() async {
+    final benchmark = widget.benchmark;
+    if (benchmark != null) {
+      await runBenchmark(benchmark);
+      return;
+    }
     final result = await _windowsStorePlugin.getAppLicenseAsync();
     setState(() {
       license = result;
     });
   }
 
+  Future<void> runBenchmark(LicenseBenchmark benchmark) async {
+    unawaited(WidgetsBinding.instance.waitUntilFirstFrameRasterized
+        .then((_) => benchmark.mark('first frame rasterized')));
+    final report = await benchmark.run();
+    await WidgetsBinding.instance.waitUntilFirstFrameRasterized;
+    stdout.writeln(report.join('\n'));
+    await stdout.flush();
+    await ServicesBinding.instance.exitApplication(AppExitType.required);
+  }
+
   @override
   Widget build(BuildContext context) {
     return MaterialApp(
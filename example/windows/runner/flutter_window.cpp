@@ -4,8 +4,9 @@
 
 #include "flutter/generated_plugin_registrant.h"
 
-FlutterWindow::FlutterWindow(const flutter::DartProject& project)
-    : project_(project) {}
+FlutterWindow::FlutterWindow(const flutter::DartProject& project,
+                             StartupBenchmark* benchmark)
+    : project_(project), benchmark_(benchmark) {}
 
 FlutterWindow::~FlutterWindow() {}
 
@@ -24,10 +25,19 @@ bool FlutterWindow::OnCreate() {
   if (!flutter_controller_->engine() || !flutter_controller_->view()) {
     return false;
   }
+  if (benchmark_) {
+    benchmark_->Mark("engine started");
+  }
   RegisterPlugins(flutter_controller_->engine());
+  if (benchmark_) {
+    benchmark_->Mark("plugins registered");
+  }
   SetChildContent(flutter_controller_->view()->GetNativeWindow());
 
   flutter_controller_->engine()->SetNextFrameCallback([&]() {
+    if (benchmark_) {
+      benchmark_->Mark("first frame");
+    }
     this->Show();
   });
 
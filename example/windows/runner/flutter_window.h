@@ -6,13 +6,16 @@
 
 #include <memory>
 
+#include "startup_benchmark.h"
 #include "win32_window.h"
 
 // A window that does nothing but host a Flutter view.
 class FlutterWindow : public Win32Window {
  public:
   // Creates a new FlutterWindow hosting a Flutter view running |project|.
-  explicit FlutterWindow(const flutter::DartProject& project);
+  // Startup milestones are recorded in |benchmark| if it is not null.
+  explicit FlutterWindow(const flutter::DartProject& project,
+                         StartupBenchmark* benchmark = nullptr);
   virtual ~FlutterWindow();
 
  protected:
@@ -26,6 +29,9 @@ class FlutterWindow : public Win32Window {
   // The project to run.
   flutter::DartProject project_;
 
+  // Startup milestones, in benchmark mode.
+  StartupBenchmark* benchmark_;
+
   // The Flutter instance hosted by this window.
   std::unique_ptr<flutter::FlutterViewController> flutter_controller_;
 };
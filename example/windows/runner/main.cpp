@@ -2,11 +2,37 @@
 #include <flutter/flutter_view_controller.h>
 #include <windows.h>
 
+#include <optional>
+
+#include <windows_store/windows_store_plugin_c_api.h>
+
 #include "flutter_window.h"
+#include "startup_benchmark.h"
 #include "utils.h"
 
 int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
                       _In_ wchar_t *command_line, _In_ int show_command) {
+  std::vector<std::string> command_line_arguments =
+      GetCommandLineArguments();
+
+  // In benchmark mode (--benchmark[=N]), startup milestones are measured
+  // from here and printed on exit, after the Dart side printed its own.
+  std::optional<StartupBenchmark> benchmark;
+  if (StartupBenchmark::IsEnabled(command_line_arguments)) {
+    benchmark.emplace();
+    command_line_arguments.push_back(benchmark->OriginArgument());
+  }
+
+  // --warm-up=session or --warm-up=license has the Store plugin start the
+  // Store session, and prefetch the license, as soon as it registers.
+  for (const std::string& argument : command_line_arguments) {
+    if (argument == "--warm-up=session") {
+      WindowsStorePluginCApiSetWarmUpPolicy(kWindowsStoreWarmUpSession);
+    } else if (argument == "--warm-up=license") {
+      WindowsStorePluginCApiSetWarmUpPolicy(kWindowsStoreWarmUpLicense);
+    }
+  }
+
   // Attach to console when present (e.g., 'flutter run') or create a
   // new console when running with a debugger.
   if (!::AttachConsole(ATTACH_PARENT_PROCESS) && ::IsDebuggerPresent()) {
@@ -19,12 +45,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
 
   flutter::DartProject project(L"data");
 
-  std::vector<std::string> command_line_arguments =
-      GetCommandLineArguments();
-
   project.set_dart_entrypoint_arguments(std::move(command_line_arguments));
 
-  FlutterWindow window(project);
+  FlutterWindow window(project, benchmark ? &*benchmark : nullptr);
   Win32Window::Point origin(10, 10);
   Win32Window::Size size(1280, 720);
   if (!window.Create(L"windows_store_example", origin, size)) {
@@ -38,6 +61,10 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
     ::DispatchMessage(&msg);
   }
 
+  if (benchmark) {
+    benchmark->Print();
+  }
+
   ::CoUninitialize();
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,53 @@
+#include "startup_benchmark.h"
+
+#include <windows.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+int64_t UnixNowUs() {
+  FILETIME now;
+  ::GetSystemTimePreciseAsFileTime(&now);
+  ULARGE_INTEGER ticks;
+  ticks.LowPart = now.dwLowDateTime;
+  ticks.HighPart = now.dwHighDateTime;
+  // FILETIME counts 100 ns intervals since 1601-01-01.
+  return static_cast<int64_t>(ticks.QuadPart / 10) - 11644473600000000LL;
+}
+
+}  // namespace
+
+// static
+bool StartupBenchmark::IsEnabled(const std::vector<std::string>& arguments) {
+  for (const std::string& argument : arguments) {
+    if (argument.compare(0, std::strlen(kFlag), kFlag) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+StartupBenchmark::StartupBenchmark() : origin_us_(UnixNowUs()) {}
+
+std::string StartupBenchmark::OriginArgument() const {
+  return "--benchmark-origin-us=" + std::to_string(origin_us_);
+}
+
+void StartupBenchmark::Mark(const char* milestone) {
+  for (const auto& recorded : milestones_) {
+    if (std::strcmp(recorded.first, milestone) == 0) {
+      return;
+    }
+  }
+  milestones_.emplace_back(milestone, UnixNowUs());
+}
+
+void StartupBenchmark::Print() const {
+  for (const auto& [name, time_us] : milestones_) {
+    std::printf("benchmark: %-24s %10.2f ms\n", name,
+                static_cast<double>(time_us - origin_us_) / 1000.0);
+  }
+  std::fflush(stdout);
+}
@@ -0,0 +1,38 @@
+#ifndef RUNNER_STARTUP_BENCHMARK_H_
+#define RUNNER_STARTUP_BENCHMARK_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Startup milestones of the runner in benchmark mode. Times are wall-clock
+// microseconds so the Dart side, which is told the origin, reports its own
+// milestones on the same scale.
+class StartupBenchmark {
+ public:
+  // Flag that enables benchmark mode. Also passed on to Dart.
+  static constexpr char kFlag[] = "--benchmark";
+
+  // Returns whether |arguments| enable benchmark mode.
+  static bool IsEnabled(const std::vector<std::string>& arguments);
+
+  // Starts the benchmark; the origin of every milestone is now.
+  StartupBenchmark();
+
+  // The argument that tells Dart the origin of the milestones.
+  std::string OriginArgument() const;
+
+  // Records that |milestone| was reached now. Only the first call for each
+  // milestone counts.
+  void Mark(const char* milestone);
+
+  // Prints every milestone in milliseconds since the origin.
+  void Print() const;
+
+ private:
+  int64_t origin_us_;
+  std::vector<std::pair<const char*, int64_t>> milestones_;
+};
+
+#endif  // RUNNER_STARTUP_BENCHMARK_H_
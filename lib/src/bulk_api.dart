@@ -0,0 +1,315 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart' show WriteBuffer;
+import 'package:flutter/services.dart';
+
+import 'columnar_table.dart';
+
+/// Per-product queries of [BulkStoreApi.runBatchQuery]. Must match
+/// `BatchQuery` in `windows/batch_query.h`.
+class BatchQuery {
+  static const int consumableBalance = 1;
+  static const int userCollection = 2;
+}
+
+/// Field ids of batch result columns. Must match `BatchItemField` in
+/// `windows/batch_query.h`.
+class BatchItemField {
+  static const int storeId = 0;
+  static const int hresult = 1;
+  static const int errorMessage = 2;
+  static const int balanceStatus = 3;
+  static const int balanceRemaining = 4;
+  static const int trackingId = 5;
+  static const int isInUserCollection = 6;
+}
+
+/// Field ids of product image result columns. Must match
+/// `ProductImageField` in `windows/image_cache.h`.
+class ProductImageField {
+  static const int storeId = 0;
+  static const int hresult = 1;
+  static const int errorMessage = 2;
+  static const int uri = 3;
+  static const int purposeTag = 4;
+  static const int width = 5;
+  static const int height = 6;
+  static const int path = 7;
+}
+
+/// Field ids of the columns of extended fields, the values extracted from
+/// ExtendedJsonData. Must match `windows/extended_json.h`.
+class ExtendedJsonField {
+  /// Bitmask of the extended fields found in each row.
+  static const int presence = 99;
+
+  /// Extended field `i` has field id `first + i`.
+  static const int first = 100;
+}
+
+/// A collection delta event, see `EncodeCollectionDelta` in
+/// `windows/collection_sync.h`.
+class CollectionDeltaEvent {
+  CollectionDeltaEvent(this.hresult, this.message, this.fromVersion,
+      this.version, this.removed, this.changed);
+
+  final int hresult;
+  final String message;
+  final int fromVersion;
+  final int version;
+  final List<String> removed;
+  final ColumnarTable changed;
+}
+
+/// Client of the raw-bytes bulk channel, see `windows/bulk_channel.h`.
+class BulkStoreApi {
+  BulkStoreApi({BinaryMessenger? binaryMessenger})
+      : _binaryMessenger = binaryMessenger;
+
+  static const String channelName = 'dev.flutter.windows_store.bulk';
+  static const String eventsChannelName = 'dev.flutter.windows_store.events';
+
+  static const int _getAssociatedStoreProducts = 1;
+  static const int _getAppLicense = 2;
+  static const int _queryCatalog = 3;
+  static const int _runBatchQuery = 4;
+  static const int _getStoreProduct = 5;
+  static const int _getProductImages = 6;
+  static const int _syncUserCollection = 7;
+  static const int _batchItemEvent = 1;
+  static const int _collectionDeltaEvent = 2;
+  static const int _eventHeaderSize = 8;
+  static const int _replyHeaderSize = 8;
+  static const int _pageHeaderSize = 8;
+
+  final BinaryMessenger? _binaryMessenger;
+
+  // Listeners of streamed batch items, by stream id. Shared by all instances
+  // since there is a single events channel.
+  static final Map<int, void Function(int index, ColumnarTable item)>
+      _batchListeners = {};
+  static final Map<int, void Function(CollectionDeltaEvent delta)>
+      _collectionListeners = {};
+  static int _nextStreamId = 1;
+  static BinaryMessenger? _eventsMessenger;
+
+  BinaryMessenger get _messenger =>
+      _binaryMessenger ?? ServicesBinding.instance.defaultBinaryMessenger;
+
+  /// Only the fields whose bit is set in [fieldMask] are sent, followed by
+  /// the [extendedFields] (JSON Pointer and `JsonFieldType`) extracted from
+  /// each product's ExtendedJsonData.
+  Future<ColumnarTable> getAssociatedStoreProducts(
+      List<String> productKinds, int fieldMask,
+      {List<(String, int)> extendedFields = const []}) async {
+    final request = WriteBuffer()..putUint8(_getAssociatedStoreProducts);
+    _putStringList(request, productKinds);
+    request.putUint64(fieldMask, endian: Endian.little);
+    _putJsonFields(request, extendedFields);
+    return _send(request);
+  }
+
+  /// Returns the license as a single row table with the fields whose bit is
+  /// set in [fieldMask], followed by the [extendedFields].
+  Future<ColumnarTable> getAppLicense(int fieldMask,
+      {List<(String, int)> extendedFields = const []}) async {
+    final request = WriteBuffer()
+      ..putUint8(_getAppLicense)
+      ..putUint64(fieldMask, endian: Endian.little);
+    _putJsonFields(request, extendedFields);
+    return _send(request);
+  }
+
+  /// Returns the total number of matches and the requested page of them.
+  Future<(int, ColumnarTable)> queryCatalog({
+    required List<String> productKinds,
+    required int ownership,
+    double? minPrice,
+    double? maxPrice,
+    required String keyword,
+    required int offset,
+    required int limit,
+    required int fieldMask,
+  }) async {
+    final request = WriteBuffer()..putUint8(_queryCatalog);
+    _putStringList(request, productKinds);
+    request
+      ..putUint8(ownership)
+      ..putUint8(minPrice != null ? 1 : 0)
+      ..putUint8(maxPrice != null ? 1 : 0)
+      ..putFloat64(minPrice ?? 0, endian: Endian.little)
+      ..putFloat64(maxPrice ?? 0, endian: Endian.little);
+    _putString(request, keyword);
+    request
+      ..putUint32(offset, endian: Endian.little)
+      ..putUint32(limit, endian: Endian.little)
+      ..putUint64(fieldMask, endian: Endian.little);
+    final body = await _sendRaw(request);
+    final total = body.getUint32(0, Endian.little);
+    return (total, ColumnarTable(ByteData.sublistView(body, _pageHeaderSize)));
+  }
+
+  /// Runs [query] for each of [storeIds] with up to [maxParallel] Store calls
+  /// in flight. Items are also passed to [onItem] as they complete.
+  Future<ColumnarTable> runBatchQuery(
+      int query, List<String> storeIds, int maxParallel,
+      {void Function(int index, ColumnarTable item)? onItem}) async {
+    var streamId = 0;
+    if (onItem != null) {
+      _listenForEvents();
+      streamId = _nextStreamId++;
+      _batchListeners[streamId] = onItem;
+    }
+    try {
+      final request = WriteBuffer()
+        ..putUint8(_runBatchQuery)
+        ..putUint8(query);
+      _putStringList(request, storeIds);
+      request
+        ..putUint32(maxParallel, endian: Endian.little)
+        ..putUint32(streamId, endian: Endian.little);
+      return await _send(request);
+    } finally {
+      _batchListeners.remove(streamId);
+    }
+  }
+
+  /// Returns the product [storeId] as a single row table, or an empty table
+  /// if the Store has no such product. Lookups sent close together are
+  /// answered by one batched Store call.
+  Future<ColumnarTable> getStoreProduct(String storeId, int fieldMask,
+      {List<(String, int)> extendedFields = const []}) async {
+    final request = WriteBuffer()..putUint8(_getStoreProduct);
+    _putString(request, storeId);
+    request.putUint64(fieldMask, endian: Endian.little);
+    _putJsonFields(request, extendedFields);
+    return _send(request);
+  }
+
+  /// Caches the images of the products [storeIds] tagged [purposeTag], or
+  /// all of them if it is empty, and returns a row per image with its local
+  /// path.
+  Future<ColumnarTable> getProductImages(
+      List<String> storeIds, String purposeTag) async {
+    final request = WriteBuffer()..putUint8(_getProductImages);
+    _putStringList(request, storeIds);
+    _putString(request, purposeTag);
+    return _send(request);
+  }
+
+  /// Returns the version and the products of the local copy of the user's
+  /// collection, and passes the changes found once the Store has answered
+  /// to [onDelta].
+  Future<(int, ColumnarTable)> syncUserCollection(List<String> productKinds,
+      int fieldMask, void Function(CollectionDeltaEvent delta) onDelta) async {
+    _listenForEvents();
+    final streamId = _nextStreamId++;
+    _collectionListeners[streamId] = onDelta;
+    try {
+      final request = WriteBuffer()..putUint8(_syncUserCollection);
+      _putStringList(request, productKinds);
+      request
+        ..putUint64(fieldMask, endian: Endian.little)
+        ..putUint32(streamId, endian: Endian.little);
+      final body = await _sendRaw(request);
+      final version = body.getUint64(0, Endian.little);
+      return (version, ColumnarTable(ByteData.sublistView(body, 8)));
+    } catch (_) {
+      _collectionListeners.remove(streamId);
+      rethrow;
+    }
+  }
+
+  void _listenForEvents() {
+    if (_eventsMessenger == _messenger) {
+      return;
+    }
+    _eventsMessenger = _messenger;
+    _messenger.setMessageHandler(eventsChannelName, (ByteData? event) async {
+      if (event != null && event.getUint8(0) == _batchItemEvent) {
+        final streamId = event.getUint32(_eventHeaderSize, Endian.little);
+        final index = event.getUint32(_eventHeaderSize + 4, Endian.little);
+        _batchListeners[streamId]?.call(index,
+            ColumnarTable(ByteData.sublistView(event, _eventHeaderSize + 8)));
+      } else if (event != null &&
+          event.getUint8(0) == _collectionDeltaEvent) {
+        final streamId = event.getUint32(_eventHeaderSize, Endian.little);
+        _collectionListeners.remove(streamId)?.call(_readCollectionDelta(event));
+      }
+      return null;
+    });
+  }
+
+  static CollectionDeltaEvent _readCollectionDelta(ByteData event) {
+    var offset = _eventHeaderSize + 4;
+    String readString() {
+      final length = event.getUint32(offset, Endian.little);
+      final value = utf8.decode(
+          Uint8List.sublistView(event, offset + 4, offset + 4 + length));
+      offset += 4 + length;
+      return value;
+    }
+
+    final hresult = event.getInt32(offset, Endian.little);
+    final fromVersion = event.getUint64(offset + 4, Endian.little);
+    final version = event.getUint64(offset + 12, Endian.little);
+    offset += 20;
+    final message = readString();
+    final removedCount = event.getUint32(offset, Endian.little);
+    offset += 4;
+    final removed = List<String>.generate(removedCount, (_) => readString());
+    // The table is 8-byte aligned within the event.
+    offset = (offset + 7) & ~7;
+    return CollectionDeltaEvent(hresult, message, fromVersion, version,
+        removed, ColumnarTable(ByteData.sublistView(event, offset)));
+  }
+
+  Future<ColumnarTable> _send(WriteBuffer request) async {
+    return ColumnarTable(await _sendRaw(request));
+  }
+
+  Future<ByteData> _sendRaw(WriteBuffer request) async {
+    final reply = await _messenger.send(channelName, request.done());
+    if (reply == null) {
+      throw PlatformException(
+        code: 'channel-error',
+        message: 'Unable to establish connection on channel: "$channelName".',
+      );
+    }
+    if (reply.getUint8(0) != 0) {
+      var offset = _replyHeaderSize;
+      String readString() {
+        final length = reply.getUint32(offset, Endian.little);
+        final value = utf8.decode(
+            Uint8List.sublistView(reply, offset + 4, offset + 4 + length));
+        offset += 4 + length;
+        return value;
+      }
+
+      throw PlatformException(code: readString(), message: readString());
+    }
+    return ByteData.sublistView(reply, _replyHeaderSize);
+  }
+
+  static void _putJsonFields(WriteBuffer buffer, List<(String, int)> fields) {
+    buffer.putUint32(fields.length, endian: Endian.little);
+    for (final (path, type) in fields) {
+      _putString(buffer, path);
+      buffer.putUint8(type);
+    }
+  }
+
+  static void _putStringList(WriteBuffer buffer, List<String> values) {
+    buffer.putUint32(values.length, endian: Endian.little);
+    for (final value in values) {
+      _putString(buffer, value);
+    }
+  }
+
+  static void _putString(WriteBuffer buffer, String value) {
+    final bytes = const Utf8Encoder().convert(value);
+    buffer.putUint32(bytes.length, endian: Endian.little);
+    buffer.putUint8List(bytes);
+  }
+}
@@ -0,0 +1,116 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Column value encodings, see `windows/columnar_writer.h`.
+class ColumnType {
+  static const int boolean = 1;
+  static const int int64 = 2;
+  static const int float64 = 3;
+  static const int string = 4;
+}
+
+/// Lazy reader of the columnar tables sent over the bulk channel.
+///
+/// Nothing is decoded up front: values are read straight out of the
+/// underlying [ByteData] when asked for, and each string of the shared string
+/// table is decoded at most once.
+class ColumnarTable {
+  ColumnarTable(this._data) {
+    if (_data.lengthInBytes < _headerSize ||
+        _data.getUint32(0, Endian.little) != _magic) {
+      throw const FormatException('Not a columnar table');
+    }
+    if (_data.getUint16(4, Endian.little) != _version) {
+      throw const FormatException('Unsupported columnar table version');
+    }
+    final columnCount = _data.getUint16(6, Endian.little);
+    rowCount = _data.getUint32(8, Endian.little);
+    final stringCount = _data.getUint32(12, Endian.little);
+    _stringOffsets = _data.getUint32(16, Endian.little);
+    _stringData = _data.getUint32(20, Endian.little);
+    _strings = List<String?>.filled(stringCount, null);
+    for (var i = 0; i < columnCount; i++) {
+      final descriptor = _headerSize + i * 8;
+      final fieldId = _data.getUint16(descriptor, Endian.little);
+      _columns[fieldId] = _Column(
+        _data.getUint8(descriptor + 2),
+        _data.getUint32(descriptor + 4, Endian.little),
+      );
+    }
+  }
+
+  static const int _magic = 0x46435357;
+  static const int _version = 1;
+  static const int _headerSize = 32;
+
+  final ByteData _data;
+  final Map<int, _Column> _columns = {};
+  late final int rowCount;
+  late final int _stringOffsets;
+  late final int _stringData;
+  late final List<String?> _strings;
+
+  /// Whether the table carries a column for [fieldId].
+  bool hasField(int fieldId) => _columns.containsKey(fieldId);
+
+  bool getBool(int fieldId, int row) =>
+      _data.getUint8(_column(fieldId, ColumnType.boolean).position + row) != 0;
+
+  int getInt(int fieldId, int row) => _data.getInt64(
+      _column(fieldId, ColumnType.int64).position + row * 8, Endian.little);
+
+  double getDouble(int fieldId, int row) => _data.getFloat64(
+      _column(fieldId, ColumnType.float64).position + row * 8, Endian.little);
+
+  String getString(int fieldId, int row) => _string(_data.getUint32(
+      _column(fieldId, ColumnType.string).position + row * 4, Endian.little));
+
+  /// Reads a value of any type, as a bool, int, double or String.
+  Object getValue(int fieldId, int row) {
+    final column = _columns[fieldId];
+    if (column == null) {
+      throw StateError('Field $fieldId was not requested');
+    }
+    switch (column.type) {
+      case ColumnType.boolean:
+        return getBool(fieldId, row);
+      case ColumnType.int64:
+        return getInt(fieldId, row);
+      case ColumnType.float64:
+        return getDouble(fieldId, row);
+      default:
+        return getString(fieldId, row);
+    }
+  }
+
+  _Column _column(int fieldId, int type) {
+    final column = _columns[fieldId];
+    if (column == null) {
+      throw StateError('Field $fieldId was not requested');
+    }
+    if (column.type != type) {
+      throw StateError('Field $fieldId has type ${column.type}, not $type');
+    }
+    return column;
+  }
+
+  String _string(int index) {
+    final cached = _strings[index];
+    if (cached != null) {
+      return cached;
+    }
+    final start = _data.getUint32(_stringOffsets + index * 4, Endian.little);
+    final end = _data.getUint32(_stringOffsets + index * 4 + 4, Endian.little);
+    final value = utf8.decode(Uint8List.sublistView(
+        _data, _stringData + start, _stringData + end));
+    _strings[index] = value;
+    return value;
+  }
+}
+
+class _Column {
+  const _Column(this.type, this.position);
+
+  final int type;
+  final int position;
+}
@@ -1,3 +1,10 @@
+import "dart:async";
+import "dart:collection";
+
+import "package:flutter/services.dart" show PlatformException;
+
+import "src/bulk_api.dart";
+import "src/columnar_table.dart";
 import "src/messages.g.dart" as inner;
 
 class StoreAppLicense {
@@ -26,6 +33,34 @@ class StoreAppLicense {
   /// The remaining time for the usage-limited trial that is associated with this app license.
   final Duration trialTimeRemaining;
 
+  /// Creates a license to be returned by [WindowsStoreApi.getAppLicenseAsync] while the app runs
+  /// without package identity. See [WindowsStoreApi.setSimulatedLicense].
+  factory StoreAppLicense.simulated({
+    bool isActive = true,
+    bool isTrial = false,
+    String skuStoreId = "",
+    String trialUniqueId = "",
+    Duration trialTimeRemaining = Duration.zero,
+  }) {
+    return StoreAppLicense._(
+      isActive: isActive,
+      isTrial: isTrial,
+      skuStoreId: skuStoreId,
+      trialUniqueId: trialUniqueId,
+      trialTimeRemaining: trialTimeRemaining,
+    );
+  }
+
+  inner.StoreAppLicenseInner _toInner() {
+    return inner.StoreAppLicenseInner(
+      isActive: isActive,
+      isTrial: isTrial,
+      skuStoreId: skuStoreId,
+      trialUniqueId: trialUniqueId,
+      trialTimeRemaining: trialTimeRemaining.inMilliseconds,
+    );
+  }
+
   factory StoreAppLicense._fromInner(inner.StoreAppLicenseInner data) {
     return StoreAppLicense._(
       isActive: data.isActive,
@@ -37,11 +72,656 @@ class StoreAppLicense {
   }
 }
 
+/// The kinds of products that can be queried from the Microsoft Store.
+enum StoreProductKind {
+  application("Application"),
+  game("Game"),
+  consumable("Consumable"),
+  unmanagedConsumable("UnmanagedConsumable"),
+  durable("Durable");
+
+  const StoreProductKind(this.value);
+
+  /// The product kind string used by the Store APIs.
+  final String value;
+}
+
+/// The fields of a [StoreProduct] that can be requested from
+/// [WindowsStoreApi.getAssociatedStoreProductsAsync].
+///
+/// The index of each value is its field id on the native side (`ProductField` in
+/// `windows/store_product.h`), so new fields must only be appended.
+enum StoreProductField {
+  storeId,
+  productKind,
+  title,
+  description,
+  formattedPrice,
+  formattedBasePrice,
+  currencyCode,
+  isInUserCollection,
+  hasDigitalDownload,
+  inAppOfferToken,
+  linkUri,
+}
+
+/// The fields of a [StoreAppLicense] that can be requested from [WindowsStoreApi.getAppLicenseFieldsAsync].
+///
+/// The index of each value is its field id on the native side (`LicenseField` in
+/// `windows/license_snapshot.h`), so new fields must only be appended.
+enum StoreAppLicenseField {
+  isActive,
+  isTrial,
+  skuStoreId,
+  trialUniqueId,
+  trialTimeRemaining,
+}
+
+int _fieldMask(Iterable<Enum> fields) {
+  return fields.fold(0, (mask, field) => mask | (1 << field.index));
+}
+
+/// How the value of a [StoreJsonField] is returned.
+///
+/// The index of each value is its id on the native side (`JsonFieldType` in
+/// `windows/json_extractor.h`), so new types must only be appended.
+enum StoreJsonFieldType {
+  /// A JSON string, returned as a [String].
+  string,
+
+  /// A JSON number, returned as a [double].
+  number,
+
+  /// A JSON boolean, returned as a [bool].
+  boolean,
+
+  /// Any JSON value, returned as its JSON text. Use for objects and arrays.
+  raw,
+}
+
+/// A value to pick out of the ExtendedJsonData of a product or license.
+///
+/// The JSON is parsed natively and only the requested values are transferred, so the (often large)
+/// document is never decoded on the Dart side.
+class StoreJsonField {
+  const StoreJsonField(this.path, [this.type = StoreJsonFieldType.string]);
+
+  /// A JSON Pointer (RFC 6901) such as "/DisplaySkuAvailabilities/0/Sku/Title". A "*" segment
+  /// matches any object key or array index; the first match of the right type is returned.
+  final String path;
+
+  final StoreJsonFieldType type;
+}
+
+/// The maximum number of [StoreJsonField]s per request.
+const int maxStoreJsonFields = 64;
+
+List<(String, int)> _jsonFields(List<StoreJsonField> fields) {
+  if (fields.length > maxStoreJsonFields) {
+    throw ArgumentError.value(fields.length, "extendedFields", "At most $maxStoreJsonFields fields are supported");
+  }
+  return [for (final field in fields) (field.path, field.type.index)];
+}
+
+Object? _extendedField(ColumnarTable table, int row, int index) {
+  if (!table.hasField(ExtendedJsonField.presence)) {
+    throw StateError("No extended fields were requested");
+  }
+  if (index < 0 || index >= maxStoreJsonFields || table.getInt(ExtendedJsonField.presence, row) & (1 << index) == 0) {
+    return null;
+  }
+  return table.getValue(ExtendedJsonField.first + index, row);
+}
+
+/// A subset of the fields of a [StoreAppLicense], as returned by
+/// [WindowsStoreApi.getAppLicenseFieldsAsync]. Fields that were not requested are null.
+class StoreAppLicenseFields {
+  StoreAppLicenseFields._(this._table);
+
+  final ColumnarTable _table;
+
+  bool? _getBool(StoreAppLicenseField field) =>
+      _table.hasField(field.index) ? _table.getBool(field.index, 0) : null;
+
+  String? _getString(StoreAppLicenseField field) =>
+      _table.hasField(field.index) ? _table.getString(field.index, 0) : null;
+
+  /// See [StoreAppLicense.isActive].
+  bool? get isActive => _getBool(StoreAppLicenseField.isActive);
+
+  /// See [StoreAppLicense.isTrial].
+  bool? get isTrial => _getBool(StoreAppLicenseField.isTrial);
+
+  /// See [StoreAppLicense.skuStoreId].
+  String? get skuStoreId => _getString(StoreAppLicenseField.skuStoreId);
+
+  /// See [StoreAppLicense.trialUniqueId].
+  String? get trialUniqueId => _getString(StoreAppLicenseField.trialUniqueId);
+
+  /// See [StoreAppLicense.trialTimeRemaining].
+  Duration? get trialTimeRemaining {
+    final id = StoreAppLicenseField.trialTimeRemaining.index;
+    return _table.hasField(id) ? Duration(milliseconds: _table.getInt(id, 0)) : null;
+  }
+
+  /// The value of the [index]th requested [StoreJsonField], or null if the license ExtendedJsonData
+  /// has no value of that type at its path.
+  Object? extendedField(int index) => _extendedField(_table, 0, index);
+}
+
+/// A product from the Microsoft Store catalog.
+///
+/// Values are read lazily from the bulk payload the product was delivered in. Reading a field that
+/// was not requested throws a [StateError].
+class StoreProduct {
+  StoreProduct._(this._table, this._row);
+
+  final ColumnarTable _table;
+  final int _row;
+
+  /// The Store ID for this product.
+  String get storeId => _table.getString(StoreProductField.storeId.index, _row);
+
+  /// The type of the product, for example "Durable" or "Consumable".
+  String get productKind =>
+      _table.getString(StoreProductField.productKind.index, _row);
+
+  /// The product title from the Microsoft Store listing.
+  String get title => _table.getString(StoreProductField.title.index, _row);
+
+  /// The product description from the Microsoft Store listing.
+  String get description =>
+      _table.getString(StoreProductField.description.index, _row);
+
+  /// The purchase price with the appropriate formatting for the current market.
+  String get formattedPrice =>
+      _table.getString(StoreProductField.formattedPrice.index, _row);
+
+  /// The base price with the appropriate formatting for the current market.
+  String get formattedBasePrice =>
+      _table.getString(StoreProductField.formattedBasePrice.index, _row);
+
+  /// The ISO 4217 currency code for the market of the current user.
+  String get currencyCode =>
+      _table.getString(StoreProductField.currencyCode.index, _row);
+
+  /// True if the current user owns this product.
+  bool get isInUserCollection =>
+      _table.getBool(StoreProductField.isInUserCollection.index, _row);
+
+  /// True if the product has optional downloadable content.
+  bool get hasDigitalDownload =>
+      _table.getBool(StoreProductField.hasDigitalDownload.index, _row);
+
+  /// The in-app offer token set in Partner Center for an add-on.
+  String get inAppOfferToken =>
+      _table.getString(StoreProductField.inAppOfferToken.index, _row);
+
+  /// The URI of the Microsoft Store listing for the product.
+  String get linkUri => _table.getString(StoreProductField.linkUri.index, _row);
+
+  /// The value of the [index]th requested [StoreJsonField], or null if the product ExtendedJsonData
+  /// has no value of that type at its path.
+  Object? extendedField(int index) => _extendedField(_table, _row, index);
+}
+
+/// A read-only list of products backed by a single bulk payload.
+class StoreProductList extends ListBase<StoreProduct> {
+  StoreProductList._(this._table);
+
+  final ColumnarTable _table;
+
+  @override
+  int get length => _table.rowCount;
+
+  @override
+  set length(int newLength) =>
+      throw UnsupportedError("Cannot change the length of a StoreProductList");
+
+  @override
+  StoreProduct operator [](int index) {
+    RangeError.checkValidIndex(index, this);
+    return StoreProduct._(_table, index);
+  }
+
+  @override
+  void operator []=(int index, StoreProduct value) =>
+      throw UnsupportedError("Cannot modify a StoreProductList");
+}
+
+/// Ownership filter of a [StoreCatalogQuery]. Must match `CatalogQuery::Ownership` in
+/// `windows/catalog_index.h`.
+enum StoreProductOwnership {
+  any,
+  owned,
+  notOwned,
+}
+
+/// Filter and page of a [WindowsStoreApi.queryCatalogAsync] call.
+class StoreCatalogQuery {
+  const StoreCatalogQuery({
+    this.productKinds = const [],
+    this.minPrice,
+    this.maxPrice,
+    this.ownership = StoreProductOwnership.any,
+    this.keyword = "",
+    this.offset = 0,
+    this.limit = 50,
+    this.fields,
+  });
+
+  /// Kinds of products to return. Empty returns all kinds.
+  final List<StoreProductKind> productKinds;
+
+  /// Inclusive price range, parsed from [StoreProduct.formattedPrice] in the user's market.
+  final double? minPrice;
+  final double? maxPrice;
+
+  final StoreProductOwnership ownership;
+
+  /// Every word of [keyword] must be the start of a word of the product title. Case-insensitive.
+  final String keyword;
+
+  /// Number of matching products to skip, for paging.
+  final int offset;
+
+  /// Maximum number of products to return. 0 returns no products, only the total count.
+  final int limit;
+
+  /// Fields of the returned products, all if null. Request only [StoreProductField.storeId] to
+  /// get matching IDs only.
+  final Set<StoreProductField>? fields;
+}
+
+/// One page of the result of [WindowsStoreApi.queryCatalogAsync].
+class StoreCatalogPage {
+  StoreCatalogPage._(this.totalCount, this.products);
+
+  /// Number of products matching the query, across all pages.
+  final int totalCount;
+
+  /// The products of this page, ordered by price.
+  final StoreProductList products;
+}
+
+/// Values of the Store's `StoreConsumableStatus`.
+enum StoreConsumableStatus {
+  succeeded,
+  insufficientQuantity,
+  networkError,
+  serverError,
+}
+
+/// The remaining balance of a consumable add-on, see [WindowsStoreApi.getConsumableBalancesAsync].
+class StoreConsumableBalance {
+  StoreConsumableBalance._(this.status, this.balanceRemaining, this.trackingId);
+
+  final StoreConsumableStatus status;
+
+  /// The remaining balance of the consumable add-on.
+  final int balanceRemaining;
+
+  /// The tracking ID that was submitted with the request to fulfill the add-on.
+  final String trackingId;
+}
+
+/// The outcome of a batched query for one Store ID. Exactly one of [value] and [error] is set.
+class StoreBatchItem<T> {
+  StoreBatchItem._(this.storeId, this.value, this.error);
+
+  final String storeId;
+  final T? value;
+  final PlatformException? error;
+
+  bool get ok => error == null;
+
+  static StoreBatchItem<T> _fromTable<T>(
+      ColumnarTable table, int row, T Function(ColumnarTable table, int row) read) {
+    final storeId = table.getString(BatchItemField.storeId, row);
+    final hresult = table.getInt(BatchItemField.hresult, row);
+    if (hresult < 0) {
+      return StoreBatchItem._(
+          storeId,
+          null,
+          PlatformException(
+              code: hresult.toString(), message: table.getString(BatchItemField.errorMessage, row)));
+    }
+    return StoreBatchItem._(storeId, read(table, row), null);
+  }
+}
+
+/// Counters of the plugin's native cache of Store data, see [WindowsStoreApi.getCacheStatsAsync].
+class StoreCacheStats {
+  StoreCacheStats._(List<int> values)
+      : hits = values[0],
+        misses = values[1],
+        evictions = values[2],
+        entries = values[3],
+        bytes = values[4],
+        pinnedBytes = values[5],
+        budgetBytes = values[6];
+
+  /// Lookups answered from the cache since the app started.
+  final int hits;
+  final int misses;
+
+  /// Entries dropped to stay within [budgetBytes].
+  final int evictions;
+
+  /// Number of cached products.
+  final int entries;
+
+  /// Approximate memory used by the cache, including [pinnedBytes].
+  final int bytes;
+
+  /// Memory used by the app license, which is never evicted.
+  final int pinnedBytes;
+  final int budgetBytes;
+
+  double get hitRatio => hits + misses == 0 ? 0 : hits / (hits + misses);
+}
+
+/// An image of a product cached on disk by [WindowsStoreApi.getProductImagesAsync]. Exactly one of
+/// [path] and [error] is set.
+class StoreProductImage {
+  StoreProductImage._(this.storeId, this.uri, this.purposeTag, this.width, this.height, this.path, this.error);
+
+  final String storeId;
+  final String uri;
+
+  /// For example "Logo", "Tile" or "Screenshot".
+  final String purposeTag;
+  final int width;
+  final int height;
+
+  /// The local file holding the image, for example for `Image.file`. Valid until the image is
+  /// evicted from the cache.
+  final String? path;
+  final PlatformException? error;
+
+  static StoreProductImage _fromTable(ColumnarTable table, int row) {
+    final hresult = table.getInt(ProductImageField.hresult, row);
+    return StoreProductImage._(
+      table.getString(ProductImageField.storeId, row),
+      table.getString(ProductImageField.uri, row),
+      table.getString(ProductImageField.purposeTag, row),
+      table.getInt(ProductImageField.width, row),
+      table.getInt(ProductImageField.height, row),
+      hresult < 0 ? null : table.getString(ProductImageField.path, row),
+      hresult < 0
+          ? PlatformException(code: hresult.toString(), message: table.getString(ProductImageField.errorMessage, row))
+          : null,
+    );
+  }
+}
+
+/// The user's collection as kept by [WindowsStoreApi.syncUserCollectionAsync].
+class StoreUserCollection {
+  StoreUserCollection._(this.version, this.products);
+
+  /// Grows whenever the collection changes. 0 for the empty collection a first sync starts from.
+  final int version;
+
+  /// The products the user owns, sorted by Store ID.
+  final List<StoreProduct> products;
+
+  /// This collection with [delta] applied. Throws a [StateError] if [delta] was not computed from
+  /// this [version].
+  StoreUserCollection applyDelta(StoreCollectionDelta delta) {
+    if (delta.fromVersion != version) {
+      throw StateError("Delta from version ${delta.fromVersion} applied to version $version");
+    }
+    if (delta.isEmpty) {
+      return StoreUserCollection._(delta.version, products);
+    }
+    final byId = {for (final product in products) product.storeId: product};
+    for (final storeId in delta.removed) {
+      byId.remove(storeId);
+    }
+    for (final product in delta.changed) {
+      byId[product.storeId] = product;
+    }
+    final storeIds = byId.keys.toList()..sort();
+    return StoreUserCollection._(
+        delta.version, List.unmodifiable(storeIds.map((storeId) => byId[storeId]!)));
+  }
+}
+
+/// The changes to the user's collection found by [WindowsStoreApi.syncUserCollectionAsync].
+class StoreCollectionDelta {
+  StoreCollectionDelta._(this.fromVersion, this.version, this.changed, this.removed);
+
+  final int fromVersion;
+  final int version;
+
+  /// Products added to the collection or changed since [fromVersion], sorted by Store ID.
+  final StoreProductList changed;
+
+  /// Store IDs of the products no longer in the collection, sorted.
+  final List<String> removed;
+
+  bool get isEmpty => changed.isEmpty && removed.isEmpty;
+}
+
+/// A sync started by [WindowsStoreApi.syncUserCollectionAsync].
+class StoreCollectionSync {
+  StoreCollectionSync._(this.local, this.delta);
+
+  /// The collection as of the last sync, possibly made in an earlier launch of the app.
+  final StoreUserCollection local;
+
+  /// Completes with the changes from [local] once the Store has answered, or with a
+  /// [PlatformException] if it could not be queried, in which case [local] stays the latest copy.
+  final Future<StoreCollectionDelta> delta;
+
+  /// [local] updated with [delta].
+  Future<StoreUserCollection> get synced async => local.applyDelta(await delta);
+}
+
 class WindowsStoreApi {
+  /// The [PlatformException.code] thrown by Store calls when the app runs without package identity
+  /// (for example an unpackaged debug build) and no simulated license is set.
+  static const String noPackageIdentityErrorCode = "no-package-identity";
+
   final _api = inner.WindowsStoreApi();
+  final _bulkApi = BulkStoreApi();
 
   /// Get's the license information for from the Microsoft Store. Only works on Windows.
   Future<StoreAppLicense> getAppLicenseAsync() async {
     return StoreAppLicense._fromInner(await _api.getAppLicenseAsync());
   }
+
+  /// Sets the license returned by [getAppLicenseAsync] when the Store cannot be queried, either
+  /// because the app has no package identity or because the Store returned a permanent error.
+  /// Pass null to throw a [PlatformException] instead, which is the default.
+  ///
+  /// The Store is never called in these cases, so the simulated license is returned immediately.
+  Future<void> setSimulatedLicense(StoreAppLicense? license) async {
+    await _api.setSimulatedLicense(license?._toInner());
+  }
+
+  /// Registers which Store products unlock each app feature.
+  ///
+  /// [features] maps a feature name to the Store IDs that enable it. A Store ID can be an app or
+  /// add-on SKU Store ID ("9NBLGGH4R315/0010"), a product Store ID ("9NBLGGH4R315", matching any of
+  /// its SKUs) or an add-on's in-app offer token. The plugin keeps a precomputed entitlement bitset
+  /// that is only recomputed when the license changes, so feature checks do not transfer the license.
+  Future<void> registerFeatures(Map<String, List<String>> features) async {
+    await _api.registerFeatures(features);
+  }
+
+  /// Whether any Store ID registered for [feature] has an active license. Only works on Windows.
+  Future<bool> isFeatureEnabledAsync(String feature) async {
+    return _api.isFeatureEnabledAsync(feature);
+  }
+
+  /// Batched version of [isFeatureEnabledAsync], returning one value per entry of [features].
+  Future<List<bool>> areFeaturesEnabledAsync(List<String> features) async {
+    return _api.areFeaturesEnabledAsync(features);
+  }
+
+  /// Gets only the requested [fields] of the app license. Only works on Windows.
+  ///
+  /// Fields that are not requested are neither read from the Store nor transferred, and add-on
+  /// licenses are skipped entirely. Use [getAppLicenseAsync] for the complete license.
+  ///
+  /// [extendedFields] are extracted from the license ExtendedJsonData and read with
+  /// [StoreAppLicenseFields.extendedField].
+  Future<StoreAppLicenseFields> getAppLicenseFieldsAsync(Set<StoreAppLicenseField> fields,
+      {List<StoreJsonField> extendedFields = const []}) async {
+    return StoreAppLicenseFields._(
+        await _bulkApi.getAppLicense(_fieldMask(fields), extendedFields: _jsonFields(extendedFields)));
+  }
+
+  /// Gets the add-ons and other products associated with the current app. Only works on Windows.
+  ///
+  /// Products are transferred in a compact columnar format and decoded lazily, so large catalogs
+  /// stay cheap to fetch even when only a few fields are read. Pass [fields] to only read and
+  /// transfer those fields; the others throw a [StateError] when accessed.
+  ///
+  /// [extendedFields] are extracted natively from each product's ExtendedJsonData and read with
+  /// [StoreProduct.extendedField], for example SKU availabilities or market data.
+  Future<StoreProductList> getAssociatedStoreProductsAsync(List<StoreProductKind> productKinds,
+      {Set<StoreProductField>? fields, List<StoreJsonField> extendedFields = const []}) async {
+    return StoreProductList._(await _bulkApi.getAssociatedStoreProducts(
+        productKinds.map((kind) => kind.value).toList(), _fieldMask(fields ?? StoreProductField.values),
+        extendedFields: _jsonFields(extendedFields)));
+  }
+
+  /// Gets the product with the Store ID [storeId], or null if the Store has no such product. Only
+  /// works on Windows.
+  ///
+  /// Meant for widgets that each show one product: lookups made within a short window of each other
+  /// are merged natively into a single Store call, so a screen of product tiles costs one Store call
+  /// rather than one per tile. See [setProductBatchWindow]. [fields] and [extendedFields] work as for
+  /// [getAssociatedStoreProductsAsync].
+  Future<StoreProduct?> getStoreProductAsync(String storeId,
+      {Set<StoreProductField>? fields, List<StoreJsonField> extendedFields = const []}) async {
+    final table = await _bulkApi.getStoreProduct(storeId, _fieldMask(fields ?? StoreProductField.values),
+        extendedFields: _jsonFields(extendedFields));
+    return table.rowCount == 0 ? null : StoreProduct._(table, 0);
+  }
+
+  /// Sets how [getStoreProductAsync] lookups are batched: a batch is sent [window] after its first
+  /// lookup, or as soon as it holds [maxBatchSize] distinct Store IDs. Defaults to 8 ms and 50
+  /// products. [Duration.zero] sends every lookup on its own.
+  Future<void> setProductBatchWindow(Duration window, {int maxBatchSize = 50}) async {
+    await _api.setProductBatchWindow(window.inMicroseconds, maxBatchSize);
+  }
+
+  /// Sets the memory budget of the native cache of Store data, which keeps the products returned by
+  /// [getStoreProductAsync] and the app license. Defaults to 16 MiB. Least recently used products
+  /// are evicted to stay within it; the app license is never evicted.
+  Future<void> setCacheBudget(int budgetBytes) async {
+    await _api.setCacheBudget(budgetBytes);
+  }
+
+  /// Returns the counters of the native cache of Store data, see [setCacheBudget].
+  Future<StoreCacheStats> getCacheStatsAsync() async {
+    return StoreCacheStats._(await _api.getCacheStats());
+  }
+
+  /// Downloads the images of the products [storeIds] into the plugin's on-disk image cache and
+  /// returns them with their local paths, in the order of [storeIds]. Only works on Windows.
+  ///
+  /// Pass [purposeTag], for example "Logo", to only fetch images with that tag. The cache is
+  /// content-addressed and shared by all callers: images already cached are not downloaded again,
+  /// images being downloaded are not downloaded twice, and only a few downloads run at a time.
+  /// Images that could not be downloaded carry their own [StoreProductImage.error]. Products the Store
+  /// does not know are left out.
+  Future<List<StoreProductImage>> getProductImagesAsync(List<String> storeIds, {String? purposeTag}) async {
+    final table = await _bulkApi.getProductImages(storeIds, purposeTag ?? "");
+    return List.generate(table.rowCount, (row) => StoreProductImage._fromTable(table, row), growable: false);
+  }
+
+  /// Sets the disk space the image cache of [getProductImagesAsync] may use. Defaults to 64 MiB.
+  /// Least recently used images are deleted to stay within it.
+  Future<void> setImageCacheLimit(int maxBytes) async {
+    await _api.setImageCacheLimit(maxBytes);
+  }
+
+  /// Syncs the products of [productKinds] the current user owns with a copy kept on disk, so
+  /// entitlements can be shown at startup without waiting for the Store. Only works on Windows.
+  ///
+  /// Returns right away with the copy from the last sync, empty on the first one, while the Store is
+  /// queried in the background; only the changes from that copy are then sent, through
+  /// [StoreCollectionSync.delta]. The copy is checksummed and replaced atomically, so a sync
+  /// interrupted by the app exiting leaves the previous copy in place. [fields] work as for
+  /// [getAssociatedStoreProductsAsync], and [StoreProduct.storeId] is always included. A single copy
+  /// is kept: syncing other [productKinds] or [fields] starts over from an empty one.
+  Future<StoreCollectionSync> syncUserCollectionAsync(List<StoreProductKind> productKinds,
+      {Set<StoreProductField>? fields}) async {
+    final delta = Completer<StoreCollectionDelta>();
+    final (version, table) = await _bulkApi.syncUserCollection(
+        productKinds.map((kind) => kind.value).toList(), _fieldMask(fields ?? StoreProductField.values), (event) {
+      if (event.hresult < 0) {
+        delta.completeError(PlatformException(code: event.hresult.toString(), message: event.message));
+      } else {
+        delta.complete(StoreCollectionDelta._(
+            event.fromVersion, event.version, StoreProductList._(event.changed), List.unmodifiable(event.removed)));
+      }
+    });
+    return StoreCollectionSync._(StoreUserCollection._(version, StoreProductList._(table)), delta.future);
+  }
+
+  /// Gets the remaining balance of each consumable add-on in [storeIds]. Only works on Windows.
+  ///
+  /// The Store is queried for up to [maxParallel] add-ons at a time, in a single channel call. Items
+  /// that fail carry their own [StoreBatchItem.error] instead of failing the whole batch. Pass
+  /// [onItem] to receive each item as soon as it completes.
+  Future<List<StoreBatchItem<StoreConsumableBalance>>> getConsumableBalancesAsync(List<String> storeIds,
+      {int maxParallel = 4, void Function(int index, StoreBatchItem<StoreConsumableBalance> item)? onItem}) async {
+    return _runBatchQuery(BatchQuery.consumableBalance, storeIds, maxParallel, onItem, (table, row) {
+      return StoreConsumableBalance._(
+        StoreConsumableStatus.values[table.getInt(BatchItemField.balanceStatus, row)],
+        table.getInt(BatchItemField.balanceRemaining, row),
+        table.getString(BatchItemField.trackingId, row),
+      );
+    });
+  }
+
+  /// Checks whether the current user owns each product in [storeIds], for example to sweep
+  /// entitlements at login. Only works on Windows. See [getConsumableBalancesAsync] for the
+  /// batching behavior.
+  Future<List<StoreBatchItem<bool>>> getUserCollectionAsync(List<String> storeIds,
+      {int maxParallel = 4, void Function(int index, StoreBatchItem<bool> item)? onItem}) async {
+    return _runBatchQuery(BatchQuery.userCollection, storeIds, maxParallel, onItem,
+        (table, row) => table.getBool(BatchItemField.isInUserCollection, row));
+  }
+
+  Future<List<StoreBatchItem<T>>> _runBatchQuery<T>(int query, List<String> storeIds, int maxParallel,
+      void Function(int index, StoreBatchItem<T> item)? onItem, T Function(ColumnarTable table, int row) read) async {
+    final table = await _bulkApi.runBatchQuery(query, storeIds, maxParallel,
+        onItem: onItem == null ? null : (index, item) => onItem(index, StoreBatchItem._fromTable(item, 0, read)));
+    return List.generate(table.rowCount, (row) => StoreBatchItem._fromTable(table, row, read), growable: false);
+  }
+
+  /// Filters and searches the associated products without transferring the whole catalog. Only
+  /// works on Windows.
+  ///
+  /// The plugin keeps a native index of the catalog that is loaded on first use and refreshed
+  /// incrementally after licenses change or [getAssociatedStoreProductsAsync] returned new data, so
+  /// only the requested page of matching products is sent to Dart.
+  Future<StoreCatalogPage> queryCatalogAsync(StoreCatalogQuery query) async {
+    final (total, table) = await _bulkApi.queryCatalog(
+      productKinds: query.productKinds.map((kind) => kind.value).toList(),
+      ownership: query.ownership.index,
+      minPrice: query.minPrice,
+      maxPrice: query.maxPrice,
+      keyword: query.keyword,
+      offset: query.offset,
+      limit: query.limit,
+      fieldMask: _fieldMask(query.fields ?? StoreProductField.values),
+    );
+    return StoreCatalogPage._(total, StoreProductList._(table));
+  }
+
+  /// Writes the plugin's flight recorder, a summary of the last Store calls with their results,
+  /// HRESULTs and latencies, to [path] and returns the path written. Defaults to a file in the
+  /// temporary directory. Only works on Windows.
+  ///
+  /// Decode the file with `dart run tool/decode_flight_recorder.dart <path>`.
+  Future<String> dumpFlightRecorderAsync([String? path]) async {
+    return await _api.dumpFlightRecorder(path);
+  }
 }
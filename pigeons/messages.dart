@@ -29,4 +29,25 @@ class StoreAppLicenseInner {
 abstract class WindowsStoreApi {
   @async
   StoreAppLicenseInner getAppLicenseAsync();
+
+  void setSimulatedLicense(StoreAppLicenseInner? license);
+
+  void registerFeatures(Map<String, List<String>> features);
+
+  @async
+  bool isFeatureEnabledAsync(String feature);
+
+  @async
+  List<bool> areFeaturesEnabledAsync(List<String> features);
+
+  String dumpFlightRecorder(String? path);
+
+  void setProductBatchWindow(int windowMicroseconds, int maxBatchSize);
+
+  void setCacheBudget(int budgetBytes);
+
+  /// Hits, misses, evictions, entries, bytes, pinned bytes and budget bytes.
+  List<int> getCacheStats();
+
+  void setImageCacheLimit(int maxBytes);
 }
@@ -0,0 +1,129 @@
+// Micro-benchmarks of the plugin's native components, each compared to the
+// straightforward implementation it replaces. See README.md.
+
+#include "benchmarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    struct Benchmark
+    {
+      const char *name;
+      bool (*run)(const BenchmarkOptions &options);
+    };
+
+    constexpr Benchmark kBenchmarks[] = {
+        {"catalog", RunCatalogIndexBenchmark},
+        {"json", RunJsonExtractorBenchmark},
+        {"batcher", RunProductBatcherBenchmark},
+        {"cache", RunStoreCacheBenchmark},
+        {"features", RunFeaturesBenchmark},
+        {"fields", RunFieldMaskBenchmark},
+        {"priority", RunWorkQueueBenchmark},
+    };
+
+    void PrintUsage()
+    {
+      std::printf(
+          "Usage: store_benchmarks [options]\n"
+          "  --benchmark=NAME   catalog, json, batcher, cache, features, fields,\n"
+          "                     priority or all (default all)\n"
+          "  --size=N           input size, 0 for the benchmark's default (default 0)\n"
+          "  --runs=N           runs per measurement, the best is reported (default 5)\n");
+    }
+
+  } // namespace
+
+  double BestMs(size_t runs, const std::function<void()> &run)
+  {
+    double best = 0;
+    for (size_t i = 0; i < runs; i++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      run();
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+  }
+
+  int RunBenchmarks(int argc, char **argv)
+  {
+    std::string benchmark = "all";
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+      std::string argument = argv[i];
+      size_t equals = argument.find('=');
+      if (argument.compare(0, 2, "--") != 0 || equals == std::string::npos)
+      {
+        PrintUsage();
+        return 2;
+      }
+      std::string name = argument.substr(2, equals - 2);
+      std::string value = argument.substr(equals + 1);
+      char *end = nullptr;
+      unsigned long long number = std::strtoull(value.c_str(), &end, 10);
+      bool is_number = !value.empty() && *end == '\0';
+      if (name == "benchmark")
+      {
+        benchmark = value;
+      }
+      else if (name == "size" && is_number)
+      {
+        options.size = static_cast<size_t>(number);
+      }
+      else if (name == "runs" && is_number && number > 0)
+      {
+        options.runs = static_cast<size_t>(number);
+      }
+      else
+      {
+        PrintUsage();
+        return 2;
+      }
+    }
+
+    bool found = false;
+    bool ok = true;
+    for (const Benchmark &entry : kBenchmarks)
+    {
+      if (benchmark != "all" && benchmark != entry.name)
+      {
+        continue;
+      }
+      if (found)
+      {
+        std::printf("\n");
+      }
+      found = true;
+      if (!entry.run(options))
+      {
+        std::fprintf(stderr, "%s: results differ from the reference implementation\n", entry.name);
+        ok = false;
+      }
+    }
+    if (!found)
+    {
+      PrintUsage();
+      return 2;
+    }
+    return ok ? 0 : 1;
+  }
+
+} // namespace windows_store
+
+int main(int argc, char **argv)
+{
+  return windows_store::RunBenchmarks(argc, argv);
+}
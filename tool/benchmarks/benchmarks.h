@@ -0,0 +1,34 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_TOOL_BENCHMARKS_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_TOOL_BENCHMARKS_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace windows_store
+{
+
+  struct BenchmarkOptions
+  {
+    // Input size, e.g. the number of products. 0 uses the benchmark's
+    // default.
+    size_t size = 0;
+    // Each measurement reports the best of this many runs.
+    size_t runs = 5;
+  };
+
+  // Best time of |runs| calls of |run|, in milliseconds.
+  double BestMs(size_t runs, const std::function<void()> &run);
+
+  // Each benchmark prints its results and returns false if the component
+  // disagreed with the straightforward implementation it is compared to.
+  bool RunCatalogIndexBenchmark(const BenchmarkOptions &options);
+  bool RunFeaturesBenchmark(const BenchmarkOptions &options);
+  bool RunFieldMaskBenchmark(const BenchmarkOptions &options);
+  bool RunJsonExtractorBenchmark(const BenchmarkOptions &options);
+  bool RunProductBatcherBenchmark(const BenchmarkOptions &options);
+  bool RunStoreCacheBenchmark(const BenchmarkOptions &options);
+  bool RunWorkQueueBenchmark(const BenchmarkOptions &options);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_TOOL_BENCHMARKS_H_
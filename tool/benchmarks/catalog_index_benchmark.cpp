@@ -0,0 +1,230 @@
+// Builds, updates and queries a CatalogIndex of a synthetic catalog and
+// compares each query with filtering and sorting the whole catalog, as a
+// caller without the index would.
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarks.h"
+#include "catalog_index.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultProducts = 50000;
+    constexpr size_t kVocabulary = 2000;
+    constexpr size_t kQueriesPerRun = 20;
+
+    const char *const kKinds[] = {"Durable", "Durable", "Consumable", "UnmanagedConsumable", "Game"};
+
+    std::vector<StoreProductRecord> SyntheticCatalog(size_t count)
+    {
+      static const char *const kSyllables[] = {"ka", "lo", "mi", "ra", "ten", "vo", "ships", "dra", "gon",
+                                               "star", "pix", "el", "quest", "nor", "ze", "bu"};
+      std::mt19937 random(42);
+      std::vector<std::string> vocabulary;
+      for (size_t i = 0; i < kVocabulary; i++)
+      {
+        std::string word;
+        for (size_t syllables = 2 + random() % 2; syllables > 0; syllables--)
+        {
+          word += kSyllables[random() % (sizeof(kSyllables) / sizeof(kSyllables[0]))];
+        }
+        word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        vocabulary.push_back(std::move(word));
+      }
+
+      std::vector<StoreProductRecord> products(count);
+      for (size_t i = 0; i < count; i++)
+      {
+        StoreProductRecord &product = products[i];
+        product.store_id = "9N" + std::to_string(100000 + i);
+        product.product_kind = kKinds[random() % (sizeof(kKinds) / sizeof(kKinds[0]))];
+        product.title = vocabulary[random() % kVocabulary] + " " + vocabulary[random() % kVocabulary] + " " +
+                        std::to_string(random() % 10);
+        uint32_t cents = random() % 1000 == 0 ? 0 : 49 + random() % 20000;
+        if (cents == 0)
+        {
+          product.formatted_price = "Free";
+        }
+        else if (i % 3 == 0)
+        {
+          product.formatted_price = std::to_string(cents / 100) + "," + std::to_string(10 + cents % 90) + " \xe2\x82\xac";
+        }
+        else
+        {
+          product.formatted_price = "$" + std::to_string(cents / 100) + "." + std::to_string(10 + cents % 90);
+        }
+        product.is_in_user_collection = random() % 10 == 0;
+      }
+      return products;
+    }
+
+    // Filters and sorts every product for each query.
+    class CatalogScan
+    {
+    public:
+      explicit CatalogScan(const std::vector<StoreProductRecord> &products) : products_(products)
+      {
+        for (const StoreProductRecord &product : products)
+        {
+          prices_.push_back(CatalogIndex::ParsePrice(product.formatted_price, product.currency_code));
+          words_.push_back(CatalogIndex::Words(product.title));
+        }
+      }
+
+      CatalogPage Query(const CatalogQuery &query) const
+      {
+        std::vector<std::string> words = CatalogIndex::Words(query.keyword);
+        std::vector<size_t> matches;
+        for (size_t i = 0; i < products_.size(); i++)
+        {
+          if (Matches(i, query, words))
+          {
+            matches.push_back(i);
+          }
+        }
+        std::sort(matches.begin(), matches.end(), [this](size_t a, size_t b)
+                  { return std::make_pair(prices_[a], a) < std::make_pair(prices_[b], b); });
+        CatalogPage page;
+        page.total = static_cast<uint32_t>(matches.size());
+        for (size_t i = query.offset; i < matches.size() && i < static_cast<size_t>(query.offset) + query.limit; i++)
+        {
+          page.products.push_back(products_[matches[i]]);
+        }
+        return page;
+      }
+
+    private:
+      bool Matches(size_t i, const CatalogQuery &query, const std::vector<std::string> &words) const
+      {
+        const StoreProductRecord &product = products_[i];
+        if (!query.product_kinds.empty() &&
+            std::find(query.product_kinds.begin(), query.product_kinds.end(), product.product_kind) ==
+                query.product_kinds.end())
+        {
+          return false;
+        }
+        if ((query.min_price && prices_[i] < *query.min_price) || (query.max_price && prices_[i] > *query.max_price))
+        {
+          return false;
+        }
+        if ((query.ownership == CatalogQuery::Ownership::kOwned && !product.is_in_user_collection) ||
+            (query.ownership == CatalogQuery::Ownership::kNotOwned && product.is_in_user_collection))
+        {
+          return false;
+        }
+        for (const std::string &word : words)
+        {
+          if (std::none_of(words_[i].begin(), words_[i].end(), [&word](const std::string &title_word)
+                           { return title_word.compare(0, word.size(), word) == 0; }))
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      const std::vector<StoreProductRecord> &products_;
+      std::vector<double> prices_;
+      std::vector<std::vector<std::string>> words_;
+    };
+
+    bool SamePage(const CatalogPage &a, const CatalogPage &b)
+    {
+      return a.total == b.total && a.products == b.products;
+    }
+
+  } // namespace
+
+  bool RunCatalogIndexBenchmark(const BenchmarkOptions &options)
+  {
+    size_t count = options.size > 0 ? options.size : kDefaultProducts;
+    std::vector<StoreProductRecord> products = SyntheticCatalog(count);
+    std::vector<std::string> kinds = {"Durable", "Consumable", "UnmanagedConsumable", "Game"};
+
+    double build_ms = BestMs(options.runs, [&kinds, &products]()
+                             {
+      CatalogIndex index;
+      index.Update(kinds, products); });
+
+    // 1% of the products change price, as after a sale starts.
+    std::vector<StoreProductRecord> updated = products;
+    for (size_t i = 0; i < updated.size(); i += 100)
+    {
+      updated[i].formatted_price = "$0.99";
+    }
+    CatalogIndex index;
+    index.Update(kinds, products);
+    bool sale = false;
+    double update_ms = BestMs(options.runs, [&kinds, &products, &updated, &index, &sale]()
+                              {
+      sale = !sale;
+      index.Update(kinds, sale ? updated : products); });
+    if (sale)
+    {
+      index.Update(kinds, products);
+    }
+    CatalogScan scan(products);
+
+    std::printf("catalog index, %zu products: build %.1f ms, 1%% price update %.1f ms\n", count, build_ms,
+                update_ms);
+    std::printf("%-28s %8s %12s %12s %9s\n", "query", "matches", "index us", "scan us", "speedup");
+
+    std::vector<std::pair<const char *, CatalogQuery>> queries(8);
+    queries[0].first = "first page";
+    queries[1].first = "page 100";
+    queries[1].second.offset = 99 * 50;
+    queries[2].first = "price 10-20";
+    queries[2].second.min_price = 10;
+    queries[2].second.max_price = 20;
+    queries[3].first = "kind Consumable";
+    queries[3].second.product_kinds = {"Consumable"};
+    queries[4].first = "keyword \"dra\"";
+    queries[4].second.keyword = "dra";
+    queries[5].first = "keyword \"kalo star\"";
+    queries[5].second.keyword = "kalo star";
+    queries[6].first = "owned Durable under 5";
+    queries[6].second.product_kinds = {"Durable"};
+    queries[6].second.ownership = CatalogQuery::Ownership::kOwned;
+    queries[6].second.max_price = 5;
+    queries[7].first = "count only (limit 0)";
+    queries[7].second.keyword = "gon";
+    queries[7].second.limit = 0;
+    for (size_t i = 0; i + 1 < queries.size(); i++)
+    {
+      queries[i].second.limit = 50;
+    }
+
+    bool ok = true;
+    for (const auto &[name, query] : queries)
+    {
+      CatalogPage expected = scan.Query(query);
+      ok = ok && SamePage(index.Query(query), expected);
+      double index_us = BestMs(options.runs, [&index, &query = query]()
+                               {
+        for (size_t i = 0; i < kQueriesPerRun; i++)
+        {
+          index.Query(query);
+        } }) *
+                        1000 / kQueriesPerRun;
+      double scan_us = BestMs(options.runs, [&scan, &query = query]()
+                              {
+        for (size_t i = 0; i < kQueriesPerRun; i++)
+        {
+          scan.Query(query);
+        } }) *
+                       1000 / kQueriesPerRun;
+      std::printf("%-28s %8u %12.1f %12.1f %8.1fx\n", name, expected.total, index_us, scan_us, scan_us / index_us);
+    }
+    return ok;
+  }
+
+} // namespace windows_store
@@ -0,0 +1,171 @@
+// Registers 10k synthetic features against the add-ons of a large license
+// and checks every one of them through FeatureEntitlements, and by
+// evaluating the license for each feature, as the Dart side did before with
+// the whole license it fetched.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "feature_entitlements.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultFeatures = 10000;
+    constexpr size_t kAddOns = 400;
+    // Store IDs each feature is unlocked by.
+    constexpr size_t kMaxIdsPerFeature = 3;
+
+    std::string AddOnProductId(size_t index)
+    {
+      return "9NADDON" + std::to_string(1000 + index);
+    }
+
+    // An active app license with |kAddOns| add-ons, two thirds of them
+    // active. |seed| varies which.
+    LicenseSnapshot SyntheticLicense(unsigned seed)
+    {
+      std::mt19937 random(seed);
+      LicenseSnapshot license;
+      license.is_active = true;
+      license.sku_store_id = "9NAPP/0010";
+      for (size_t i = 0; i < kAddOns; i++)
+      {
+        license.add_ons.push_back(
+            {AddOnProductId(i) + "/0010", "offer-" + std::to_string(i), random() % 3 != 0, 0});
+      }
+      return license;
+    }
+
+    FeatureEntitlements::FeatureMap SyntheticFeatures(size_t count)
+    {
+      std::mt19937 random(42);
+      FeatureEntitlements::FeatureMap features;
+      for (size_t i = 0; i < count; i++)
+      {
+        std::vector<std::string> ids;
+        size_t id_count = 1 + random() % kMaxIdsPerFeature;
+        for (size_t j = 0; j < id_count; j++)
+        {
+          // Product IDs, SKU IDs and offer tokens, with some IDs no license
+          // has.
+          size_t add_on = random() % (kAddOns + kAddOns / 4);
+          switch (random() % 4)
+          {
+          case 0:
+            ids.push_back(AddOnProductId(add_on) + "/0010");
+            break;
+          case 1:
+            ids.push_back("offer-" + std::to_string(add_on));
+            break;
+          default:
+            ids.push_back(AddOnProductId(add_on));
+            break;
+          }
+        }
+        if (i % 50 == 0)
+        {
+          ids.push_back("9NAPP");
+        }
+        features.emplace_back("feature-" + std::to_string(i), std::move(ids));
+      }
+      return features;
+    }
+
+    // Whether a license SKU Store ID, "<product id>/<sku id>", is |id| or
+    // belongs to the product |id|.
+    bool SkuMatches(const std::string &sku_store_id, const std::string &id)
+    {
+      return sku_store_id == id ||
+             (sku_store_id.size() > id.size() && sku_store_id.compare(0, id.size(), id) == 0 &&
+              sku_store_id[id.size()] == '/');
+    }
+
+    // Evaluates |license| for one feature, scanning it for each of the
+    // feature's Store IDs.
+    bool IsEnabledByLookup(const LicenseSnapshot &license, const std::vector<std::string> &ids)
+    {
+      for (const std::string &id : ids)
+      {
+        if (license.is_active && SkuMatches(license.sku_store_id, id))
+        {
+          return true;
+        }
+        for (const AddOnLicenseRecord &add_on : license.add_ons)
+        {
+          if (add_on.is_active && (SkuMatches(add_on.sku_store_id, id) || add_on.in_app_offer_token == id))
+          {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+  } // namespace
+
+  bool RunFeaturesBenchmark(const BenchmarkOptions &options)
+  {
+    size_t count = options.size > 0 ? options.size : kDefaultFeatures;
+    FeatureEntitlements::FeatureMap features = SyntheticFeatures(count);
+    const LicenseSnapshot licenses[] = {SyntheticLicense(1), SyntheticLicense(2)};
+
+    FeatureEntitlements entitlements;
+    double register_ms = BestMs(options.runs, [&]()
+                                { entitlements.Register(features); });
+    // Alternates between the licenses so each update recomputes.
+    size_t update = 0;
+    double update_ms = BestMs(options.runs, [&]()
+                              { entitlements.Update(licenses[update++ % 2]); });
+
+    bool ok = true;
+    size_t enabled = 0;
+    for (const LicenseSnapshot &license : licenses)
+    {
+      entitlements.Update(license);
+      for (const auto &[feature, ids] : features)
+      {
+        std::optional<bool> bit = entitlements.IsEnabled(feature);
+        bool expected = IsEnabledByLookup(license, ids);
+        ok = ok && bit.has_value() && *bit == expected;
+        enabled += expected ? 1 : 0;
+      }
+    }
+    ok = ok && !entitlements.IsEnabled("unregistered").has_value();
+
+    size_t checked = 0;
+    double bitset_ms = BestMs(options.runs, [&]()
+                              {
+      checked = 0;
+      for (const auto &[feature, ids] : features)
+      {
+        checked += entitlements.IsEnabled(feature).value_or(false) ? 1 : 0;
+      } });
+    const LicenseSnapshot &license = licenses[1];
+    size_t looked_up = 0;
+    double lookup_ms = BestMs(options.runs, [&]()
+                              {
+      looked_up = 0;
+      for (const auto &[feature, ids] : features)
+      {
+        looked_up += IsEnabledByLookup(license, ids) ? 1 : 0;
+      } });
+    ok = ok && checked == looked_up;
+
+    std::printf("features, %zu features, %zu add-ons, %.0f%% enabled\n", count, kAddOns,
+                50.0 * enabled / count);
+    std::printf("%-28s %14s %14s\n", "operation", "bitset ms", "lookup ms");
+    std::printf("%-28s %14.3f %14s\n", "register", register_ms, "-");
+    std::printf("%-28s %14.3f %14s\n", "update on license change", update_ms, "-");
+    std::printf("%-28s %14.3f %14.3f\n", "check every feature", bitset_ms, lookup_ms);
+    std::printf("%-28s %14.0f %14.0f\n", "ns per check", bitset_ms * 1e6 / count, lookup_ms * 1e6 / count);
+    return ok;
+  }
+
+} // namespace windows_store
@@ -0,0 +1,232 @@
+// Converts several thousand synthetic products from UTF-16, as the WinRT
+// backend converts StoreProduct properties with winrt::to_string, and
+// encodes them for the bulk channel, with narrow field masks and with every
+// field.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "byte_buffer.h"
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultProducts = 5000;
+
+    // The UTF-16 strings of a StoreProduct, standing in for its hstring
+    // properties.
+    struct WideProduct
+    {
+      std::u16string store_id;
+      std::u16string product_kind;
+      std::u16string title;
+      std::u16string description;
+      std::u16string formatted_price;
+      std::u16string formatted_base_price;
+      std::u16string currency_code;
+      bool is_in_user_collection = false;
+      bool has_digital_download = false;
+      std::u16string in_app_offer_token;
+      std::u16string link_uri;
+      std::u16string extended_json_data;
+    };
+
+    // Stands in for winrt::to_string. Strings hold no surrogate pairs.
+    std::string Utf8From(const std::u16string &value)
+    {
+      std::string utf8;
+      utf8.reserve(value.size());
+      for (char16_t unit : value)
+      {
+        if (unit < 0x80)
+        {
+          utf8.push_back(static_cast<char>(unit));
+        }
+        else if (unit < 0x800)
+        {
+          utf8.push_back(static_cast<char>(0xC0 | unit >> 6));
+          utf8.push_back(static_cast<char>(0x80 | (unit & 0x3F)));
+        }
+        else
+        {
+          utf8.push_back(static_cast<char>(0xE0 | unit >> 12));
+          utf8.push_back(static_cast<char>(0x80 | (unit >> 6 & 0x3F)));
+          utf8.push_back(static_cast<char>(0x80 | (unit & 0x3F)));
+        }
+      }
+      return utf8;
+    }
+
+    std::u16string Utf16From(const std::string &ascii)
+    {
+      return std::u16string(ascii.begin(), ascii.end());
+    }
+
+    // Mirrors RecordFrom in winrt_store_backend.cpp.
+    StoreProductRecord RecordFrom(const WideProduct &product, uint64_t field_mask)
+    {
+      auto requested = [field_mask](ProductField field)
+      { return (field_mask & ProductFieldBit(field)) != 0; };
+      StoreProductRecord record;
+      if (requested(ProductField::kStoreId))
+      {
+        record.store_id = Utf8From(product.store_id);
+      }
+      if (requested(ProductField::kProductKind))
+      {
+        record.product_kind = Utf8From(product.product_kind);
+      }
+      if (requested(ProductField::kTitle))
+      {
+        record.title = Utf8From(product.title);
+      }
+      if (requested(ProductField::kDescription))
+      {
+        record.description = Utf8From(product.description);
+      }
+      if (requested(ProductField::kFormattedPrice))
+      {
+        record.formatted_price = Utf8From(product.formatted_price);
+      }
+      if (requested(ProductField::kFormattedBasePrice))
+      {
+        record.formatted_base_price = Utf8From(product.formatted_base_price);
+      }
+      if (requested(ProductField::kCurrencyCode))
+      {
+        record.currency_code = Utf8From(product.currency_code);
+      }
+      if (requested(ProductField::kIsInUserCollection))
+      {
+        record.is_in_user_collection = product.is_in_user_collection;
+      }
+      if (requested(ProductField::kHasDigitalDownload))
+      {
+        record.has_digital_download = product.has_digital_download;
+      }
+      if (requested(ProductField::kInAppOfferToken))
+      {
+        record.in_app_offer_token = Utf8From(product.in_app_offer_token);
+      }
+      if (requested(ProductField::kLinkUri))
+      {
+        record.link_uri = Utf8From(product.link_uri);
+      }
+      if (requested(ProductField::kExtendedJsonData))
+      {
+        record.extended_json_data = Utf8From(product.extended_json_data);
+      }
+      return record;
+    }
+
+    std::vector<WideProduct> SyntheticProducts(size_t count)
+    {
+      std::mt19937 random(42);
+      std::vector<WideProduct> products;
+      for (size_t i = 0; i < count; i++)
+      {
+        std::string store_id = "9N" + std::to_string(1000000 + i);
+        WideProduct product;
+        product.store_id = Utf16From(store_id);
+        product.product_kind = u"Durable";
+        // Localized titles and descriptions are not all ASCII.
+        product.title = Utf16From("Expansion pack " + std::to_string(i)) + u" édition 一";
+        product.description = std::u16string(300 + random() % 1200, u'd') + u"é一";
+        product.formatted_price = Utf16From(std::to_string(random() % 50) + ",99") + u" €";
+        product.formatted_base_price = product.formatted_price;
+        product.currency_code = u"EUR";
+        product.is_in_user_collection = random() % 4 == 0;
+        product.has_digital_download = random() % 2 == 0;
+        product.in_app_offer_token = Utf16From("offer-" + std::to_string(i));
+        product.link_uri = Utf16From("https://www.microsoft.com/store/productId/" + store_id);
+        product.extended_json_data = Utf16From("{\"ProductId\":\"" + store_id + "\",\"Properties\":{\"Padding\":\"" +
+                                               std::string(1500 + random() % 2000, 'x') + "\"}}");
+        products.push_back(std::move(product));
+      }
+      return products;
+    }
+
+    // Whether |narrow| holds exactly the fields of |full| in |field_mask|.
+    bool IsProjection(const StoreProductRecord &narrow, const StoreProductRecord &full, uint64_t field_mask)
+    {
+      StoreProductRecord expected;
+      auto requested = [field_mask](ProductField field)
+      { return (field_mask & ProductFieldBit(field)) != 0; };
+      expected.store_id = requested(ProductField::kStoreId) ? full.store_id : "";
+      expected.product_kind = requested(ProductField::kProductKind) ? full.product_kind : "";
+      expected.title = requested(ProductField::kTitle) ? full.title : "";
+      expected.description = requested(ProductField::kDescription) ? full.description : "";
+      expected.formatted_price = requested(ProductField::kFormattedPrice) ? full.formatted_price : "";
+      expected.formatted_base_price = requested(ProductField::kFormattedBasePrice) ? full.formatted_base_price : "";
+      expected.currency_code = requested(ProductField::kCurrencyCode) ? full.currency_code : "";
+      expected.is_in_user_collection = requested(ProductField::kIsInUserCollection) && full.is_in_user_collection;
+      expected.has_digital_download = requested(ProductField::kHasDigitalDownload) && full.has_digital_download;
+      expected.in_app_offer_token = requested(ProductField::kInAppOfferToken) ? full.in_app_offer_token : "";
+      expected.link_uri = requested(ProductField::kLinkUri) ? full.link_uri : "";
+      expected.extended_json_data = requested(ProductField::kExtendedJsonData) ? full.extended_json_data : "";
+      return narrow == expected;
+    }
+
+  } // namespace
+
+  bool RunFieldMaskBenchmark(const BenchmarkOptions &options)
+  {
+    size_t count = options.size > 0 ? options.size : kDefaultProducts;
+    std::vector<WideProduct> products = SyntheticProducts(count);
+    constexpr uint64_t kEveryField = kAllProductFields | ProductFieldBit(ProductField::kExtendedJsonData);
+    struct Mask
+    {
+      const char *name;
+      uint64_t bits;
+    };
+    const Mask masks[] = {
+        {"store id + title", ProductFieldBit(ProductField::kStoreId) | ProductFieldBit(ProductField::kTitle)},
+        {"store id + prices", ProductFieldBit(ProductField::kStoreId) | ProductFieldBit(ProductField::kFormattedPrice) |
+                                  ProductFieldBit(ProductField::kCurrencyCode)},
+        {"all columns", kAllProductFields},
+        {"all + ExtendedJsonData", kEveryField},
+    };
+
+    std::vector<StoreProductRecord> full;
+    for (const WideProduct &product : products)
+    {
+      full.push_back(RecordFrom(product, kEveryField));
+    }
+
+    std::printf("field mask, %zu products\n", count);
+    std::printf("%-24s %14s %14s %14s\n", "mask", "convert ms", "encode ms", "encoded KB");
+    bool ok = true;
+    for (const Mask &mask : masks)
+    {
+      std::vector<StoreProductRecord> records;
+      double convert_ms = BestMs(options.runs, [&]()
+                                 {
+        records.clear();
+        records.reserve(products.size());
+        for (const WideProduct &product : products)
+        {
+          records.push_back(RecordFrom(product, mask.bits));
+        } });
+      for (size_t i = 0; i < count; i++)
+      {
+        ok = ok && IsProjection(records[i], full[i], mask.bits);
+      }
+      size_t encoded = 0;
+      double encode_ms = BestMs(options.runs, [&]()
+                                {
+        ByteWriter writer;
+        EncodeStoreProducts(records, mask.bits, writer);
+        encoded = writer.size(); });
+      std::printf("%-24s %14.2f %14.2f %14zu\n", mask.name, convert_ms, encode_ms, encoded >> 10);
+    }
+    return ok;
+  }
+
+} // namespace windows_store
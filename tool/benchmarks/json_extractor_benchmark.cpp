@@ -0,0 +1,118 @@
+// Extracts a few fields from synthetic Store-shaped ExtendedJsonData with
+// JsonExtractor and with the reference parser of the unit tests, which
+// builds the whole tree first as a general-purpose JSON library would.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarks.h"
+#include "json_extractor.h"
+#include "reference_json.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultDocuments = 2000;
+
+    std::string Quoted(const std::string &text) { return "\"" + text + "\""; }
+
+    // A product roughly as StoreProduct.ExtendedJsonData returns it: a few
+    // KB of localized properties, images and SKUs with their availabilities.
+    std::string SyntheticProduct(std::mt19937 &random, size_t index)
+    {
+      std::string id = "9N" + std::to_string(100000 + index);
+      std::string json = "{\"ProductId\":" + Quoted(id) + ",\"ProductKind\":\"Durable\",\"LocalizedProperties\":[{";
+      json += "\"ProductTitle\":\"Expansion pack " + std::to_string(index) + "\",";
+      json += "\"ShortDescription\":\"" + std::string(200 + random() % 400, 'd') + "\",";
+      json += "\"Images\":[";
+      for (size_t image = 0, count = 3 + random() % 4; image < count; image++)
+      {
+        json += std::string(image > 0 ? "," : "") + "{\"ImagePurpose\":\"Screenshot\",\"Uri\":\"//store-images." +
+                "example.com/image/apps." + std::to_string(random()) + ".png\",\"Width\":1920,\"Height\":1080," +
+                "\"Caption\":\"Caption with \\\"quotes\\\" and caf\\u00e9\"}";
+      }
+      json += "],\"Language\":\"en-us\"}],\"Properties\":{\"Category\":\"Games\",\"Attributes\":[";
+      for (size_t attribute = 0, count = 4 + random() % 8; attribute < count; attribute++)
+      {
+        json += std::string(attribute > 0 ? "," : "") + "{\"Name\":\"Attribute" + std::to_string(attribute) +
+                "\",\"Minimum\":null,\"Maximum\":" + std::to_string(random() % 100) + "}";
+      }
+      json += "]},\"Skus\":[";
+      for (size_t sku = 0, count = 1 + random() % 3; sku < count; sku++)
+      {
+        json += std::string(sku > 0 ? "," : "") + "{\"Sku\":{\"SkuId\":\"" + std::to_string(sku) +
+                "\",\"LocalizedProperties\":[{\"SkuTitle\":\"Edition " + std::to_string(sku) +
+                "\",\"SkuDescription\":\"" + std::string(100 + random() % 300, 's') + "\"}]," +
+                "\"Properties\":{\"IsTrial\":" + (random() % 2 == 0 ? "true" : "false") +
+                "}},\"Availabilities\":[{\"AvailabilityId\":\"" + std::to_string(random()) +
+                "\",\"Conditions\":{\"ClientConditions\":{\"AllowedPlatforms\":[{\"PlatformName\":\"Windows.Desktop\"}]}}," +
+                "\"OrderManagementData\":{\"Price\":{\"CurrencyCode\":\"USD\",\"ListPrice\":" +
+                std::to_string(random() % 5000) + "." + std::to_string(10 + random() % 90) + ",\"MSRP\":" +
+                std::to_string(random() % 5000) + "}}}]}";
+      }
+      return json + "]}";
+    }
+
+  } // namespace
+
+  bool RunJsonExtractorBenchmark(const BenchmarkOptions &options)
+  {
+    size_t count = options.size > 0 ? options.size : kDefaultDocuments;
+    std::mt19937 random(42);
+    std::vector<std::string> documents;
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      documents.push_back(SyntheticProduct(random, i));
+      bytes += documents.back().size();
+    }
+
+    std::vector<std::pair<const char *, std::vector<JsonExtractor::Field>>> requests = {
+        {"early field", {{"/ProductId", JsonFieldType::kString}}},
+        {"sku title and price",
+         {{"/Skus/0/Sku/LocalizedProperties/0/SkuTitle", JsonFieldType::kString},
+          {"/Skus/0/Availabilities/0/OrderManagementData/Price/ListPrice", JsonFieldType::kNumber}}},
+        {"wildcard trial flag", {{"/Skus/*/Sku/Properties/IsTrial", JsonFieldType::kBool}}},
+        {"raw attributes, missing field",
+         {{"/Properties/Attributes", JsonFieldType::kRaw}, {"/Properties/Missing", JsonFieldType::kString}}},
+    };
+
+    std::printf("json extractor, %zu products of %.1f KB on average\n", count, bytes / 1024.0 / count);
+    std::printf("%-32s %12s %12s %10s %9s\n", "fields", "extract us", "tree us", "MB/s", "speedup");
+    bool ok = true;
+    for (const auto &[name, fields] : requests)
+    {
+      JsonExtractor extractor(fields);
+      std::vector<std::optional<JsonValue>> values;
+      std::vector<std::optional<JsonValue>> expected;
+      for (const std::string &document : documents)
+      {
+        ok = ok && extractor.Extract(document, values) && test::ReferenceExtract(document, fields, expected) &&
+             values == expected;
+      }
+
+      double extract_ms = BestMs(options.runs, [&documents, &extractor, &values]()
+                                 {
+        for (const std::string &document : documents)
+        {
+          extractor.Extract(document, values);
+        } });
+      double tree_ms = BestMs(options.runs, [&documents, &fields = fields, &expected]()
+                              {
+        for (const std::string &document : documents)
+        {
+          test::ReferenceExtract(document, fields, expected);
+        } });
+      std::printf("%-32s %12.2f %12.2f %10.0f %8.1fx\n", name, extract_ms * 1000 / count, tree_ms * 1000 / count,
+                  bytes / 1e3 / extract_ms, tree_ms / extract_ms);
+    }
+    return ok;
+  }
+
+} // namespace windows_store
@@ -0,0 +1,138 @@
+// Looks up a screen of product tiles through ProductBatcher and with one
+// Store call per tile, against a stand-in for GetStoreProductsAsync that
+// takes a fixed round trip plus a little per product, on a work queue of the
+// plugin's size.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"
+#include "product_batcher.h"
+#include "work_queue.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultTiles = 48;
+    constexpr size_t kWorkerCount = 4;
+    constexpr std::chrono::milliseconds kAgingInterval(250);
+    constexpr std::chrono::milliseconds kRoundTrip(4);
+    constexpr std::chrono::microseconds kPerProduct(50);
+
+    struct TilesResult
+    {
+      size_t store_calls = 0;
+      // From the first lookup to each tile's product, in milliseconds.
+      double mean_ms = 0;
+      double last_ms = 0;
+      bool ok = true;
+    };
+
+    StoreResult<std::vector<StoreProductRecord>> FetchProducts(const std::vector<std::string> &store_ids,
+                                                               std::atomic<size_t> &calls)
+    {
+      calls++;
+      std::this_thread::sleep_for(kRoundTrip + kPerProduct * store_ids.size());
+      StoreResult<std::vector<StoreProductRecord>> result;
+      for (const std::string &store_id : store_ids)
+      {
+        StoreProductRecord product;
+        product.store_id = store_id;
+        product.title = "Title of " + store_id;
+        result.value.push_back(std::move(product));
+      }
+      return result;
+    }
+
+    // Every tile looks up its product at once, as a grid does when it is
+    // first laid out. A zero |window| makes one Store call per tile.
+    TilesResult LoadTiles(size_t tiles, std::chrono::microseconds window)
+    {
+      std::atomic<size_t> calls{0};
+      WorkQueue queue(kWorkerCount, kAgingInterval);
+      ProductBatcher batcher([&calls](const std::vector<std::string> &store_ids, uint64_t field_mask)
+                             { return FetchProducts(store_ids, calls); },
+                             [&queue](std::function<void()> task)
+                             { queue.Post(WorkPriority::kInteractive, std::move(task)); });
+      batcher.SetWindow(window, ProductBatcher::kDefaultMaxBatchSize);
+
+      std::mutex mutex;
+      std::condition_variable done;
+      std::vector<double> latencies;
+      bool ok = true;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < tiles; i++)
+      {
+        std::string store_id = "9N" + std::to_string(100000 + i);
+        batcher.Load(store_id, ProductFieldBit(ProductField::kTitle),
+                     [&, store_id](const StoreResult<const StoreProductRecord *> &product)
+                     {
+          double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+          std::lock_guard<std::mutex> lock(mutex);
+          ok = ok && product.ok() && product.value != nullptr && product.value->title == "Title of " + store_id;
+          latencies.push_back(ms);
+          done.notify_all(); });
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [&latencies, tiles]()
+                { return latencies.size() == tiles; });
+
+      TilesResult result;
+      result.store_calls = calls;
+      for (double ms : latencies)
+      {
+        result.mean_ms += ms / tiles;
+        result.last_ms = std::max(result.last_ms, ms);
+      }
+      result.ok = ok;
+      return result;
+    }
+
+  } // namespace
+
+  bool RunProductBatcherBenchmark(const BenchmarkOptions &options)
+  {
+    size_t tiles = options.size > 0 ? options.size : kDefaultTiles;
+    struct Mode
+    {
+      const char *name;
+      std::chrono::microseconds window;
+    };
+    const Mode modes[] = {
+        {"one call per tile", std::chrono::microseconds::zero()},
+        {"2 ms window", std::chrono::milliseconds(2)},
+        {"8 ms window (default)", ProductBatcher::kDefaultWindow},
+    };
+
+    std::printf("product batcher, %zu tiles, %lld ms round trip + %lld us per product, %zu workers\n", tiles,
+                static_cast<long long>(kRoundTrip.count()), static_cast<long long>(kPerProduct.count()), kWorkerCount);
+    std::printf("%-24s %12s %12s %12s\n", "lookups", "store calls", "mean ms", "last ms");
+    bool ok = true;
+    for (const Mode &mode : modes)
+    {
+      TilesResult best;
+      for (size_t run = 0; run < options.runs; run++)
+      {
+        TilesResult result = LoadTiles(tiles, mode.window);
+        ok = ok && result.ok;
+        if (run == 0 || result.last_ms < best.last_ms)
+        {
+          best = result;
+        }
+      }
+      std::printf("%-24s %12zu %12.2f %12.2f\n", mode.name, best.store_calls, best.mean_ms, best.last_ms);
+    }
+    return ok;
+  }
+
+} // namespace windows_store
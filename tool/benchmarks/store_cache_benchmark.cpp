@@ -0,0 +1,209 @@
+// Replays skewed product lookups over a large synthetic catalog, with
+// periodic passes over the whole catalog as a browsing user makes them,
+// through StoreCache and through a plain LRU cache with the same budget, and
+// compares their hit rates and lookup times.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "benchmarks.h"
+#include "store_cache.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultProducts = 100000;
+    constexpr size_t kLookups = 1000000;
+    // Zipf exponent of the lookups.
+    constexpr double kSkew = 0.9;
+    // Every kScanInterval lookups, kScanLength products are looked up in
+    // catalog order.
+    constexpr size_t kScanInterval = 100000;
+    constexpr size_t kScanLength = 20000;
+    constexpr uint64_t kFields = ProductFieldBit(ProductField::kTitle) | ProductFieldBit(ProductField::kDescription);
+
+    // Evicts the least recently used product once over budget, charging
+    // products as StoreCache does.
+    class LruCache
+    {
+    public:
+      LruCache(size_t budget_bytes, size_t entry_overhead)
+          : budget_bytes_(budget_bytes), entry_overhead_(entry_overhead) {}
+
+      std::shared_ptr<const StoreProductRecord> Get(std::string_view store_id)
+      {
+        auto found = index_.find(store_id);
+        if (found == index_.end())
+        {
+          return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return found->second->first;
+      }
+
+      void Put(std::shared_ptr<const StoreProductRecord> product)
+      {
+        size_t bytes = StoreCache::ByteSize(*product) + entry_overhead_;
+        entries_.emplace_front(std::move(product), bytes);
+        index_.emplace(entries_.front().first->store_id, entries_.begin());
+        bytes_ += bytes;
+        while (bytes_ > budget_bytes_)
+        {
+          bytes_ -= entries_.back().second;
+          index_.erase(entries_.back().first->store_id);
+          entries_.pop_back();
+        }
+      }
+
+    private:
+      using Entry = std::pair<std::shared_ptr<const StoreProductRecord>, size_t>;
+
+      size_t budget_bytes_;
+      size_t entry_overhead_;
+      size_t bytes_ = 0;
+      std::list<Entry> entries_;
+      std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    };
+
+    std::vector<std::shared_ptr<const StoreProductRecord>> SyntheticCatalog(size_t count)
+    {
+      std::mt19937 random(42);
+      std::vector<std::shared_ptr<const StoreProductRecord>> catalog;
+      for (size_t i = 0; i < count; i++)
+      {
+        auto product = std::make_shared<StoreProductRecord>();
+        product->store_id = "9N" + std::to_string(1000000 + i);
+        product->product_kind = "Durable";
+        product->title = "Expansion pack " + std::to_string(i);
+        product->description = std::string(200 + random() % 800, 'd');
+        product->formatted_price = "$" + std::to_string(random() % 50) + ".99";
+        catalog.push_back(std::move(product));
+      }
+      return catalog;
+    }
+
+    // Catalog indices to look up: Zipf-distributed over a shuffled catalog,
+    // with scans in between.
+    std::vector<size_t> SyntheticLookups(size_t products)
+    {
+      std::mt19937 random(7);
+      std::vector<double> cumulative(products);
+      double total = 0;
+      for (size_t rank = 0; rank < products; rank++)
+      {
+        total += 1 / std::pow(static_cast<double>(rank + 1), kSkew);
+        cumulative[rank] = total;
+      }
+      std::vector<size_t> by_rank(products);
+      for (size_t i = 0; i < products; i++)
+      {
+        by_rank[i] = i;
+      }
+      std::shuffle(by_rank.begin(), by_rank.end(), random);
+
+      std::uniform_real_distribution<double> uniform(0, total);
+      std::vector<size_t> lookups;
+      lookups.reserve(kLookups + kLookups / kScanInterval * kScanLength);
+      size_t scan_start = 0;
+      for (size_t i = 0; i < kLookups; i++)
+      {
+        if (i > 0 && i % kScanInterval == 0)
+        {
+          for (size_t j = 0; j < kScanLength; j++)
+          {
+            lookups.push_back((scan_start + j) % products);
+          }
+          scan_start += kScanLength;
+        }
+        size_t rank = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(random)) - cumulative.begin();
+        lookups.push_back(by_rank[std::min(rank, products - 1)]);
+      }
+      return lookups;
+    }
+
+  } // namespace
+
+  bool RunStoreCacheBenchmark(const BenchmarkOptions &options)
+  {
+    size_t count = options.size > 0 ? options.size : kDefaultProducts;
+    std::vector<std::shared_ptr<const StoreProductRecord>> catalog = SyntheticCatalog(count);
+    std::vector<size_t> lookups = SyntheticLookups(count);
+
+    size_t entry_overhead;
+    {
+      StoreCache probe;
+      probe.PutProduct(catalog[0], kFields);
+      entry_overhead = probe.GetStats().bytes - StoreCache::ByteSize(*catalog[0]);
+    }
+    size_t catalog_bytes = 0;
+    for (const auto &product : catalog)
+    {
+      catalog_bytes += StoreCache::ByteSize(*product) + entry_overhead;
+    }
+
+    std::printf("store cache, %zu products of %.0f bytes on average, %zu lookups with zipf %.1f and %zu scans\n", count,
+                static_cast<double>(catalog_bytes) / count, lookups.size(), kSkew, kLookups / kScanInterval - 1);
+    std::printf("%-12s %14s %14s %14s %14s\n", "budget", "slru hits", "lru hits", "slru ns", "lru ns");
+    bool ok = true;
+    for (size_t percent : {5, 10, 25})
+    {
+      size_t budget = catalog_bytes / 100 * percent;
+      size_t slru_hits = 0;
+      size_t lru_hits = 0;
+      double slru_ms = BestMs(options.runs, [&]()
+                              {
+        StoreCache cache(budget);
+        slru_hits = 0;
+        for (size_t index : lookups)
+        {
+          const std::shared_ptr<const StoreProductRecord> &product = catalog[index];
+          std::shared_ptr<const StoreProductRecord> cached = cache.GetProduct(product->store_id, kFields);
+          if (cached)
+          {
+            ok = ok && cached == product;
+            slru_hits++;
+          }
+          else
+          {
+            cache.PutProduct(product, kFields);
+          }
+        } });
+      double lru_ms = BestMs(options.runs, [&]()
+                             {
+        LruCache cache(budget, entry_overhead);
+        lru_hits = 0;
+        for (size_t index : lookups)
+        {
+          const std::shared_ptr<const StoreProductRecord> &product = catalog[index];
+          std::shared_ptr<const StoreProductRecord> cached = cache.Get(product->store_id);
+          if (cached)
+          {
+            ok = ok && cached == product;
+            lru_hits++;
+          }
+          else
+          {
+            cache.Put(product);
+          }
+        } });
+      char name[32];
+      std::snprintf(name, sizeof(name), "%zu%% (%zu MB)", percent, budget >> 20);
+      std::printf("%-12s %13.1f%% %13.1f%% %14.0f %14.0f\n", name, 100.0 * slru_hits / lookups.size(),
+                  100.0 * lru_hits / lookups.size(), slru_ms * 1e6 / lookups.size(), lru_ms * 1e6 / lookups.size());
+    }
+    return ok;
+  }
+
+} // namespace windows_store
@@ -0,0 +1,126 @@
+// Issues license checks at a steady rate while a large background sync
+// saturates a work queue of the plugin's size, and reports their latency
+// with the sync posted as background work and with it posted at the same
+// priority as the checks, as a single FIFO queue would run it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"
+#include "work_queue.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kDefaultChecks = 100;
+    constexpr size_t kWorkerCount = 4;
+    constexpr std::chrono::milliseconds kAgingInterval(250);
+    // Stand-ins for GetAppLicenseAsync and for one call of a sync.
+    constexpr std::chrono::milliseconds kLicenseCall(1);
+    constexpr std::chrono::milliseconds kSyncCall(4);
+    constexpr std::chrono::milliseconds kCheckInterval(5);
+
+    struct LatencyResult
+    {
+      // From posting a license check to its completion, in milliseconds.
+      double p50_ms = 0;
+      double p99_ms = 0;
+      double max_ms = 0;
+      // Sync calls completed while the checks ran.
+      size_t sync_calls = 0;
+    };
+
+    LatencyResult CheckUnderLoad(size_t checks, WorkPriority sync_priority)
+    {
+      // Twice the sync calls the workers can get through while the checks
+      // are issued, so the queue never runs dry.
+      size_t sync_calls = 2 * checks * kCheckInterval.count() * kWorkerCount / kSyncCall.count();
+      std::atomic<size_t> sync_done{0};
+      std::vector<double> latencies(checks);
+      std::mutex mutex;
+      std::condition_variable done;
+      size_t finished = 0;
+      {
+        WorkQueue queue(kWorkerCount, kAgingInterval);
+        for (size_t i = 0; i < sync_calls; i++)
+        {
+          queue.Post(sync_priority, [&sync_done]()
+                     {
+            std::this_thread::sleep_for(kSyncCall);
+            sync_done++; });
+        }
+        for (size_t i = 0; i < checks; i++)
+        {
+          auto posted = std::chrono::steady_clock::now();
+          queue.Post(WorkPriority::kInteractive, [&, i, posted]()
+                     {
+            std::this_thread::sleep_for(kLicenseCall);
+            latencies[i] =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - posted).count();
+            std::lock_guard<std::mutex> lock(mutex);
+            finished++;
+            done.notify_all(); });
+          std::this_thread::sleep_for(kCheckInterval);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&finished, checks]()
+                  { return finished == checks; });
+        // The rest of the sync is dropped with the queue.
+      }
+
+      LatencyResult result;
+      result.sync_calls = sync_done;
+      std::sort(latencies.begin(), latencies.end());
+      result.p50_ms = latencies[checks / 2];
+      result.p99_ms = latencies[std::min(checks - 1, checks * 99 / 100)];
+      result.max_ms = latencies.back();
+      return result;
+    }
+
+  } // namespace
+
+  bool RunWorkQueueBenchmark(const BenchmarkOptions &options)
+  {
+    size_t checks = options.size > 0 ? options.size : kDefaultChecks;
+    struct Mode
+    {
+      const char *name;
+      WorkPriority sync_priority;
+    };
+    const Mode modes[] = {
+        {"priority classes", WorkPriority::kBackground},
+        {"one class (FIFO)", WorkPriority::kInteractive},
+    };
+
+    std::printf("work queue, %zu license checks of %lld ms every %lld ms, sync calls of %lld ms, %zu workers\n",
+                checks, static_cast<long long>(kLicenseCall.count()), static_cast<long long>(kCheckInterval.count()),
+                static_cast<long long>(kSyncCall.count()), kWorkerCount);
+    std::printf("%-20s %12s %12s %12s %12s\n", "sync posted with", "p50 ms", "p99 ms", "max ms", "sync calls");
+    for (const Mode &mode : modes)
+    {
+      LatencyResult best;
+      for (size_t run = 0; run < options.runs; run++)
+      {
+        LatencyResult result = CheckUnderLoad(checks, mode.sync_priority);
+        if (run == 0 || result.p99_ms < best.p99_ms)
+        {
+          best = result;
+        }
+      }
+      std::printf("%-20s %12.2f %12.2f %12.2f %12zu\n", mode.name, best.p50_ms, best.p99_ms, best.max_ms,
+                  best.sync_calls);
+    }
+    // Checks always complete, so there is nothing to disagree on.
+    return true;
+  }
+
+} // namespace windows_store
@@ -0,0 +1,803 @@
+// Load generator for the plugin's channel layer. Sends encoded requests
+// through the handlers WindowsStoreApi::SetUp and BulkStoreApi::SetUp
+// register, in process and without an engine, and reports throughput,
+// latency percentiles and heap allocations per request. See README.md.
+
+#include <flutter/encodable_value.h>
+#include <flutter/standard_message_codec.h>
+
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch_query.h"
+#include "bulk_channel.h"
+#include "byte_buffer.h"
+#include "columnar_writer.h"
+#include "in_process_messenger.h"
+#include "license_snapshot.h"
+#include "pigeon/messages.g.h"
+#include "store_product.h"
+#include "store_trace.h"
+#include "synthetic_store_backend.h"
+#include "windows_store_api_instance.h"
+
+namespace
+{
+
+  std::atomic<uint64_t> g_allocations{0};
+  std::atomic<uint64_t> g_allocated_bytes{0};
+  // Set while the generator itself allocates, e.g. to decode replies, so
+  // only the plugin and the channel layer are counted.
+  thread_local bool t_uncounted = false;
+
+  void *CountedAllocation(size_t size)
+  {
+    if (!t_uncounted)
+    {
+      g_allocations.fetch_add(1, std::memory_order_relaxed);
+      g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return std::malloc(size != 0 ? size : 1);
+  }
+
+  class UncountedScope
+  {
+  public:
+    UncountedScope() : previous_(t_uncounted) { t_uncounted = true; }
+    ~UncountedScope() { t_uncounted = previous_; }
+
+    UncountedScope(const UncountedScope &) = delete;
+    UncountedScope &operator=(const UncountedScope &) = delete;
+
+  private:
+    bool previous_;
+  };
+
+} // namespace
+
+void *operator new(size_t size)
+{
+  if (void *memory = CountedAllocation(size))
+  {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  return CountedAllocation(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  return CountedAllocation(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+  std::free(memory);
+}
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr char kPigeonChannelPrefix[] = "dev.flutter.pigeon.windows_store.WindowsStoreApi.";
+    constexpr size_t kFeatureCount = 8;
+    constexpr size_t kBatchSize = 16;
+
+    struct Options
+    {
+      std::string scenario = "all";
+      size_t requests = 20000;
+      size_t warmup = 1000;
+      size_t concurrency = 16;
+      // Requests per second; 0 sends as fast as replies allow.
+      double rate = 0;
+      std::chrono::microseconds store_latency{0};
+      size_t add_ons = 32;
+      size_t products = 200;
+      // Products of the payload the codec comparison encodes.
+      size_t codec_products = 10000;
+      // Store trace to answer Store calls from instead of the synthetic
+      // backend, and its replay speed.
+      std::string trace;
+      double speed = 1;
+    };
+
+    // Requests of one kind: the messages are sent in turn, and every reply
+    // is decoded by |check|.
+    struct Scenario
+    {
+      std::string name;
+      std::string channel;
+      std::vector<std::vector<uint8_t>> messages;
+      std::function<bool(const uint8_t *reply, size_t reply_size)> check;
+      // Heap allocations per request above which the run fails, if set.
+      std::optional<double> max_allocations;
+    };
+
+    struct RunResult
+    {
+      std::vector<int64_t> latencies_ns;
+      size_t errors = 0;
+      double seconds = 0;
+      uint64_t allocations = 0;
+      uint64_t allocated_bytes = 0;
+    };
+
+    const flutter::StandardMessageCodec &Codec()
+    {
+      return WindowsStoreApi::GetCodec();
+    }
+
+    std::vector<uint8_t> EncodePigeon(const flutter::EncodableValue &arguments)
+    {
+      return *Codec().EncodeMessage(arguments);
+    }
+
+    // Pigeon replies are a list of the value, or of code, message and
+    // details for errors.
+    bool DecodePigeonReply(const uint8_t *reply, size_t reply_size, flutter::EncodableValue *value)
+    {
+      std::unique_ptr<flutter::EncodableValue> decoded = Codec().DecodeMessage(reply, reply_size);
+      const auto *list = decoded ? std::get_if<flutter::EncodableList>(decoded.get()) : nullptr;
+      if (list == nullptr || list->size() != 1)
+      {
+        return false;
+      }
+      if (value != nullptr)
+      {
+        *value = (*list)[0];
+      }
+      return true;
+    }
+
+    bool CheckBulkReply(const uint8_t *reply, size_t reply_size)
+    {
+      uint32_t magic = 0;
+      if (reply_size < 16 || reply[0] != 0)
+      {
+        return false;
+      }
+      std::memcpy(&magic, reply + 8, sizeof(magic));
+      return magic == ColumnarWriter::kMagic;
+    }
+
+    std::vector<uint8_t> BytesOf(const ByteWriter &writer)
+    {
+      return std::vector<uint8_t>(writer.data(), writer.data() + writer.size());
+    }
+
+    Scenario LicenseScenario()
+    {
+      Scenario scenario;
+      scenario.name = "license";
+      scenario.channel = std::string(kPigeonChannelPrefix) + "getAppLicenseAsync";
+      scenario.messages.push_back(EncodePigeon(flutter::EncodableValue()));
+      scenario.check = [](const uint8_t *reply, size_t reply_size)
+      {
+        flutter::EncodableValue value;
+        if (!DecodePigeonReply(reply, reply_size, &value))
+        {
+          return false;
+        }
+        const auto *custom = std::get_if<flutter::CustomEncodableValue>(&value);
+        const auto *license = custom != nullptr ? std::any_cast<StoreAppLicenseInner>(&static_cast<const std::any &>(*custom)) : nullptr;
+        return license != nullptr && license->is_active();
+      };
+      return scenario;
+    }
+
+    Scenario FeaturesScenario()
+    {
+      flutter::EncodableList features;
+      for (size_t i = 0; i < kFeatureCount; i++)
+      {
+        features.emplace_back("feature_" + std::to_string(i));
+      }
+      Scenario scenario;
+      scenario.name = "features";
+      scenario.channel = std::string(kPigeonChannelPrefix) + "areFeaturesEnabledAsync";
+      scenario.messages.push_back(EncodePigeon(flutter::EncodableList{flutter::EncodableValue(features)}));
+      scenario.check = [](const uint8_t *reply, size_t reply_size)
+      {
+        flutter::EncodableValue value;
+        if (!DecodePigeonReply(reply, reply_size, &value))
+        {
+          return false;
+        }
+        const auto *enabled = std::get_if<flutter::EncodableList>(&value);
+        return enabled != nullptr && enabled->size() == kFeatureCount;
+      };
+      return scenario;
+    }
+
+    Scenario LicenseFieldsScenario()
+    {
+      ByteWriter request;
+      request.WriteU8(BulkStoreApi::kGetAppLicense);
+      request.WriteU64(kAllLicenseFields);
+      request.WriteU32(0);
+      Scenario scenario;
+      scenario.name = "license-fields";
+      scenario.channel = BulkStoreApi::kChannelName;
+      scenario.messages.push_back(BytesOf(request));
+      scenario.check = CheckBulkReply;
+      // Requests reuse pooled contexts and reply with the cached license.
+      scenario.max_allocations = 0;
+      return scenario;
+    }
+
+    Scenario ProductScenario(const Options &options)
+    {
+      Scenario scenario;
+      scenario.name = "product";
+      scenario.channel = BulkStoreApi::kChannelName;
+      for (size_t i = 0; i < options.products; i++)
+      {
+        ByteWriter request;
+        request.WriteU8(BulkStoreApi::kGetStoreProduct);
+        request.WriteString(SyntheticStoreBackend::ProductId(i));
+        request.WriteU64(kAllProductFields);
+        request.WriteU32(0);
+        scenario.messages.push_back(BytesOf(request));
+      }
+      scenario.check = CheckBulkReply;
+      return scenario;
+    }
+
+    Scenario BatchScenario(const Options &options)
+    {
+      Scenario scenario;
+      scenario.name = "batch";
+      scenario.channel = BulkStoreApi::kChannelName;
+      for (size_t first = 0; first < options.products; first += kBatchSize)
+      {
+        ByteWriter request;
+        request.WriteU8(BulkStoreApi::kRunBatchQuery);
+        request.WriteU8(static_cast<uint8_t>(BatchQuery::kUserCollection));
+        request.WriteU32(static_cast<uint32_t>(kBatchSize));
+        for (size_t i = 0; i < kBatchSize; i++)
+        {
+          request.WriteString(SyntheticStoreBackend::ProductId((first + i) % options.products));
+        }
+        request.WriteU32(4);
+        request.WriteU32(0);
+        scenario.messages.push_back(BytesOf(request));
+      }
+      scenario.check = CheckBulkReply;
+      return scenario;
+    }
+
+    // A product as a Pigeon data class would encode it: the list of its
+    // fields.
+    flutter::EncodableValue ProductValue(const StoreProductRecord &product)
+    {
+      return flutter::EncodableValue(flutter::EncodableList{
+          flutter::EncodableValue(product.store_id),
+          flutter::EncodableValue(product.product_kind),
+          flutter::EncodableValue(product.title),
+          flutter::EncodableValue(product.description),
+          flutter::EncodableValue(product.formatted_price),
+          flutter::EncodableValue(product.formatted_base_price),
+          flutter::EncodableValue(product.currency_code),
+          flutter::EncodableValue(product.is_in_user_collection),
+          flutter::EncodableValue(product.has_digital_download),
+          flutter::EncodableValue(product.in_app_offer_token),
+          flutter::EncodableValue(product.link_uri),
+      });
+    }
+
+    // Decodes a StandardMessageCodec product list and reads every field.
+    // Returns the total length of the strings plus the number of true
+    // flags, to check both formats carry the same values.
+    size_t ReadStandardProducts(const std::vector<uint8_t> &message)
+    {
+      std::unique_ptr<flutter::EncodableValue> decoded = Codec().DecodeMessage(message.data(), message.size());
+      size_t checksum = 0;
+      for (const flutter::EncodableValue &product : std::get<flutter::EncodableList>(*decoded))
+      {
+        for (const flutter::EncodableValue &field : std::get<flutter::EncodableList>(product))
+        {
+          if (const auto *text = std::get_if<std::string>(&field))
+          {
+            checksum += text->size();
+          }
+          else if (const auto *flag = std::get_if<bool>(&field))
+          {
+            checksum += *flag ? 1 : 0;
+          }
+        }
+      }
+      return checksum;
+    }
+
+    // Reads every value of a columnar table the way the Dart reader does,
+    // without copying strings. Returns the same checksum as
+    // ReadStandardProducts.
+    size_t ReadColumnarProducts(const std::vector<uint8_t> &table)
+    {
+      ByteReader header(table.data(), table.size());
+      header.ReadU32();
+      header.ReadU16();
+      uint16_t column_count = header.ReadU16();
+      uint32_t row_count = header.ReadU32();
+      header.ReadU32();
+      uint32_t string_offsets = header.ReadU32();
+      uint32_t string_data = header.ReadU32();
+      auto u32_at = [&table](size_t position)
+      {
+        uint32_t value;
+        std::memcpy(&value, table.data() + position, sizeof(value));
+        return value;
+      };
+      size_t checksum = 0;
+      for (uint16_t column = 0; column < column_count; column++)
+      {
+        size_t descriptor = ColumnarWriter::kHeaderSize + column * ColumnarWriter::kColumnDescriptorSize;
+        auto type = static_cast<ColumnType>(table[descriptor + 2]);
+        uint32_t position = u32_at(descriptor + 4);
+        for (uint32_t row = 0; row < row_count; row++)
+        {
+          if (type == ColumnType::kString)
+          {
+            uint32_t index = u32_at(position + row * 4);
+            uint32_t start = u32_at(string_offsets + index * 4);
+            uint32_t end = u32_at(string_offsets + index * 4 + 4);
+            checksum += std::string_view(reinterpret_cast<const char *>(table.data()) + string_data + start,
+                                         end - start)
+                            .size();
+          }
+          else if (type == ColumnType::kBool)
+          {
+            checksum += table[position + row] != 0 ? 1 : 0;
+          }
+        }
+      }
+      return checksum;
+    }
+
+    // Best time of |runs| calls of |run|, in milliseconds.
+    double BestMs(size_t runs, const std::function<void()> &run)
+    {
+      double best = 0;
+      for (size_t i = 0; i < runs; i++)
+      {
+        Clock::time_point start = Clock::now();
+        run();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        best = i == 0 ? ms : std::min(best, ms);
+      }
+      return best;
+    }
+
+    // Compares the size and the encode and decode times of a product
+    // payload sent with the Pigeon StandardMessageCodec and as a bulk
+    // channel columnar table. Returns false if the two disagree.
+    bool RunCodecComparison(const Options &options)
+    {
+      constexpr size_t kRuns = 10;
+      SyntheticStoreBackend backend(std::chrono::microseconds(0), 0, options.codec_products);
+      std::vector<StoreProductRecord> products =
+          backend.GetAssociatedStoreProducts({"Durable"}, kAllProductFields).value;
+
+      std::vector<uint8_t> standard;
+      double standard_encode_ms = BestMs(kRuns, [&products, &standard]()
+                                         {
+        flutter::EncodableList list;
+        list.reserve(products.size());
+        for (const StoreProductRecord &product : products)
+        {
+          list.push_back(ProductValue(product));
+        }
+        standard = *Codec().EncodeMessage(flutter::EncodableValue(std::move(list))); });
+      size_t standard_checksum = 0;
+      double standard_decode_ms = BestMs(kRuns, [&standard, &standard_checksum]()
+                                         { standard_checksum = ReadStandardProducts(standard); });
+
+      std::vector<uint8_t> columnar;
+      double columnar_encode_ms = BestMs(kRuns, [&products, &columnar]()
+                                         {
+        ByteWriter writer;
+        EncodeStoreProducts(products, kAllProductFields, writer);
+        columnar = writer.TakeBytes(); });
+      size_t columnar_checksum = 0;
+      double columnar_decode_ms = BestMs(kRuns, [&columnar, &columnar_checksum]()
+                                         { columnar_checksum = ReadColumnarProducts(columnar); });
+
+      std::printf("\ncodec comparison: %zu products, all fields, best of %zu runs\n", products.size(), kRuns);
+      std::printf("%-15s %11s %11s %11s\n", "format", "bytes", "encode ms", "decode ms");
+      std::printf("%-15s %11zu %11.2f %11.2f\n", "standard codec", standard.size(), standard_encode_ms,
+                  standard_decode_ms);
+      std::printf("%-15s %11zu %11.2f %11.2f\n", "columnar", columnar.size(), columnar_encode_ms,
+                  columnar_decode_ms);
+      return standard_checksum == columnar_checksum;
+    }
+
+    // Sends one message and waits for its reply, for setup calls.
+    bool SendAndWait(const flutter::BinaryMessenger &messenger, const std::string &channel,
+                     const std::vector<uint8_t> &message)
+    {
+      std::mutex mutex;
+      std::condition_variable replied;
+      bool done = false;
+      bool ok = false;
+      messenger.Send(channel, message.data(), message.size(), [&](const uint8_t *reply, size_t reply_size)
+                     {
+        bool decoded = reply != nullptr && DecodePigeonReply(reply, reply_size, nullptr);
+        std::lock_guard<std::mutex> lock(mutex);
+        ok = decoded;
+        done = true;
+        replied.notify_all(); });
+      std::unique_lock<std::mutex> lock(mutex);
+      replied.wait(lock, [&done]()
+                   { return done; });
+      return ok;
+    }
+
+    bool RegisterFeatures(const flutter::BinaryMessenger &messenger)
+    {
+      flutter::EncodableMap features;
+      for (size_t i = 0; i < kFeatureCount; i++)
+      {
+        features.emplace(flutter::EncodableValue("feature_" + std::to_string(i)),
+                         flutter::EncodableList{flutter::EncodableValue(SyntheticStoreBackend::AddOnId(i * 2))});
+      }
+      return SendAndWait(messenger, std::string(kPigeonChannelPrefix) + "registerFeatures",
+                         EncodePigeon(flutter::EncodableList{flutter::EncodableValue(features)}));
+    }
+
+    // Sends |count| messages of |scenario| from the calling thread, which
+    // stands in for the platform thread, keeping at most
+    // |options.concurrency| unanswered. With a rate, latency counts from the
+    // time a request was due, so requests held back by the concurrency limit
+    // are not flattered.
+    RunResult Run(const flutter::BinaryMessenger &messenger, const Scenario &scenario, size_t count,
+                  const Options &options)
+    {
+      struct State
+      {
+        const Scenario *scenario;
+        std::mutex mutex;
+        std::condition_variable changed;
+        size_t in_flight = 0;
+        size_t done = 0;
+        std::atomic<size_t> errors{0};
+        std::vector<Clock::time_point> sent;
+        std::vector<int64_t> latencies_ns;
+      } state;
+      state.scenario = &scenario;
+      state.sent.resize(count);
+      state.latencies_ns.resize(count);
+
+      auto interval = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(options.rate > 0 ? 1.0 / options.rate : 0.0));
+      uint64_t allocations = g_allocations.load();
+      uint64_t allocated_bytes = g_allocated_bytes.load();
+      Clock::time_point start = Clock::now();
+      for (size_t i = 0; i < count; i++)
+      {
+        {
+          std::unique_lock<std::mutex> lock(state.mutex);
+          state.changed.wait(lock, [&state, &options]()
+                             { return state.in_flight < options.concurrency; });
+          state.in_flight++;
+        }
+        if (options.rate > 0)
+        {
+          Clock::time_point due = start + interval * static_cast<int64_t>(i);
+          std::this_thread::sleep_until(due);
+          state.sent[i] = due;
+        }
+        else
+        {
+          state.sent[i] = Clock::now();
+        }
+
+        flutter::BinaryReply reply;
+        {
+          UncountedScope uncounted;
+          reply = [state = &state, i](const uint8_t *data, size_t size)
+          {
+            Clock::time_point now = Clock::now();
+            bool ok;
+            {
+              UncountedScope uncounted;
+              ok = data != nullptr && state->scenario->check(data, size);
+            }
+            state->latencies_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - state->sent[i]).count();
+            if (!ok)
+            {
+              state->errors++;
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->in_flight--;
+            state->done++;
+            state->changed.notify_all();
+          };
+        }
+        const std::vector<uint8_t> &message = scenario.messages[i % scenario.messages.size()];
+        messenger.Send(scenario.channel, message.data(), message.size(), std::move(reply));
+      }
+      {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.changed.wait(lock, [&state, count]()
+                           { return state.done == count; });
+      }
+
+      RunResult result;
+      result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      result.allocations = g_allocations.load() - allocations;
+      result.allocated_bytes = g_allocated_bytes.load() - allocated_bytes;
+      result.errors = state.errors;
+      UncountedScope uncounted;
+      result.latencies_ns = std::move(state.latencies_ns);
+      return result;
+    }
+
+    // Nearest-rank percentile of sorted |values|, in microseconds.
+    double PercentileUs(const std::vector<int64_t> &values, double percentile)
+    {
+      if (values.empty())
+      {
+        return 0;
+      }
+      size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(values.size()) + 0.999999);
+      return static_cast<double>(values[std::min(std::max<size_t>(rank, 1), values.size()) - 1]) / 1000.0;
+    }
+
+    void PrintHeader()
+    {
+      std::printf("%-15s %9s %5s %11s %9s %9s %9s %9s %11s %10s %7s\n", "scenario", "requests", "conc", "req/s",
+                  "p50 us", "p90 us", "p99 us", "max us", "allocs/req", "bytes/req", "errors");
+    }
+
+    void PrintResult(const std::string &name, const Options &options, RunResult &result)
+    {
+      std::sort(result.latencies_ns.begin(), result.latencies_ns.end());
+      double requests = static_cast<double>(result.latencies_ns.size());
+      std::printf("%-15s %9zu %5zu %11.0f %9.1f %9.1f %9.1f %9.1f %11.2f %10.0f %7zu\n", name.c_str(),
+                  result.latencies_ns.size(), options.concurrency, requests / result.seconds,
+                  PercentileUs(result.latencies_ns, 50), PercentileUs(result.latencies_ns, 90),
+                  PercentileUs(result.latencies_ns, 99), PercentileUs(result.latencies_ns, 100),
+                  static_cast<double>(result.allocations) / requests,
+                  static_cast<double>(result.allocated_bytes) / requests, result.errors);
+    }
+
+    void PrintUsage()
+    {
+      std::printf(
+          "Usage: channel_load [options]\n"
+          "  --scenario=NAME        license, features, license-fields, product, batch, codec or all (default all)\n"
+          "  --requests=N           measured requests per scenario (default 20000)\n"
+          "  --warmup=N             unmeasured requests sent first (default 1000)\n"
+          "  --concurrency=N        most unanswered requests at a time (default 16)\n"
+          "  --rate=N               requests per second, 0 for as fast as possible (default 0)\n"
+          "  --store-latency-us=N   latency of every synthetic Store call (default 0)\n"
+          "  --add-ons=N            add-on licenses of the synthetic app license (default 32)\n"
+          "  --products=N           products of the synthetic catalog (default 200)\n"
+          "  --codec-products=N     products of the codec comparison payload (default 10000)\n"
+          "  --trace=FILE           answer Store calls from a recorded trace instead of the synthetic backend\n"
+          "  --speed=X              trace replay speed relative to the recorded latencies, 0 for no delay\n"
+          "                         (default 1)\n");
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+      for (int i = 1; i < argc; i++)
+      {
+        std::string argument = argv[i];
+        size_t equals = argument.find('=');
+        if (argument.compare(0, 2, "--") != 0 || equals == std::string::npos)
+        {
+          return false;
+        }
+        std::string name = argument.substr(2, equals - 2);
+        std::string value = argument.substr(equals + 1);
+        char *end = nullptr;
+        double number = std::strtod(value.c_str(), &end);
+        bool is_number = !value.empty() && *end == '\0' && number >= 0;
+        if (name == "scenario")
+        {
+          options.scenario = value;
+          continue;
+        }
+        if (name == "trace")
+        {
+          options.trace = value;
+          continue;
+        }
+        if (!is_number)
+        {
+          return false;
+        }
+        if (name == "requests")
+        {
+          options.requests = static_cast<size_t>(number);
+        }
+        else if (name == "warmup")
+        {
+          options.warmup = static_cast<size_t>(number);
+        }
+        else if (name == "concurrency")
+        {
+          options.concurrency = std::max<size_t>(static_cast<size_t>(number), 1);
+        }
+        else if (name == "rate")
+        {
+          options.rate = number;
+        }
+        else if (name == "store-latency-us")
+        {
+          options.store_latency = std::chrono::microseconds(static_cast<int64_t>(number));
+        }
+        else if (name == "add-ons")
+        {
+          options.add_ons = static_cast<size_t>(number);
+        }
+        else if (name == "products")
+        {
+          options.products = std::max<size_t>(static_cast<size_t>(number), 1);
+        }
+        else if (name == "codec-products")
+        {
+          options.codec_products = static_cast<size_t>(number);
+        }
+        else if (name == "speed")
+        {
+          options.speed = number;
+        }
+        else
+        {
+          return false;
+        }
+      }
+      return options.requests > 0;
+    }
+
+  } // namespace
+
+  int RunChannelLoad(int argc, char **argv)
+  {
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+      PrintUsage();
+      return 2;
+    }
+
+    std::vector<Scenario> scenarios;
+    scenarios.push_back(LicenseScenario());
+    scenarios.push_back(FeaturesScenario());
+    scenarios.push_back(LicenseFieldsScenario());
+    scenarios.push_back(ProductScenario(options));
+    scenarios.push_back(BatchScenario(options));
+    bool compare_codecs = options.scenario == "all" || options.scenario == "codec";
+    if (options.scenario == "codec")
+    {
+      scenarios.clear();
+    }
+    else if (options.scenario != "all")
+    {
+      scenarios.erase(std::remove_if(scenarios.begin(), scenarios.end(), [&options](const Scenario &scenario)
+                                     { return scenario.name != options.scenario; }),
+                      scenarios.end());
+      if (scenarios.empty())
+      {
+        PrintUsage();
+        return 2;
+      }
+    }
+
+    std::unique_ptr<StoreBackend> backend;
+    if (!options.trace.empty())
+    {
+      std::vector<StoreTraceRecord> records;
+      if (!StoreTraceFile::Read(options.trace, records))
+      {
+        std::fprintf(stderr, "cannot read trace %s\n", options.trace.c_str());
+        return 1;
+      }
+      backend = std::make_unique<ReplayStoreBackend>(std::move(records), options.speed);
+    }
+    else
+    {
+      backend = std::make_unique<SyntheticStoreBackend>(options.store_latency, options.add_ons, options.products);
+    }
+
+    InProcessMessenger messenger;
+    WindowsStoreApiInstance plugin(std::move(backend), true);
+    WindowsStoreApi::SetUp(&messenger, &plugin);
+    BulkStoreApi::SetUp(&messenger, &plugin);
+    if (!RegisterFeatures(messenger))
+    {
+      std::fprintf(stderr, "registerFeatures failed\n");
+      return 1;
+    }
+
+    if (!scenarios.empty())
+    {
+      PrintHeader();
+    }
+    size_t errors = 0;
+    for (const Scenario &scenario : scenarios)
+    {
+      if (options.warmup > 0)
+      {
+        Run(messenger, scenario, options.warmup, options);
+      }
+      RunResult result = Run(messenger, scenario, options.requests, options);
+      PrintResult(scenario.name, options, result);
+      errors += result.errors;
+      double allocations = static_cast<double>(result.allocations) / static_cast<double>(options.requests);
+      if (scenario.max_allocations && allocations > *scenario.max_allocations)
+      {
+        std::fprintf(stderr, "%s: %.2f allocations per request, expected at most %.2f\n", scenario.name.c_str(),
+                     allocations, *scenario.max_allocations);
+        errors++;
+      }
+    }
+    if (compare_codecs && !RunCodecComparison(options))
+    {
+      std::fprintf(stderr, "codec comparison: the two payloads carry different values\n");
+      errors++;
+    }
+    return errors == 0 ? 0 : 1;
+  }
+
+} // namespace windows_store
+
+int main(int argc, char **argv)
+{
+  return windows_store::RunChannelLoad(argc, argv);
+}
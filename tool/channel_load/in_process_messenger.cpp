@@ -0,0 +1,42 @@
+#include "in_process_messenger.h"
+
+namespace windows_store
+{
+
+  void InProcessMessenger::Send(const std::string &channel, const uint8_t *message, size_t message_size,
+                                flutter::BinaryReply reply) const
+  {
+    const flutter::BinaryMessageHandler *handler = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = handlers_.find(channel);
+      if (found != handlers_.end())
+      {
+        handler = &found->second;
+      }
+    }
+    if (handler == nullptr)
+    {
+      if (reply)
+      {
+        reply(nullptr, 0);
+      }
+      return;
+    }
+    (*handler)(message, message_size, reply ? std::move(reply) : [](const uint8_t *, size_t) {});
+  }
+
+  void InProcessMessenger::SetMessageHandler(const std::string &channel, flutter::BinaryMessageHandler handler)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (handler)
+    {
+      handlers_[channel] = std::move(handler);
+    }
+    else
+    {
+      handlers_.erase(channel);
+    }
+  }
+
+} // namespace windows_store
@@ -0,0 +1,41 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_IN_PROCESS_MESSENGER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_IN_PROCESS_MESSENGER_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace windows_store
+{
+
+  // BinaryMessenger that delivers messages to the handlers registered on it
+  // in the calling thread, standing in for the engine so the plugin's
+  // channel handlers run without one. Both sides use it: the plugin
+  // registers its handlers and sends events, the load generator sends
+  // requests and may register handlers for the events.
+  class InProcessMessenger : public flutter::BinaryMessenger
+  {
+  public:
+    InProcessMessenger() {}
+    virtual ~InProcessMessenger() {}
+
+    InProcessMessenger(const InProcessMessenger &) = delete;
+    InProcessMessenger &operator=(const InProcessMessenger &) = delete;
+
+    // Calls the handler of |channel|, or |reply| with no data if there is
+    // none, as the engine does. Handlers must not be changed while messages
+    // are being sent.
+    void Send(const std::string &channel, const uint8_t *message, size_t message_size,
+              flutter::BinaryReply reply = nullptr) const override;
+    void SetMessageHandler(const std::string &channel, flutter::BinaryMessageHandler handler) override;
+
+  private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, flutter::BinaryMessageHandler> handlers_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_IN_PROCESS_MESSENGER_H_
@@ -0,0 +1,162 @@
+#include "synthetic_store_backend.h"
+
+#include <cstdio>
+#include <thread>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr char kAddOnPrefix[] = "9NADDON";
+    constexpr char kProductPrefix[] = "9NPRODUCT";
+
+    std::string NumberedId(const char *prefix, size_t index)
+    {
+      char id[32];
+      std::snprintf(id, sizeof(id), "%s%05zu", prefix, index);
+      return id;
+    }
+
+  } // namespace
+
+  SyntheticStoreBackend::SyntheticStoreBackend(std::chrono::microseconds latency, size_t add_on_count,
+                                               size_t product_count)
+      : latency_(latency), add_on_count_(add_on_count), product_count_(product_count)
+  {
+  }
+
+  // static
+  std::string SyntheticStoreBackend::AddOnId(size_t index)
+  {
+    return NumberedId(kAddOnPrefix, index);
+  }
+
+  // static
+  std::string SyntheticStoreBackend::ProductId(size_t index)
+  {
+    return NumberedId(kProductPrefix, index);
+  }
+
+  StoreResult<LicenseSnapshot> SyntheticStoreBackend::GetAppLicense(uint64_t field_mask)
+  {
+    Wait();
+    StoreResult<LicenseSnapshot> result;
+    LicenseSnapshot &license = result.value;
+    license.is_active = true;
+    license.sku_store_id = "9NSYNTHETIC0/0010";
+    if ((field_mask & LicenseFieldBit(LicenseField::kAddOnLicenses)) != 0)
+    {
+      for (size_t i = 0; i < add_on_count_; i++)
+      {
+        AddOnLicenseRecord add_on;
+        add_on.sku_store_id = AddOnId(i) + "/0010";
+        add_on.in_app_offer_token = "addon_" + std::to_string(i);
+        add_on.is_active = true;
+        license.add_ons.push_back(std::move(add_on));
+      }
+    }
+    return result;
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> SyntheticStoreBackend::GetAssociatedStoreProducts(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    Wait();
+    StoreResult<std::vector<StoreProductRecord>> result;
+    for (size_t i = 0; i < product_count_; i++)
+    {
+      result.value.push_back(Product(i));
+    }
+    return result;
+  }
+
+  StoreResult<ConsumableBalanceRecord> SyntheticStoreBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+  {
+    Wait();
+    StoreResult<ConsumableBalanceRecord> result;
+    result.value.balance_remaining = static_cast<uint32_t>(store_id.size());
+    return result;
+  }
+
+  StoreResult<bool> SyntheticStoreBackend::IsInUserCollection(const std::string &store_id)
+  {
+    Wait();
+    StoreResult<bool> result;
+    size_t index = ProductIndex(store_id);
+    result.value = index < product_count_ && index % 2 == 0;
+    return result;
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> SyntheticStoreBackend::GetStoreProducts(
+      const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+      uint64_t field_mask)
+  {
+    Wait();
+    StoreResult<std::vector<StoreProductRecord>> result;
+    for (const std::string &store_id : store_ids)
+    {
+      size_t index = ProductIndex(store_id);
+      if (index < product_count_)
+      {
+        result.value.push_back(Product(index));
+      }
+    }
+    return result;
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> SyntheticStoreBackend::GetUserCollection(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    Wait();
+    StoreResult<std::vector<StoreProductRecord>> result;
+    for (size_t i = 0; i < product_count_; i += 2)
+    {
+      result.value.push_back(Product(i));
+    }
+    return result;
+  }
+
+  void SyntheticStoreBackend::Wait() const
+  {
+    if (latency_.count() > 0)
+    {
+      std::this_thread::sleep_for(latency_);
+    }
+  }
+
+  StoreProductRecord SyntheticStoreBackend::Product(size_t index) const
+  {
+    StoreProductRecord product;
+    product.store_id = ProductId(index);
+    product.product_kind = "Durable";
+    product.title = "Synthetic product " + std::to_string(index);
+    product.description = "Generated by the channel load generator";
+    product.formatted_price = "$" + std::to_string(1 + index % 20) + ".99";
+    product.currency_code = "USD";
+    product.is_in_user_collection = index % 2 == 0;
+    return product;
+  }
+
+  size_t SyntheticStoreBackend::ProductIndex(const std::string &store_id) const
+  {
+    constexpr size_t kPrefixLength = sizeof(kProductPrefix) - 1;
+    if (store_id.compare(0, kPrefixLength, kProductPrefix) != 0)
+    {
+      return product_count_;
+    }
+    size_t index = 0;
+    for (size_t i = kPrefixLength; i < store_id.size(); i++)
+    {
+      char digit = store_id[i];
+      if (digit < '0' || digit > '9')
+      {
+        return product_count_;
+      }
+      index = index * 10 + static_cast<size_t>(digit - '0');
+    }
+    return index < product_count_ ? index : product_count_;
+  }
+
+} // namespace windows_store
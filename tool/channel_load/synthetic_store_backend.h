@@ -0,0 +1,54 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_SYNTHETIC_STORE_BACKEND_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_SYNTHETIC_STORE_BACKEND_H_
+
+#include <chrono>
+#include <string>
+
+#include "store_backend.h"
+
+namespace windows_store
+{
+
+  // StoreBackend that answers every call with generated data after
+  // |latency|, so load runs measure the plugin rather than the Store.
+  //
+  // The license has |add_on_count| active add-ons, AddOnId(i), and the
+  // catalog holds |product_count| durables, ProductId(i), of which the user
+  // owns the even ones.
+  class SyntheticStoreBackend : public StoreBackend
+  {
+  public:
+    SyntheticStoreBackend(std::chrono::microseconds latency, size_t add_on_count, size_t product_count);
+    virtual ~SyntheticStoreBackend() {}
+
+    static std::string AddOnId(size_t index);
+    static std::string ProductId(size_t index);
+
+    bool RequiresPackageIdentity() const override { return false; }
+
+    StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+    StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+    StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+    StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+  private:
+    void Wait() const;
+    StoreProductRecord Product(size_t index) const;
+    // The index of the product |store_id|, or |product_count_| if there is
+    // none.
+    size_t ProductIndex(const std::string &store_id) const;
+
+    const std::chrono::microseconds latency_;
+    const size_t add_on_count_;
+    const size_t product_count_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_SYNTHETIC_STORE_BACKEND_H_
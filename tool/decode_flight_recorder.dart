@@ -0,0 +1,181 @@
+// Decodes a flight recorder dump of the windows_store plugin, as written by
+// `WindowsStoreApi.dumpFlightRecorderAsync` or at exit when
+// WINDOWS_STORE_FLIGHT_RECORDER is set. See `windows/flight_recorder.h` for
+// the format. Runs on any platform:
+//
+//   dart run tool/decode_flight_recorder.dart <dump> [--json]
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+const int _magic = 0x52465357;
+const int _version = 1;
+const int _headerSize = 32;
+const int _recordSize = 96;
+const int _textCapacity = 48;
+
+// Values of `StoreApi` in windows/store_backend.h.
+const Map<int, String> _apiNames = {
+  1: 'GetAppLicense',
+  2: 'GetAssociatedStoreProducts',
+  3: 'GetConsumableBalanceRemaining',
+  4: 'IsInUserCollection',
+  5: 'GetStoreProducts',
+  6: 'GetUserCollection',
+};
+
+// Values of `ConsumableBalanceRecord::Status` in windows/store_product.h.
+const List<String> _consumableStatuses = [
+  'succeeded',
+  'insufficientQuantity',
+  'networkError',
+  'serverError',
+];
+
+const int _isActive = 1 << 0;
+const int _isTrial = 1 << 1;
+const int _result = 1 << 2;
+const int _textTruncated = 1 << 3;
+
+class FlightRecord {
+  FlightRecord(ByteData data, int offset)
+      : sequence = data.getUint64(offset, Endian.little),
+        start = DateTime.fromMicrosecondsSinceEpoch(
+            data.getInt64(offset + 8, Endian.little),
+            isUtc: true),
+        argumentsHash = data.getUint64(offset + 16, Endian.little),
+        value = data.getInt64(offset + 24, Endian.little),
+        latencyUs = data.getUint32(offset + 32, Endian.little),
+        hresult = data.getInt32(offset + 36, Endian.little),
+        count = data.getUint32(offset + 40, Endian.little),
+        api = data.getUint8(offset + 44),
+        flags = data.getUint8(offset + 45),
+        status = data.getUint8(offset + 46),
+        text = utf8.decode(
+            Uint8List.sublistView(data, offset + 48,
+                offset + 48 + _min(data.getUint8(offset + 47), _textCapacity)),
+            allowMalformed: true);
+
+  final int sequence;
+  final DateTime start;
+  final int argumentsHash;
+  final int value;
+  final int latencyUs;
+  final int hresult;
+  final int count;
+  final int api;
+  final int flags;
+  final int status;
+  final String text;
+
+  bool get ok => hresult >= 0;
+  String get apiName => _apiNames[api] ?? 'Unknown($api)';
+  String get hresultHex =>
+      '0x${(hresult & 0xFFFFFFFF).toRadixString(16).padLeft(8, '0')}';
+  String get argumentsHashHex =>
+      argumentsHash.toUnsigned(64).toRadixString(16).padLeft(16, '0');
+  String get displayText =>
+      (flags & _textTruncated) != 0 ? '$text...' : text;
+
+  /// Human readable summary of the result.
+  String get summary {
+    if (!ok) {
+      return 'error "$displayText"';
+    }
+    switch (api) {
+      case 1:
+        return 'active=${(flags & _isActive) != 0} '
+            'trial=${(flags & _isTrial) != 0} '
+            'trialRemaining=${Duration(milliseconds: value)} '
+            'addOns=$count sku="$displayText"';
+      case 2:
+        return 'products=$count';
+      case 3:
+        final name = status < _consumableStatuses.length
+            ? _consumableStatuses[status]
+            : 'status($status)';
+        return '$name balance=$value trackingId="$displayText"';
+      case 4:
+        return 'storeId="$displayText" owned=${(flags & _result) != 0}';
+      case 5:
+        return 'products=$count of $value IDs';
+      case 6:
+        return 'products=$count';
+    }
+    return '';
+  }
+
+  Map<String, Object> toJson() => {
+        'sequence': sequence,
+        'start': start.toIso8601String(),
+        'api': apiName,
+        'argumentsHash': argumentsHashHex,
+        'latencyUs': latencyUs,
+        'hresult': hresultHex,
+        'value': value,
+        'count': count,
+        'flags': flags,
+        'status': status,
+        'text': displayText,
+      };
+}
+
+int _min(int a, int b) => a < b ? a : b;
+
+void main(List<String> arguments) {
+  final paths = arguments.where((argument) => !argument.startsWith('--'));
+  if (paths.length != 1) {
+    stderr.writeln(
+        'Usage: dart run tool/decode_flight_recorder.dart <dump> [--json]');
+    exitCode = 64;
+    return;
+  }
+  final bytes = File(paths.single).readAsBytesSync();
+  final data = ByteData.sublistView(bytes);
+  if (bytes.length < _headerSize ||
+      data.getUint32(0, Endian.little) != _magic) {
+    stderr.writeln('Not a flight recorder dump');
+    exitCode = 65;
+    return;
+  }
+  final version = data.getUint16(4, Endian.little);
+  final recordSize = data.getUint16(6, Endian.little);
+  if (version != _version || recordSize != _recordSize) {
+    stderr.writeln('Unsupported dump version $version');
+    exitCode = 65;
+    return;
+  }
+  final capacity = data.getUint32(8, Endian.little);
+  final count = data.getUint32(12, Endian.little);
+  final total = data.getUint64(16, Endian.little);
+  final dumped = DateTime.fromMicrosecondsSinceEpoch(
+      data.getInt64(24, Endian.little),
+      isUtc: true);
+  final available = (bytes.length - _headerSize) ~/ _recordSize;
+  final records = [
+    for (var i = 0; i < _min(count, available); i++)
+      FlightRecord(data, _headerSize + i * _recordSize),
+  ];
+
+  if (arguments.contains('--json')) {
+    stdout.writeln(const JsonEncoder.withIndent('  ').convert({
+      'dumped': dumped.toIso8601String(),
+      'capacity': capacity,
+      'totalRecorded': total,
+      'records': [for (final record in records) record.toJson()],
+    }));
+    return;
+  }
+
+  stdout.writeln('Dumped $dumped: ${records.length} of $total calls '
+      '(capacity $capacity)');
+  for (final record in records) {
+    final latency = (record.latencyUs / 1000).toStringAsFixed(1);
+    stdout.writeln('#${record.sequence} ${record.start.toIso8601String()} '
+        '${record.apiName} ${latency}ms ${record.hresultHex} '
+        'args=${record.argumentsHashHex} ${record.summary}');
+  }
+  if (count > available) {
+    stderr.writeln('Dump is truncated: ${count - available} records missing');
+  }
+}
@@ -0,0 +1,37 @@
+#include "atomic_file.h"
+
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace windows_store
+{
+
+  bool WriteFileAtomically(const std::filesystem::path &path, const std::filesystem::path &temp_path,
+                           const void *data, size_t size)
+  {
+    {
+      std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+      file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+      if (!file)
+      {
+        return false;
+      }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error)
+    {
+      std::filesystem::remove(temp_path, error);
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<uint8_t> ReadFileBytes(const std::filesystem::path &path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  }
+
+} // namespace windows_store
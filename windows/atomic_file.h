@@ -0,0 +1,23 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_ATOMIC_FILE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_ATOMIC_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace windows_store
+{
+
+  // Writes |size| bytes to |path| through |temp_path|, which is renamed over
+  // |path| once complete, so a crash never leaves a partial file under the
+  // final name.
+  bool WriteFileAtomically(const std::filesystem::path &path, const std::filesystem::path &temp_path,
+                           const void *data, size_t size);
+
+  // The contents of |path|, or nothing if it cannot be read.
+  std::vector<uint8_t> ReadFileBytes(const std::filesystem::path &path);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_ATOMIC_FILE_H_
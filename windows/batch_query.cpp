@@ -0,0 +1,87 @@
+#include "batch_query.h"
+
+#include "byte_buffer.h"
+#include "columnar_writer.h"
+
+namespace windows_store
+{
+
+  BatchItemResult RunBatchItem(StoreBackend &backend, BatchQuery query, const std::string &store_id)
+  {
+    BatchItemResult item;
+    item.store_id = store_id;
+    switch (query)
+    {
+    case BatchQuery::kConsumableBalance:
+    {
+      auto balance = backend.GetConsumableBalanceRemaining(store_id);
+      item.hresult = balance.hresult;
+      item.message = std::move(balance.message);
+      item.balance = std::move(balance.value);
+      break;
+    }
+    case BatchQuery::kUserCollection:
+    {
+      auto owned = backend.IsInUserCollection(store_id);
+      item.hresult = owned.hresult;
+      item.message = std::move(owned.message);
+      item.is_in_user_collection = owned.value;
+      break;
+    }
+    }
+    return item;
+  }
+
+  void EncodeBatchResults(BatchQuery query, const std::vector<BatchItemResult> &results, ByteWriter &out)
+  {
+    ColumnarWriter writer(static_cast<uint32_t>(results.size()));
+    auto begin = [&writer](BatchItemField field, ColumnType type)
+    { writer.BeginColumn(static_cast<uint16_t>(field), type); };
+
+    begin(BatchItemField::kStoreId, ColumnType::kString);
+    for (const BatchItemResult &item : results)
+    {
+      writer.AppendString(item.store_id);
+    }
+    begin(BatchItemField::kHResult, ColumnType::kInt64);
+    for (const BatchItemResult &item : results)
+    {
+      writer.AppendInt64(item.hresult);
+    }
+    begin(BatchItemField::kErrorMessage, ColumnType::kString);
+    for (const BatchItemResult &item : results)
+    {
+      writer.AppendString(item.message);
+    }
+
+    switch (query)
+    {
+    case BatchQuery::kConsumableBalance:
+      begin(BatchItemField::kBalanceStatus, ColumnType::kInt64);
+      for (const BatchItemResult &item : results)
+      {
+        writer.AppendInt64(item.balance.status);
+      }
+      begin(BatchItemField::kBalanceRemaining, ColumnType::kInt64);
+      for (const BatchItemResult &item : results)
+      {
+        writer.AppendInt64(item.balance.balance_remaining);
+      }
+      begin(BatchItemField::kTrackingId, ColumnType::kString);
+      for (const BatchItemResult &item : results)
+      {
+        writer.AppendString(item.balance.tracking_id);
+      }
+      break;
+    case BatchQuery::kUserCollection:
+      begin(BatchItemField::kIsInUserCollection, ColumnType::kBool);
+      for (const BatchItemResult &item : results)
+      {
+        writer.AppendBool(item.is_in_user_collection);
+      }
+      break;
+    }
+    writer.Finish(out);
+  }
+
+} // namespace windows_store
@@ -0,0 +1,56 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_BATCH_QUERY_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_BATCH_QUERY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "store_backend.h"
+
+namespace windows_store
+{
+
+  // Per-product Store queries that can be run for many Store IDs at once.
+  enum class BatchQuery : uint8_t
+  {
+    kConsumableBalance = 1,
+    kUserCollection = 2,
+  };
+
+  // Field ids of batch result columns. Must match BatchItemField in
+  // lib/src/bulk_api.dart.
+  enum class BatchItemField : uint16_t
+  {
+    kStoreId = 0,
+    kHResult = 1,
+    kErrorMessage = 2,
+    kBalanceStatus = 3,
+    kBalanceRemaining = 4,
+    kTrackingId = 5,
+    kIsInUserCollection = 6,
+  };
+
+  // Outcome of a BatchQuery for one Store ID. Failed items carry a negative
+  // |hresult| and |message|; the query-specific fields are only set on
+  // success.
+  struct BatchItemResult
+  {
+    std::string store_id;
+    int32_t hresult = 0;
+    std::string message;
+    ConsumableBalanceRecord balance;
+    bool is_in_user_collection = false;
+  };
+
+  // Runs |query| for |store_id| against |backend|.
+  BatchItemResult RunBatchItem(StoreBackend &backend, BatchQuery query, const std::string &store_id);
+
+  class ByteWriter;
+
+  // Appends |results| to |writer| as a columnar table with the common columns
+  // and those of |query|.
+  void EncodeBatchResults(BatchQuery query, const std::vector<BatchItemResult> &results, ByteWriter &writer);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_BATCH_QUERY_H_
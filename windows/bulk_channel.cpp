@@ -0,0 +1,285 @@
+#include "bulk_channel.h"
+
+#include "byte_buffer.h"
+#include "store_serialization.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr uint8_t kStatusOk = 0;
+    constexpr uint8_t kStatusError = 1;
+    constexpr size_t kReplyHeaderSize = 8;
+
+    // Requests whose reply grew past this, e.g. for a catalog sync, free
+    // their buffers rather than keeping them in the pool.
+    constexpr size_t kMaxPooledReplyCapacity = 64 * 1024;
+
+    void WriteReplyHeader(ByteWriter &writer, uint8_t status)
+    {
+      writer.Clear();
+      writer.WriteU8(status);
+      writer.Align(kReplyHeaderSize);
+    }
+
+  } // namespace
+
+  void BulkStoreApi::Reply(Request *request)
+  {
+    request->reply(request->writer.data(), request->writer.size());
+    request->reply = nullptr;
+    if (request->writer.bytes().capacity() > kMaxPooledReplyCapacity)
+    {
+      std::vector<uint8_t>().swap(request->writer.bytes());
+      request->table = ColumnarWriter(0);
+    }
+    requests_.Release(request);
+  }
+
+  void BulkStoreApi::ReplyError(Request *request, const FlutterError &error)
+  {
+    WriteReplyHeader(request->writer, kStatusError);
+    request->writer.WriteString(error.code());
+    request->writer.WriteString(error.message());
+    Reply(request);
+  }
+
+  template <typename Encode>
+  void BulkStoreApi::ReplyTable(Request *request, Encode encode)
+  {
+    WriteReplyHeader(request->writer, kStatusOk);
+    encode(request->writer);
+    Reply(request);
+  }
+
+  void BulkStoreApi::SetUp(flutter::BinaryMessenger *binary_messenger, BulkStoreApi *api)
+  {
+    if (api == nullptr)
+    {
+      binary_messenger->SetMessageHandler(kChannelName, nullptr);
+      return;
+    }
+    binary_messenger->SetMessageHandler(
+        kChannelName,
+        [api](const uint8_t *message, size_t message_size, flutter::BinaryReply reply)
+        {
+          ByteReader reader(message, message_size);
+          uint8_t opcode = reader.ReadU8();
+          Request *request = api->requests_.Acquire();
+          request->reply = std::move(reply);
+          try
+          {
+            switch (opcode)
+            {
+            case kGetAssociatedStoreProducts:
+            {
+              std::vector<std::string> product_kinds = ReadStringList(reader);
+              request->field_mask = reader.ReadU64() & kAllProductFields;
+              request->extended_fields.emplace(ReadJsonFields(reader));
+              if (!reader.ok())
+              {
+                break;
+              }
+              if (request->extended_fields->field_count() != 0)
+              {
+                request->field_mask |= ProductFieldBit(ProductField::kExtendedJsonData);
+              }
+              api->GetAssociatedStoreProductsAsync(
+                  product_kinds, request->field_mask,
+                  [api, request](ErrorOr<std::vector<StoreProductRecord>> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output, request](ByteWriter &writer)
+                                    { EncodeStoreProducts(output.value(), request->field_mask, *request->extended_fields, request->table, writer); });
+                  });
+              return;
+            }
+            case kGetAppLicense:
+            {
+              request->field_mask = reader.ReadU64() & kAllLicenseFields;
+              request->extended_fields.emplace(ReadJsonFields(reader));
+              if (!reader.ok())
+              {
+                break;
+              }
+              if (request->extended_fields->field_count() != 0)
+              {
+                request->field_mask |= LicenseFieldBit(LicenseField::kExtendedJsonData);
+              }
+              api->GetAppLicenseFieldsAsync(
+                  request->field_mask,
+                  [api, request](ErrorOr<std::shared_ptr<const LicenseSnapshot>> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output, request](ByteWriter &writer)
+                                    { EncodeLicenseSnapshot(*output.value(), request->field_mask, *request->extended_fields, request->table, writer); });
+                  });
+              return;
+            }
+            case kQueryCatalog:
+            {
+              CatalogQuery query;
+              query.product_kinds = ReadStringList(reader);
+              uint8_t ownership = reader.ReadU8();
+              bool has_min_price = reader.ReadU8() != 0;
+              bool has_max_price = reader.ReadU8() != 0;
+              double min_price = reader.ReadF64();
+              double max_price = reader.ReadF64();
+              query.keyword = reader.ReadString();
+              query.offset = reader.ReadU32();
+              query.limit = reader.ReadU32();
+              request->field_mask = reader.ReadU64() & kAllProductFields;
+              if (!reader.ok() || ownership > static_cast<uint8_t>(CatalogQuery::Ownership::kNotOwned))
+              {
+                break;
+              }
+              query.ownership = static_cast<CatalogQuery::Ownership>(ownership);
+              if (has_min_price)
+              {
+                query.min_price = min_price;
+              }
+              if (has_max_price)
+              {
+                query.max_price = max_price;
+              }
+              api->QueryCatalogAsync(
+                  query,
+                  [api, request](ErrorOr<CatalogPage> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output, request](ByteWriter &writer)
+                                    {
+                      writer.WriteU32(output.value().total);
+                      writer.WriteU32(0);
+                      EncodeStoreProducts(output.value().products, request->field_mask, writer); });
+                  });
+              return;
+            }
+            case kRunBatchQuery:
+            {
+              uint8_t query = reader.ReadU8();
+              std::vector<std::string> store_ids = ReadStringList(reader);
+              uint32_t max_parallel = reader.ReadU32();
+              uint32_t stream_id = reader.ReadU32();
+              if (!reader.ok() || query < static_cast<uint8_t>(BatchQuery::kConsumableBalance) ||
+                  query > static_cast<uint8_t>(BatchQuery::kUserCollection))
+              {
+                break;
+              }
+              request->batch_query = static_cast<BatchQuery>(query);
+              api->RunBatchQueryAsync(
+                  request->batch_query, store_ids, max_parallel, stream_id,
+                  [api, request](ErrorOr<std::vector<BatchItemResult>> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output, request](ByteWriter &writer)
+                                    { EncodeBatchResults(request->batch_query, output.value(), writer); });
+                  });
+              return;
+            }
+            case kGetStoreProduct:
+            {
+              std::string store_id = reader.ReadString();
+              request->field_mask = reader.ReadU64() & kAllProductFields;
+              request->extended_fields.emplace(ReadJsonFields(reader));
+              if (!reader.ok())
+              {
+                break;
+              }
+              if (request->extended_fields->field_count() != 0)
+              {
+                request->field_mask |= ProductFieldBit(ProductField::kExtendedJsonData);
+              }
+              api->GetStoreProductAsync(
+                  store_id, request->field_mask,
+                  [api, request](ErrorOr<std::vector<StoreProductRecord>> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output, request](ByteWriter &writer)
+                                    { EncodeStoreProducts(output.value(), request->field_mask, *request->extended_fields, request->table, writer); });
+                  });
+              return;
+            }
+            case kGetProductImages:
+            {
+              std::vector<std::string> store_ids = ReadStringList(reader);
+              std::string purpose_tag = reader.ReadString();
+              if (!reader.ok())
+              {
+                break;
+              }
+              api->GetProductImagesAsync(
+                  store_ids, purpose_tag,
+                  [api, request](ErrorOr<std::vector<ProductImageResult>> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output](ByteWriter &writer)
+                                    { EncodeProductImages(output.value(), writer); });
+                  });
+              return;
+            }
+            case kSyncUserCollection:
+            {
+              std::vector<std::string> product_kinds = ReadStringList(reader);
+              request->field_mask = (reader.ReadU64() & kAllProductFields) | ProductFieldBit(ProductField::kStoreId);
+              uint32_t stream_id = reader.ReadU32();
+              if (!reader.ok())
+              {
+                break;
+              }
+              api->SyncUserCollectionAsync(
+                  product_kinds, request->field_mask, stream_id,
+                  [api, request](ErrorOr<std::shared_ptr<const UserCollection>> output)
+                  {
+                    if (output.has_error())
+                    {
+                      api->ReplyError(request, output.error());
+                      return;
+                    }
+                    api->ReplyTable(request, [&output, request](ByteWriter &writer)
+                                    {
+                      writer.WriteU64(output.value()->version);
+                      EncodeStoreProducts(output.value()->products, request->field_mask, writer); });
+                  });
+              return;
+            }
+            default:
+              api->ReplyError(request, FlutterError("bulk-unknown-opcode", "Unknown bulk opcode " + std::to_string(opcode)));
+              return;
+            }
+            api->ReplyError(request, FlutterError("bulk-malformed-request", "Malformed bulk request"));
+          }
+          catch (const std::exception &exception)
+          {
+            api->ReplyError(request, FlutterError("bulk-exception", exception.what()));
+          }
+        });
+  }
+
+} // namespace windows_store
@@ -0,0 +1,153 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_BULK_CHANNEL_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_BULK_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "batch_query.h"
+#include "byte_buffer.h"
+#include "catalog_index.h"
+#include "collection_sync.h"
+#include "columnar_writer.h"
+#include "image_cache.h"
+#include "json_extractor.h"
+#include "license_snapshot.h"
+#include "pigeon/messages.g.h"
+#include "request_pool.h"
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  // Handler of the raw-bytes bulk channel. Large Store payloads are sent as
+  // columnar tables (see columnar_writer.h) instead of going through
+  // StandardMessageCodec, so neither side boxes every field.
+  //
+  // Request:  u8 opcode | opcode specific arguments (see BulkOpcode)
+  // Reply:    u8 status | 7 bytes padding | body
+  //           status 0: body is a columnar table, preceded by u32 total |
+  //                     u32 reserved for kQueryCatalog and by u64 version
+  //                     for kSyncUserCollection
+  //           status 1: body is string code | string message
+  class BulkStoreApi
+  {
+  public:
+    static constexpr char kChannelName[] = "dev.flutter.windows_store.bulk";
+
+    enum BulkOpcode : uint8_t
+    {
+      // u32 kind count | kind count x string | u64 ProductField mask |
+      // extended fields (see ReadJsonFields and extended_json.h)
+      kGetAssociatedStoreProducts = 1,
+      // u64 LicenseField mask | extended fields
+      kGetAppLicense = 2,
+      // u32 kind count | kind count x string | u8 ownership | u8 has min |
+      // u8 has max | f64 min price | f64 max price | string keyword |
+      // u32 offset | u32 limit | u64 ProductField mask
+      kQueryCatalog = 3,
+      // u8 BatchQuery | u32 id count | id count x string | u32 max parallel |
+      // u32 stream id (0 to not stream items as events)
+      kRunBatchQuery = 4,
+      // string Store ID | u64 ProductField mask | extended fields
+      kGetStoreProduct = 5,
+      // u32 id count | id count x string | string ImagePurposeTag (empty for
+      // all images)
+      kGetProductImages = 6,
+      // u32 kind count | kind count x string | u64 ProductField mask |
+      // u32 stream id of the delta event
+      kSyncUserCollection = 7,
+    };
+
+    BulkStoreApi(const BulkStoreApi &) = delete;
+    BulkStoreApi &operator=(const BulkStoreApi &) = delete;
+    virtual ~BulkStoreApi() {}
+
+    // Only the fields in |field_mask| need to be filled in. Its
+    // kExtendedJsonData bit is set when extended fields were requested.
+    virtual void GetAssociatedStoreProductsAsync(
+        const std::vector<std::string> &product_kinds,
+        uint64_t field_mask,
+        std::function<void(ErrorOr<std::vector<StoreProductRecord>> reply)> result) = 0;
+    // A full license is shared with the plugin's license cache, so answering
+    // from the cache does not copy it. Narrower ones are trimmed copies.
+    virtual void GetAppLicenseFieldsAsync(
+        uint64_t field_mask,
+        std::function<void(ErrorOr<std::shared_ptr<const LicenseSnapshot>> reply)> result) = 0;
+    virtual void QueryCatalogAsync(
+        const CatalogQuery &query,
+        std::function<void(ErrorOr<CatalogPage> reply)> result) = 0;
+    // Results are in the order of |store_ids|; failed items carry their own
+    // error instead of failing the whole batch.
+    virtual void RunBatchQueryAsync(
+        BatchQuery query,
+        const std::vector<std::string> &store_ids,
+        uint32_t max_parallel,
+        uint32_t stream_id,
+        std::function<void(ErrorOr<std::vector<BatchItemResult>> reply)> result) = 0;
+    // Replies the product as a single row, or no row if the Store has no
+    // product |store_id|. Lookups made close together may be answered by a
+    // single Store call.
+    virtual void GetStoreProductAsync(
+        const std::string &store_id,
+        uint64_t field_mask,
+        std::function<void(ErrorOr<std::vector<StoreProductRecord>> reply)> result) = 0;
+    // Caches the images of the products |store_ids| with |purpose_tag|, or
+    // all of them if it is empty, and replies a row per image, in the order
+    // of |store_ids|. Images that failed to download carry their own error.
+    virtual void GetProductImagesAsync(
+        const std::vector<std::string> &store_ids,
+        const std::string &purpose_tag,
+        std::function<void(ErrorOr<std::vector<ProductImageResult>> reply)> result) = 0;
+    // Replies the local copy of the user's collection of |product_kinds|
+    // right away, then syncs it with the Store in the background and sends
+    // the changes from that copy as a kCollectionDelta event with
+    // |stream_id|. Products always carry their Store ID.
+    virtual void SyncUserCollectionAsync(
+        const std::vector<std::string> &product_kinds,
+        uint64_t field_mask,
+        uint32_t stream_id,
+        std::function<void(ErrorOr<std::shared_ptr<const UserCollection>> reply)> result) = 0;
+
+    // Sets up an instance of `BulkStoreApi` to handle messages through the
+    // `binary_messenger`.
+    static void SetUp(flutter::BinaryMessenger *binary_messenger, BulkStoreApi *api);
+
+  protected:
+    BulkStoreApi() = default;
+
+  private:
+    static constexpr size_t kMaxIdleRequests = 16;
+
+    // State of a request from its arrival to its reply. Pooled, so a
+    // steady-state request allocates neither its context nor the buffers
+    // its reply is built in, and its completion handler only captures a
+    // pointer, which std::function stores without allocating.
+    struct Request
+    {
+      flutter::BinaryReply reply;
+      uint64_t field_mask = 0;
+      BatchQuery batch_query = BatchQuery::kConsumableBalance;
+      std::optional<JsonExtractor> extended_fields;
+      ColumnarWriter table{0};
+      ByteWriter writer;
+    };
+
+    // Sends the reply written to |request|->writer and gives |request| back.
+    void Reply(Request *request);
+    void ReplyError(Request *request, const FlutterError &error);
+    template <typename Encode>
+    void ReplyTable(Request *request, Encode encode);
+
+    // A base class member, so it outlives the worker threads of the
+    // implementation that complete requests.
+    RequestPool<Request> requests_{kMaxIdleRequests};
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_BULK_CHANNEL_H_
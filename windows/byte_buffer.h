@@ -0,0 +1,153 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_BYTE_BUFFER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_BYTE_BUFFER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace windows_store
+{
+
+  // Appends little-endian scalars and length-prefixed strings to a growable
+  // byte buffer. Used by every hand-rolled binary format in the plugin.
+  class ByteWriter
+  {
+  public:
+    ByteWriter() {}
+    explicit ByteWriter(size_t reserve) { bytes_.reserve(reserve); }
+
+    void WriteU8(uint8_t value) { bytes_.push_back(value); }
+    void WriteU16(uint16_t value) { WriteRaw(&value, sizeof(value)); }
+    void WriteU32(uint32_t value) { WriteRaw(&value, sizeof(value)); }
+    void WriteI32(int32_t value) { WriteRaw(&value, sizeof(value)); }
+    void WriteU64(uint64_t value) { WriteRaw(&value, sizeof(value)); }
+    void WriteI64(int64_t value) { WriteRaw(&value, sizeof(value)); }
+    void WriteF64(double value) { WriteRaw(&value, sizeof(value)); }
+
+    // Writes a u32 byte length followed by the UTF-8 bytes.
+    void WriteString(std::string_view value)
+    {
+      WriteU32(static_cast<uint32_t>(value.size()));
+      WriteRaw(value.data(), value.size());
+    }
+
+    void WriteRaw(const void *data, size_t size)
+    {
+      const uint8_t *begin = static_cast<const uint8_t *>(data);
+      bytes_.insert(bytes_.end(), begin, begin + size);
+    }
+
+    // Pads with zero bytes until the size is a multiple of |alignment|.
+    void Align(size_t alignment)
+    {
+      while (bytes_.size() % alignment != 0)
+      {
+        bytes_.push_back(0);
+      }
+    }
+
+    // Overwrites a u32 previously written at |position|.
+    void PatchU32(size_t position, uint32_t value)
+    {
+      std::memcpy(bytes_.data() + position, &value, sizeof(value));
+    }
+
+    // Empties the buffer but keeps its capacity for reuse.
+    void Clear() { bytes_.clear(); }
+
+    size_t size() const { return bytes_.size(); }
+    const uint8_t *data() const { return bytes_.data(); }
+    std::vector<uint8_t> &bytes() { return bytes_; }
+    std::vector<uint8_t> TakeBytes() { return std::move(bytes_); }
+
+  private:
+    std::vector<uint8_t> bytes_;
+  };
+
+  // Reads the format produced by ByteWriter. Every read is bounds checked;
+  // once a read runs past the end, ok() turns false and all further reads
+  // return zero values.
+  class ByteReader
+  {
+  public:
+    ByteReader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+    uint8_t ReadU8() { return ReadScalar<uint8_t>(); }
+    uint16_t ReadU16() { return ReadScalar<uint16_t>(); }
+    uint32_t ReadU32() { return ReadScalar<uint32_t>(); }
+    int32_t ReadI32() { return ReadScalar<int32_t>(); }
+    uint64_t ReadU64() { return ReadScalar<uint64_t>(); }
+    int64_t ReadI64() { return ReadScalar<int64_t>(); }
+    double ReadF64() { return ReadScalar<double>(); }
+
+    std::string ReadString()
+    {
+      uint32_t length = ReadU32();
+      if (!Require(length))
+      {
+        return std::string();
+      }
+      std::string value(reinterpret_cast<const char *>(data_ + position_), length);
+      position_ += length;
+      return value;
+    }
+
+    bool ReadRaw(void *out, size_t size)
+    {
+      if (!Require(size))
+      {
+        return false;
+      }
+      std::memcpy(out, data_ + position_, size);
+      position_ += size;
+      return true;
+    }
+
+    bool Skip(size_t size)
+    {
+      if (!Require(size))
+      {
+        return false;
+      }
+      position_ += size;
+      return true;
+    }
+
+    // Marks the input as malformed, e.g. when a decoded count is implausible.
+    void Invalidate() { ok_ = false; }
+
+    bool ok() const { return ok_; }
+    bool AtEnd() const { return position_ == size_; }
+    size_t position() const { return position_; }
+    size_t remaining() const { return size_ - position_; }
+
+  private:
+    template <typename T>
+    T ReadScalar()
+    {
+      T value{};
+      ReadRaw(&value, sizeof(T));
+      return value;
+    }
+
+    bool Require(size_t size)
+    {
+      if (!ok_ || size > size_ - position_)
+      {
+        ok_ = false;
+        return false;
+      }
+      return true;
+    }
+
+    const uint8_t *data_;
+    size_t size_;
+    size_t position_ = 0;
+    bool ok_ = true;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_BYTE_BUFFER_H_
@@ -0,0 +1,389 @@
+#include "catalog_index.h"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    bool IsWordByte(unsigned char c)
+    {
+      return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+    }
+
+    // ISO 4217 currencies with three minor unit digits.
+    constexpr const char *kThreeDecimalCurrencies[] = {"BHD", "IQD", "JOD", "KWD", "LYD", "OMR", "TND"};
+
+    bool StartsWith(const std::string &value, const std::string &prefix)
+    {
+      return value.compare(0, prefix.size(), prefix) == 0;
+    }
+
+  } // namespace
+
+  void CatalogIndex::Update(const std::vector<std::string> &product_kinds,
+                            const std::vector<StoreProductRecord> &products)
+  {
+    std::unique_lock lock(mutex_);
+    std::unordered_set<std::string> kinds(product_kinds.begin(), product_kinds.end());
+    std::vector<bool> seen(entries_.size());
+    bool changed = false;
+
+    for (const StoreProductRecord &product : products)
+    {
+      auto it = slots_.find(product.store_id);
+      if (it != slots_.end())
+      {
+        seen[it->second] = true;
+        if (entries_[it->second].record == product)
+        {
+          continue;
+        }
+        Remove(it->second);
+      }
+
+      uint32_t slot;
+      if (!free_slots_.empty())
+      {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      }
+      else
+      {
+        slot = static_cast<uint32_t>(entries_.size());
+        entries_.emplace_back();
+        keys_.emplace_back();
+        seen.push_back(false);
+      }
+      Entry &entry = entries_[slot];
+      entry.record = product;
+      entry.words = Words(product.title);
+      Key &key = keys_[slot];
+      key.price = ParsePrice(product.formatted_price, product.currency_code);
+      auto kind = kind_ids_.emplace(product.product_kind, static_cast<uint32_t>(kinds_.size()));
+      if (kind.second)
+      {
+        kinds_.push_back(product.product_kind);
+      }
+      key.kind = kind.first->second;
+      key.owned = product.is_in_user_collection;
+      Insert(slot);
+      seen[slot] = true;
+      changed = true;
+    }
+
+    // Products of the updated kinds that are no longer associated.
+    for (uint32_t slot = 0; slot < keys_.size(); slot++)
+    {
+      if (keys_[slot].live && !seen[slot] && kinds.count(kinds_[keys_[slot].kind]) != 0)
+      {
+        Remove(slot);
+        changed = true;
+      }
+    }
+    if (changed)
+    {
+      SortByPrice();
+    }
+
+    for (const std::string &kind : kinds)
+    {
+      loaded_kinds_[kind] = true;
+    }
+  }
+
+  void CatalogIndex::Invalidate()
+  {
+    std::unique_lock lock(mutex_);
+    for (auto &[kind, fresh] : loaded_kinds_)
+    {
+      fresh = false;
+    }
+  }
+
+  std::vector<std::string> CatalogIndex::StaleKinds(const std::vector<std::string> &product_kinds) const
+  {
+    std::shared_lock lock(mutex_);
+    std::vector<std::string> stale;
+    for (const std::string &kind : product_kinds)
+    {
+      auto it = loaded_kinds_.find(kind);
+      if (it == loaded_kinds_.end() || !it->second)
+      {
+        stale.push_back(kind);
+      }
+    }
+    return stale;
+  }
+
+  CatalogPage CatalogIndex::Query(const CatalogQuery &query) const
+  {
+    std::shared_lock lock(mutex_);
+    std::vector<std::string> words = Words(query.keyword);
+    std::vector<bool> kinds;
+    if (!query.product_kinds.empty())
+    {
+      kinds.resize(kinds_.size());
+      for (const std::string &kind : query.product_kinds)
+      {
+        auto it = kind_ids_.find(kind);
+        if (it != kind_ids_.end())
+        {
+          kinds[it->second] = true;
+        }
+      }
+    }
+
+    CatalogPage page;
+    uint64_t end = static_cast<uint64_t>(query.offset) + query.limit;
+    auto collect = [this, &page, &query, end](uint32_t slot)
+    {
+      if (page.total >= query.offset && page.total < end)
+      {
+        page.products.push_back(entries_[slot].record);
+      }
+      page.total++;
+    };
+
+    if (words.empty())
+    {
+      // The slots in price order are already in result order, and the
+      // price range is a contiguous part of them.
+      auto first = by_price_.begin();
+      auto last = by_price_.end();
+      if (query.min_price)
+      {
+        first = std::lower_bound(first, last, *query.min_price, [this](uint32_t slot, double price)
+                                 { return keys_[slot].price < price; });
+      }
+      if (query.max_price)
+      {
+        last = std::upper_bound(first, last, *query.max_price, [this](double price, uint32_t slot)
+                                { return price < keys_[slot].price; });
+      }
+      if (kinds.empty() && query.ownership == CatalogQuery::Ownership::kAny)
+      {
+        // Every slot in the range matches; only the page is visited.
+        size_t count = static_cast<size_t>(last - first);
+        for (size_t i = query.offset; i < count && i < end; i++)
+        {
+          page.products.push_back(entries_[first[i]].record);
+        }
+        page.total = static_cast<uint32_t>(count);
+        return page;
+      }
+      for (auto it = first; it != last; ++it)
+      {
+        if (Matches(*it, query, kinds, words))
+        {
+          collect(*it);
+        }
+      }
+      return page;
+    }
+
+    // The longest word is the most selective one; the others are checked
+    // per candidate.
+    auto longest = std::max_element(words.begin(), words.end(),
+                                    [](const std::string &a, const std::string &b)
+                                    { return a.size() < b.size(); });
+    std::vector<uint32_t> candidates = PrefixPostings(*longest);
+    words.erase(longest);
+    std::vector<uint32_t> matches;
+    for (uint32_t slot : candidates)
+    {
+      if (Matches(slot, query, kinds, words))
+      {
+        matches.push_back(price_rank_[slot]);
+      }
+    }
+    std::sort(matches.begin(), matches.end());
+    for (uint32_t rank : matches)
+    {
+      collect(by_price_[rank]);
+    }
+    return page;
+  }
+
+  // static
+  double CatalogIndex::ParsePrice(const std::string &formatted_price, const std::string &currency_code)
+  {
+    std::string number;
+    for (char c : formatted_price)
+    {
+      if ((c >= '0' && c <= '9') || ((c == '.' || c == ',') && !number.empty()))
+      {
+        number.push_back(c);
+      }
+    }
+    while (!number.empty() && (number.back() == '.' || number.back() == ','))
+    {
+      number.pop_back();
+    }
+
+    // The last separator is the decimal one unless exactly three digits
+    // follow it, in which case it groups thousands ("1,299"), except in
+    // currencies with three decimals.
+    size_t decimal = number.find_last_of(".,");
+    bool three_decimals = std::find(std::begin(kThreeDecimalCurrencies), std::end(kThreeDecimalCurrencies),
+                                    currency_code) != std::end(kThreeDecimalCurrencies);
+    if (decimal != std::string::npos && number.size() - decimal - 1 == 3 && !three_decimals)
+    {
+      decimal = std::string::npos;
+    }
+
+    double value = 0;
+    double scale = 0;
+    for (size_t i = 0; i < number.size(); i++)
+    {
+      char c = number[i];
+      if (i == decimal)
+      {
+        scale = 1;
+      }
+      else if (c >= '0' && c <= '9')
+      {
+        if (scale == 0)
+        {
+          value = value * 10 + (c - '0');
+        }
+        else
+        {
+          scale /= 10;
+          value += (c - '0') * scale;
+        }
+      }
+    }
+    return value;
+  }
+
+  // static
+  std::vector<std::string> CatalogIndex::Words(const std::string &text)
+  {
+    std::vector<std::string> words;
+    std::string word;
+    for (char c : text)
+    {
+      unsigned char byte = static_cast<unsigned char>(c);
+      if (IsWordByte(byte))
+      {
+        word.push_back(byte >= 'A' && byte <= 'Z' ? static_cast<char>(byte - 'A' + 'a') : c);
+      }
+      else if (!word.empty())
+      {
+        words.push_back(std::move(word));
+        word.clear();
+      }
+    }
+    if (!word.empty())
+    {
+      words.push_back(std::move(word));
+    }
+    return words;
+  }
+
+  void CatalogIndex::Insert(uint32_t slot)
+  {
+    Entry &entry = entries_[slot];
+    keys_[slot].live = true;
+    slots_[entry.record.store_id] = slot;
+    for (const std::string &word : entry.words)
+    {
+      word_postings_[word].push_back(slot);
+    }
+  }
+
+  void CatalogIndex::Remove(uint32_t slot)
+  {
+    Entry &entry = entries_[slot];
+    if (!keys_[slot].live)
+    {
+      return;
+    }
+    slots_.erase(entry.record.store_id);
+    for (const std::string &word : entry.words)
+    {
+      auto postings = word_postings_.find(word);
+      if (postings == word_postings_.end())
+      {
+        continue;
+      }
+      std::vector<uint32_t> &slots = postings->second;
+      slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+      if (slots.empty())
+      {
+        word_postings_.erase(postings);
+      }
+    }
+    entry = Entry();
+    keys_[slot] = Key();
+    free_slots_.push_back(slot);
+  }
+
+  void CatalogIndex::SortByPrice()
+  {
+    by_price_.clear();
+    for (uint32_t slot = 0; slot < keys_.size(); slot++)
+    {
+      if (keys_[slot].live)
+      {
+        by_price_.push_back(slot);
+      }
+    }
+    std::sort(by_price_.begin(), by_price_.end(), [this](uint32_t a, uint32_t b)
+              { return keys_[a].price < keys_[b].price || (keys_[a].price == keys_[b].price && a < b); });
+    price_rank_.assign(keys_.size(), 0);
+    for (uint32_t rank = 0; rank < by_price_.size(); rank++)
+    {
+      price_rank_[by_price_[rank]] = rank;
+    }
+  }
+
+  std::vector<uint32_t> CatalogIndex::PrefixPostings(const std::string &prefix) const
+  {
+    std::vector<uint32_t> slots;
+    for (auto it = word_postings_.lower_bound(prefix);
+         it != word_postings_.end() && StartsWith(it->first, prefix); ++it)
+    {
+      slots.insert(slots.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    return slots;
+  }
+
+  bool CatalogIndex::Matches(uint32_t slot, const CatalogQuery &query, const std::vector<bool> &kinds,
+                             const std::vector<std::string> &words) const
+  {
+    const Key &key = keys_[slot];
+    if (!kinds.empty() && !kinds[key.kind])
+    {
+      return false;
+    }
+    if ((query.min_price && key.price < *query.min_price) ||
+        (query.max_price && key.price > *query.max_price))
+    {
+      return false;
+    }
+    if ((query.ownership == CatalogQuery::Ownership::kOwned && !key.owned) ||
+        (query.ownership == CatalogQuery::Ownership::kNotOwned && key.owned))
+    {
+      return false;
+    }
+    const std::vector<std::string> &title_words = entries_[slot].words;
+    for (const std::string &word : words)
+    {
+      if (std::none_of(title_words.begin(), title_words.end(), [&word](const std::string &title_word)
+                       { return StartsWith(title_word, word); }))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace windows_store
@@ -0,0 +1,138 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_CATALOG_INDEX_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_CATALOG_INDEX_H_
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  // Filter and page of a catalog query. Empty |product_kinds| and |keyword|
+  // match everything.
+  struct CatalogQuery
+  {
+    enum class Ownership : uint8_t
+    {
+      kAny = 0,
+      kOwned = 1,
+      kNotOwned = 2,
+    };
+
+    std::vector<std::string> product_kinds;
+    std::optional<double> min_price;
+    std::optional<double> max_price;
+    Ownership ownership = Ownership::kAny;
+    // Every word of |keyword| must be a prefix of a word of the title.
+    std::string keyword;
+    uint32_t offset = 0;
+    // Most products to return. 0 returns none, which only counts the
+    // matches; the Dart side defaults to 50.
+    uint32_t limit = 0;
+  };
+
+  struct CatalogPage
+  {
+    // Number of products matching the query, regardless of paging.
+    uint32_t total = 0;
+    std::vector<StoreProductRecord> products;
+  };
+
+  // In-memory index of the associated Store products, so filtering and
+  // searching the catalog does not transfer it to Dart. Products are kept in
+  // slots. The values filters test are kept per slot apart from the records,
+  // together with the slots in price order, so queries scan them
+  // sequentially. A sorted word index over titles serves prefix search.
+  // Results are ordered by price.
+  class CatalogIndex
+  {
+  public:
+    // Fields that must be present in products passed to Update.
+    static constexpr uint64_t kIndexedFields = ProductFieldBit(ProductField::kStoreId) |
+                                               ProductFieldBit(ProductField::kProductKind) |
+                                               ProductFieldBit(ProductField::kTitle) |
+                                               ProductFieldBit(ProductField::kFormattedPrice) |
+                                               ProductFieldBit(ProductField::kIsInUserCollection);
+
+    CatalogIndex() {}
+
+    // Makes |products| the current content for |product_kinds|. Only
+    // products that were added, removed or changed touch the postings.
+    void Update(const std::vector<std::string> &product_kinds, const std::vector<StoreProductRecord> &products);
+
+    // Marks every kind stale, e.g. after the Store reported that licenses
+    // changed. Stale kinds keep answering queries until the next Update.
+    void Invalidate();
+
+    // Returns the kinds among |product_kinds| that were never loaded or are
+    // stale.
+    std::vector<std::string> StaleKinds(const std::vector<std::string> &product_kinds) const;
+
+    CatalogPage Query(const CatalogQuery &query) const;
+
+    // Best effort parse of a localized formatted price such as "$1,299.99"
+    // or "1.299,99 €". Prices without digits ("Free") are 0. Three digits
+    // after the last separator group thousands ("$12.000" is 12000) unless
+    // |currency_code| has three decimals, e.g. "KWD".
+    static double ParsePrice(const std::string &formatted_price, const std::string &currency_code = "");
+
+    // Lower-cased words of |text|. Non-ASCII bytes are kept as word
+    // characters.
+    static std::vector<std::string> Words(const std::string &text);
+
+  private:
+    struct Entry
+    {
+      StoreProductRecord record;
+      std::vector<std::string> words;
+    };
+
+    // What the filters other than the keyword test, per slot.
+    struct Key
+    {
+      double price = 0;
+      uint32_t kind = 0;
+      bool owned = false;
+      bool live = false;
+    };
+
+    void Insert(uint32_t slot);
+    void Remove(uint32_t slot);
+
+    // Rebuilds |by_price_| and |price_rank_| after slots changed.
+    void SortByPrice();
+
+    // Slots whose title has a word starting with |prefix|, sorted.
+    std::vector<uint32_t> PrefixPostings(const std::string &prefix) const;
+
+    bool Matches(uint32_t slot, const CatalogQuery &query, const std::vector<bool> &kinds,
+                 const std::vector<std::string> &words) const;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Entry> entries_;
+    std::vector<Key> keys_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_map<std::string, uint32_t> slots_;
+    // Product kinds by Key::kind.
+    std::vector<std::string> kinds_;
+    std::unordered_map<std::string, uint32_t> kind_ids_;
+    // Live slots ordered by price, then slot, and the position of each slot
+    // in that order.
+    std::vector<uint32_t> by_price_;
+    std::vector<uint32_t> price_rank_;
+    // Slots by title word, unordered.
+    std::map<std::string, std::vector<uint32_t>> word_postings_;
+    std::unordered_map<std::string, bool> loaded_kinds_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_CATALOG_INDEX_H_
@@ -0,0 +1,225 @@
+#include "collection_sync.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "atomic_file.h"
+#include "byte_buffer.h"
+#include "sha256.h"
+#include "store_serialization.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr char kTempExtension[] = ".tmp";
+    constexpr size_t kHeaderSize = 12 + sizeof(Sha256::Digest);
+
+    bool ByStoreId(const StoreProductRecord &a, const StoreProductRecord &b)
+    {
+      return a.store_id < b.store_id;
+    }
+
+    Sha256::Digest DigestOf(const uint8_t *data, size_t size)
+    {
+      Sha256 hasher;
+      hasher.Update(data, size);
+      return hasher.Finish();
+    }
+
+  } // namespace
+
+  CollectionDelta ComputeCollectionDelta(const std::vector<StoreProductRecord> &from,
+                                         const std::vector<StoreProductRecord> &to)
+  {
+    CollectionDelta delta;
+    auto old_it = from.begin();
+    auto new_it = to.begin();
+    while (old_it != from.end() || new_it != to.end())
+    {
+      if (new_it == to.end() || (old_it != from.end() && old_it->store_id < new_it->store_id))
+      {
+        delta.removed.push_back(old_it->store_id);
+        ++old_it;
+      }
+      else if (old_it == from.end() || new_it->store_id < old_it->store_id)
+      {
+        delta.changed.push_back(*new_it);
+        ++new_it;
+      }
+      else
+      {
+        if (*old_it != *new_it)
+        {
+          delta.changed.push_back(*new_it);
+        }
+        ++old_it;
+        ++new_it;
+      }
+    }
+    return delta;
+  }
+
+  CollectionSync::CollectionSync(std::filesystem::path directory) : directory_(std::move(directory)) {}
+
+  std::shared_ptr<const UserCollection> CollectionSync::Local(const std::vector<std::string> &product_kinds,
+                                                              uint64_t field_mask)
+  {
+    EnsureLoaded();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (collection_->product_kinds == product_kinds && collection_->field_mask == field_mask)
+      {
+        return collection_;
+      }
+    }
+    auto empty = std::make_shared<UserCollection>();
+    empty->product_kinds = product_kinds;
+    empty->field_mask = field_mask;
+    return empty;
+  }
+
+  std::shared_ptr<const UserCollection> CollectionSync::Update(const std::vector<std::string> &product_kinds,
+                                                               uint64_t field_mask,
+                                                               std::vector<StoreProductRecord> products)
+  {
+    EnsureLoaded();
+    std::stable_sort(products.begin(), products.end(), ByStoreId);
+    products.erase(std::unique(products.begin(), products.end(), [](const StoreProductRecord &a, const StoreProductRecord &b)
+                               { return a.store_id == b.store_id; }),
+                   products.end());
+    auto updated = std::make_shared<UserCollection>();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (collection_->product_kinds == product_kinds && collection_->field_mask == field_mask &&
+          collection_->products == products)
+      {
+        return collection_;
+      }
+      updated->version = collection_->version + 1;
+      updated->product_kinds = product_kinds;
+      updated->field_mask = field_mask;
+      updated->products = std::move(products);
+      collection_ = updated;
+    }
+    Save();
+    return updated;
+  }
+
+  // static
+  bool CollectionSync::Read(const std::filesystem::path &path, UserCollection &collection)
+  {
+    std::vector<uint8_t> bytes = ReadFileBytes(path);
+    ByteReader header(bytes.data(), bytes.size());
+    if (header.ReadU32() != kMagic || header.ReadU16() != kFormatVersion)
+    {
+      return false;
+    }
+    header.ReadU16();
+    uint32_t body_size = header.ReadU32();
+    Sha256::Digest digest{};
+    if (!header.ReadRaw(digest.data(), digest.size()) || header.remaining() != body_size)
+    {
+      return false;
+    }
+    const uint8_t *body = bytes.data() + kHeaderSize;
+    if (DigestOf(body, body_size) != digest)
+    {
+      return false;
+    }
+
+    ByteReader reader(body, body_size);
+    UserCollection read;
+    read.version = reader.ReadU64();
+    read.field_mask = reader.ReadU64();
+    read.product_kinds = ReadStringList(reader);
+    read.products = ReadStoreProductRecords(reader);
+    if (!reader.ok() || !reader.AtEnd() ||
+        std::adjacent_find(read.products.begin(), read.products.end(), [](const StoreProductRecord &a, const StoreProductRecord &b)
+                           { return !(a.store_id < b.store_id); }) != read.products.end())
+    {
+      return false;
+    }
+    collection = std::move(read);
+    return true;
+  }
+
+  // static
+  bool CollectionSync::Write(const std::filesystem::path &path, const UserCollection &collection)
+  {
+    ByteWriter body;
+    body.WriteU64(collection.version);
+    body.WriteU64(collection.field_mask);
+    WriteStringList(body, collection.product_kinds);
+    WriteStoreProductRecords(body, collection.products);
+    Sha256::Digest digest = DigestOf(body.data(), body.size());
+
+    ByteWriter file(kHeaderSize + body.size());
+    file.WriteU32(kMagic);
+    file.WriteU16(kFormatVersion);
+    file.WriteU16(0);
+    file.WriteU32(static_cast<uint32_t>(body.size()));
+    file.WriteRaw(digest.data(), digest.size());
+    file.WriteRaw(body.data(), body.size());
+
+    std::filesystem::path temp_path = path;
+    temp_path += kTempExtension;
+    return WriteFileAtomically(path, temp_path, file.data(), file.size());
+  }
+
+  void CollectionSync::EnsureLoaded()
+  {
+    std::call_once(loaded_, [this]()
+                   {
+      std::error_code error;
+      std::filesystem::create_directories(directory_, error);
+      // Left by a write that was interrupted before its rename.
+      std::filesystem::path temp_path = directory_ / kFileName;
+      temp_path += kTempExtension;
+      std::filesystem::remove(temp_path, error);
+
+      auto collection = std::make_shared<UserCollection>();
+      if (Read(directory_ / kFileName, *collection))
+      {
+        std::lock_guard<std::mutex> file_lock(file_mutex_);
+        saved_version_ = collection->version;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      collection_ = std::move(collection); });
+  }
+
+  void CollectionSync::Save()
+  {
+    std::lock_guard<std::mutex> file_lock(file_mutex_);
+    std::shared_ptr<const UserCollection> collection;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      collection = collection_;
+    }
+    // A concurrent save may have written a later version already.
+    if (collection->version <= saved_version_)
+    {
+      return;
+    }
+    if (Write(directory_ / kFileName, *collection))
+    {
+      saved_version_ = collection->version;
+    }
+  }
+
+  void EncodeCollectionDelta(uint32_t stream_id, int32_t hresult, const std::string &message,
+                             uint64_t from_version, uint64_t version, const CollectionDelta &delta,
+                             uint64_t field_mask, ByteWriter &writer)
+  {
+    writer.WriteU32(stream_id);
+    writer.WriteI32(hresult);
+    writer.WriteU64(from_version);
+    writer.WriteU64(version);
+    writer.WriteString(message);
+    WriteStringList(writer, delta.removed);
+    EncodeStoreProducts(delta.changed, field_mask, writer);
+  }
+
+} // namespace windows_store
@@ -0,0 +1,111 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_COLLECTION_SYNC_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_COLLECTION_SYNC_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  // A copy of the user's collection: the owned products of |product_kinds|
+  // with the fields of |field_mask|, sorted by Store ID. |version| grows
+  // whenever the products change; version 0 is the empty copy a first sync
+  // starts from.
+  struct UserCollection
+  {
+    uint64_t version = 0;
+    std::vector<std::string> product_kinds;
+    uint64_t field_mask = 0;
+    std::vector<StoreProductRecord> products;
+  };
+
+  // Changes between two copies of a collection: products added or changed,
+  // and the Store IDs of products removed, both sorted by Store ID.
+  struct CollectionDelta
+  {
+    std::vector<StoreProductRecord> changed;
+    std::vector<std::string> removed;
+
+    bool empty() const { return changed.empty() && removed.empty(); }
+  };
+
+  // The changes turning |from| into |to|, both sorted by Store ID.
+  CollectionDelta ComputeCollectionDelta(const std::vector<StoreProductRecord> &from,
+                                         const std::vector<StoreProductRecord> &to);
+
+  // Keeps the local copy of the user's collection under |directory|, so an
+  // app can show what the user owns at startup and only transfer what
+  // changed once the Store answers.
+  //
+  // The copy is written through a temporary file renamed into place, and its
+  // body carries a SHA-256, so a sync interrupted by a crash leaves the
+  // previous copy intact, and a damaged file is discarded rather than
+  // trusted; the next sync then starts over from an empty copy. A single
+  // collection is kept: syncing other kinds or fields replaces it.
+  //
+  // File layout, little-endian:
+  //   u32 magic 'WSUC' | u16 format version | u16 reserved | u32 body size |
+  //   32 bytes SHA-256 of the body
+  //   body: u64 version | u64 ProductField mask | u32 kind count |
+  //         kind count x string | products (see WriteStoreProductRecords)
+  class CollectionSync
+  {
+  public:
+    static constexpr char kFileName[] = "collection.wsuc";
+    static constexpr uint32_t kMagic = 0x43555357; // 'WSUC'
+    static constexpr uint16_t kFormatVersion = 1;
+
+    explicit CollectionSync(std::filesystem::path directory);
+
+    CollectionSync(const CollectionSync &) = delete;
+    CollectionSync &operator=(const CollectionSync &) = delete;
+
+    // The local copy if it holds |product_kinds| with |field_mask|, or an
+    // empty copy of version 0. Reads the file on the first call, so it
+    // blocks.
+    std::shared_ptr<const UserCollection> Local(const std::vector<std::string> &product_kinds, uint64_t field_mask);
+
+    // Makes |products|, as fetched from the Store, the local copy and saves
+    // it under a new version, unless the copy already holds them. Returns
+    // the local copy.
+    std::shared_ptr<const UserCollection> Update(const std::vector<std::string> &product_kinds, uint64_t field_mask,
+                                                 std::vector<StoreProductRecord> products);
+
+    // Reads the collection at |path|. Returns false, leaving |collection|
+    // untouched, if the file is missing, of another format version, or
+    // damaged.
+    static bool Read(const std::filesystem::path &path, UserCollection &collection);
+    static bool Write(const std::filesystem::path &path, const UserCollection &collection);
+
+  private:
+    void EnsureLoaded();
+    // Writes the local copy if no later version was written yet.
+    void Save();
+
+    const std::filesystem::path directory_;
+    std::once_flag loaded_;
+    std::mutex mutex_;
+    std::shared_ptr<const UserCollection> collection_;
+    std::mutex file_mutex_;
+    uint64_t saved_version_ = 0;
+  };
+
+  class ByteWriter;
+
+  // Appends a collection delta event body to |writer|: u32 stream id |
+  // i32 hresult | u64 from version | u64 version | string message |
+  // u32 removed count | removed count x string | changed products table
+  // (8-byte aligned), with one column per ProductField in |field_mask|.
+  void EncodeCollectionDelta(uint32_t stream_id, int32_t hresult, const std::string &message,
+                             uint64_t from_version, uint64_t version, const CollectionDelta &delta,
+                             uint64_t field_mask, ByteWriter &writer);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_COLLECTION_SYNC_H_
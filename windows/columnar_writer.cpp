@@ -0,0 +1,184 @@
+#include "columnar_writer.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "byte_buffer.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kMinStringSlots = 16;
+
+  } // namespace
+
+  ColumnarWriter::ColumnarWriter(uint32_t row_count) : row_count_(row_count), string_ends_(1, 0) {}
+
+  void ColumnarWriter::Reset(uint32_t row_count)
+  {
+    row_count_ = row_count;
+    column_count_ = 0;
+    string_data_.clear();
+    string_ends_.resize(1);
+    std::fill(string_slots_.begin(), string_slots_.end(), 0);
+  }
+
+  void ColumnarWriter::BeginColumn(uint16_t field_id, ColumnType type)
+  {
+    if (column_count_ == columns_.size())
+    {
+      columns_.emplace_back();
+    }
+    Column &column = columns_[column_count_++];
+    column.field_id = field_id;
+    column.type = type;
+    size_t width = 8;
+    if (type == ColumnType::kBool)
+    {
+      width = 1;
+    }
+    else if (type == ColumnType::kString)
+    {
+      width = 4;
+    }
+    column.data.clear();
+    column.data.reserve(width * row_count_);
+  }
+
+  void ColumnarWriter::AppendBool(bool value)
+  {
+    uint8_t byte = value ? 1 : 0;
+    AppendRaw(&byte, sizeof(byte));
+  }
+
+  void ColumnarWriter::AppendInt64(int64_t value)
+  {
+    AppendRaw(&value, sizeof(value));
+  }
+
+  void ColumnarWriter::AppendDouble(double value)
+  {
+    AppendRaw(&value, sizeof(value));
+  }
+
+  void ColumnarWriter::AppendString(std::string_view value)
+  {
+    uint32_t index = Intern(value);
+    AppendRaw(&index, sizeof(index));
+  }
+
+  void ColumnarWriter::AppendRaw(const void *value, size_t size)
+  {
+    std::vector<uint8_t> &data = columns_[column_count_ - 1].data;
+    const uint8_t *begin = static_cast<const uint8_t *>(value);
+    data.insert(data.end(), begin, begin + size);
+  }
+
+  uint32_t ColumnarWriter::Intern(std::string_view value)
+  {
+    uint32_t count = static_cast<uint32_t>(string_ends_.size() - 1);
+    // Kept at most half full.
+    if (count * 2 >= string_slots_.size())
+    {
+      string_slots_.assign(std::max(kMinStringSlots, string_slots_.size() * 2), 0);
+      for (uint32_t index = 0; index < count; index++)
+      {
+        InsertStringSlot(index);
+      }
+    }
+    size_t mask = string_slots_.size() - 1;
+    for (size_t slot = std::hash<std::string_view>()(value) & mask;; slot = (slot + 1) & mask)
+    {
+      if (string_slots_[slot] == 0)
+      {
+        string_slots_[slot] = count + 1;
+        string_data_.append(value);
+        string_ends_.push_back(static_cast<uint32_t>(string_data_.size()));
+        return count;
+      }
+      if (StringAt(string_slots_[slot] - 1) == value)
+      {
+        return string_slots_[slot] - 1;
+      }
+    }
+  }
+
+  std::string_view ColumnarWriter::StringAt(uint32_t index) const
+  {
+    return std::string_view(string_data_).substr(string_ends_[index], string_ends_[index + 1] - string_ends_[index]);
+  }
+
+  void ColumnarWriter::InsertStringSlot(uint32_t index)
+  {
+    size_t mask = string_slots_.size() - 1;
+    size_t slot = std::hash<std::string_view>()(StringAt(index)) & mask;
+    while (string_slots_[slot] != 0)
+    {
+      slot = (slot + 1) & mask;
+    }
+    string_slots_[slot] = index + 1;
+  }
+
+  std::vector<uint8_t> ColumnarWriter::Finish()
+  {
+    ByteWriter writer;
+    Finish(writer);
+    return writer.TakeBytes();
+  }
+
+  void ColumnarWriter::Finish(ByteWriter &writer)
+  {
+    writer.Align(8);
+    const size_t base = writer.size();
+    auto position = [&writer, base]()
+    { return static_cast<uint32_t>(writer.size() - base); };
+
+    size_t column_bytes = 0;
+    for (size_t i = 0; i < column_count_; i++)
+    {
+      column_bytes += columns_[i].data.size() + 8;
+    }
+    writer.bytes().reserve(base + kHeaderSize + column_count_ * kColumnDescriptorSize +
+                           column_bytes + string_ends_.size() * 4 + string_data_.size() + 8);
+
+    writer.WriteU32(kMagic);
+    writer.WriteU16(kVersion);
+    writer.WriteU16(static_cast<uint16_t>(column_count_));
+    writer.WriteU32(row_count_);
+    writer.WriteU32(static_cast<uint32_t>(string_ends_.size() - 1));
+    size_t string_offsets_slot = writer.size();
+    writer.WriteU32(0);
+    size_t string_data_slot = writer.size();
+    writer.WriteU32(0);
+    writer.WriteU32(static_cast<uint32_t>(string_data_.size()));
+    writer.WriteU32(0);
+
+    size_t descriptors_slot = writer.size();
+    for (size_t i = 0; i < column_count_; i++)
+    {
+      writer.WriteU16(columns_[i].field_id);
+      writer.WriteU8(static_cast<uint8_t>(columns_[i].type));
+      writer.WriteU8(0);
+      writer.WriteU32(0);
+    }
+
+    for (size_t i = 0; i < column_count_; i++)
+    {
+      writer.Align(8);
+      writer.PatchU32(descriptors_slot + i * kColumnDescriptorSize + 4, position());
+      writer.WriteRaw(columns_[i].data.data(), columns_[i].data.size());
+    }
+
+    writer.Align(8);
+    writer.PatchU32(string_offsets_slot, position());
+    writer.WriteRaw(string_ends_.data(), string_ends_.size() * sizeof(uint32_t));
+
+    writer.PatchU32(string_data_slot, position());
+    writer.WriteRaw(string_data_.data(), string_data_.size());
+    writer.Align(8);
+  }
+
+} // namespace windows_store
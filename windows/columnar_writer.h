@@ -0,0 +1,92 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_COLUMNAR_WRITER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_COLUMNAR_WRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace windows_store
+{
+
+  class ByteWriter;
+
+  // Column value encodings of the columnar wire format. Every column holds
+  // exactly one fixed-width value per row; strings are u32 indexes into the
+  // shared, de-duplicated string table.
+  enum class ColumnType : uint8_t
+  {
+    kBool = 1,   // u8 per row
+    kInt64 = 2,  // i64 per row
+    kDouble = 3, // f64 per row
+    kString = 4, // u32 string table index per row
+  };
+
+  // Builds a columnar table (see lib/src/columnar_table.dart for the reader).
+  //
+  // Layout, all little-endian, every section 8-byte aligned:
+  //   u32 magic 'WSCF' | u16 version | u16 column count
+  //   u32 row count | u32 string count
+  //   u32 string offsets position | u32 string data position
+  //   u32 string data length | u32 reserved
+  //   column count x { u16 field id | u8 type | u8 reserved | u32 position }
+  //   column data
+  //   (string count + 1) x u32 string start offsets
+  //   string data
+  class ColumnarWriter
+  {
+  public:
+    static constexpr uint32_t kMagic = 0x46435357; // 'WSCF'
+    static constexpr uint16_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 32;
+    static constexpr size_t kColumnDescriptorSize = 8;
+
+    explicit ColumnarWriter(uint32_t row_count);
+
+    // Starts a new table of |row_count| rows, keeping the buffers of the
+    // previous one, so a reused writer does not allocate once warm.
+    void Reset(uint32_t row_count);
+
+    // Starts a new column. Exactly |row_count| values must be appended
+    // before the next BeginColumn or Finish.
+    void BeginColumn(uint16_t field_id, ColumnType type);
+    void AppendBool(bool value);
+    void AppendInt64(int64_t value);
+    void AppendDouble(double value);
+    void AppendString(std::string_view value);
+
+    std::vector<uint8_t> Finish();
+
+    // Appends the table to |writer|, 8-byte aligned. Positions inside the
+    // table are relative to its first byte, so callers can put a small
+    // header in front of it.
+    void Finish(ByteWriter &writer);
+
+  private:
+    struct Column
+    {
+      uint16_t field_id;
+      ColumnType type;
+      std::vector<uint8_t> data;
+    };
+
+    uint32_t Intern(std::string_view value);
+    std::string_view StringAt(uint32_t index) const;
+    void InsertStringSlot(uint32_t index);
+    void AppendRaw(const void *value, size_t size);
+
+    uint32_t row_count_;
+    // Only the first |column_count_| columns are in use; the others keep
+    // their buffers for the next table.
+    std::vector<Column> columns_;
+    size_t column_count_ = 0;
+    // Interned strings back to back, and their end offsets after a leading 0.
+    std::string string_data_;
+    std::vector<uint32_t> string_ends_;
+    // Open-addressing index of the strings: string index + 1, 0 if empty.
+    std::vector<uint32_t> string_slots_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_COLUMNAR_WRITER_H_
@@ -0,0 +1,78 @@
+#include "extended_json.h"
+
+namespace windows_store
+{
+
+  void AppendExtendedJsonColumns(const JsonExtractor &extractor, const std::vector<std::string_view> &documents,
+                                 ColumnarWriter &writer)
+  {
+    size_t field_count = extractor.field_count();
+    if (field_count == 0)
+    {
+      return;
+    }
+
+    // Extracted row by row, written column by column.
+    std::vector<std::optional<JsonValue>> rows;
+    rows.reserve(documents.size() * field_count);
+    std::vector<std::optional<JsonValue>> values;
+    for (std::string_view document : documents)
+    {
+      // A malformed document still yields the fields found before the error.
+      extractor.Extract(document, values);
+      for (std::optional<JsonValue> &value : values)
+      {
+        rows.push_back(std::move(value));
+      }
+    }
+
+    writer.BeginColumn(kExtendedPresenceField, ColumnType::kInt64);
+    for (size_t row = 0; row < documents.size(); ++row)
+    {
+      uint64_t present = 0;
+      for (size_t field = 0; field < field_count; ++field)
+      {
+        if (rows[row * field_count + field])
+        {
+          present |= uint64_t{1} << field;
+        }
+      }
+      writer.AppendInt64(static_cast<int64_t>(present));
+    }
+
+    for (size_t field = 0; field < field_count; ++field)
+    {
+      uint16_t field_id = static_cast<uint16_t>(kFirstExtendedField + field);
+      const std::optional<JsonValue> *column = rows.data() + field;
+      switch (extractor.field_type(field))
+      {
+      case JsonFieldType::kString:
+      case JsonFieldType::kRaw:
+        writer.BeginColumn(field_id, ColumnType::kString);
+        for (size_t row = 0; row < documents.size(); ++row)
+        {
+          const std::optional<JsonValue> &value = column[row * field_count];
+          writer.AppendString(value ? std::get<std::string>(*value) : std::string_view());
+        }
+        break;
+      case JsonFieldType::kNumber:
+        writer.BeginColumn(field_id, ColumnType::kDouble);
+        for (size_t row = 0; row < documents.size(); ++row)
+        {
+          const std::optional<JsonValue> &value = column[row * field_count];
+          writer.AppendDouble(value ? std::get<double>(*value) : 0.0);
+        }
+        break;
+      case JsonFieldType::kBool:
+        writer.BeginColumn(field_id, ColumnType::kBool);
+        for (size_t row = 0; row < documents.size(); ++row)
+        {
+          const std::optional<JsonValue> &value = column[row * field_count];
+          writer.AppendBool(value ? std::get<bool>(*value) : false);
+        }
+        break;
+      }
+    }
+  }
+
+} // namespace windows_store
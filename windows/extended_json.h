@@ -0,0 +1,31 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_EXTENDED_JSON_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_EXTENDED_JSON_H_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "columnar_writer.h"
+#include "json_extractor.h"
+
+namespace windows_store
+{
+
+  // Extended fields are values picked out of the ExtendedJsonData of Store
+  // products and licenses, sent as extra columns of the same table so Dart
+  // never decodes the JSON itself. Must match lib/src/bulk_api.dart.
+  //
+  //   kExtendedPresenceField:  i64 bitmask of the extended fields found
+  //   kFirstExtendedField + i: extended field i; string for kString and
+  //                            kRaw, f64 for kNumber, bool for kBool, and
+  //                            the zero value when not found
+  constexpr uint16_t kExtendedPresenceField = 99;
+  constexpr uint16_t kFirstExtendedField = 100;
+
+  // Appends the extended field columns of |extractor|, one row per document.
+  void AppendExtendedJsonColumns(const JsonExtractor &extractor, const std::vector<std::string_view> &documents,
+                                 ColumnarWriter &writer);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_EXTENDED_JSON_H_
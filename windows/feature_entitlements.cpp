@@ -0,0 +1,121 @@
+#include "feature_entitlements.h"
+
+#include <algorithm>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // SKU Store IDs have the form "<product id>/<sku id>". A feature mapped
+    // to the product ID is unlocked by any of its SKUs.
+    void AddSkuIds(const std::string &sku_store_id, std::vector<std::string> &ids)
+    {
+      if (sku_store_id.empty())
+      {
+        return;
+      }
+      ids.push_back(sku_store_id);
+      size_t slash = sku_store_id.find('/');
+      if (slash != std::string::npos)
+      {
+        ids.push_back(sku_store_id.substr(0, slash));
+      }
+    }
+
+  } // namespace
+
+  void FeatureEntitlements::Register(const FeatureMap &features)
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    feature_index_.clear();
+    id_features_.clear();
+    for (const auto &[feature, ids] : features)
+    {
+      auto [it, inserted] = feature_index_.emplace(feature, static_cast<uint32_t>(feature_index_.size()));
+      for (const std::string &id : ids)
+      {
+        id_features_[id].push_back(it->second);
+      }
+    }
+    bits_.assign((feature_index_.size() + 63) / 64, 0);
+    active_ids_.reset();
+  }
+
+  void FeatureEntitlements::Update(const LicenseSnapshot &license)
+  {
+    std::vector<std::string> active_ids = ActiveIds(license);
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      if (active_ids_ == active_ids)
+      {
+        return;
+      }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::fill(bits_.begin(), bits_.end(), 0);
+    for (const std::string &id : active_ids)
+    {
+      auto it = id_features_.find(id);
+      if (it == id_features_.end())
+      {
+        continue;
+      }
+      for (uint32_t index : it->second)
+      {
+        bits_[index / 64] |= uint64_t{1} << (index % 64);
+      }
+    }
+    active_ids_ = std::move(active_ids);
+  }
+
+  void FeatureEntitlements::Invalidate()
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    active_ids_.reset();
+  }
+
+  bool FeatureEntitlements::IsValid() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return active_ids_.has_value();
+  }
+
+  std::optional<bool> FeatureEntitlements::IsEnabled(const std::string &feature) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = feature_index_.find(feature);
+    if (it == feature_index_.end())
+    {
+      return std::nullopt;
+    }
+    return (bits_[it->second / 64] >> (it->second % 64) & 1) != 0;
+  }
+
+  std::vector<std::string> FeatureEntitlements::ActiveIds(const LicenseSnapshot &license)
+  {
+    std::vector<std::string> ids;
+    if (license.is_active)
+    {
+      AddSkuIds(license.sku_store_id, ids);
+    }
+    for (const AddOnLicenseRecord &add_on : license.add_ons)
+    {
+      if (!add_on.is_active)
+      {
+        continue;
+      }
+      AddSkuIds(add_on.sku_store_id, ids);
+      if (!add_on.in_app_offer_token.empty())
+      {
+        ids.push_back(add_on.in_app_offer_token);
+      }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+  }
+
+} // namespace windows_store
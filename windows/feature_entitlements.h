@@ -0,0 +1,61 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_FEATURE_ENTITLEMENTS_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_FEATURE_ENTITLEMENTS_H_
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "license_snapshot.h"
+
+namespace windows_store
+{
+
+  // Precomputed feature entitlements. Dart registers which Store IDs (app
+  // SKU, add-on SKU or product IDs, or in-app offer tokens) unlock each
+  // feature once; the resulting bitset is only recomputed when the set of
+  // active licenses changes, so a feature check is a hash lookup and a bit
+  // test.
+  class FeatureEntitlements
+  {
+  public:
+    using FeatureMap = std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+    FeatureEntitlements() {}
+
+    // Replaces the registered features. Entitlements stay invalid until the
+    // next Update.
+    void Register(const FeatureMap &features);
+
+    // Recomputes the bitset if the active licenses in |license| differ from
+    // the ones it was last computed from.
+    void Update(const LicenseSnapshot &license);
+
+    // Forces the next Update to recompute, e.g. after the Store reported
+    // that licenses changed.
+    void Invalidate();
+
+    // Whether the bitset reflects a license seen since the last Register or
+    // Invalidate.
+    bool IsValid() const;
+
+    // Returns nullopt if |feature| was never registered.
+    std::optional<bool> IsEnabled(const std::string &feature) const;
+
+  private:
+    static std::vector<std::string> ActiveIds(const LicenseSnapshot &license);
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, uint32_t> feature_index_;
+    std::unordered_map<std::string, std::vector<uint32_t>> id_features_;
+    std::vector<uint64_t> bits_;
+    std::optional<std::vector<std::string>> active_ids_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_FEATURE_ENTITLEMENTS_H_
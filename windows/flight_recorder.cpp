@@ -0,0 +1,284 @@
+#include "flight_recorder.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+    constexpr uint64_t kFnvPrime = 0x100000001b3ull;
+
+    uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+    {
+      const uint8_t *bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0; i < size; i++)
+      {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+      }
+      return hash;
+    }
+
+    uint64_t HashU64(uint64_t hash, uint64_t value)
+    {
+      return HashBytes(hash, &value, sizeof(value));
+    }
+
+    // Strings are hashed with their length so lists hash unambiguously.
+    uint64_t HashString(uint64_t hash, std::string_view value)
+    {
+      hash = HashU64(hash, value.size());
+      return HashBytes(hash, value.data(), value.size());
+    }
+
+    int64_t UnixNowUs()
+    {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    template <typename T>
+    uint8_t *WriteScalar(uint8_t *out, T value)
+    {
+      std::memcpy(out, &value, sizeof(value));
+      return out + sizeof(value);
+    }
+
+  } // namespace
+
+  FlightRecorder::FlightRecorder(size_t capacity)
+      : capacity_(capacity > 0 ? capacity : 1), slots_(new Slot[capacity_]) {}
+
+  void FlightRecorder::Record(const FlightRecord &record)
+  {
+    uint64_t sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots_[(sequence - 1) % capacity_];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = record;
+    slot.record.sequence = sequence;
+    slot.sequence.store(sequence, std::memory_order_release);
+  }
+
+  bool FlightRecorder::Read(uint64_t sequence, FlightRecord &record) const
+  {
+    const Slot &slot = slots_[(sequence - 1) % capacity_];
+    if (slot.sequence.load(std::memory_order_acquire) != sequence)
+    {
+      return false;
+    }
+    // May be torn by a writer that lapped the ring; only used if the
+    // sequence number proves it was not.
+    record = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence && record.sequence == sequence;
+  }
+
+  size_t FlightRecorder::Snapshot(std::vector<FlightRecord> &records) const
+  {
+    uint64_t end = next_sequence_.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity_ ? end - capacity_ : 1;
+    size_t count = 0;
+    FlightRecord record;
+    for (uint64_t sequence = begin; sequence < end; sequence++)
+    {
+      if (Read(sequence, record))
+      {
+        records.push_back(record);
+        count++;
+      }
+    }
+    return count;
+  }
+
+  size_t FlightRecorder::DumpTo(uint8_t *buffer) const
+  {
+    // Streamed straight from the ring rather than from a Snapshot, so a dump
+    // from a crash handler does not copy the records to the heap first.
+    uint64_t end = next_sequence_.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity_ ? end - capacity_ : 1;
+
+    uint8_t *out = WriteScalar<uint32_t>(buffer, kMagic);
+    out = WriteScalar<uint16_t>(out, kVersion);
+    out = WriteScalar<uint16_t>(out, static_cast<uint16_t>(sizeof(FlightRecord)));
+    out = WriteScalar<uint32_t>(out, static_cast<uint32_t>(capacity_));
+    uint8_t *count_position = out;
+    out = WriteScalar<uint32_t>(out, 0);
+    out = WriteScalar<uint64_t>(out, end - 1);
+    out = WriteScalar<int64_t>(out, UnixNowUs());
+
+    uint32_t count = 0;
+    FlightRecord record;
+    for (uint64_t sequence = begin; sequence < end; sequence++)
+    {
+      if (Read(sequence, record))
+      {
+        out = WriteScalar(out, record);
+        count++;
+      }
+    }
+    WriteScalar<uint32_t>(count_position, count);
+    return static_cast<size_t>(out - buffer);
+  }
+
+  bool FlightRecorder::Dump(const std::filesystem::path &path) const
+  {
+    std::vector<uint8_t> buffer(MaxDumpSize());
+    size_t size = DumpTo(buffer.data());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+      return false;
+    }
+    file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(size));
+    file.close();
+    return !file.fail();
+  }
+
+  void FlightRecorder::SetText(FlightRecord &record, std::string_view text)
+  {
+    size_t length = text.size() < FlightRecord::kTextCapacity ? text.size() : FlightRecord::kTextCapacity;
+    std::memcpy(record.text, text.data(), length);
+    std::memset(record.text + length, 0, FlightRecord::kTextCapacity - length);
+    record.text_length = static_cast<uint8_t>(length);
+    if (length < text.size())
+    {
+      record.flags = static_cast<uint8_t>(record.flags | FlightRecord::kTextTruncated);
+    }
+  }
+
+  FlightRecordingBackend::FlightRecordingBackend(std::unique_ptr<StoreBackend> inner, FlightRecorder &recorder)
+      : inner_(std::move(inner)), recorder_(recorder) {}
+
+  void FlightRecordingBackend::SetLicensesChangedHandler(std::function<void()> handler)
+  {
+    inner_->SetLicensesChangedHandler(std::move(handler));
+  }
+
+  template <typename T, typename Call, typename Summarize>
+  StoreResult<T> FlightRecordingBackend::Record(StoreApi api, uint64_t arguments_hash, Call call, Summarize summarize)
+  {
+    FlightRecord record{};
+    record.api = static_cast<uint8_t>(api);
+    record.arguments_hash = arguments_hash;
+    record.start_unix_us = UnixNowUs();
+    auto start = std::chrono::steady_clock::now();
+    StoreResult<T> result = call();
+    record.latency_us = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    record.hresult = result.hresult;
+    if (result.ok())
+    {
+      summarize(result.value, record);
+    }
+    else
+    {
+      FlightRecorder::SetText(record, result.message);
+    }
+    recorder_.Record(record);
+    return result;
+  }
+
+  StoreResult<LicenseSnapshot> FlightRecordingBackend::GetAppLicense(uint64_t field_mask)
+  {
+    return Record<LicenseSnapshot>(
+        StoreApi::kGetAppLicense, HashU64(kFnvOffsetBasis, field_mask), [this, field_mask]()
+        { return inner_->GetAppLicense(field_mask); },
+        [](const LicenseSnapshot &license, FlightRecord &record)
+        {
+          record.flags = static_cast<uint8_t>((license.is_active ? FlightRecord::kIsActive : 0) |
+                                              (license.is_trial ? FlightRecord::kIsTrial : 0));
+          record.value = license.trial_time_remaining_ms;
+          record.count = static_cast<uint32_t>(license.add_ons.size());
+          FlightRecorder::SetText(record, license.sku_store_id);
+        });
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> FlightRecordingBackend::GetAssociatedStoreProducts(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    uint64_t hash = HashU64(kFnvOffsetBasis, product_kinds.size());
+    for (const std::string &kind : product_kinds)
+    {
+      hash = HashString(hash, kind);
+    }
+    hash = HashU64(hash, field_mask);
+    return Record<std::vector<StoreProductRecord>>(
+        StoreApi::kGetAssociatedStoreProducts, hash, [this, &product_kinds, field_mask]()
+        { return inner_->GetAssociatedStoreProducts(product_kinds, field_mask); },
+        [](const std::vector<StoreProductRecord> &products, FlightRecord &record)
+        { record.count = static_cast<uint32_t>(products.size()); });
+  }
+
+  StoreResult<ConsumableBalanceRecord> FlightRecordingBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+  {
+    return Record<ConsumableBalanceRecord>(
+        StoreApi::kGetConsumableBalanceRemaining, HashString(kFnvOffsetBasis, store_id), [this, &store_id]()
+        { return inner_->GetConsumableBalanceRemaining(store_id); },
+        [](const ConsumableBalanceRecord &balance, FlightRecord &record)
+        {
+          record.status = balance.status;
+          record.value = balance.balance_remaining;
+          FlightRecorder::SetText(record, balance.tracking_id);
+        });
+  }
+
+  StoreResult<bool> FlightRecordingBackend::IsInUserCollection(const std::string &store_id)
+  {
+    return Record<bool>(
+        StoreApi::kIsInUserCollection, HashString(kFnvOffsetBasis, store_id), [this, &store_id]()
+        { return inner_->IsInUserCollection(store_id); },
+        [&store_id](const bool &owned, FlightRecord &record)
+        {
+          record.flags = static_cast<uint8_t>(owned ? FlightRecord::kResult : 0);
+          FlightRecorder::SetText(record, store_id);
+        });
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> FlightRecordingBackend::GetStoreProducts(
+      const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+      uint64_t field_mask)
+  {
+    uint64_t hash = HashU64(kFnvOffsetBasis, product_kinds.size());
+    for (const std::string &kind : product_kinds)
+    {
+      hash = HashString(hash, kind);
+    }
+    hash = HashU64(hash, store_ids.size());
+    for (const std::string &store_id : store_ids)
+    {
+      hash = HashString(hash, store_id);
+    }
+    hash = HashU64(hash, field_mask);
+    return Record<std::vector<StoreProductRecord>>(
+        StoreApi::kGetStoreProducts, hash, [this, &product_kinds, &store_ids, field_mask]()
+        { return inner_->GetStoreProducts(product_kinds, store_ids, field_mask); },
+        [&store_ids](const std::vector<StoreProductRecord> &products, FlightRecord &record)
+        {
+          record.count = static_cast<uint32_t>(products.size());
+          record.value = static_cast<int64_t>(store_ids.size());
+        });
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> FlightRecordingBackend::GetUserCollection(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    uint64_t hash = HashU64(kFnvOffsetBasis, product_kinds.size());
+    for (const std::string &kind : product_kinds)
+    {
+      hash = HashString(hash, kind);
+    }
+    hash = HashU64(hash, field_mask);
+    return Record<std::vector<StoreProductRecord>>(
+        StoreApi::kGetUserCollection, hash, [this, &product_kinds, field_mask]()
+        { return inner_->GetUserCollection(product_kinds, field_mask); },
+        [](const std::vector<StoreProductRecord> &products, FlightRecord &record)
+        { record.count = static_cast<uint32_t>(products.size()); });
+  }
+
+} // namespace windows_store
@@ -0,0 +1,158 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_FLIGHT_RECORDER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "store_backend.h"
+
+namespace windows_store
+{
+
+  // Summary of one Store call, fixed size so recording never allocates.
+  // Written to dumps as is; must match tool/decode_flight_recorder.dart.
+  struct FlightRecord
+  {
+    static constexpr size_t kTextCapacity = 48;
+
+    enum Flags : uint8_t
+    {
+      kIsActive = 1 << 0,
+      kIsTrial = 1 << 1,
+      // IsInUserCollection result.
+      kResult = 1 << 2,
+      // |text| was cut to kTextCapacity bytes.
+      kTextTruncated = 1 << 3,
+    };
+
+    uint64_t sequence;
+    int64_t start_unix_us;
+    // FNV-1a of the call arguments, to tell calls apart without storing them.
+    uint64_t arguments_hash;
+    // License: trial time remaining in ms. Consumable: balance remaining.
+    // Products by ID: number of IDs asked for.
+    int64_t value;
+    uint32_t latency_us;
+    int32_t hresult;
+    // License: add-on count. Products: product count.
+    uint32_t count;
+    uint8_t api;
+    uint8_t flags;
+    // Consumable: ConsumableBalanceRecord::Status.
+    uint8_t status;
+    uint8_t text_length;
+    // Failed calls: start of the error message. License: SKU Store ID.
+    // Consumable: tracking ID. Collection: Store ID.
+    char text[kTextCapacity];
+  };
+
+  static_assert(sizeof(FlightRecord) == 96, "FlightRecord is part of the dump format");
+
+  // Fixed-size ring buffer of the last Store calls, kept so support can see
+  // what the Store returned when a purchase "did not unlock".
+  //
+  // Recording is lock-free and allocation-free: a writer claims a sequence
+  // number, clears the sequence of its slot, copies the record and then
+  // publishes the sequence. Readers only keep slots whose sequence was the
+  // same before and after copying, so a dump taken at any moment, including
+  // from a crash handler, contains only complete records (unless a writer
+  // stalled for a whole lap of the ring mid-copy).
+  //
+  // Dump layout, little-endian:
+  //   u32 magic 'WSFR' | u16 version | u16 record size
+  //   u32 capacity | u32 record count
+  //   u64 total recorded | i64 dump unix us
+  //   record count x FlightRecord, oldest first
+  class FlightRecorder
+  {
+  public:
+    static constexpr uint32_t kMagic = 0x52465357; // 'WSFR'
+    static constexpr uint16_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 32;
+
+    explicit FlightRecorder(size_t capacity);
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // Appends |record|, overwriting the oldest one once full. Sets its
+    // sequence number.
+    void Record(const FlightRecord &record);
+
+    // Copies the complete records, oldest first, into |records|, which is
+    // not cleared. Returns the number of records copied.
+    size_t Snapshot(std::vector<FlightRecord> &records) const;
+
+    // Writes the records to |path|. Returns false if it cannot be written.
+    bool Dump(const std::filesystem::path &path) const;
+
+    // Size of a dump holding every slot.
+    size_t MaxDumpSize() const { return kHeaderSize + capacity_ * sizeof(FlightRecord); }
+
+    // Writes a dump into |buffer| of MaxDumpSize() bytes and returns its
+    // size. Neither allocates nor locks, for crash handlers.
+    size_t DumpTo(uint8_t *buffer) const;
+
+    // Sets |text| and |text_length| of |record| from |text|.
+    static void SetText(FlightRecord &record, std::string_view text);
+
+  private:
+    struct Slot
+    {
+      std::atomic<uint64_t> sequence{0};
+      FlightRecord record;
+    };
+
+    // Copies the record of |sequence| into |record|, unless its slot was
+    // already overwritten or is being written.
+    bool Read(uint64_t sequence, FlightRecord &record) const;
+
+    const size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> next_sequence_{1};
+  };
+
+  // StoreBackend decorator that records a summary of every call made
+  // through |inner| in |recorder|.
+  class FlightRecordingBackend : public StoreBackend
+  {
+  public:
+    FlightRecordingBackend(std::unique_ptr<StoreBackend> inner, FlightRecorder &recorder);
+    virtual ~FlightRecordingBackend() {}
+
+    bool RequiresPackageIdentity() const override { return inner_->RequiresPackageIdentity(); }
+    void SetLicensesChangedHandler(std::function<void()> handler) override;
+    void WarmUp() override { inner_->WarmUp(); }
+
+    StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+    StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+    StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+    StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+  private:
+    // Times |call| and records it; |summarize| fills in the result summary
+    // of successful calls.
+    template <typename T, typename Call, typename Summarize>
+    StoreResult<T> Record(StoreApi api, uint64_t arguments_hash, Call call, Summarize summarize);
+
+    std::unique_ptr<StoreBackend> inner_;
+    FlightRecorder &recorder_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_FLIGHT_RECORDER_H_
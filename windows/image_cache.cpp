@@ -0,0 +1,407 @@
+#include "image_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+#include "atomic_file.h"
+#include "byte_buffer.h"
+#include "columnar_writer.h"
+#include "sha256.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // E_FAIL, returned when a downloaded image cannot be written.
+    constexpr int32_t kWriteFailedHResult = static_cast<int32_t>(0x80004005);
+
+    constexpr char kObjectsDirectory[] = "objects";
+    constexpr char kTempExtension[] = ".tmp";
+
+    // Promoted after the workers have been busy for this long, as for the
+    // Store calls; all downloads share one priority anyway.
+    constexpr std::chrono::milliseconds kAgingInterval(250);
+
+  } // namespace
+
+  ImageCache::ImageCache(std::filesystem::path directory, std::unique_ptr<ImageDownloader> downloader,
+                         uint64_t max_bytes, size_t max_downloads)
+      : directory_(std::move(directory)),
+        downloader_(std::move(downloader)),
+        max_bytes_(max_bytes),
+        // A WorkQueue keeps a worker free of background work, so it always
+        // has two; say so here rather than rely on it.
+        downloads_(std::max<size_t>(max_downloads, kMinDownloads), kAgingInterval)
+  {
+  }
+
+  ImageCache::~ImageCache()
+  {
+    // Keeps the use order of cache hits since the last download.
+    Save();
+  }
+
+  void ImageCache::Fetch(const std::string &uri, Callback callback)
+  {
+    EnsureLoaded();
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto cached = uris_.find(uri);
+    if (cached != uris_.end())
+    {
+      std::filesystem::path path = ObjectPath(cached->second);
+      std::error_code error;
+      if (std::filesystem::exists(path, error))
+      {
+        objects_[cached->second].last_used = ++use_clock_;
+        sequence_++;
+        lock.unlock();
+        StoreResult<std::string> result;
+        result.value = path.u8string();
+        callback(result);
+        return;
+      }
+      // Deleted behind our back, e.g. by disk cleanup.
+      auto object = objects_.find(cached->second);
+      if (object != objects_.end())
+      {
+        total_bytes_ -= object->second.size;
+        objects_.erase(object);
+      }
+      uris_.erase(cached);
+      sequence_++;
+    }
+
+    auto [waiters, inserted] = in_flight_.try_emplace(uri);
+    waiters->second.push_back(std::move(callback));
+    if (!inserted)
+    {
+      return;
+    }
+    lock.unlock();
+    downloads_.Post(WorkPriority::kInteractive, [this, uri]()
+                    { Download(uri); });
+  }
+
+  void ImageCache::SetMaxBytes(uint64_t max_bytes)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      max_bytes_ = max_bytes;
+    }
+    downloads_.Post(WorkPriority::kInteractive, [this]()
+                    {
+      EnsureLoaded();
+      std::vector<std::filesystem::path> evicted;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evicted = EvictOverflow(std::string());
+      }
+      std::error_code error;
+      for (const std::filesystem::path &path : evicted)
+      {
+        std::filesystem::remove(path, error);
+      }
+      Save(); });
+  }
+
+  void ImageCache::EnsureLoaded()
+  {
+    std::call_once(loaded_, [this]()
+                   { Load(); });
+  }
+
+  void ImageCache::Load()
+  {
+    std::error_code error;
+    std::filesystem::create_directories(directory_ / kObjectsDirectory, error);
+
+    std::vector<uint8_t> bytes = ReadFileBytes(directory_ / kIndexName);
+    ByteReader reader(bytes.data(), bytes.size());
+    std::unordered_map<std::string, Object> objects;
+    std::unordered_map<std::string, std::string> uris;
+    uint64_t use_clock = 0;
+    if (reader.ReadU32() == kIndexMagic && reader.ReadU16() == kIndexVersion)
+    {
+      reader.ReadU16();
+      use_clock = reader.ReadU64();
+      uint32_t object_count = reader.ReadU32();
+      for (uint32_t i = 0; i < object_count && reader.ok(); i++)
+      {
+        std::string hash = reader.ReadString();
+        Object object;
+        object.size = reader.ReadU64();
+        object.last_used = reader.ReadU64();
+        objects.emplace(std::move(hash), object);
+      }
+      uint32_t uri_count = reader.ReadU32();
+      for (uint32_t i = 0; i < uri_count && reader.ok(); i++)
+      {
+        std::string uri = reader.ReadString();
+        uris.emplace(std::move(uri), reader.ReadString());
+      }
+      if (!reader.ok())
+      {
+        objects.clear();
+        uris.clear();
+      }
+    }
+
+    // Objects must have their file, and files their object.
+    bool changed = false;
+    for (auto it = objects.begin(); it != objects.end();)
+    {
+      auto size = std::filesystem::file_size(ObjectPath(it->first), error);
+      if (error || size != it->second.size)
+      {
+        it = objects.erase(it);
+        changed = true;
+        continue;
+      }
+      ++it;
+    }
+    for (auto it = uris.begin(); it != uris.end();)
+    {
+      if (objects.count(it->second) == 0)
+      {
+        it = uris.erase(it);
+        changed = true;
+        continue;
+      }
+      ++it;
+    }
+    std::vector<std::filesystem::path> orphans;
+    for (std::filesystem::directory_iterator entry(directory_ / kObjectsDirectory, error), end;
+         !error && entry != end; entry.increment(error))
+    {
+      if (objects.count(entry->path().filename().u8string()) == 0)
+      {
+        orphans.push_back(entry->path());
+      }
+    }
+    for (const std::filesystem::path &path : orphans)
+    {
+      std::filesystem::remove(path, error);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    objects_ = std::move(objects);
+    uris_ = std::move(uris);
+    use_clock_ = use_clock;
+    total_bytes_ = 0;
+    for (const auto &[hash, object] : objects_)
+    {
+      total_bytes_ += object.size;
+    }
+    if (changed)
+    {
+      sequence_++;
+    }
+  }
+
+  void ImageCache::Download(const std::string &uri)
+  {
+    StoreResult<std::vector<uint8_t>> body = downloader_->Download(uri);
+    StoreResult<std::string> result;
+    std::string hash;
+    if (!body.ok())
+    {
+      result = StoreResult<std::string>::Failure(body.hresult, std::move(body.message));
+    }
+    else
+    {
+      hash = Sha256Hex(body.value.data(), body.value.size());
+      std::filesystem::path path = ObjectPath(hash);
+      std::filesystem::path temp_path = path;
+      temp_path += "." + std::to_string(++temp_counter_) + kTempExtension;
+      std::error_code error;
+      if (std::filesystem::exists(path, error) ||
+          WriteFileAtomically(path, temp_path, body.value.data(), body.value.size()))
+      {
+        result.value = path.u8string();
+      }
+      else
+      {
+        result = StoreResult<std::string>::Failure(kWriteFailedHResult, "Could not write " + path.u8string());
+      }
+    }
+
+    std::vector<Callback> waiters;
+    std::vector<std::filesystem::path> evicted;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = in_flight_.find(uri);
+      if (found != in_flight_.end())
+      {
+        waiters = std::move(found->second);
+        in_flight_.erase(found);
+      }
+      if (result.ok())
+      {
+        auto [object, inserted] = objects_.try_emplace(hash);
+        if (inserted)
+        {
+          object->second.size = body.value.size();
+          total_bytes_ += object->second.size;
+        }
+        object->second.last_used = ++use_clock_;
+        uris_[uri] = hash;
+        sequence_++;
+        evicted = EvictOverflow(hash);
+      }
+    }
+    std::error_code error;
+    for (const std::filesystem::path &path : evicted)
+    {
+      std::filesystem::remove(path, error);
+    }
+    if (result.ok())
+    {
+      Save();
+    }
+    for (const Callback &waiter : waiters)
+    {
+      waiter(result);
+    }
+  }
+
+  std::vector<std::filesystem::path> ImageCache::EvictOverflow(const std::string &keep)
+  {
+    std::vector<std::filesystem::path> evicted;
+    if (total_bytes_ <= max_bytes_)
+    {
+      return evicted;
+    }
+    std::vector<std::pair<uint64_t, const std::string *>> by_use;
+    by_use.reserve(objects_.size());
+    for (const auto &[hash, object] : objects_)
+    {
+      if (hash != keep)
+      {
+        by_use.emplace_back(object.last_used, &hash);
+      }
+    }
+    std::sort(by_use.begin(), by_use.end());
+
+    std::unordered_set<std::string> evicted_hashes;
+    for (const auto &[last_used, hash] : by_use)
+    {
+      if (total_bytes_ <= max_bytes_)
+      {
+        break;
+      }
+      total_bytes_ -= objects_[*hash].size;
+      evicted.push_back(ObjectPath(*hash));
+      evicted_hashes.insert(*hash);
+    }
+    for (const std::string &hash : evicted_hashes)
+    {
+      objects_.erase(hash);
+    }
+    for (auto it = uris_.begin(); it != uris_.end();)
+    {
+      it = evicted_hashes.count(it->second) != 0 ? uris_.erase(it) : std::next(it);
+    }
+    sequence_++;
+    return evicted;
+  }
+
+  void ImageCache::Save()
+  {
+    ByteWriter writer;
+    uint64_t sequence;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sequence = sequence_;
+      writer.WriteU32(kIndexMagic);
+      writer.WriteU16(kIndexVersion);
+      writer.WriteU16(0);
+      writer.WriteU64(use_clock_);
+      writer.WriteU32(static_cast<uint32_t>(objects_.size()));
+      for (const auto &[hash, object] : objects_)
+      {
+        writer.WriteString(hash);
+        writer.WriteU64(object.size);
+        writer.WriteU64(object.last_used);
+      }
+      writer.WriteU32(static_cast<uint32_t>(uris_.size()));
+      for (const auto &[uri, hash] : uris_)
+      {
+        writer.WriteString(uri);
+        writer.WriteString(hash);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    // A concurrent save may have written a later state already.
+    if (sequence <= saved_sequence_)
+    {
+      return;
+    }
+    std::filesystem::path path = directory_ / kIndexName;
+    std::filesystem::path temp_path = path;
+    temp_path += kTempExtension;
+    if (WriteFileAtomically(path, temp_path, writer.data(), writer.size()))
+    {
+      saved_sequence_ = sequence;
+    }
+  }
+
+  std::filesystem::path ImageCache::ObjectPath(const std::string &hash) const
+  {
+    return directory_ / kObjectsDirectory / hash;
+  }
+
+  void EncodeProductImages(const std::vector<ProductImageResult> &results, ByteWriter &out)
+  {
+    ColumnarWriter writer(static_cast<uint32_t>(results.size()));
+    auto begin = [&writer](ProductImageField field, ColumnType type)
+    { writer.BeginColumn(static_cast<uint16_t>(field), type); };
+
+    begin(ProductImageField::kStoreId, ColumnType::kString);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendString(item.store_id);
+    }
+    begin(ProductImageField::kHResult, ColumnType::kInt64);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendInt64(item.hresult);
+    }
+    begin(ProductImageField::kErrorMessage, ColumnType::kString);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendString(item.message);
+    }
+    begin(ProductImageField::kUri, ColumnType::kString);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendString(item.image.uri);
+    }
+    begin(ProductImageField::kPurposeTag, ColumnType::kString);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendString(item.image.purpose_tag);
+    }
+    begin(ProductImageField::kWidth, ColumnType::kInt64);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendInt64(item.image.width);
+    }
+    begin(ProductImageField::kHeight, ColumnType::kInt64);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendInt64(item.image.height);
+    }
+    begin(ProductImageField::kPath, ColumnType::kString);
+    for (const ProductImageResult &item : results)
+    {
+      writer.AppendString(item.path);
+    }
+    writer.Finish(out);
+  }
+
+} // namespace windows_store
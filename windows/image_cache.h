@@ -0,0 +1,152 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_IMAGE_CACHE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_IMAGE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "store_backend.h"
+#include "store_product.h"
+#include "work_queue.h"
+
+namespace windows_store
+{
+
+  // Downloads image files for ImageCache. WinRtImageDownloader uses
+  // HttpClient; other implementations serve tests.
+  class ImageDownloader
+  {
+  public:
+    ImageDownloader(const ImageDownloader &) = delete;
+    ImageDownloader &operator=(const ImageDownloader &) = delete;
+    virtual ~ImageDownloader() {}
+
+    // The body of |uri|. Blocks, and may be called from several threads at
+    // once.
+    virtual StoreResult<std::vector<uint8_t>> Download(const std::string &uri) = 0;
+
+  protected:
+    ImageDownloader() = default;
+  };
+
+  // Content-addressed on-disk cache of Store images, so every product tile
+  // of a storefront does not download its thumbnail itself.
+  //
+  // Files are stored as objects/<SHA-256 of the content> under |directory|,
+  // so URIs serving the same image share one file, and an index file maps
+  // URIs to objects and records when each object was last used. Once the
+  // objects exceed |max_bytes|, the least recently used ones are deleted.
+  // At most |max_downloads|, but no fewer than kMinDownloads, downloads run
+  // at once, and a URI already being downloaded is not downloaded again: its
+  // callers all wait for the same download.
+  //
+  // The index is read on the first fetch, dropping objects whose file is
+  // missing and deleting files that are not in the index, such as those of
+  // an interrupted write.
+  class ImageCache
+  {
+  public:
+    static constexpr uint64_t kDefaultMaxBytes = 64 * 1024 * 1024;
+    static constexpr size_t kDefaultMaxDownloads = 4;
+    static constexpr size_t kMinDownloads = 2;
+    static constexpr char kIndexName[] = "index.wsic";
+    static constexpr uint32_t kIndexMagic = 0x43495357; // 'WSIC'
+    static constexpr uint16_t kIndexVersion = 1;
+
+    // The local path of the image, valid until the image is evicted.
+    using Callback = std::function<void(const StoreResult<std::string> &path)>;
+
+    ImageCache(std::filesystem::path directory, std::unique_ptr<ImageDownloader> downloader,
+               uint64_t max_bytes = kDefaultMaxBytes, size_t max_downloads = kDefaultMaxDownloads);
+    ~ImageCache();
+
+    ImageCache(const ImageCache &) = delete;
+    ImageCache &operator=(const ImageCache &) = delete;
+
+    // Passes the local path of the image at |uri| to |callback|: in place if
+    // it is cached, otherwise on a download thread once it is downloaded.
+    // Reads the index first if needed, so it blocks on the first call.
+    void Fetch(const std::string &uri, Callback callback);
+
+    // Evicts images on a download thread if the cache is over the new limit.
+    void SetMaxBytes(uint64_t max_bytes);
+
+  private:
+    struct Object
+    {
+      uint64_t size = 0;
+      // Value of |use_clock_| when last fetched.
+      uint64_t last_used = 0;
+    };
+
+    void EnsureLoaded();
+    void Load();
+    // Downloads |uri| and answers its waiters.
+    void Download(const std::string &uri);
+    // Evicts least recently used objects other than |keep| until the cache
+    // fits |max_bytes_|, and returns their paths. Requires |mutex_|.
+    std::vector<std::filesystem::path> EvictOverflow(const std::string &keep);
+    // Writes the index if no later state was written yet.
+    void Save();
+    std::filesystem::path ObjectPath(const std::string &hash) const;
+
+    const std::filesystem::path directory_;
+    const std::unique_ptr<ImageDownloader> downloader_;
+    std::once_flag loaded_;
+    std::mutex mutex_;
+    uint64_t max_bytes_;
+    uint64_t total_bytes_ = 0;
+    uint64_t use_clock_ = 0;
+    // By lowercase hex SHA-256.
+    std::unordered_map<std::string, Object> objects_;
+    // URI to SHA-256 of its content.
+    std::unordered_map<std::string, std::string> uris_;
+    std::unordered_map<std::string, std::vector<Callback>> in_flight_;
+    // Bumped on every change; the index file holds |saved_sequence_|.
+    uint64_t sequence_ = 0;
+    std::mutex file_mutex_;
+    uint64_t saved_sequence_ = 0;
+    std::atomic<uint64_t> temp_counter_{0};
+    // Last, so downloads stop before the state they use is destroyed.
+    WorkQueue downloads_;
+  };
+
+  // Field ids of product image result columns. Must match ProductImageField
+  // in lib/src/bulk_api.dart.
+  enum class ProductImageField : uint16_t
+  {
+    kStoreId = 0,
+    kHResult = 1,
+    kErrorMessage = 2,
+    kUri = 3,
+    kPurposeTag = 4,
+    kWidth = 5,
+    kHeight = 6,
+    kPath = 7,
+  };
+
+  // An image of a product and where it is cached. Images that could not be
+  // cached carry a negative |hresult| and |message| and no |path|.
+  struct ProductImageResult
+  {
+    std::string store_id;
+    StoreImageRecord image;
+    int32_t hresult = 0;
+    std::string message;
+    std::string path;
+  };
+
+  class ByteWriter;
+
+  // Appends |results| to |writer| as a columnar table.
+  void EncodeProductImages(const std::vector<ProductImageResult> &results, ByteWriter &writer);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_IMAGE_CACHE_H_
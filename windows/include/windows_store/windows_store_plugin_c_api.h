@@ -13,9 +13,26 @@
 extern "C" {
 #endif
 
+// What the plugin prepares as soon as it registers, on a background thread,
+// so the first Dart call does not pay for it.
+typedef enum {
+  // Nothing; the first Store call starts the Store session.
+  kWindowsStoreWarmUpNone = 0,
+  // Activates the Store session (StoreContext).
+  kWindowsStoreWarmUpSession = 1,
+  // Activates the Store session and prefetches the app license. The first
+  // getAppLicenseAsync waits for the prefetch or returns its result.
+  kWindowsStoreWarmUpLicense = 2,
+} WindowsStoreWarmUpPolicy;
+
 FLUTTER_PLUGIN_EXPORT void WindowsStorePluginCApiRegisterWithRegistrar(
     FlutterDesktopPluginRegistrarRef registrar);
 
+// Sets the warm-up policy, kWindowsStoreWarmUpNone by default. Must be called
+// before the plugin registers, i.e. before RegisterPlugins in the runner.
+FLUTTER_PLUGIN_EXPORT void WindowsStorePluginCApiSetWarmUpPolicy(
+    WindowsStoreWarmUpPolicy policy);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
@@ -0,0 +1,792 @@
+#include "json_extractor.h"
+
+#include <charconv>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WINDOWS_STORE_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kNotFound = std::string_view::npos;
+
+    inline uint32_t CountTrailingZeros(uint32_t value)
+    {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward(&index, value);
+      return static_cast<uint32_t>(index);
+#else
+      return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+    }
+
+    inline uint32_t CountTrailingZeros64(uint64_t value)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, value);
+      return static_cast<uint32_t>(index);
+#elif defined(_MSC_VER)
+      uint32_t low = static_cast<uint32_t>(value);
+      return low != 0 ? CountTrailingZeros(low) : 32 + CountTrailingZeros(static_cast<uint32_t>(value >> 32));
+#else
+      return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    // Returns the position of the first '"' or '\' at or after |pos|.
+    size_t FindQuoteOrBackslash(std::string_view json, size_t pos)
+    {
+#ifdef WINDOWS_STORE_JSON_SSE2
+      const __m128i quote = _mm_set1_epi8('"');
+      const __m128i backslash = _mm_set1_epi8('\\');
+      for (; pos + 16 <= json.size(); pos += 16)
+      {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(json.data() + pos));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0)
+        {
+          return pos + CountTrailingZeros(static_cast<uint32_t>(mask));
+        }
+      }
+#endif
+      for (; pos < json.size(); ++pos)
+      {
+        if (json[pos] == '"' || json[pos] == '\\')
+        {
+          return pos;
+        }
+      }
+      return kNotFound;
+    }
+
+    // Returns the position of the first '"', '{', '}', '[' or ']' at or
+    // after |pos|.
+    size_t FindStructural(std::string_view json, size_t pos)
+    {
+#ifdef WINDOWS_STORE_JSON_SSE2
+      // '[' and ']' differ from '{' and '}' only in bit 0x20.
+      const __m128i quote = _mm_set1_epi8('"');
+      const __m128i open = _mm_set1_epi8('{');
+      const __m128i close = _mm_set1_epi8('}');
+      const __m128i case_bit = _mm_set1_epi8(0x20);
+      for (; pos + 16 <= json.size(); pos += 16)
+      {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(json.data() + pos));
+        __m128i folded = _mm_or_si128(chunk, case_bit);
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                    _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0)
+        {
+          return pos + CountTrailingZeros(static_cast<uint32_t>(mask));
+        }
+      }
+#endif
+      for (; pos < json.size(); ++pos)
+      {
+        char c = json[pos];
+        if (c == '"' || c == '{' || c == '}' || c == '[' || c == ']')
+        {
+          return pos;
+        }
+      }
+      return kNotFound;
+    }
+
+    bool IsWhitespace(char c)
+    {
+      return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    int HexDigit(char c)
+    {
+      if (c >= '0' && c <= '9')
+      {
+        return c - '0';
+      }
+      if (c >= 'a' && c <= 'f')
+      {
+        return c - 'a' + 10;
+      }
+      if (c >= 'A' && c <= 'F')
+      {
+        return c - 'A' + 10;
+      }
+      return -1;
+    }
+
+    void AppendUtf8(uint32_t code_point, std::string &out)
+    {
+      if (code_point < 0x80)
+      {
+        out.push_back(static_cast<char>(code_point));
+      }
+      else if (code_point < 0x800)
+      {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+      }
+      else if (code_point < 0x10000)
+      {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+      }
+      else
+      {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+      }
+    }
+
+    // Unescapes a JSON Pointer segment ("~1" is '/', "~0" is '~').
+    bool UnescapeSegment(std::string_view segment, std::string &out)
+    {
+      for (size_t i = 0; i < segment.size(); ++i)
+      {
+        if (segment[i] != '~')
+        {
+          out.push_back(segment[i]);
+          continue;
+        }
+        if (i + 1 == segment.size() || (segment[i + 1] != '0' && segment[i + 1] != '1'))
+        {
+          return false;
+        }
+        out.push_back(segment[++i] == '0' ? '~' : '/');
+      }
+      return true;
+    }
+
+    std::optional<uint32_t> ParseIndex(std::string_view segment)
+    {
+      if (segment.empty() || segment.size() > 9 || (segment.size() > 1 && segment[0] == '0'))
+      {
+        return std::nullopt;
+      }
+      uint32_t index = 0;
+      auto result = std::from_chars(segment.data(), segment.data() + segment.size(), index);
+      if (result.ec != std::errc() || result.ptr != segment.data() + segment.size())
+      {
+        return std::nullopt;
+      }
+      return index;
+    }
+
+  } // namespace
+
+  JsonExtractor::JsonExtractor(const std::vector<Field> &fields)
+  {
+    fields_.reserve(fields.size());
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+      CompiledField compiled;
+      compiled.type = fields[i].type;
+      std::string_view path = fields[i].path;
+      bool valid = i < kMaxFields && (path.empty() || path[0] == '/');
+      size_t start = 1;
+      while (valid && start <= path.size())
+      {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos)
+        {
+          end = path.size();
+        }
+        std::string_view raw = path.substr(start, end - start);
+        Segment segment;
+        segment.wildcard = raw == "*";
+        valid = UnescapeSegment(raw, segment.key);
+        segment.index = ParseIndex(segment.key);
+        compiled.segments.push_back(std::move(segment));
+        start = end + 1;
+      }
+      valid = valid && compiled.segments.size() <= kMaxDepth;
+
+      if (valid)
+      {
+        uint64_t bit = uint64_t{1} << i;
+        valid_fields_ |= bit;
+        if (ends_at_depth_.size() <= compiled.segments.size())
+        {
+          ends_at_depth_.resize(compiled.segments.size() + 1);
+        }
+        ends_at_depth_[compiled.segments.size()] |= bit;
+      }
+      fields_.push_back(std::move(compiled));
+    }
+  }
+
+  // Recursive descent over the values some field goes through. |matched|
+  // masks hold the fields whose path matched every segment down to the
+  // value being parsed.
+  class JsonExtractor::Parser
+  {
+  public:
+    Parser(const JsonExtractor &extractor, std::string_view json, std::vector<std::optional<JsonValue>> &values)
+        : extractor_(extractor), json_(json), values_(values), pending_(extractor.valid_fields_) {}
+
+    bool Run()
+    {
+      if (pending_ == 0)
+      {
+        return true;
+      }
+      if (!ParseValue(0, pending_))
+      {
+        return false;
+      }
+      if (pending_ == 0)
+      {
+        return true;
+      }
+      SkipWhitespace();
+      return pos_ == json_.size();
+    }
+
+  private:
+    bool ParseValue(size_t depth, uint64_t matched)
+    {
+      SkipWhitespace();
+      if (pos_ >= json_.size())
+      {
+        return false;
+      }
+      matched &= pending_;
+      if (matched == 0)
+      {
+        return SkipValue();
+      }
+      uint64_t ends_here = depth < extractor_.ends_at_depth_.size() ? extractor_.ends_at_depth_[depth] : 0;
+      uint64_t terminal = matched & ends_here;
+      uint64_t descending = matched & ~ends_here;
+
+      size_t start = pos_;
+      char c = json_[pos_];
+      switch (c)
+      {
+      case '"':
+      {
+        if (Wants(terminal, JsonFieldType::kString))
+        {
+          std::string value;
+          if (!ReadString(value))
+          {
+            return false;
+          }
+          Assign(terminal, JsonFieldType::kString, JsonValue(std::move(value)));
+        }
+        else if (!SkipString())
+        {
+          return false;
+        }
+        break;
+      }
+      case '{':
+      case '[':
+      {
+        bool ok = descending == 0 ? SkipContainer()
+                                  : (c == '{' ? ParseObject(depth, descending) : ParseArray(depth, descending));
+        if (!ok)
+        {
+          return false;
+        }
+        if (pending_ == 0)
+        {
+          return true;
+        }
+        break;
+      }
+      case 't':
+      case 'f':
+      {
+        std::string_view literal = c == 't' ? "true" : "false";
+        if (json_.compare(pos_, literal.size(), literal) != 0)
+        {
+          return false;
+        }
+        pos_ += literal.size();
+        Assign(terminal, JsonFieldType::kBool, JsonValue(c == 't'));
+        break;
+      }
+      case 'n':
+        if (json_.compare(pos_, 4, "null") != 0)
+        {
+          return false;
+        }
+        pos_ += 4;
+        break;
+      default:
+      {
+        std::optional<double> value;
+        if (!ReadNumber(value))
+        {
+          return false;
+        }
+        if (value)
+        {
+          Assign(terminal, JsonFieldType::kNumber, JsonValue(*value));
+        }
+        break;
+      }
+      }
+
+      if (Wants(terminal, JsonFieldType::kRaw))
+      {
+        Assign(terminal, JsonFieldType::kRaw, JsonValue(std::string(json_.substr(start, pos_ - start))));
+      }
+      return true;
+    }
+
+    bool ParseObject(size_t depth, uint64_t descending)
+    {
+      if (depth >= kMaxDepth)
+      {
+        return false;
+      }
+      ++pos_; // '{'
+      SkipWhitespace();
+      if (Consume('}'))
+      {
+        return true;
+      }
+      std::string scratch;
+      while (true)
+      {
+        SkipWhitespace();
+        std::string_view key;
+        if (pos_ >= json_.size() || json_[pos_] != '"' || !ReadKey(scratch, key))
+        {
+          return false;
+        }
+        SkipWhitespace();
+        if (!Consume(':'))
+        {
+          return false;
+        }
+
+        uint64_t child = 0;
+        for (uint64_t bits = descending & pending_; bits != 0; bits &= bits - 1)
+        {
+          uint32_t field = CountTrailingZeros64(bits);
+          const Segment &segment = extractor_.fields_[field].segments[depth];
+          if (segment.wildcard || segment.key == key)
+          {
+            child |= uint64_t{1} << field;
+          }
+        }
+        if (!ParseValue(depth + 1, child))
+        {
+          return false;
+        }
+        if (pending_ == 0)
+        {
+          return true;
+        }
+
+        SkipWhitespace();
+        if (Consume('}'))
+        {
+          return true;
+        }
+        if (!Consume(','))
+        {
+          return false;
+        }
+      }
+    }
+
+    bool ParseArray(size_t depth, uint64_t descending)
+    {
+      if (depth >= kMaxDepth)
+      {
+        return false;
+      }
+      ++pos_; // '['
+      SkipWhitespace();
+      if (Consume(']'))
+      {
+        return true;
+      }
+      for (uint32_t index = 0;; ++index)
+      {
+        uint64_t child = 0;
+        for (uint64_t bits = descending & pending_; bits != 0; bits &= bits - 1)
+        {
+          uint32_t field = CountTrailingZeros64(bits);
+          const Segment &segment = extractor_.fields_[field].segments[depth];
+          if (segment.wildcard || segment.index == index)
+          {
+            child |= uint64_t{1} << field;
+          }
+        }
+        if (!ParseValue(depth + 1, child))
+        {
+          return false;
+        }
+        if (pending_ == 0)
+        {
+          return true;
+        }
+
+        SkipWhitespace();
+        if (Consume(']'))
+        {
+          return true;
+        }
+        if (!Consume(','))
+        {
+          return false;
+        }
+      }
+    }
+
+    bool Wants(uint64_t fields, JsonFieldType type) const
+    {
+      for (uint64_t bits = fields & pending_; bits != 0; bits &= bits - 1)
+      {
+        if (extractor_.fields_[CountTrailingZeros64(bits)].type == type)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void Assign(uint64_t fields, JsonFieldType type, const JsonValue &value)
+    {
+      for (uint64_t bits = fields & pending_; bits != 0; bits &= bits - 1)
+      {
+        uint32_t field = CountTrailingZeros64(bits);
+        if (extractor_.fields_[field].type == type)
+        {
+          values_[field] = value;
+          pending_ &= ~(uint64_t{1} << field);
+        }
+      }
+    }
+
+    bool SkipValue()
+    {
+      switch (json_[pos_])
+      {
+      case '"':
+        return SkipString();
+      case '{':
+      case '[':
+        return SkipContainer();
+      case 't':
+        return SkipLiteral("true");
+      case 'f':
+        return SkipLiteral("false");
+      case 'n':
+        return SkipLiteral("null");
+      default:
+      {
+        std::optional<double> ignored;
+        return ReadNumber(ignored);
+      }
+      }
+    }
+
+    bool SkipLiteral(std::string_view literal)
+    {
+      if (json_.compare(pos_, literal.size(), literal) != 0)
+      {
+        return false;
+      }
+      pos_ += literal.size();
+      return true;
+    }
+
+    // Skips the string starting at |pos_| without unescaping it.
+    bool SkipString()
+    {
+      size_t pos = pos_ + 1;
+      while (true)
+      {
+        pos = FindQuoteOrBackslash(json_, pos);
+        if (pos == kNotFound)
+        {
+          return false;
+        }
+        if (json_[pos] == '"')
+        {
+          pos_ = pos + 1;
+          return true;
+        }
+        pos += 2;
+      }
+    }
+
+    // Skips the object or array starting at |pos_|, looking only at
+    // brackets and strings.
+    bool SkipContainer()
+    {
+      size_t depth = 0;
+      size_t pos = pos_;
+      while (true)
+      {
+        pos = FindStructural(json_, pos);
+        if (pos == kNotFound)
+        {
+          return false;
+        }
+        char c = json_[pos];
+        if (c == '"')
+        {
+          pos_ = pos;
+          if (!SkipString())
+          {
+            return false;
+          }
+          pos = pos_;
+          continue;
+        }
+        ++pos;
+        if (c == '{' || c == '[')
+        {
+          ++depth;
+        }
+        else if (--depth == 0)
+        {
+          pos_ = pos;
+          return true;
+        }
+      }
+    }
+
+    // Reads an object key. |key| points into the document unless the key
+    // has escapes, in which case it points into |scratch|.
+    bool ReadKey(std::string &scratch, std::string_view &key)
+    {
+      size_t end = FindQuoteOrBackslash(json_, pos_ + 1);
+      if (end != kNotFound && json_[end] == '"')
+      {
+        key = json_.substr(pos_ + 1, end - pos_ - 1);
+        pos_ = end + 1;
+        return true;
+      }
+      scratch.clear();
+      if (!ReadString(scratch))
+      {
+        return false;
+      }
+      key = scratch;
+      return true;
+    }
+
+    // Reads and unescapes the string starting at |pos_|.
+    bool ReadString(std::string &out)
+    {
+      size_t pos = pos_ + 1;
+      while (true)
+      {
+        size_t end = FindQuoteOrBackslash(json_, pos);
+        if (end == kNotFound)
+        {
+          return false;
+        }
+        for (size_t i = pos; i < end; ++i)
+        {
+          if (static_cast<unsigned char>(json_[i]) < 0x20)
+          {
+            return false;
+          }
+        }
+        out.append(json_.data() + pos, end - pos);
+        if (json_[end] == '"')
+        {
+          pos_ = end + 1;
+          return true;
+        }
+        if (end + 1 >= json_.size())
+        {
+          return false;
+        }
+        pos = end + 2;
+        switch (json_[end + 1])
+        {
+        case '"':
+          out.push_back('"');
+          break;
+        case '\\':
+          out.push_back('\\');
+          break;
+        case '/':
+          out.push_back('/');
+          break;
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u':
+        {
+          uint32_t code_point;
+          if (!ReadHex4(pos, code_point))
+          {
+            return false;
+          }
+          pos += 4;
+          if (code_point >= 0xD800 && code_point < 0xDC00)
+          {
+            uint32_t low;
+            if (json_.compare(pos, 2, "\\u") != 0 || !ReadHex4(pos + 2, low) || low < 0xDC00 || low >= 0xE000)
+            {
+              return false;
+            }
+            pos += 6;
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+          }
+          else if (code_point >= 0xDC00 && code_point < 0xE000)
+          {
+            return false;
+          }
+          AppendUtf8(code_point, out);
+          break;
+        }
+        default:
+          return false;
+        }
+      }
+    }
+
+    bool ReadHex4(size_t pos, uint32_t &value) const
+    {
+      if (pos + 4 > json_.size())
+      {
+        return false;
+      }
+      value = 0;
+      for (size_t i = pos; i < pos + 4; ++i)
+      {
+        int digit = HexDigit(json_[i]);
+        if (digit < 0)
+        {
+          return false;
+        }
+        value = (value << 4) | static_cast<uint32_t>(digit);
+      }
+      return true;
+    }
+
+    // Reads the number at |pos_|. |value| is left empty if it does not
+    // fit a double.
+    bool ReadNumber(std::optional<double> &value)
+    {
+      // from_chars accepts a subset of the JSON number grammar plus "inf",
+      // "nan" and hex, so check the JSON shape first.
+      size_t pos = pos_;
+      if (pos < json_.size() && json_[pos] == '-')
+      {
+        ++pos;
+      }
+      size_t digits = pos;
+      while (pos < json_.size() && json_[pos] >= '0' && json_[pos] <= '9')
+      {
+        ++pos;
+      }
+      if (pos == digits || (json_[digits] == '0' && pos - digits > 1))
+      {
+        return false;
+      }
+      if (pos < json_.size() && json_[pos] == '.')
+      {
+        digits = ++pos;
+        while (pos < json_.size() && json_[pos] >= '0' && json_[pos] <= '9')
+        {
+          ++pos;
+        }
+        if (pos == digits)
+        {
+          return false;
+        }
+      }
+      if (pos < json_.size() && (json_[pos] == 'e' || json_[pos] == 'E'))
+      {
+        ++pos;
+        if (pos < json_.size() && (json_[pos] == '+' || json_[pos] == '-'))
+        {
+          ++pos;
+        }
+        digits = pos;
+        while (pos < json_.size() && json_[pos] >= '0' && json_[pos] <= '9')
+        {
+          ++pos;
+        }
+        if (pos == digits)
+        {
+          return false;
+        }
+      }
+      double number;
+      auto result = std::from_chars(json_.data() + pos_, json_.data() + pos, number);
+      if (result.ec == std::errc::invalid_argument)
+      {
+        return false;
+      }
+      if (result.ec == std::errc())
+      {
+        value = number;
+      }
+      pos_ = pos;
+      return true;
+    }
+
+    void SkipWhitespace()
+    {
+      while (pos_ < json_.size() && IsWhitespace(json_[pos_]))
+      {
+        ++pos_;
+      }
+    }
+
+    bool Consume(char c)
+    {
+      if (pos_ < json_.size() && json_[pos_] == c)
+      {
+        ++pos_;
+        return true;
+      }
+      return false;
+    }
+
+    const JsonExtractor &extractor_;
+    std::string_view json_;
+    std::vector<std::optional<JsonValue>> &values_;
+    size_t pos_ = 0;
+    // Fields that have no value yet.
+    uint64_t pending_;
+  };
+
+  bool JsonExtractor::Extract(std::string_view json, std::vector<std::optional<JsonValue>> &values) const
+  {
+    values.assign(fields_.size(), std::nullopt);
+    return Parser(*this, json, values).Run();
+  }
+
+} // namespace windows_store
@@ -0,0 +1,83 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_JSON_EXTRACTOR_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_JSON_EXTRACTOR_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace windows_store
+{
+
+  // Types a field can be extracted as. kRaw returns the JSON text of the
+  // value, which also works for objects and arrays.
+  enum class JsonFieldType : uint8_t
+  {
+    kString = 0,
+    kNumber = 1,
+    kBool = 2,
+    kRaw = 3,
+  };
+
+  using JsonValue = std::variant<std::string, double, bool>;
+
+  // Single-pass extractor of a few fields from a JSON document, such as the
+  // ExtendedJsonData of Store products, without building a DOM. Subtrees
+  // that no requested field goes through are skipped by scanning for
+  // structural characters, 16 bytes at a time where SSE2 is available.
+  class JsonExtractor
+  {
+  public:
+    struct Field
+    {
+      // JSON Pointer (RFC 6901), e.g. "/Skus/0/Sku/Title". A "*" segment
+      // matches any key or array index.
+      std::string path;
+      JsonFieldType type = JsonFieldType::kString;
+    };
+
+    static constexpr size_t kMaxDepth = 128;
+    static constexpr size_t kMaxFields = 64;
+
+    // Fields past kMaxFields, and paths that are not JSON Pointers, never
+    // match.
+    explicit JsonExtractor(const std::vector<Field> &fields);
+
+    size_t field_count() const { return fields_.size(); }
+    JsonFieldType field_type(size_t index) const { return fields_[index].type; }
+
+    // Sets values[i] to the first value matching field i with its type, or
+    // nullopt. Parsing stops once every field has a value. Returns false if
+    // |json| is malformed; values found before the error are kept. Skipped
+    // subtrees are only checked for balanced brackets and strings.
+    bool Extract(std::string_view json, std::vector<std::optional<JsonValue>> &values) const;
+
+  private:
+    struct Segment
+    {
+      std::string key;
+      bool wildcard = false;
+      // Set if |key| is an array index.
+      std::optional<uint32_t> index;
+    };
+
+    struct CompiledField
+    {
+      std::vector<Segment> segments;
+      JsonFieldType type;
+    };
+
+    class Parser;
+
+    std::vector<CompiledField> fields_;
+    // Bit i is set for the fields that can match at all.
+    uint64_t valid_fields_ = 0;
+    // Element d has bit i set if field i has d segments.
+    std::vector<uint64_t> ends_at_depth_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_JSON_EXTRACTOR_H_
@@ -0,0 +1,182 @@
+#include "license_refresh.h"
+
+#include <algorithm>
+
+namespace windows_store
+{
+
+  LicenseRefreshScheduler::LicenseRefreshScheduler(std::function<void(uint64_t generation)> revalidate,
+                                                   std::function<Clock::time_point()> now,
+                                                   bool run_timer)
+      : revalidate_(std::move(revalidate)), now_(std::move(now))
+  {
+    if (run_timer)
+    {
+      timer_ = std::thread([this]()
+                           { Run(); });
+    }
+  }
+
+  LicenseRefreshScheduler::~LicenseRefreshScheduler()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    changed_.notify_all();
+    if (timer_.joinable())
+    {
+      timer_.join();
+    }
+  }
+
+  // static
+  std::chrono::milliseconds LicenseRefreshScheduler::RefreshDelay(const LicenseSnapshot &license,
+                                                                  int64_t now_unix_ms)
+  {
+    std::chrono::milliseconds delay;
+    if (!license.is_active)
+    {
+      delay = kInactiveLicenseDelay;
+    }
+    else if (license.is_trial)
+    {
+      // Revalidate a few times over the rest of the trial, down to every
+      // minute as it runs out.
+      delay = std::clamp(std::chrono::milliseconds(license.trial_time_remaining_ms / 4), kMinDelay, kMaxTrialDelay);
+    }
+    else
+    {
+      delay = kFullLicenseDelay;
+    }
+
+    for (const AddOnLicenseRecord &add_on : license.add_ons)
+    {
+      if (add_on.is_active && add_on.expiration_ms > now_unix_ms)
+      {
+        delay = std::min(delay, std::chrono::milliseconds(add_on.expiration_ms - now_unix_ms));
+      }
+    }
+    return std::max(delay, kMinDelay);
+  }
+
+  std::shared_ptr<const LicenseSnapshot> LicenseRefreshScheduler::Get()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<const LicenseSnapshot> license = license_;
+    // Someone is using the app, so a stale license is revalidated even while
+    // it is inactive.
+    RevalidateIfDue(lock);
+    return license;
+  }
+
+  uint64_t LicenseRefreshScheduler::Generation()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+  }
+
+  bool LicenseRefreshScheduler::Complete(std::shared_ptr<const LicenseSnapshot> license, uint64_t generation)
+  {
+    int64_t now_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+    std::chrono::milliseconds delay = RefreshDelay(*license, now_unix_ms);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (generation != generation_)
+      {
+        return false;
+      }
+      license_ = std::move(license);
+      in_flight_ = false;
+      retry_delay_ = kMinDelay;
+      due_ = now_() + delay;
+    }
+    changed_.notify_all();
+    return true;
+  }
+
+  void LicenseRefreshScheduler::Fail(uint64_t generation)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (generation != generation_)
+      {
+        return;
+      }
+      in_flight_ = false;
+      due_ = now_() + retry_delay_;
+      retry_delay_ = std::min(retry_delay_ * 2, kMaxRetryDelay);
+    }
+    changed_.notify_all();
+  }
+
+  void LicenseRefreshScheduler::Invalidate()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      license_.reset();
+      generation_++;
+      // The revalidation running, if any, ends as a stale fetch; the next
+      // license starts a new one.
+      in_flight_ = false;
+      retry_delay_ = kMinDelay;
+    }
+    changed_.notify_all();
+  }
+
+  void LicenseRefreshScheduler::SetAppActive(bool active)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      app_active_ = active;
+    }
+    changed_.notify_all();
+  }
+
+  void LicenseRefreshScheduler::Tick()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (app_active_)
+    {
+      RevalidateIfDue(lock);
+    }
+  }
+
+  void LicenseRefreshScheduler::Run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+      if (!license_ || in_flight_ || !app_active_)
+      {
+        // Nothing to schedule until a license arrives, the running
+        // revalidation ends or the app is activated.
+        changed_.wait(lock);
+        continue;
+      }
+      Clock::time_point now = now_();
+      if (now < due_)
+      {
+        changed_.wait_for(lock, due_ - now);
+        continue;
+      }
+      RevalidateIfDue(lock);
+    }
+  }
+
+  void LicenseRefreshScheduler::RevalidateIfDue(std::unique_lock<std::mutex> &lock)
+  {
+    if (!license_ || in_flight_ || now_() < due_)
+    {
+      return;
+    }
+    in_flight_ = true;
+    uint64_t generation = generation_;
+    lock.unlock();
+    revalidate_(generation);
+    lock.lock();
+  }
+
+} // namespace windows_store
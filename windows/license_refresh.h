@@ -0,0 +1,100 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_LICENSE_REFRESH_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_LICENSE_REFRESH_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "license_snapshot.h"
+
+namespace windows_store
+{
+
+  // Stale-while-revalidate cache of the app license. The cached snapshot is
+  // served right away and revalidated in the background at a time derived
+  // from the license itself: soon for short trials and add-ons about to
+  // expire, rarely for active full licenses. Revalidation pauses while the
+  // app is inactive and catches up when it is activated again.
+  class LicenseRefreshScheduler
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds kMinDelay = std::chrono::minutes(1);
+    static constexpr std::chrono::milliseconds kMaxRetryDelay = std::chrono::minutes(30);
+    static constexpr std::chrono::milliseconds kFullLicenseDelay = std::chrono::hours(24);
+    static constexpr std::chrono::milliseconds kInactiveLicenseDelay = std::chrono::hours(1);
+    static constexpr std::chrono::milliseconds kMaxTrialDelay = std::chrono::hours(6);
+
+    // |revalidate| starts a background fetch of the given generation that
+    // must end with Complete or Fail. |now| is the clock driving the
+    // schedule. Without |run_timer|,
+    // nothing waits for the due time and the owner calls Tick instead, e.g.
+    // a test advancing |now| by hand.
+    LicenseRefreshScheduler(std::function<void(uint64_t generation)> revalidate,
+                            std::function<Clock::time_point()> now = Clock::now,
+                            bool run_timer = true);
+    ~LicenseRefreshScheduler();
+
+    LicenseRefreshScheduler(const LicenseRefreshScheduler &) = delete;
+    LicenseRefreshScheduler &operator=(const LicenseRefreshScheduler &) = delete;
+
+    // How long |license| stays fresh, |now_unix_ms| being the wall clock
+    // time it was fetched at.
+    static std::chrono::milliseconds RefreshDelay(const LicenseSnapshot &license, int64_t now_unix_ms);
+
+    // The cached license, if any. Starts a revalidation if it is stale.
+    // Shared rather than copied, so a cache hit does not allocate.
+    std::shared_ptr<const LicenseSnapshot> Get();
+
+    // Bumped by Invalidate. A fetch takes the generation when it starts and
+    // passes it to Complete or Fail, so that a fetch which raced an
+    // invalidation cannot bring back the license it replaced.
+    uint64_t Generation();
+
+    // Caches a freshly fetched license, unless the cache was invalidated
+    // since the fetch of |generation| started. Returns whether it did.
+    bool Complete(std::shared_ptr<const LicenseSnapshot> license, uint64_t generation);
+    // Records a failed revalidation; it is retried with exponential backoff.
+    // Ignored if the cache was invalidated since the fetch started.
+    void Fail(uint64_t generation);
+
+    // Drops the cached license, e.g. after the Store reported that licenses
+    // changed, so the next Get misses instead of serving a stale license.
+    // Fetches still running are disregarded.
+    void Invalidate();
+
+    void SetAppActive(bool active);
+
+    // Starts a revalidation if one is due and the app is active, as the
+    // timer does when the due time passes.
+    void Tick();
+
+  private:
+    void Run();
+
+    // Starts a revalidation if the cache is stale. Requires |mutex_|.
+    void RevalidateIfDue(std::unique_lock<std::mutex> &lock);
+
+    std::function<void(uint64_t generation)> revalidate_;
+    std::function<Clock::time_point()> now_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::shared_ptr<const LicenseSnapshot> license_;
+    Clock::time_point due_;
+    std::chrono::milliseconds retry_delay_ = kMinDelay;
+    uint64_t generation_ = 0;
+    bool in_flight_ = false;
+    bool app_active_ = true;
+    bool stopping_ = false;
+    std::thread timer_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_LICENSE_REFRESH_H_
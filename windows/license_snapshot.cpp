@@ -0,0 +1,99 @@
+#include "license_snapshot.h"
+
+#include "byte_buffer.h"
+#include "columnar_writer.h"
+#include "extended_json.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    void WriteLicenseColumns(ColumnarWriter &writer, const LicenseSnapshot &license, uint64_t field_mask)
+    {
+      auto requested = [field_mask](LicenseField field)
+      { return (field_mask & LicenseFieldBit(field)) != 0; };
+      auto begin = [&writer](LicenseField field, ColumnType type)
+      { writer.BeginColumn(static_cast<uint16_t>(field), type); };
+
+      if (requested(LicenseField::kIsActive))
+      {
+        begin(LicenseField::kIsActive, ColumnType::kBool);
+        writer.AppendBool(license.is_active);
+      }
+      if (requested(LicenseField::kIsTrial))
+      {
+        begin(LicenseField::kIsTrial, ColumnType::kBool);
+        writer.AppendBool(license.is_trial);
+      }
+      if (requested(LicenseField::kSkuStoreId))
+      {
+        begin(LicenseField::kSkuStoreId, ColumnType::kString);
+        writer.AppendString(license.sku_store_id);
+      }
+      if (requested(LicenseField::kTrialUniqueId))
+      {
+        begin(LicenseField::kTrialUniqueId, ColumnType::kString);
+        writer.AppendString(license.trial_unique_id);
+      }
+      if (requested(LicenseField::kTrialTimeRemaining))
+      {
+        begin(LicenseField::kTrialTimeRemaining, ColumnType::kInt64);
+        writer.AppendInt64(license.trial_time_remaining_ms);
+      }
+    }
+
+  } // namespace
+
+  LicenseSnapshot ProjectLicenseSnapshot(const LicenseSnapshot &license, uint64_t field_mask)
+  {
+    auto requested = [field_mask](LicenseField field)
+    { return (field_mask & LicenseFieldBit(field)) != 0; };
+
+    LicenseSnapshot projection;
+    projection.is_active = requested(LicenseField::kIsActive) && license.is_active;
+    projection.is_trial = requested(LicenseField::kIsTrial) && license.is_trial;
+    if (requested(LicenseField::kSkuStoreId))
+    {
+      projection.sku_store_id = license.sku_store_id;
+    }
+    if (requested(LicenseField::kTrialUniqueId))
+    {
+      projection.trial_unique_id = license.trial_unique_id;
+    }
+    if (requested(LicenseField::kTrialTimeRemaining))
+    {
+      projection.trial_time_remaining_ms = license.trial_time_remaining_ms;
+    }
+    if (requested(LicenseField::kAddOnLicenses))
+    {
+      projection.add_ons = license.add_ons;
+    }
+    if (requested(LicenseField::kExtendedJsonData))
+    {
+      projection.extended_json_data = license.extended_json_data;
+    }
+    return projection;
+  }
+
+  void EncodeLicenseSnapshot(const LicenseSnapshot &license, uint64_t field_mask, ByteWriter &out)
+  {
+    ColumnarWriter writer(1);
+    WriteLicenseColumns(writer, license, field_mask);
+    writer.Finish(out);
+  }
+
+  void EncodeLicenseSnapshot(const LicenseSnapshot &license, uint64_t field_mask,
+                             const JsonExtractor &extended_fields, ColumnarWriter &table, ByteWriter &out)
+  {
+    table.Reset(1);
+    WriteLicenseColumns(table, license, field_mask);
+    if (extended_fields.field_count() != 0)
+    {
+      AppendExtendedJsonColumns(extended_fields, {license.extended_json_data}, table);
+    }
+    table.Finish(out);
+  }
+
+} // namespace windows_store
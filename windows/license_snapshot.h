@@ -0,0 +1,116 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_LICENSE_SNAPSHOT_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_LICENSE_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json_extractor.h"
+#include "pigeon/messages.g.h"
+
+namespace windows_store
+{
+
+  // Field ids of license columns on the bulk channel. Must match
+  // StoreAppLicenseField in lib/windows_store.dart.
+  enum class LicenseField : uint16_t
+  {
+    kIsActive = 0,
+    kIsTrial = 1,
+    kSkuStoreId = 2,
+    kTrialUniqueId = 3,
+    kTrialTimeRemaining = 4,
+    // Not a column; controls whether add-on licenses are read.
+    kAddOnLicenses = 5,
+    // Not a column; controls whether ExtendedJsonData is read for the
+    // extended fields of the query (see extended_json.h).
+    kExtendedJsonData = 6,
+  };
+
+  constexpr uint64_t LicenseFieldBit(LicenseField field)
+  {
+    return uint64_t{1} << static_cast<uint16_t>(field);
+  }
+
+  constexpr uint64_t kAllLicenseFields = (uint64_t{1} << 6) - 1;
+
+  // Plain copy of a StoreLicense from StoreAppLicense::AddOnLicenses.
+  struct AddOnLicenseRecord
+  {
+    std::string sku_store_id;
+    std::string in_app_offer_token;
+    bool is_active = false;
+    // Milliseconds since the Unix epoch.
+    int64_t expiration_ms = 0;
+
+    bool operator==(const AddOnLicenseRecord &other) const
+    {
+      return sku_store_id == other.sku_store_id &&
+             in_app_offer_token == other.in_app_offer_token &&
+             is_active == other.is_active &&
+             expiration_ms == other.expiration_ms;
+    }
+    bool operator!=(const AddOnLicenseRecord &other) const { return !(*this == other); }
+  };
+
+  // Plain copy of a StoreAppLicense, including add-on licenses. Fields outside
+  // the field mask of the query that produced it are left empty.
+  struct LicenseSnapshot
+  {
+    bool is_active = false;
+    bool is_trial = false;
+    std::string sku_store_id;
+    std::string trial_unique_id;
+    int64_t trial_time_remaining_ms = 0;
+    std::vector<AddOnLicenseRecord> add_ons;
+    std::string extended_json_data;
+
+    static LicenseSnapshot FromInner(const StoreAppLicenseInner &inner)
+    {
+      LicenseSnapshot snapshot;
+      snapshot.is_active = inner.is_active();
+      snapshot.is_trial = inner.is_trial();
+      snapshot.sku_store_id = inner.sku_store_id();
+      snapshot.trial_unique_id = inner.trial_unique_id();
+      snapshot.trial_time_remaining_ms = inner.trial_time_remaining();
+      return snapshot;
+    }
+
+    StoreAppLicenseInner ToInner() const
+    {
+      return StoreAppLicenseInner(is_active, is_trial, sku_store_id, trial_unique_id, trial_time_remaining_ms);
+    }
+
+    bool operator==(const LicenseSnapshot &other) const
+    {
+      return is_active == other.is_active &&
+             is_trial == other.is_trial &&
+             sku_store_id == other.sku_store_id &&
+             trial_unique_id == other.trial_unique_id &&
+             trial_time_remaining_ms == other.trial_time_remaining_ms &&
+             add_ons == other.add_ons &&
+             extended_json_data == other.extended_json_data;
+    }
+    bool operator!=(const LicenseSnapshot &other) const { return !(*this == other); }
+  };
+
+  // Copy of |license| holding only the fields of |field_mask|, as if it was
+  // read with that mask.
+  LicenseSnapshot ProjectLicenseSnapshot(const LicenseSnapshot &license, uint64_t field_mask);
+
+  class ByteWriter;
+  class ColumnarWriter;
+
+  // Appends |license| to |writer| as a single row columnar table, with one
+  // column per LicenseField in |field_mask|.
+  void EncodeLicenseSnapshot(const LicenseSnapshot &license, uint64_t field_mask, ByteWriter &writer);
+
+  // As above, followed by the columns of |extended_fields| extracted from the
+  // license ExtendedJsonData. The table is built in |table|, which is reset
+  // first, so callers encoding repeatedly can keep its buffers.
+  void EncodeLicenseSnapshot(const LicenseSnapshot &license, uint64_t field_mask,
+                             const JsonExtractor &extended_fields, ColumnarWriter &table, ByteWriter &writer);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_LICENSE_SNAPSHOT_H_
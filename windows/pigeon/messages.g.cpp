@@ -175,6 +175,251 @@ void WindowsStoreApi::SetUp(
       channel.SetMessageHandler(nullptr);
     }
   }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.setSimulatedLicense" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_license_arg = args.at(0);
+          const auto* license_arg = encodable_license_arg.IsNull() ? nullptr : &(std::any_cast<const StoreAppLicenseInner&>(std::get<CustomEncodableValue>(encodable_license_arg)));
+          std::optional<FlutterError> output = api->SetSimulatedLicense(license_arg);
+          if (output.has_value()) {
+            reply(WrapError(output.value()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue());
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.registerFeatures" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_features_arg = args.at(0);
+          if (encodable_features_arg.IsNull()) {
+            reply(WrapError("features_arg unexpectedly null."));
+            return;
+          }
+          const auto& features_arg = std::get<EncodableMap>(encodable_features_arg);
+          std::optional<FlutterError> output = api->RegisterFeatures(features_arg);
+          if (output.has_value()) {
+            reply(WrapError(output.value()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue());
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.isFeatureEnabledAsync" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_feature_arg = args.at(0);
+          if (encodable_feature_arg.IsNull()) {
+            reply(WrapError("feature_arg unexpectedly null."));
+            return;
+          }
+          const auto& feature_arg = std::get<std::string>(encodable_feature_arg);
+          api->IsFeatureEnabledAsync(feature_arg, [reply](ErrorOr<bool>&& output) {
+            if (output.has_error()) {
+              reply(WrapError(output.error()));
+              return;
+            }
+            EncodableList wrapped;
+            wrapped.push_back(EncodableValue(std::move(output).TakeValue()));
+            reply(EncodableValue(std::move(wrapped)));
+          });
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.areFeaturesEnabledAsync" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_features_arg = args.at(0);
+          if (encodable_features_arg.IsNull()) {
+            reply(WrapError("features_arg unexpectedly null."));
+            return;
+          }
+          const auto& features_arg = std::get<EncodableList>(encodable_features_arg);
+          api->AreFeaturesEnabledAsync(features_arg, [reply](ErrorOr<EncodableList>&& output) {
+            if (output.has_error()) {
+              reply(WrapError(output.error()));
+              return;
+            }
+            EncodableList wrapped;
+            wrapped.push_back(EncodableValue(std::move(output).TakeValue()));
+            reply(EncodableValue(std::move(wrapped)));
+          });
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.dumpFlightRecorder" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_path_arg = args.at(0);
+          const auto* path_arg = std::get_if<std::string>(&encodable_path_arg);
+          ErrorOr<std::string> output = api->DumpFlightRecorder(path_arg);
+          if (output.has_error()) {
+            reply(WrapError(output.error()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue(std::move(output).TakeValue()));
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.setProductBatchWindow" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_window_microseconds_arg = args.at(0);
+          if (encodable_window_microseconds_arg.IsNull()) {
+            reply(WrapError("window_microseconds_arg unexpectedly null."));
+            return;
+          }
+          const int64_t window_microseconds_arg = encodable_window_microseconds_arg.LongValue();
+          const auto& encodable_max_batch_size_arg = args.at(1);
+          if (encodable_max_batch_size_arg.IsNull()) {
+            reply(WrapError("max_batch_size_arg unexpectedly null."));
+            return;
+          }
+          const int64_t max_batch_size_arg = encodable_max_batch_size_arg.LongValue();
+          std::optional<FlutterError> output = api->SetProductBatchWindow(window_microseconds_arg, max_batch_size_arg);
+          if (output.has_value()) {
+            reply(WrapError(output.value()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue());
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.setCacheBudget" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_budget_bytes_arg = args.at(0);
+          if (encodable_budget_bytes_arg.IsNull()) {
+            reply(WrapError("budget_bytes_arg unexpectedly null."));
+            return;
+          }
+          const int64_t budget_bytes_arg = encodable_budget_bytes_arg.LongValue();
+          std::optional<FlutterError> output = api->SetCacheBudget(budget_bytes_arg);
+          if (output.has_value()) {
+            reply(WrapError(output.value()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue());
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.getCacheStats" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          ErrorOr<EncodableList> output = api->GetCacheStats();
+          if (output.has_error()) {
+            reply(WrapError(output.error()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue(std::move(output).TakeValue()));
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
+  {
+    BasicMessageChannel<> channel(binary_messenger, "dev.flutter.pigeon.windows_store.WindowsStoreApi.setImageCacheLimit" + prepended_suffix, &GetCodec());
+    if (api != nullptr) {
+      channel.SetMessageHandler([api](const EncodableValue& message, const flutter::MessageReply<EncodableValue>& reply) {
+        try {
+          const auto& args = std::get<EncodableList>(message);
+          const auto& encodable_max_bytes_arg = args.at(0);
+          if (encodable_max_bytes_arg.IsNull()) {
+            reply(WrapError("max_bytes_arg unexpectedly null."));
+            return;
+          }
+          const int64_t max_bytes_arg = encodable_max_bytes_arg.LongValue();
+          std::optional<FlutterError> output = api->SetImageCacheLimit(max_bytes_arg);
+          if (output.has_value()) {
+            reply(WrapError(output.value()));
+            return;
+          }
+          EncodableList wrapped;
+          wrapped.push_back(EncodableValue());
+          reply(EncodableValue(std::move(wrapped)));
+        } catch (const std::exception& exception) {
+          reply(WrapError(exception.what()));
+        }
+      });
+    } else {
+      channel.SetMessageHandler(nullptr);
+    }
+  }
 }
 
 EncodableValue WindowsStoreApi::WrapError(std::string_view error_message) {
@@ -124,6 +124,22 @@ class WindowsStoreApi {
   WindowsStoreApi& operator=(const WindowsStoreApi&) = delete;
   virtual ~WindowsStoreApi() {}
   virtual void GetAppLicenseAsync(std::function<void(ErrorOr<StoreAppLicenseInner> reply)> result) = 0;
+  virtual std::optional<FlutterError> SetSimulatedLicense(const StoreAppLicenseInner* license) = 0;
+  virtual std::optional<FlutterError> RegisterFeatures(const flutter::EncodableMap& features) = 0;
+  virtual void IsFeatureEnabledAsync(
+    const std::string& feature,
+    std::function<void(ErrorOr<bool> reply)> result) = 0;
+  virtual void AreFeaturesEnabledAsync(
+    const flutter::EncodableList& features,
+    std::function<void(ErrorOr<flutter::EncodableList> reply)> result) = 0;
+  virtual ErrorOr<std::string> DumpFlightRecorder(const std::string* path) = 0;
+  virtual std::optional<FlutterError> SetProductBatchWindow(
+    int64_t window_microseconds,
+    int64_t max_batch_size) = 0;
+  virtual std::optional<FlutterError> SetCacheBudget(int64_t budget_bytes) = 0;
+  // Hits, misses, evictions, entries, bytes, pinned bytes and budget bytes.
+  virtual ErrorOr<flutter::EncodableList> GetCacheStats() = 0;
+  virtual std::optional<FlutterError> SetImageCacheLimit(int64_t max_bytes) = 0;
 
   // The codec used by WindowsStoreApi.
   static const flutter::StandardMessageCodec& GetCodec();
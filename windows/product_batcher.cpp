@@ -0,0 +1,129 @@
+#include "product_batcher.h"
+
+#include <algorithm>
+
+namespace windows_store
+{
+
+  ProductBatcher::ProductBatcher(Fetch fetch, Post post)
+      : fetch_(std::move(fetch)), post_(std::move(post))
+  {
+    timer_ = std::thread([this]()
+                         { Run(); });
+  }
+
+  ProductBatcher::~ProductBatcher()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    changed_.notify_all();
+    timer_.join();
+  }
+
+  void ProductBatcher::SetWindow(std::chrono::microseconds window, size_t max_batch_size)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_ = std::max(window, std::chrono::microseconds::zero());
+    max_batch_size_ = std::max<size_t>(max_batch_size, 1);
+  }
+
+  void ProductBatcher::Load(const std::string &store_id, uint64_t field_mask, Callback callback)
+  {
+    std::shared_ptr<Batch> full;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      bool started = false;
+      if (!pending_)
+      {
+        pending_ = std::make_shared<Batch>();
+        deadline_ = Clock::now() + window_;
+        started = true;
+      }
+      auto [it, inserted] = pending_index_.try_emplace(store_id, pending_->store_ids.size());
+      if (inserted)
+      {
+        pending_->store_ids.push_back(store_id);
+      }
+      pending_->field_mask |= field_mask;
+      pending_->waiters.emplace_back(it->second, std::move(callback));
+      if (pending_->store_ids.size() >= max_batch_size_ || window_.count() == 0)
+      {
+        full = TakePending();
+      }
+      else if (started)
+      {
+        changed_.notify_all();
+      }
+    }
+    if (full)
+    {
+      Dispatch(std::move(full));
+    }
+  }
+
+  void ProductBatcher::Run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+      if (!pending_)
+      {
+        changed_.wait(lock);
+        continue;
+      }
+      if (Clock::now() < deadline_)
+      {
+        changed_.wait_until(lock, deadline_);
+        continue;
+      }
+      std::shared_ptr<Batch> batch = TakePending();
+      lock.unlock();
+      Dispatch(std::move(batch));
+      lock.lock();
+    }
+  }
+
+  std::shared_ptr<ProductBatcher::Batch> ProductBatcher::TakePending()
+  {
+    pending_index_.clear();
+    return std::move(pending_);
+  }
+
+  void ProductBatcher::Dispatch(std::shared_ptr<Batch> batch)
+  {
+    // The task owns what it uses, so it may outlive the batcher.
+    post_([fetch = fetch_, batch = std::move(batch)]()
+          { Complete(*batch, fetch(batch->store_ids, batch->field_mask | ProductFieldBit(ProductField::kStoreId))); });
+  }
+
+  // static
+  void ProductBatcher::Complete(const Batch &batch, const StoreResult<std::vector<StoreProductRecord>> &products)
+  {
+    if (!products.ok())
+    {
+      auto failure = StoreResult<const StoreProductRecord *>::Failure(products.hresult, products.message);
+      for (const auto &[index, callback] : batch.waiters)
+      {
+        callback(failure);
+      }
+      return;
+    }
+
+    std::unordered_map<std::string, const StoreProductRecord *> by_id;
+    by_id.reserve(products.value.size());
+    for (const StoreProductRecord &product : products.value)
+    {
+      by_id.emplace(product.store_id, &product);
+    }
+    StoreResult<const StoreProductRecord *> result;
+    for (const auto &[index, callback] : batch.waiters)
+    {
+      auto it = by_id.find(batch.store_ids[index]);
+      result.value = it != by_id.end() ? it->second : nullptr;
+      callback(result);
+    }
+  }
+
+} // namespace windows_store
@@ -0,0 +1,96 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_PRODUCT_BATCHER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_PRODUCT_BATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "store_backend.h"
+
+namespace windows_store
+{
+
+  // Coalesces product-by-ID lookups into batched Store calls. Lookups made
+  // within |window| of the first pending one are collected, duplicates
+  // merged, and sent as a single fetch of all their Store IDs, which is sent
+  // early once |max_batch_size| distinct IDs are pending. Each caller then
+  // gets its own product back, so a screen of product tiles that each look
+  // up their product costs one Store call instead of one per tile. Lookups
+  // still pending when the batcher is destroyed are dropped.
+  class ProductBatcher
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::microseconds kDefaultWindow = std::chrono::milliseconds(8);
+    static constexpr size_t kDefaultMaxBatchSize = 50;
+
+    // Fetches the products among |store_ids| with the fields of
+    // |field_mask|. Products must carry their Store ID.
+    using Fetch = std::function<StoreResult<std::vector<StoreProductRecord>>(
+        const std::vector<std::string> &store_ids, uint64_t field_mask)>;
+    // Runs |task| off the calling thread; batches are fetched in such tasks.
+    using Post = std::function<void(std::function<void()> task)>;
+    // The product, or nullptr if the Store has none with the requested ID.
+    // The product is only valid during the call.
+    using Callback = std::function<void(const StoreResult<const StoreProductRecord *> &result)>;
+
+    ProductBatcher(Fetch fetch, Post post);
+    ~ProductBatcher();
+
+    ProductBatcher(const ProductBatcher &) = delete;
+    ProductBatcher &operator=(const ProductBatcher &) = delete;
+
+    // Applies to batches started after the call. A zero |window| sends every
+    // lookup right away, as do batches of one.
+    void SetWindow(std::chrono::microseconds window, size_t max_batch_size);
+
+    // Looks up |store_id| with at least the fields of |field_mask| in the
+    // next batch. |callback| is called on the thread the batch is fetched on.
+    void Load(const std::string &store_id, uint64_t field_mask, Callback callback);
+
+  private:
+    struct Batch
+    {
+      // Distinct, in order of first lookup.
+      std::vector<std::string> store_ids;
+      // Union of the field masks of the lookups.
+      uint64_t field_mask = 0;
+      // Index in |store_ids| and callback of every lookup.
+      std::vector<std::pair<size_t, Callback>> waiters;
+    };
+
+    void Run();
+
+    // Detaches the pending batch. Requires |mutex_|.
+    std::shared_ptr<Batch> TakePending();
+
+    // Fetches |batch| on a posted task and answers its waiters.
+    void Dispatch(std::shared_ptr<Batch> batch);
+    static void Complete(const Batch &batch, const StoreResult<std::vector<StoreProductRecord>> &products);
+
+    Fetch fetch_;
+    Post post_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::chrono::microseconds window_ = kDefaultWindow;
+    size_t max_batch_size_ = kDefaultMaxBatchSize;
+    std::shared_ptr<Batch> pending_;
+    std::unordered_map<std::string, size_t> pending_index_;
+    Clock::time_point deadline_;
+    bool stopping_ = false;
+    std::thread timer_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_PRODUCT_BATCHER_H_
@@ -0,0 +1,63 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_REQUEST_POOL_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_REQUEST_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace windows_store
+{
+
+  // Thread-safe free list of request contexts. A request takes a context
+  // when it arrives and gives it back once it replied, so in steady state
+  // contexts, and the buffers they keep, are reused instead of allocated.
+  // Callers reset whatever state they use.
+  template <typename T>
+  class RequestPool
+  {
+  public:
+    explicit RequestPool(size_t max_idle) : max_idle_(max_idle)
+    {
+      idle_.reserve(max_idle_);
+    }
+
+    RequestPool(const RequestPool &) = delete;
+    RequestPool &operator=(const RequestPool &) = delete;
+
+    // Returns an idle context, or a new one if none is idle. It must be
+    // given back with Release.
+    T *Acquire()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty())
+        {
+          T *context = idle_.back().release();
+          idle_.pop_back();
+          return context;
+        }
+      }
+      return new T();
+    }
+
+    // Keeps |context| for a later Acquire, or frees it if enough are idle.
+    void Release(T *context)
+    {
+      std::unique_ptr<T> owned(context);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (idle_.size() < max_idle_)
+      {
+        idle_.push_back(std::move(owned));
+      }
+    }
+
+  private:
+    const size_t max_idle_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<T>> idle_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_REQUEST_POOL_H_
@@ -0,0 +1,38 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_SHA256_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_SHA256_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace windows_store
+{
+
+  // Incremental SHA-256 (FIPS 180-4), used to name content-addressed files.
+  class Sha256
+  {
+  public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+
+    void Update(const void *data, size_t size);
+    // Only valid once; the hasher must not be updated afterwards.
+    Digest Finish();
+
+  private:
+    void Transform(const uint8_t *block);
+
+    std::array<uint32_t, 8> state_;
+    std::array<uint8_t, 64> block_{};
+    size_t block_size_ = 0;
+    uint64_t total_bytes_ = 0;
+  };
+
+  // Lowercase hex SHA-256 of |data|.
+  std::string Sha256Hex(const void *data, size_t size);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_SHA256_H_
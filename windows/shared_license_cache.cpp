@@ -0,0 +1,287 @@
+#include "shared_license_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "store_serialization.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr int kMaxReadAttempts = 64;
+    // Writers check that they still hold their claim before copying each
+    // part of this size.
+    constexpr size_t kWriteChunk = 4096;
+
+    int64_t UnixNowMs()
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    uint32_t SequenceOf(uint64_t state)
+    {
+      return static_cast<uint32_t>(state >> 32);
+    }
+
+    uint64_t MakeState(uint32_t sequence, uint32_t claimed_ms)
+    {
+      return (static_cast<uint64_t>(sequence) << 32) | claimed_ms;
+    }
+
+    void Fnv1a(uint64_t &hash, const void *data, size_t size)
+    {
+      const uint8_t *bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0; i < size; i++)
+      {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+      }
+    }
+
+  } // namespace
+
+  // static
+  std::unique_ptr<SharedLicenseCache> SharedLicenseCache::Open(const std::string &name,
+                                                               std::chrono::milliseconds stale_write_timeout)
+  {
+    std::unique_ptr<SharedMemoryRegion> region = SharedMemoryRegion::Open(name, sizeof(Layout));
+    if (!region)
+    {
+      return nullptr;
+    }
+    return std::make_unique<SharedLicenseCache>(std::move(region), stale_write_timeout);
+  }
+
+  SharedLicenseCache::SharedLicenseCache(std::unique_ptr<SharedMemoryRegion> region,
+                                         std::chrono::milliseconds stale_write_timeout)
+      : region_(std::move(region)), stale_write_timeout_(stale_write_timeout) {}
+
+  // static
+  uint64_t SharedLicenseCache::Checksum(uint32_t payload_size, int64_t published_unix_ms, const uint8_t *payload)
+  {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    Fnv1a(hash, &payload_size, sizeof(payload_size));
+    Fnv1a(hash, &published_unix_ms, sizeof(published_unix_ms));
+    Fnv1a(hash, payload, payload_size);
+    return hash;
+  }
+
+  std::optional<LicenseSnapshot> SharedLicenseCache::Read(std::chrono::milliseconds max_age) const
+  {
+    Layout *shared = layout();
+    std::vector<uint8_t> payload;
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++)
+    {
+      uint64_t state = shared->state.load(std::memory_order_acquire);
+      if (SequenceOf(state) % 2 != 0)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      // Everything read here may be torn by a concurrent writer; it is only
+      // used once the state proves it was not.
+      uint32_t magic = shared->magic;
+      uint16_t version = shared->version;
+      uint32_t payload_size = std::min<uint32_t>(shared->payload_size, kPayloadCapacity);
+      int64_t published_unix_ms = shared->published_unix_ms;
+      uint64_t checksum = shared->checksum;
+      payload.assign(shared->payload, shared->payload + payload_size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (shared->state.load(std::memory_order_relaxed) != state)
+      {
+        continue;
+      }
+
+      if (magic != kMagic || version != kLayoutVersion || published_unix_ms == 0 ||
+          UnixNowMs() - published_unix_ms >= max_age.count())
+      {
+        return std::nullopt;
+      }
+      // A writer that was taken over may have written after the new one
+      // released.
+      if (Checksum(payload_size, published_unix_ms, payload.data()) != checksum)
+      {
+        return std::nullopt;
+      }
+      ByteReader reader(payload.data(), payload.size());
+      LicenseSnapshot license = ReadLicenseSnapshot(reader);
+      if (!reader.ok())
+      {
+        return std::nullopt;
+      }
+      return license;
+    }
+    return std::nullopt;
+  }
+
+  bool SharedLicenseCache::Publish(const LicenseSnapshot &license)
+  {
+    ByteWriter writer;
+    WriteLicenseSnapshot(writer, license);
+    if (writer.size() > kPayloadCapacity)
+    {
+      return false;
+    }
+    uint32_t payload_size = static_cast<uint32_t>(writer.size());
+    std::optional<uint64_t> claim = Claim();
+    if (!claim)
+    {
+      return false;
+    }
+    Layout *shared = layout();
+    int64_t published_unix_ms = UnixNowMs();
+    for (size_t offset = 0; offset < writer.size(); offset += kWriteChunk)
+    {
+      if (!Holds(*claim))
+      {
+        return false;
+      }
+      std::memcpy(shared->payload + offset, writer.data() + offset, std::min(kWriteChunk, writer.size() - offset));
+    }
+    if (!Holds(*claim))
+    {
+      return false;
+    }
+    shared->magic = kMagic;
+    shared->version = kLayoutVersion;
+    shared->payload_size = payload_size;
+    shared->published_unix_ms = published_unix_ms;
+    shared->checksum = Checksum(payload_size, published_unix_ms, writer.data());
+    Release(*claim);
+    return true;
+  }
+
+  void SharedLicenseCache::Invalidate()
+  {
+    std::optional<uint64_t> claim = Claim();
+    if (!claim)
+    {
+      return;
+    }
+    if (Holds(*claim))
+    {
+      layout()->published_unix_ms = 0;
+    }
+    Release(*claim);
+  }
+
+  std::optional<uint64_t> SharedLicenseCache::Claim()
+  {
+    Layout *shared = layout();
+    uint64_t state = shared->state.load(std::memory_order_acquire);
+    while (true)
+    {
+      uint32_t sequence = SequenceOf(state);
+      // Only differences of the low 32 bits are used, which wrap every 49
+      // days.
+      uint32_t now_ms = static_cast<uint32_t>(UnixNowMs());
+      uint32_t claimed;
+      if (sequence % 2 == 0)
+      {
+        claimed = sequence + 1;
+      }
+      else if (now_ms - static_cast<uint32_t>(state) >= static_cast<uint64_t>(stale_write_timeout_.count()))
+      {
+        // The writer died mid-write, or is too slow. Bumping by two keeps
+        // the sequence odd, and the new state makes it give up.
+        claimed = sequence + 2;
+      }
+      else
+      {
+        return std::nullopt;
+      }
+      uint64_t claim = MakeState(claimed, now_ms);
+      if (shared->state.compare_exchange_weak(state, claim, std::memory_order_acq_rel))
+      {
+        std::atomic_thread_fence(std::memory_order_release);
+        return claim;
+      }
+    }
+  }
+
+  bool SharedLicenseCache::Holds(uint64_t claim) const
+  {
+    return layout()->state.load(std::memory_order_acquire) == claim;
+  }
+
+  void SharedLicenseCache::Release(uint64_t claim)
+  {
+    layout()->state.compare_exchange_strong(claim, MakeState(SequenceOf(claim) + 1, 0), std::memory_order_release,
+                                            std::memory_order_relaxed);
+  }
+
+  SharedLicenseBackend::SharedLicenseBackend(std::unique_ptr<StoreBackend> inner,
+                                             std::unique_ptr<SharedLicenseCache> cache,
+                                             std::chrono::milliseconds max_age)
+      : inner_(std::move(inner)), cache_(std::move(cache)), max_age_(max_age) {}
+
+  void SharedLicenseBackend::SetLicensesChangedHandler(std::function<void()> handler)
+  {
+    inner_->SetLicensesChangedHandler([this, handler]()
+                                      {
+      cache_->Invalidate();
+      if (handler)
+      {
+        handler();
+      } });
+  }
+
+  StoreResult<LicenseSnapshot> SharedLicenseBackend::GetAppLicense(uint64_t field_mask)
+  {
+    // The shared license never carries ExtendedJsonData.
+    if ((field_mask & ~kAllLicenseFields) != 0)
+    {
+      return inner_->GetAppLicense(field_mask);
+    }
+    if (std::optional<LicenseSnapshot> shared = cache_->Read(max_age_))
+    {
+      StoreResult<LicenseSnapshot> result;
+      result.value = std::move(*shared);
+      return result;
+    }
+    // The full license is fetched whatever |field_mask| is, so it can be
+    // shared with every other process.
+    StoreResult<LicenseSnapshot> result = inner_->GetAppLicense(kAllLicenseFields);
+    if (result.ok())
+    {
+      cache_->Publish(result.value);
+    }
+    return result;
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> SharedLicenseBackend::GetAssociatedStoreProducts(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    return inner_->GetAssociatedStoreProducts(product_kinds, field_mask);
+  }
+
+  StoreResult<ConsumableBalanceRecord> SharedLicenseBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+  {
+    return inner_->GetConsumableBalanceRemaining(store_id);
+  }
+
+  StoreResult<bool> SharedLicenseBackend::IsInUserCollection(const std::string &store_id)
+  {
+    return inner_->IsInUserCollection(store_id);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> SharedLicenseBackend::GetStoreProducts(
+      const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+      uint64_t field_mask)
+  {
+    return inner_->GetStoreProducts(product_kinds, store_ids, field_mask);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> SharedLicenseBackend::GetUserCollection(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    return inner_->GetUserCollection(product_kinds, field_mask);
+  }
+
+} // namespace windows_store
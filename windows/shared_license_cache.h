@@ -0,0 +1,132 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_SHARED_LICENSE_CACHE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_SHARED_LICENSE_CACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "license_snapshot.h"
+#include "shared_memory.h"
+#include "store_backend.h"
+
+namespace windows_store
+{
+
+  // License snapshot shared between the processes of an app, so only one of
+  // them calls the Store. Writers publish under a seqlock; readers copy the
+  // snapshot without locking and retry if the sequence number changed (or
+  // was odd, meaning a write was in progress) while they copied.
+  //
+  // The sequence number and the time of the claim share one 64-bit word, so
+  // a writer that died mid-write is taken over by exactly one process. A
+  // writer that was only slow checks the word before each part it writes and
+  // gives up once taken over; readers also verify a checksum, so whatever it
+  // wrote in between is never returned.
+  //
+  // Region layout:
+  //   u32 magic 'WSLC' | u16 layout version | u16 reserved
+  //   atomic u64 state: u32 sequence << 32 | u32 claim time, the low 32 bits
+  //                     of unix ms
+  //   u32 payload size | u32 padding
+  //   i64 published unix ms
+  //   u64 checksum: FNV-1a of the payload size, published time and payload
+  //   payload: license encoded by WriteLicenseSnapshot
+  class SharedLicenseCache
+  {
+  public:
+    static constexpr uint32_t kMagic = 0x434C5357; // 'WSLC'
+    static constexpr uint16_t kLayoutVersion = 3;
+    static constexpr size_t kPayloadCapacity = 64 * 1024;
+    // A write that has not finished after this long is assumed to belong to
+    // a process that died, and may be taken over.
+    static constexpr std::chrono::milliseconds kStaleWriteTimeout = std::chrono::seconds(5);
+
+    // Opens the cache region |name|, or returns nullptr if it cannot be
+    // mapped.
+    static std::unique_ptr<SharedLicenseCache> Open(const std::string &name,
+                                                    std::chrono::milliseconds stale_write_timeout = kStaleWriteTimeout);
+
+    explicit SharedLicenseCache(std::unique_ptr<SharedMemoryRegion> region,
+                                std::chrono::milliseconds stale_write_timeout = kStaleWriteTimeout);
+
+    // Returns the published license if it is younger than |max_age|.
+    std::optional<LicenseSnapshot> Read(std::chrono::milliseconds max_age) const;
+
+    // Publishes |license|. Returns false if another process is publishing
+    // or the license does not fit.
+    bool Publish(const LicenseSnapshot &license);
+
+    // Withdraws the published license, e.g. after licenses changed.
+    void Invalidate();
+
+  private:
+    struct Layout
+    {
+      uint32_t magic;
+      uint16_t version;
+      uint16_t reserved;
+      std::atomic<uint64_t> state;
+      uint32_t payload_size;
+      uint32_t padding;
+      int64_t published_unix_ms;
+      uint64_t checksum;
+      uint8_t payload[kPayloadCapacity];
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory atomics must be lock free");
+
+    static uint64_t Checksum(uint32_t payload_size, int64_t published_unix_ms, const uint8_t *payload);
+
+    // Claims the seqlock for writing. Returns the state word holding the
+    // claim, to check and release with, or nullopt if another live writer
+    // holds it.
+    std::optional<uint64_t> Claim();
+    // Whether |claim| was not taken over.
+    bool Holds(uint64_t claim) const;
+    void Release(uint64_t claim);
+
+    Layout *layout() const { return reinterpret_cast<Layout *>(region_->data()); }
+
+    std::unique_ptr<SharedMemoryRegion> region_;
+    const std::chrono::milliseconds stale_write_timeout_;
+  };
+
+  // StoreBackend decorator answering license queries from a
+  // SharedLicenseCache while its license is younger than |max_age|, and
+  // publishing the licenses it fetches through |inner|.
+  class SharedLicenseBackend : public StoreBackend
+  {
+  public:
+    SharedLicenseBackend(std::unique_ptr<StoreBackend> inner, std::unique_ptr<SharedLicenseCache> cache,
+                         std::chrono::milliseconds max_age);
+    virtual ~SharedLicenseBackend() {}
+
+    bool RequiresPackageIdentity() const override { return inner_->RequiresPackageIdentity(); }
+    void SetLicensesChangedHandler(std::function<void()> handler) override;
+    void WarmUp() override { inner_->WarmUp(); }
+
+    StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+    StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+    StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+    StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+  private:
+    std::unique_ptr<StoreBackend> inner_;
+    std::unique_ptr<SharedLicenseCache> cache_;
+    std::chrono::milliseconds max_age_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_SHARED_LICENSE_CACHE_H_
@@ -0,0 +1,90 @@
+#include "shared_memory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace windows_store
+{
+
+#ifdef _WIN32
+
+  // static
+  std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::Open(const std::string &name, size_t size)
+  {
+    int length = MultiByteToWideChar(CP_UTF8, 0, name.data(), static_cast<int>(name.size()), nullptr, 0);
+    std::wstring wide_name(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, name.data(), static_cast<int>(name.size()), wide_name.data(), length);
+
+    uint64_t mapping_size = size;
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(mapping_size >> 32), static_cast<DWORD>(mapping_size),
+                                        wide_name.c_str());
+    if (mapping == nullptr)
+    {
+      return nullptr;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr)
+    {
+      CloseHandle(mapping);
+      return nullptr;
+    }
+    return std::unique_ptr<SharedMemoryRegion>(new SharedMemoryRegion(mapping, static_cast<uint8_t *>(view), size));
+  }
+
+  // static
+  void SharedMemoryRegion::Unlink(const std::string &name) {}
+
+  SharedMemoryRegion::~SharedMemoryRegion()
+  {
+    UnmapViewOfFile(data_);
+    CloseHandle(handle_);
+  }
+
+#else
+
+  // static
+  std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::Open(const std::string &name, size_t size)
+  {
+    std::string path = "/" + name;
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+    {
+      return nullptr;
+    }
+    // Growing a new region zero-fills it; an existing one keeps its content.
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (static_cast<size_t>(info.st_size) < size && ftruncate(fd, size) != 0))
+    {
+      close(fd);
+      return nullptr;
+    }
+    void *view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+      return nullptr;
+    }
+    return std::unique_ptr<SharedMemoryRegion>(new SharedMemoryRegion(nullptr, static_cast<uint8_t *>(view), size));
+  }
+
+  // static
+  void SharedMemoryRegion::Unlink(const std::string &name)
+  {
+    shm_unlink(("/" + name).c_str());
+  }
+
+  SharedMemoryRegion::~SharedMemoryRegion()
+  {
+    munmap(data_, size_);
+  }
+
+#endif
+
+} // namespace windows_store
@@ -0,0 +1,46 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_SHARED_MEMORY_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_SHARED_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace windows_store
+{
+
+  // Named memory region shared between processes: a file mapping on Windows,
+  // POSIX shared memory elsewhere. A region that did not exist yet is
+  // zero-filled.
+  class SharedMemoryRegion
+  {
+  public:
+    // Opens or creates the region |name| of |size| bytes. Returns nullptr on
+    // failure.
+    static std::unique_ptr<SharedMemoryRegion> Open(const std::string &name, size_t size);
+
+    // Removes |name| so the next Open creates a new region. Does nothing on
+    // Windows, where the mapping lives as long as a process has it open.
+    static void Unlink(const std::string &name);
+
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion &) = delete;
+    SharedMemoryRegion &operator=(const SharedMemoryRegion &) = delete;
+
+    uint8_t *data() const { return data_; }
+    size_t size() const { return size_; }
+
+  private:
+    SharedMemoryRegion(void *handle, uint8_t *data, size_t size)
+        : handle_(handle), data_(data), size_(size) {}
+
+    // File mapping handle on Windows, unused elsewhere.
+    void *handle_;
+    uint8_t *data_;
+    size_t size_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_SHARED_MEMORY_H_
@@ -0,0 +1,109 @@
+#include "store_availability.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE)
+    constexpr int32_t kNoPackageHResult = static_cast<int32_t>(0x80073D54);
+    // REGDB_E_CLASSNOTREG, Windows.Services.Store is not available on this SKU.
+    constexpr int32_t kClassNotRegisteredHResult = static_cast<int32_t>(0x80040154);
+    // The app is not associated with an app in the Microsoft Store.
+    constexpr int32_t kNotAssociatedHResult = static_cast<int32_t>(0x803F6107);
+
+  } // namespace
+
+  bool IsPermanentStoreError(int32_t hresult)
+  {
+    switch (hresult)
+    {
+    case kNoPackageHResult:
+    case kClassNotRegisteredHResult:
+    case kNotAssociatedHResult:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  StoreAvailability::StoreAvailability(bool has_package_identity)
+      : has_package_identity_(has_package_identity) {}
+
+  void StoreAvailability::SetSimulatedLicense(const StoreAppLicenseInner *license)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (license == nullptr)
+    {
+      simulated_license_.reset();
+    }
+    else
+    {
+      simulated_license_ = *license;
+    }
+  }
+
+  StoreAvailability::Decision StoreAvailability::Decide() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return DecideLocked();
+  }
+
+  std::optional<ErrorOr<StoreAppLicenseInner>> StoreAvailability::ShortCircuitLicense() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (DecideLocked())
+    {
+    case Decision::kSimulate:
+      return ErrorOr<StoreAppLicenseInner>(*simulated_license_);
+    case Decision::kFailFast:
+      return ErrorOr<StoreAppLicenseInner>(FailFastErrorLocked());
+    default:
+      return std::nullopt;
+    }
+  }
+
+  std::optional<FlutterError> StoreAvailability::ShortCircuitError() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (has_package_identity_ && !permanent_error_)
+    {
+      return std::nullopt;
+    }
+    return FailFastErrorLocked();
+  }
+
+  StoreAvailability::Decision StoreAvailability::DecideLocked() const
+  {
+    if (has_package_identity_ && !permanent_error_)
+    {
+      return Decision::kCallStore;
+    }
+    return simulated_license_ ? Decision::kSimulate : Decision::kFailFast;
+  }
+
+  FlutterError StoreAvailability::FailFastErrorLocked() const
+  {
+    if (permanent_error_)
+    {
+      return *permanent_error_;
+    }
+    return FlutterError(kNoPackageIdentityErrorCode,
+                        "The app has no package identity. Run it as a packaged (MSIX) app to query the Microsoft Store.");
+  }
+
+  void StoreAvailability::RecordFailure(int32_t hresult, const std::string &message)
+  {
+    if (!IsPermanentStoreError(hresult))
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!permanent_error_)
+    {
+      permanent_error_ = FlutterError(std::to_string(hresult), message);
+    }
+  }
+
+} // namespace windows_store
@@ -0,0 +1,68 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_AVAILABILITY_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_AVAILABILITY_H_
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "pigeon/messages.g.h"
+
+namespace windows_store
+{
+
+  // Error code returned without calling the Store when the app runs without
+  // package identity (unpackaged dev builds, CI, sideload tests).
+  constexpr char kNoPackageIdentityErrorCode[] = "no-package-identity";
+
+  // Returns true for Store HRESULTs that will not go away by retrying within
+  // the same process, such as a missing package identity or an app that is
+  // not associated with a Store listing.
+  bool IsPermanentStoreError(int32_t hresult);
+
+  // Decides whether a Store call is worth making. The package identity is
+  // checked once at registration and permanent Store errors are remembered,
+  // so unpackaged runs answer immediately instead of paying for a WinRT call
+  // that is known to throw.
+  class StoreAvailability
+  {
+  public:
+    enum class Decision
+    {
+      kCallStore,
+      kFailFast,
+      kSimulate,
+    };
+
+    explicit StoreAvailability(bool has_package_identity);
+
+    // The license returned instead of an error while the Store is
+    // unavailable. Pass nullptr to go back to failing fast.
+    void SetSimulatedLicense(const StoreAppLicenseInner *license);
+
+    Decision Decide() const;
+
+    // Returns the reply for a license request that must not reach the Store
+    // (the simulated license or the fail-fast error), or nullopt when the
+    // Store should be called.
+    std::optional<ErrorOr<StoreAppLicenseInner>> ShortCircuitLicense() const;
+
+    // Same as ShortCircuitLicense for requests that have nothing to simulate.
+    std::optional<FlutterError> ShortCircuitError() const;
+
+    // Records a failed Store call. Permanent errors disable further calls.
+    void RecordFailure(int32_t hresult, const std::string &message);
+
+  private:
+    Decision DecideLocked() const;
+    FlutterError FailFastErrorLocked() const;
+
+    mutable std::mutex mutex_;
+    bool has_package_identity_;
+    std::optional<FlutterError> permanent_error_;
+    std::optional<StoreAppLicenseInner> simulated_license_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_AVAILABILITY_H_
@@ -0,0 +1,91 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_BACKEND_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_BACKEND_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "license_snapshot.h"
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  // Store calls made through a StoreBackend, as identified in traces.
+  enum class StoreApi : uint8_t
+  {
+    kGetAppLicense = 1,
+    kGetAssociatedStoreProducts = 2,
+    kGetConsumableBalanceRemaining = 3,
+    kIsInUserCollection = 4,
+    kGetStoreProducts = 5,
+    kGetUserCollection = 6,
+  };
+
+  // Outcome of a blocking Store call. |hresult| follows HRESULT conventions:
+  // negative values are failures described by |message|.
+  template <typename T>
+  struct StoreResult
+  {
+    int32_t hresult = 0;
+    std::string message;
+    T value{};
+
+    bool ok() const { return hresult >= 0; }
+
+    static StoreResult Failure(int32_t hresult, std::string message)
+    {
+      StoreResult result;
+      result.hresult = hresult;
+      result.message = std::move(message);
+      return result;
+    }
+  };
+
+  // The Store calls the plugin makes. Calls block and are only made off the
+  // platform thread. WinRtStoreBackend talks to the Microsoft Store; other
+  // implementations record or replay those calls.
+  class StoreBackend
+  {
+  public:
+    StoreBackend(const StoreBackend &) = delete;
+    StoreBackend &operator=(const StoreBackend &) = delete;
+    virtual ~StoreBackend() {}
+
+    // Whether calls fail without package identity. Backends that do not talk
+    // to the Store return false so they keep working in unpackaged runs.
+    virtual bool RequiresPackageIdentity() const { return true; }
+
+    // Sets the handler invoked when the Store reports that licenses changed.
+    // Must be called before the first Store call.
+    virtual void SetLicensesChangedHandler(std::function<void()> handler) {}
+
+    // Starts the Store session ahead of the first call, so that call does
+    // not pay for it. Blocks; failures are left for the first call to report.
+    virtual void WarmUp() {}
+
+    // Only the fields in |field_mask| (LicenseField and ProductField bits)
+    // are read and converted; the others are left empty.
+    virtual StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) = 0;
+    virtual StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) = 0;
+    virtual StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) = 0;
+    // Whether the current user owns the product |store_id|.
+    virtual StoreResult<bool> IsInUserCollection(const std::string &store_id) = 0;
+    // The products of |product_kinds| among |store_ids|. IDs that match no
+    // product are left out of the result rather than failing the call.
+    virtual StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) = 0;
+    // The products of |product_kinds| the current user owns.
+    virtual StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) = 0;
+
+  protected:
+    StoreBackend() = default;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_BACKEND_H_
@@ -0,0 +1,224 @@
+#include "store_cache.h"
+
+#include <iterator>
+#include <utility>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // Longest string kept inside std::string itself by MSVC and libstdc++.
+    constexpr size_t kInlineStringCapacity = 15;
+
+    size_t HeapBytes(const std::string &value)
+    {
+      return value.capacity() > kInlineStringCapacity ? value.capacity() + 1 : 0;
+    }
+
+  } // namespace
+
+  StoreCache::StoreCache(size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+  // static
+  size_t StoreCache::ByteSize(const StoreProductRecord &product)
+  {
+    size_t bytes = sizeof(StoreProductRecord) +
+                   HeapBytes(product.store_id) +
+                   HeapBytes(product.product_kind) +
+                   HeapBytes(product.title) +
+                   HeapBytes(product.description) +
+                   HeapBytes(product.formatted_price) +
+                   HeapBytes(product.formatted_base_price) +
+                   HeapBytes(product.currency_code) +
+                   HeapBytes(product.in_app_offer_token) +
+                   HeapBytes(product.link_uri) +
+                   HeapBytes(product.extended_json_data) +
+                   product.images.capacity() * sizeof(StoreImageRecord);
+    for (const StoreImageRecord &image : product.images)
+    {
+      bytes += HeapBytes(image.uri) + HeapBytes(image.purpose_tag);
+    }
+    return bytes;
+  }
+
+  // static
+  size_t StoreCache::ByteSize(const LicenseSnapshot &license)
+  {
+    size_t bytes = sizeof(LicenseSnapshot) +
+                   HeapBytes(license.sku_store_id) +
+                   HeapBytes(license.trial_unique_id) +
+                   HeapBytes(license.extended_json_data) +
+                   license.add_ons.capacity() * sizeof(AddOnLicenseRecord);
+    for (const AddOnLicenseRecord &add_on : license.add_ons)
+    {
+      bytes += HeapBytes(add_on.sku_store_id) + HeapBytes(add_on.in_app_offer_token);
+    }
+    return bytes;
+  }
+
+  std::shared_ptr<const StoreProductRecord> StoreCache::GetProduct(std::string_view store_id, uint64_t field_mask)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(store_id);
+    if (found == index_.end() || (found->second->field_mask & field_mask) != field_mask)
+    {
+      misses_++;
+      return nullptr;
+    }
+    hits_++;
+    Segment::iterator entry = found->second;
+    if (entry->is_protected)
+    {
+      protected_.splice(protected_.begin(), protected_, entry);
+    }
+    else
+    {
+      // A second hit: the product is in regular use.
+      entry->is_protected = true;
+      probation_bytes_ -= entry->bytes;
+      protected_bytes_ += entry->bytes;
+      protected_.splice(protected_.begin(), probation_, entry);
+      DemoteOverflow();
+    }
+    return entry->product;
+  }
+
+  void StoreCache::PutProduct(std::shared_ptr<const StoreProductRecord> product, uint64_t field_mask)
+  {
+    if (!product)
+    {
+      return;
+    }
+    // The list links, the index node with its bucket, and the shared_ptr
+    // control block.
+    constexpr size_t kEntryOverhead = sizeof(Entry) + 2 * sizeof(void *) +
+                                      sizeof(std::pair<const std::string_view, Segment::iterator>) +
+                                      3 * sizeof(void *) + 2 * sizeof(void *);
+    size_t bytes = ByteSize(*product) + kEntryOverhead;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool is_protected = false;
+    auto found = index_.find(product->store_id);
+    if (found != index_.end())
+    {
+      if ((found->second->field_mask & field_mask) == field_mask)
+      {
+        return;
+      }
+      // Refetched with other fields; it keeps its segment.
+      is_protected = found->second->is_protected;
+      Erase(found->second);
+    }
+    if (bytes + license_bytes_ > budget_bytes_)
+    {
+      return;
+    }
+    Segment &segment = is_protected ? protected_ : probation_;
+    segment.push_front(Entry{std::move(product), field_mask, bytes, is_protected});
+    index_.emplace(segment.front().product->store_id, segment.begin());
+    if (is_protected)
+    {
+      protected_bytes_ += bytes;
+      DemoteOverflow();
+    }
+    else
+    {
+      probation_bytes_ += bytes;
+    }
+    EvictOverflow();
+  }
+
+  void StoreCache::InvalidateProducts()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    probation_.clear();
+    protected_.clear();
+    probation_bytes_ = 0;
+    protected_bytes_ = 0;
+  }
+
+  void StoreCache::PinLicense(std::shared_ptr<const LicenseSnapshot> license)
+  {
+    size_t bytes = license ? ByteSize(*license) : 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    license_ = std::move(license);
+    license_bytes_ = bytes;
+    EvictOverflow();
+  }
+
+  void StoreCache::SetBudget(size_t budget_bytes)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_bytes_ = budget_bytes;
+    DemoteOverflow();
+    EvictOverflow();
+  }
+
+  StoreCache::Stats StoreCache::GetStats() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = index_.size();
+    stats.bytes = probation_bytes_ + protected_bytes_ + license_bytes_;
+    stats.pinned_bytes = license_bytes_;
+    stats.protected_bytes = protected_bytes_;
+    stats.budget_bytes = budget_bytes_;
+    return stats;
+  }
+
+  void StoreCache::Erase(Segment::iterator it)
+  {
+    index_.erase(it->product->store_id);
+    if (it->is_protected)
+    {
+      protected_bytes_ -= it->bytes;
+      protected_.erase(it);
+    }
+    else
+    {
+      probation_bytes_ -= it->bytes;
+      probation_.erase(it);
+    }
+  }
+
+  void StoreCache::DemoteOverflow()
+  {
+    size_t protected_budget = budget_bytes_ / 100 * kProtectedShare;
+    while (protected_bytes_ > protected_budget && !protected_.empty())
+    {
+      Segment::iterator oldest = std::prev(protected_.end());
+      oldest->is_protected = false;
+      protected_bytes_ -= oldest->bytes;
+      probation_bytes_ += oldest->bytes;
+      probation_.splice(probation_.begin(), protected_, oldest);
+    }
+  }
+
+  void StoreCache::EvictOverflow()
+  {
+    while (probation_bytes_ + protected_bytes_ + license_bytes_ > budget_bytes_)
+    {
+      if (!probation_.empty())
+      {
+        Erase(std::prev(probation_.end()));
+      }
+      else if (!protected_.empty())
+      {
+        Erase(std::prev(protected_.end()));
+      }
+      else
+      {
+        // Only the pinned license is left.
+        break;
+      }
+      evictions_++;
+    }
+  }
+
+} // namespace windows_store
@@ -0,0 +1,118 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_CACHE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "license_snapshot.h"
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  // Native cache of Store data with a memory budget, for long-running apps
+  // such as kiosks. Each entry is charged its approximate heap usage
+  // (strings, ExtendedJsonData, URIs and bookkeeping), and entries are
+  // evicted by segmented LRU once the total exceeds the budget: products
+  // start in a probation segment and move to a protected one, capped at
+  // kProtectedShare of the budget, when they are hit again, so a single
+  // pass over the catalog does not flush the products in regular use.
+  //
+  // The current app license is pinned: it is charged against the budget but
+  // never evicted.
+  class StoreCache
+  {
+  public:
+    static constexpr size_t kDefaultBudgetBytes = 16 * 1024 * 1024;
+    // Protected segment share of the budget, in percent.
+    static constexpr size_t kProtectedShare = 80;
+
+    struct Stats
+    {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t evictions = 0;
+      size_t entries = 0;
+      // Charged bytes, including the pinned license.
+      size_t bytes = 0;
+      size_t pinned_bytes = 0;
+      size_t protected_bytes = 0;
+      size_t budget_bytes = 0;
+    };
+
+    explicit StoreCache(size_t budget_bytes = kDefaultBudgetBytes);
+
+    StoreCache(const StoreCache &) = delete;
+    StoreCache &operator=(const StoreCache &) = delete;
+
+    // The product |store_id| if it is cached with all fields of
+    // |field_mask|, or nullptr, which counts as a miss.
+    std::shared_ptr<const StoreProductRecord> GetProduct(std::string_view store_id, uint64_t field_mask);
+
+    // Caches |product|, which holds the fields of |field_mask|, unless it is
+    // cached with all of them already. Products larger than the budget are
+    // not cached.
+    void PutProduct(std::shared_ptr<const StoreProductRecord> product, uint64_t field_mask);
+
+    // Drops all products, e.g. after licenses changed, since ownership is
+    // part of them.
+    void InvalidateProducts();
+
+    // Replaces the pinned license, evicting products to make room for it.
+    void PinLicense(std::shared_ptr<const LicenseSnapshot> license);
+
+    // Evicts products right away if the cache is over the new budget.
+    void SetBudget(size_t budget_bytes);
+
+    Stats GetStats() const;
+
+    // Approximate heap usage of a record, including its own size.
+    static size_t ByteSize(const StoreProductRecord &product);
+    static size_t ByteSize(const LicenseSnapshot &license);
+
+  private:
+    struct Entry
+    {
+      std::shared_ptr<const StoreProductRecord> product;
+      uint64_t field_mask = 0;
+      size_t bytes = 0;
+      bool is_protected = false;
+    };
+
+    // Most recently used first.
+    using Segment = std::list<Entry>;
+
+    // Removes |it| from its segment and the index. Requires |mutex_|.
+    void Erase(Segment::iterator it);
+    // Moves protected entries to probation until the protected segment fits
+    // its share. Requires |mutex_|.
+    void DemoteOverflow();
+    // Evicts least recently used products, probation first, until the cache
+    // fits its budget. Requires |mutex_|.
+    void EvictOverflow();
+
+    mutable std::mutex mutex_;
+    size_t budget_bytes_;
+    Segment probation_;
+    Segment protected_;
+    size_t probation_bytes_ = 0;
+    size_t protected_bytes_ = 0;
+    // Keys view the Store ID of the entry's product, which lives as long as
+    // the entry.
+    std::unordered_map<std::string_view, Segment::iterator> index_;
+    std::shared_ptr<const LicenseSnapshot> license_;
+    size_t license_bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_CACHE_H_
@@ -0,0 +1,30 @@
+#include "store_events.h"
+
+#include <utility>
+#include <vector>
+
+namespace windows_store
+{
+
+  // static
+  ByteWriter StoreEventChannel::Begin(EventType type)
+  {
+    ByteWriter writer;
+    writer.WriteU8(type);
+    writer.Align(kHeaderSize);
+    return writer;
+  }
+
+  void StoreEventChannel::Send(const ByteWriter &event) const
+  {
+    if (!post_to_platform_thread_)
+    {
+      binary_messenger_->Send(kChannelName, event.data(), event.size());
+      return;
+    }
+    post_to_platform_thread_([binary_messenger = binary_messenger_,
+                              bytes = std::vector<uint8_t>(event.data(), event.data() + event.size())]()
+                             { binary_messenger->Send(kChannelName, bytes.data(), bytes.size()); });
+  }
+
+} // namespace windows_store
@@ -0,0 +1,60 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_EVENTS_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_EVENTS_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "byte_buffer.h"
+
+namespace windows_store
+{
+
+  // Raw-bytes channel for messages the plugin sends to Dart unprompted, such
+  // as streamed batch results.
+  //
+  // Event: u8 EventType | 7 bytes padding | body
+  class StoreEventChannel
+  {
+  public:
+    static constexpr char kChannelName[] = "dev.flutter.windows_store.events";
+    static constexpr size_t kHeaderSize = 8;
+
+    enum EventType : uint8_t
+    {
+      // u32 stream id | u32 item index | single row batch result table
+      kBatchItem = 1,
+      // Body of EncodeCollectionDelta (see collection_sync.h)
+      kCollectionDelta = 2,
+    };
+
+    // Runs a task on the platform thread, the only thread the messenger may
+    // be used from.
+    using PlatformThreadPoster = std::function<void(std::function<void()> task)>;
+
+    // Events are sent through |post_to_platform_thread|, or on the thread
+    // calling Send if it is empty.
+    StoreEventChannel(flutter::BinaryMessenger *binary_messenger, PlatformThreadPoster post_to_platform_thread)
+        : binary_messenger_(binary_messenger), post_to_platform_thread_(std::move(post_to_platform_thread)) {}
+
+    StoreEventChannel(const StoreEventChannel &) = delete;
+    StoreEventChannel &operator=(const StoreEventChannel &) = delete;
+
+    // Returns a writer holding the header of an event of |type|, for the
+    // caller to append the body to.
+    static ByteWriter Begin(EventType type);
+
+    // May be called from any thread. Events sent from one thread arrive in
+    // the order sent.
+    void Send(const ByteWriter &event) const;
+
+  private:
+    flutter::BinaryMessenger *binary_messenger_;
+    PlatformThreadPoster post_to_platform_thread_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_EVENTS_H_
@@ -0,0 +1,100 @@
+#include "store_product.h"
+
+#include "byte_buffer.h"
+#include "columnar_writer.h"
+#include "extended_json.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    template <typename Getter>
+    void WriteStringColumn(ColumnarWriter &writer, uint64_t field_mask, ProductField field,
+                           const std::vector<StoreProductRecord> &products, Getter get)
+    {
+      if ((field_mask & ProductFieldBit(field)) == 0)
+      {
+        return;
+      }
+      writer.BeginColumn(static_cast<uint16_t>(field), ColumnType::kString);
+      for (const StoreProductRecord &product : products)
+      {
+        writer.AppendString(get(product));
+      }
+    }
+
+    template <typename Getter>
+    void WriteBoolColumn(ColumnarWriter &writer, uint64_t field_mask, ProductField field,
+                         const std::vector<StoreProductRecord> &products, Getter get)
+    {
+      if ((field_mask & ProductFieldBit(field)) == 0)
+      {
+        return;
+      }
+      writer.BeginColumn(static_cast<uint16_t>(field), ColumnType::kBool);
+      for (const StoreProductRecord &product : products)
+      {
+        writer.AppendBool(get(product));
+      }
+    }
+
+    void WriteProductColumns(ColumnarWriter &writer, const std::vector<StoreProductRecord> &products,
+                             uint64_t field_mask)
+    {
+      WriteStringColumn(writer, field_mask, ProductField::kStoreId, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.store_id; });
+      WriteStringColumn(writer, field_mask, ProductField::kProductKind, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.product_kind; });
+      WriteStringColumn(writer, field_mask, ProductField::kTitle, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.title; });
+      WriteStringColumn(writer, field_mask, ProductField::kDescription, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.description; });
+      WriteStringColumn(writer, field_mask, ProductField::kFormattedPrice, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.formatted_price; });
+      WriteStringColumn(writer, field_mask, ProductField::kFormattedBasePrice, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.formatted_base_price; });
+      WriteStringColumn(writer, field_mask, ProductField::kCurrencyCode, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.currency_code; });
+      WriteBoolColumn(writer, field_mask, ProductField::kIsInUserCollection, products,
+                      [](const StoreProductRecord &p) { return p.is_in_user_collection; });
+      WriteBoolColumn(writer, field_mask, ProductField::kHasDigitalDownload, products,
+                      [](const StoreProductRecord &p) { return p.has_digital_download; });
+      WriteStringColumn(writer, field_mask, ProductField::kInAppOfferToken, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.in_app_offer_token; });
+      WriteStringColumn(writer, field_mask, ProductField::kLinkUri, products,
+                        [](const StoreProductRecord &p) -> const std::string & { return p.link_uri; });
+    }
+
+  } // namespace
+
+  void EncodeStoreProducts(const std::vector<StoreProductRecord> &products, uint64_t field_mask,
+                           ByteWriter &out)
+  {
+    ColumnarWriter writer(static_cast<uint32_t>(products.size()));
+    WriteProductColumns(writer, products, field_mask);
+    writer.Finish(out);
+  }
+
+  void EncodeStoreProducts(const std::vector<StoreProductRecord> &products, uint64_t field_mask,
+                           const JsonExtractor &extended_fields, ColumnarWriter &table, ByteWriter &out)
+  {
+    table.Reset(static_cast<uint32_t>(products.size()));
+    WriteProductColumns(table, products, field_mask);
+    if (extended_fields.field_count() == 0)
+    {
+      table.Finish(out);
+      return;
+    }
+    std::vector<std::string_view> documents;
+    documents.reserve(products.size());
+    for (const StoreProductRecord &product : products)
+    {
+      documents.push_back(product.extended_json_data);
+    }
+    AppendExtendedJsonColumns(extended_fields, documents, table);
+    table.Finish(out);
+  }
+
+} // namespace windows_store
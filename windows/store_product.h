@@ -0,0 +1,133 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_PRODUCT_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_PRODUCT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json_extractor.h"
+
+namespace windows_store
+{
+
+  // Field ids of product columns on the bulk channel. Must match
+  // StoreProductField in lib/windows_store.dart.
+  enum class ProductField : uint16_t
+  {
+    kStoreId = 0,
+    kProductKind = 1,
+    kTitle = 2,
+    kDescription = 3,
+    kFormattedPrice = 4,
+    kFormattedBasePrice = 5,
+    kCurrencyCode = 6,
+    kIsInUserCollection = 7,
+    kHasDigitalDownload = 8,
+    kInAppOfferToken = 9,
+    kLinkUri = 10,
+    // Not a column; controls whether ExtendedJsonData is read for the
+    // extended fields of the query (see extended_json.h).
+    kExtendedJsonData = 11,
+    // Not a column; controls whether Images are read, for the image cache
+    // (see image_cache.h).
+    kImages = 12,
+  };
+
+  constexpr uint64_t ProductFieldBit(ProductField field)
+  {
+    return uint64_t{1} << static_cast<uint16_t>(field);
+  }
+
+  constexpr uint64_t kAllProductFields = (uint64_t{1} << 11) - 1;
+
+  // Plain copy of a StoreImage from StoreProduct::Images.
+  struct StoreImageRecord
+  {
+    std::string uri;
+    // For example "Logo", "Tile" or "Screenshot".
+    std::string purpose_tag;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool operator==(const StoreImageRecord &other) const
+    {
+      return uri == other.uri &&
+             purpose_tag == other.purpose_tag &&
+             width == other.width &&
+             height == other.height;
+    }
+    bool operator!=(const StoreImageRecord &other) const { return !(*this == other); }
+  };
+
+  // Plain copy of the StoreProduct properties the plugin forwards to Dart.
+  // Fields outside the field mask of the query that produced it are left
+  // empty.
+  struct StoreProductRecord
+  {
+    std::string store_id;
+    std::string product_kind;
+    std::string title;
+    std::string description;
+    std::string formatted_price;
+    std::string formatted_base_price;
+    std::string currency_code;
+    bool is_in_user_collection = false;
+    bool has_digital_download = false;
+    std::string in_app_offer_token;
+    std::string link_uri;
+    std::string extended_json_data;
+    std::vector<StoreImageRecord> images;
+
+    bool operator==(const StoreProductRecord &other) const
+    {
+      return store_id == other.store_id &&
+             product_kind == other.product_kind &&
+             title == other.title &&
+             description == other.description &&
+             formatted_price == other.formatted_price &&
+             formatted_base_price == other.formatted_base_price &&
+             currency_code == other.currency_code &&
+             is_in_user_collection == other.is_in_user_collection &&
+             has_digital_download == other.has_digital_download &&
+             in_app_offer_token == other.in_app_offer_token &&
+             link_uri == other.link_uri &&
+             extended_json_data == other.extended_json_data &&
+             images == other.images;
+    }
+    bool operator!=(const StoreProductRecord &other) const { return !(*this == other); }
+  };
+
+  // Result of StoreContext::GetConsumableBalanceRemainingAsync.
+  struct ConsumableBalanceRecord
+  {
+    // Values of StoreConsumableStatus.
+    enum Status : uint8_t
+    {
+      kSucceeded = 0,
+      kInsufficientQuantity = 1,
+      kNetworkError = 2,
+      kServerError = 3,
+    };
+
+    uint8_t status = kSucceeded;
+    uint32_t balance_remaining = 0;
+    std::string tracking_id;
+  };
+
+  class ByteWriter;
+  class ColumnarWriter;
+
+  // Appends |products| to |writer| as a columnar table, with one column per
+  // ProductField in |field_mask|.
+  void EncodeStoreProducts(const std::vector<StoreProductRecord> &products, uint64_t field_mask,
+                           ByteWriter &writer);
+
+  // As above, followed by the columns of |extended_fields| extracted from the
+  // ExtendedJsonData of every product. The table is built in |table|, which
+  // is reset first, so callers encoding repeatedly can keep its buffers.
+  void EncodeStoreProducts(const std::vector<StoreProductRecord> &products, uint64_t field_mask,
+                           const JsonExtractor &extended_fields, ColumnarWriter &table, ByteWriter &writer);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_PRODUCT_H_
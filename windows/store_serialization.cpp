@@ -0,0 +1,221 @@
+#include "store_serialization.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // Every encoded element takes at least this many bytes, which bounds
+    // the element count a well-formed input can claim.
+    constexpr size_t kMinElementSize = 4;
+
+    uint32_t ReadCount(ByteReader &reader)
+    {
+      uint32_t count = reader.ReadU32();
+      if (count > reader.remaining() / kMinElementSize)
+      {
+        reader.Invalidate();
+        return 0;
+      }
+      return count;
+    }
+
+  } // namespace
+
+  void WriteLicenseSnapshot(ByteWriter &writer, const LicenseSnapshot &license)
+  {
+    writer.WriteU8(license.is_active ? 1 : 0);
+    writer.WriteU8(license.is_trial ? 1 : 0);
+    writer.WriteString(license.sku_store_id);
+    writer.WriteString(license.trial_unique_id);
+    writer.WriteI64(license.trial_time_remaining_ms);
+    writer.WriteU32(static_cast<uint32_t>(license.add_ons.size()));
+    for (const AddOnLicenseRecord &add_on : license.add_ons)
+    {
+      writer.WriteString(add_on.sku_store_id);
+      writer.WriteString(add_on.in_app_offer_token);
+      writer.WriteU8(add_on.is_active ? 1 : 0);
+      writer.WriteI64(add_on.expiration_ms);
+    }
+    writer.WriteString(license.extended_json_data);
+  }
+
+  LicenseSnapshot ReadLicenseSnapshot(ByteReader &reader, uint16_t format)
+  {
+    LicenseSnapshot license;
+    license.is_active = reader.ReadU8() != 0;
+    license.is_trial = reader.ReadU8() != 0;
+    license.sku_store_id = reader.ReadString();
+    license.trial_unique_id = reader.ReadString();
+    license.trial_time_remaining_ms = reader.ReadI64();
+    uint32_t count = ReadCount(reader);
+    for (uint32_t i = 0; i < count && reader.ok(); i++)
+    {
+      AddOnLicenseRecord add_on;
+      add_on.sku_store_id = reader.ReadString();
+      add_on.in_app_offer_token = reader.ReadString();
+      add_on.is_active = reader.ReadU8() != 0;
+      add_on.expiration_ms = reader.ReadI64();
+      license.add_ons.push_back(std::move(add_on));
+    }
+    if (format >= kRecordFormatExtendedJson)
+    {
+      license.extended_json_data = reader.ReadString();
+    }
+    return license;
+  }
+
+  void WriteStoreProductRecord(ByteWriter &writer, const StoreProductRecord &product)
+  {
+    writer.WriteString(product.store_id);
+    writer.WriteString(product.product_kind);
+    writer.WriteString(product.title);
+    writer.WriteString(product.description);
+    writer.WriteString(product.formatted_price);
+    writer.WriteString(product.formatted_base_price);
+    writer.WriteString(product.currency_code);
+    writer.WriteU8(product.is_in_user_collection ? 1 : 0);
+    writer.WriteU8(product.has_digital_download ? 1 : 0);
+    writer.WriteString(product.in_app_offer_token);
+    writer.WriteString(product.link_uri);
+    writer.WriteString(product.extended_json_data);
+    writer.WriteU32(static_cast<uint32_t>(product.images.size()));
+    for (const StoreImageRecord &image : product.images)
+    {
+      writer.WriteString(image.uri);
+      writer.WriteString(image.purpose_tag);
+      writer.WriteU32(image.width);
+      writer.WriteU32(image.height);
+    }
+  }
+
+  StoreProductRecord ReadStoreProductRecord(ByteReader &reader, uint16_t format)
+  {
+    StoreProductRecord product;
+    product.store_id = reader.ReadString();
+    product.product_kind = reader.ReadString();
+    product.title = reader.ReadString();
+    product.description = reader.ReadString();
+    product.formatted_price = reader.ReadString();
+    product.formatted_base_price = reader.ReadString();
+    product.currency_code = reader.ReadString();
+    product.is_in_user_collection = reader.ReadU8() != 0;
+    product.has_digital_download = reader.ReadU8() != 0;
+    product.in_app_offer_token = reader.ReadString();
+    product.link_uri = reader.ReadString();
+    if (format >= kRecordFormatExtendedJson)
+    {
+      product.extended_json_data = reader.ReadString();
+    }
+    if (format < kRecordFormatImages)
+    {
+      return product;
+    }
+    uint32_t count = ReadCount(reader);
+    for (uint32_t i = 0; i < count && reader.ok(); i++)
+    {
+      StoreImageRecord image;
+      image.uri = reader.ReadString();
+      image.purpose_tag = reader.ReadString();
+      image.width = reader.ReadU32();
+      image.height = reader.ReadU32();
+      product.images.push_back(std::move(image));
+    }
+    return product;
+  }
+
+  void WriteStoreProductRecords(ByteWriter &writer, const std::vector<StoreProductRecord> &products)
+  {
+    writer.WriteU32(static_cast<uint32_t>(products.size()));
+    for (const StoreProductRecord &product : products)
+    {
+      WriteStoreProductRecord(writer, product);
+    }
+  }
+
+  std::vector<StoreProductRecord> ReadStoreProductRecords(ByteReader &reader, uint16_t format)
+  {
+    std::vector<StoreProductRecord> products;
+    uint32_t count = ReadCount(reader);
+    products.reserve(count);
+    for (uint32_t i = 0; i < count && reader.ok(); i++)
+    {
+      products.push_back(ReadStoreProductRecord(reader, format));
+    }
+    return products;
+  }
+
+  void WriteConsumableBalance(ByteWriter &writer, const ConsumableBalanceRecord &balance)
+  {
+    writer.WriteU8(balance.status);
+    writer.WriteU32(balance.balance_remaining);
+    writer.WriteString(balance.tracking_id);
+  }
+
+  ConsumableBalanceRecord ReadConsumableBalance(ByteReader &reader)
+  {
+    ConsumableBalanceRecord balance;
+    balance.status = reader.ReadU8();
+    balance.balance_remaining = reader.ReadU32();
+    balance.tracking_id = reader.ReadString();
+    return balance;
+  }
+
+  void WriteStringList(ByteWriter &writer, const std::vector<std::string> &values)
+  {
+    writer.WriteU32(static_cast<uint32_t>(values.size()));
+    for (const std::string &value : values)
+    {
+      writer.WriteString(value);
+    }
+  }
+
+  std::vector<std::string> ReadStringList(ByteReader &reader)
+  {
+    std::vector<std::string> values;
+    uint32_t count = ReadCount(reader);
+    values.reserve(count);
+    for (uint32_t i = 0; i < count && reader.ok(); i++)
+    {
+      values.push_back(reader.ReadString());
+    }
+    return values;
+  }
+
+  void WriteJsonFields(ByteWriter &writer, const std::vector<JsonExtractor::Field> &fields)
+  {
+    writer.WriteU32(static_cast<uint32_t>(fields.size()));
+    for (const JsonExtractor::Field &field : fields)
+    {
+      writer.WriteString(field.path);
+      writer.WriteU8(static_cast<uint8_t>(field.type));
+    }
+  }
+
+  std::vector<JsonExtractor::Field> ReadJsonFields(ByteReader &reader)
+  {
+    std::vector<JsonExtractor::Field> fields;
+    uint32_t count = ReadCount(reader);
+    if (count > JsonExtractor::kMaxFields)
+    {
+      reader.Invalidate();
+      return fields;
+    }
+    for (uint32_t i = 0; i < count && reader.ok(); i++)
+    {
+      JsonExtractor::Field field;
+      field.path = reader.ReadString();
+      uint8_t type = reader.ReadU8();
+      if (type > static_cast<uint8_t>(JsonFieldType::kRaw))
+      {
+        reader.Invalidate();
+        break;
+      }
+      field.type = static_cast<JsonFieldType>(type);
+      fields.push_back(std::move(field));
+    }
+    return fields;
+  }
+
+} // namespace windows_store
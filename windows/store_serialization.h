@@ -0,0 +1,51 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_SERIALIZATION_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_SERIALIZATION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "byte_buffer.h"
+#include "json_extractor.h"
+#include "license_snapshot.h"
+#include "store_product.h"
+
+namespace windows_store
+{
+
+  // Row-wise binary encodings of the plain Store records, used for files the
+  // plugin writes (traces, caches). Readers return default values and leave
+  // the ByteReader not ok() on malformed input.
+
+  // Revisions of the license and product encodings. Writers always use
+  // kRecordFormat; readers take the revision a file was written with.
+  constexpr uint16_t kRecordFormatBase = 1;
+  // Adds ExtendedJsonData to licenses and products.
+  constexpr uint16_t kRecordFormatExtendedJson = 2;
+  // Adds the images of products.
+  constexpr uint16_t kRecordFormatImages = 3;
+  constexpr uint16_t kRecordFormat = kRecordFormatImages;
+
+  void WriteLicenseSnapshot(ByteWriter &writer, const LicenseSnapshot &license);
+  LicenseSnapshot ReadLicenseSnapshot(ByteReader &reader, uint16_t format = kRecordFormat);
+
+  void WriteStoreProductRecord(ByteWriter &writer, const StoreProductRecord &product);
+  StoreProductRecord ReadStoreProductRecord(ByteReader &reader, uint16_t format = kRecordFormat);
+
+  void WriteStoreProductRecords(ByteWriter &writer, const std::vector<StoreProductRecord> &products);
+  std::vector<StoreProductRecord> ReadStoreProductRecords(ByteReader &reader, uint16_t format = kRecordFormat);
+
+  void WriteConsumableBalance(ByteWriter &writer, const ConsumableBalanceRecord &balance);
+  ConsumableBalanceRecord ReadConsumableBalance(ByteReader &reader);
+
+  void WriteStringList(ByteWriter &writer, const std::vector<std::string> &values);
+  std::vector<std::string> ReadStringList(ByteReader &reader);
+
+  // u32 count | count x { string JSON Pointer | u8 JsonFieldType }. Reading
+  // fails on more than JsonExtractor::kMaxFields fields.
+  void WriteJsonFields(ByteWriter &writer, const std::vector<JsonExtractor::Field> &fields);
+  std::vector<JsonExtractor::Field> ReadJsonFields(ByteReader &reader);
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_SERIALIZATION_H_
@@ -0,0 +1,349 @@
+#include "store_trace.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+#include "byte_buffer.h"
+#include "store_serialization.h"
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // E_FAIL, returned when a replayed call was never recorded.
+    constexpr int32_t kNotRecordedHResult = static_cast<int32_t>(0x80004005);
+
+    std::string ToString(const ByteWriter &writer)
+    {
+      return std::string(reinterpret_cast<const char *>(writer.data()), writer.size());
+    }
+
+    ByteReader ReaderFor(const std::string &bytes)
+    {
+      return ByteReader(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size());
+    }
+
+    template <typename T, typename Call, typename Encode>
+    StoreResult<T> TimedCall(std::chrono::steady_clock::time_point origin, StoreTraceRecord &record,
+                             Call call, Encode encode)
+    {
+      auto start = std::chrono::steady_clock::now();
+      StoreResult<T> result = call();
+      auto end = std::chrono::steady_clock::now();
+      record.start_us = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(start - origin).count());
+      record.latency_us = static_cast<uint32_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+      record.hresult = result.hresult;
+      record.message = result.message;
+      if (result.ok())
+      {
+        ByteWriter writer;
+        encode(writer, result.value);
+        record.payload = ToString(writer);
+      }
+      return result;
+    }
+
+    std::string EncodeLicenseArguments(uint64_t field_mask)
+    {
+      ByteWriter writer;
+      writer.WriteU64(field_mask);
+      return ToString(writer);
+    }
+
+    std::string EncodeStoreIdArguments(const std::string &store_id)
+    {
+      ByteWriter writer;
+      writer.WriteString(store_id);
+      return ToString(writer);
+    }
+
+    void WriteBool(ByteWriter &writer, const bool &value)
+    {
+      writer.WriteU8(value ? 1 : 0);
+    }
+
+    bool ReadBool(ByteReader &reader)
+    {
+      return reader.ReadU8() != 0;
+    }
+
+    std::string EncodeProductArguments(const std::vector<std::string> &product_kinds, uint64_t field_mask)
+    {
+      ByteWriter writer;
+      WriteStringList(writer, product_kinds);
+      writer.WriteU64(field_mask);
+      return ToString(writer);
+    }
+
+    std::string EncodeProductIdArguments(const std::vector<std::string> &product_kinds,
+                                         const std::vector<std::string> &store_ids, uint64_t field_mask)
+    {
+      ByteWriter writer;
+      WriteStringList(writer, product_kinds);
+      WriteStringList(writer, store_ids);
+      writer.WriteU64(field_mask);
+      return ToString(writer);
+    }
+
+  } // namespace
+
+  bool StoreTraceFile::Read(const std::string &path, std::vector<StoreTraceRecord> &records)
+  {
+    std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+    if (!file)
+    {
+      return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ByteReader reader(bytes.data(), bytes.size());
+    uint32_t magic = reader.ReadU32();
+    uint16_t version = reader.ReadU16();
+    if (magic != kMagic || version == 0 || version > kVersion || !reader.ok())
+    {
+      return false;
+    }
+    reader.ReadU16();
+
+    while (reader.remaining() >= sizeof(uint32_t))
+    {
+      uint32_t size = reader.ReadU32();
+      if (size > reader.remaining())
+      {
+        break;
+      }
+      ByteReader record_reader(bytes.data() + reader.position(), size);
+      StoreTraceRecord record;
+      record.api = static_cast<StoreApi>(record_reader.ReadU8());
+      record.start_us = record_reader.ReadU64();
+      record.latency_us = record_reader.ReadU32();
+      record.hresult = record_reader.ReadI32();
+      record.message = record_reader.ReadString();
+      record.arguments = record_reader.ReadString();
+      record.payload = record_reader.ReadString();
+      record.format = version;
+      if (!record_reader.ok())
+      {
+        break;
+      }
+      records.push_back(std::move(record));
+      reader.Skip(size);
+    }
+    return true;
+  }
+
+  RecordingStoreBackend::RecordingStoreBackend(std::unique_ptr<StoreBackend> inner, const std::string &path)
+      : inner_(std::move(inner)),
+        start_(std::chrono::steady_clock::now()),
+        file_(std::filesystem::u8path(path), std::ios::binary | std::ios::trunc)
+  {
+    ByteWriter header;
+    header.WriteU32(StoreTraceFile::kMagic);
+    header.WriteU16(StoreTraceFile::kVersion);
+    header.WriteU16(0);
+    file_.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file_.flush();
+  }
+
+  void RecordingStoreBackend::SetLicensesChangedHandler(std::function<void()> handler)
+  {
+    inner_->SetLicensesChangedHandler(std::move(handler));
+  }
+
+  template <typename T, typename Call, typename Encode>
+  StoreResult<T> RecordingStoreBackend::Record(StoreApi api, std::string arguments, Call call, Encode encode)
+  {
+    StoreTraceRecord record;
+    record.api = api;
+    record.arguments = std::move(arguments);
+    auto result = TimedCall<T>(start_, record, call, encode);
+    Append(record);
+    return result;
+  }
+
+  StoreResult<LicenseSnapshot> RecordingStoreBackend::GetAppLicense(uint64_t field_mask)
+  {
+    return Record<LicenseSnapshot>(
+        StoreApi::kGetAppLicense, EncodeLicenseArguments(field_mask), [this, field_mask]()
+        { return inner_->GetAppLicense(field_mask); },
+        WriteLicenseSnapshot);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> RecordingStoreBackend::GetAssociatedStoreProducts(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    return Record<std::vector<StoreProductRecord>>(
+        StoreApi::kGetAssociatedStoreProducts, EncodeProductArguments(product_kinds, field_mask),
+        [this, &product_kinds, field_mask]()
+        { return inner_->GetAssociatedStoreProducts(product_kinds, field_mask); },
+        WriteStoreProductRecords);
+  }
+
+  StoreResult<ConsumableBalanceRecord> RecordingStoreBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+  {
+    return Record<ConsumableBalanceRecord>(
+        StoreApi::kGetConsumableBalanceRemaining, EncodeStoreIdArguments(store_id), [this, &store_id]()
+        { return inner_->GetConsumableBalanceRemaining(store_id); },
+        WriteConsumableBalance);
+  }
+
+  StoreResult<bool> RecordingStoreBackend::IsInUserCollection(const std::string &store_id)
+  {
+    return Record<bool>(
+        StoreApi::kIsInUserCollection, EncodeStoreIdArguments(store_id), [this, &store_id]()
+        { return inner_->IsInUserCollection(store_id); },
+        WriteBool);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> RecordingStoreBackend::GetStoreProducts(
+      const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+      uint64_t field_mask)
+  {
+    return Record<std::vector<StoreProductRecord>>(
+        StoreApi::kGetStoreProducts, EncodeProductIdArguments(product_kinds, store_ids, field_mask),
+        [this, &product_kinds, &store_ids, field_mask]()
+        { return inner_->GetStoreProducts(product_kinds, store_ids, field_mask); },
+        WriteStoreProductRecords);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> RecordingStoreBackend::GetUserCollection(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    return Record<std::vector<StoreProductRecord>>(
+        StoreApi::kGetUserCollection, EncodeProductArguments(product_kinds, field_mask),
+        [this, &product_kinds, field_mask]()
+        { return inner_->GetUserCollection(product_kinds, field_mask); },
+        WriteStoreProductRecords);
+  }
+
+  void RecordingStoreBackend::Append(const StoreTraceRecord &record)
+  {
+    ByteWriter body;
+    body.WriteU8(static_cast<uint8_t>(record.api));
+    body.WriteU64(record.start_us);
+    body.WriteU32(record.latency_us);
+    body.WriteI32(record.hresult);
+    body.WriteString(record.message);
+    body.WriteString(record.arguments);
+    body.WriteString(record.payload);
+
+    ByteWriter size;
+    size.WriteU32(static_cast<uint32_t>(body.size()));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.write(reinterpret_cast<const char *>(size.data()), size.size());
+    file_.write(reinterpret_cast<const char *>(body.data()), body.size());
+    file_.flush();
+  }
+
+  ReplayStoreBackend::ReplayStoreBackend(std::vector<StoreTraceRecord> records, double speed)
+      : records_(std::move(records)), speed_(speed), start_(std::chrono::steady_clock::now())
+  {
+    for (size_t i = 0; i < records_.size(); i++)
+    {
+      sequences_[Key(records_[i].api, records_[i].arguments)].first.push_back(i);
+    }
+  }
+
+  template <typename T, typename Decode>
+  StoreResult<T> ReplayStoreBackend::Replay(const Key &key, const char *name, Decode decode)
+  {
+    const StoreTraceRecord *record = Next(key);
+    if (record == nullptr)
+    {
+      return StoreResult<T>::Failure(kNotRecordedHResult, std::string("No recorded ") + name + " call");
+    }
+    Wait(*record);
+    if (record->hresult < 0)
+    {
+      return StoreResult<T>::Failure(record->hresult, record->message);
+    }
+    StoreResult<T> result;
+    ByteReader reader = ReaderFor(record->payload);
+    result.value = decode(reader, record->format);
+    return result;
+  }
+
+  StoreResult<LicenseSnapshot> ReplayStoreBackend::GetAppLicense(uint64_t field_mask)
+  {
+    return Replay<LicenseSnapshot>(Key(StoreApi::kGetAppLicense, EncodeLicenseArguments(field_mask)),
+                                   "GetAppLicense", ReadLicenseSnapshot);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> ReplayStoreBackend::GetAssociatedStoreProducts(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    return Replay<std::vector<StoreProductRecord>>(
+        Key(StoreApi::kGetAssociatedStoreProducts, EncodeProductArguments(product_kinds, field_mask)),
+        "GetAssociatedStoreProducts", ReadStoreProductRecords);
+  }
+
+  StoreResult<ConsumableBalanceRecord> ReplayStoreBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+  {
+    return Replay<ConsumableBalanceRecord>(
+        Key(StoreApi::kGetConsumableBalanceRemaining, EncodeStoreIdArguments(store_id)),
+        "GetConsumableBalanceRemaining", [](ByteReader &reader, uint16_t)
+        { return ReadConsumableBalance(reader); });
+  }
+
+  StoreResult<bool> ReplayStoreBackend::IsInUserCollection(const std::string &store_id)
+  {
+    return Replay<bool>(Key(StoreApi::kIsInUserCollection, EncodeStoreIdArguments(store_id)),
+                        "IsInUserCollection", [](ByteReader &reader, uint16_t)
+                        { return ReadBool(reader); });
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> ReplayStoreBackend::GetStoreProducts(
+      const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+      uint64_t field_mask)
+  {
+    return Replay<std::vector<StoreProductRecord>>(
+        Key(StoreApi::kGetStoreProducts, EncodeProductIdArguments(product_kinds, store_ids, field_mask)),
+        "GetStoreProducts", ReadStoreProductRecords);
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> ReplayStoreBackend::GetUserCollection(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    return Replay<std::vector<StoreProductRecord>>(
+        Key(StoreApi::kGetUserCollection, EncodeProductArguments(product_kinds, field_mask)),
+        "GetUserCollection", ReadStoreProductRecords);
+  }
+
+  const StoreTraceRecord *ReplayStoreBackend::Next(const Key &key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sequences_.find(key);
+    if (it == sequences_.end())
+    {
+      // Fall back to any recorded call of the same API with other arguments.
+      it = sequences_.lower_bound(Key(key.first, std::string()));
+      if (it == sequences_.end() || it->first.first != key.first)
+      {
+        return nullptr;
+      }
+    }
+    auto &[indexes, cursor] = it->second;
+    const StoreTraceRecord *record = &records_[indexes[cursor]];
+    cursor = (cursor + 1) % indexes.size();
+    return record;
+  }
+
+  void ReplayStoreBackend::Wait(const StoreTraceRecord &record) const
+  {
+    if (speed_ <= 0)
+    {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    auto end = std::max(
+        now + std::chrono::microseconds(static_cast<int64_t>(record.latency_us / speed_)),
+        start_ + std::chrono::microseconds(static_cast<int64_t>((record.start_us + record.latency_us) / speed_)));
+    std::this_thread::sleep_until(end);
+  }
+
+} // namespace windows_store
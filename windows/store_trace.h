@@ -0,0 +1,134 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_STORE_TRACE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_STORE_TRACE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "store_backend.h"
+#include "store_serialization.h"
+
+namespace windows_store
+{
+
+  // One Store call captured in a trace file.
+  struct StoreTraceRecord
+  {
+    StoreApi api = StoreApi::kGetAppLicense;
+    // Start of the call, relative to the start of the recording.
+    uint64_t start_us = 0;
+    uint32_t latency_us = 0;
+    int32_t hresult = 0;
+    std::string message;
+    // Encoded call arguments and result (see store_serialization.h).
+    std::string arguments;
+    std::string payload;
+    // Revision of the payload encoding, from the version of the trace.
+    uint16_t format = kRecordFormat;
+  };
+
+  // Trace file layout, little-endian:
+  //   u32 magic 'WSTR' | u16 version | u16 reserved
+  //   records: u32 record size | u8 api | u64 start us | u32 latency us
+  //            i32 hresult | string message | string arguments | string payload
+  // Versions 1 to 3 encode payloads with the record format of the same
+  // number (see store_serialization.h).
+  class StoreTraceFile
+  {
+  public:
+    static constexpr uint32_t kMagic = 0x52545357; // 'WSTR'
+    static constexpr uint16_t kVersion = 3;
+
+    // Reads all records of the trace at |path|, which may have been written
+    // with any version up to kVersion. A truncated last record, as left by a
+    // process that was killed while recording, is ignored.
+    static bool Read(const std::string &path, std::vector<StoreTraceRecord> &records);
+  };
+
+  // StoreBackend decorator that appends every call made through |inner| to
+  // a trace file.
+  class RecordingStoreBackend : public StoreBackend
+  {
+  public:
+    RecordingStoreBackend(std::unique_ptr<StoreBackend> inner, const std::string &path);
+    virtual ~RecordingStoreBackend() {}
+
+    bool RequiresPackageIdentity() const override { return inner_->RequiresPackageIdentity(); }
+    void SetLicensesChangedHandler(std::function<void()> handler) override;
+    void WarmUp() override { inner_->WarmUp(); }
+
+    StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+    StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+    StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+    StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+  private:
+    template <typename T, typename Call, typename Encode>
+    StoreResult<T> Record(StoreApi api, std::string arguments, Call call, Encode encode);
+    void Append(const StoreTraceRecord &record);
+
+    std::unique_ptr<StoreBackend> inner_;
+    std::chrono::steady_clock::time_point start_;
+    std::mutex mutex_;
+    std::ofstream file_;
+  };
+
+  // StoreBackend that answers from a recorded trace. Calls are matched by API
+  // and arguments and replayed in recorded order, wrapping around when a
+  // sequence is exhausted. Each call takes its recorded latency divided by
+  // |speed|, and does not complete before its recorded start plus latency,
+  // also divided by |speed|, counted from the creation of the backend. This
+  // keeps the pacing of the recording when the app calls faster than it
+  // did. A speed of 0 replays as fast as possible.
+  class ReplayStoreBackend : public StoreBackend
+  {
+  public:
+    ReplayStoreBackend(std::vector<StoreTraceRecord> records, double speed);
+    virtual ~ReplayStoreBackend() {}
+
+    bool RequiresPackageIdentity() const override { return false; }
+
+    StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+    StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+    StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+    StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+  private:
+    using Key = std::pair<StoreApi, std::string>;
+
+    // Returns the next record for |key|, or nullptr if none was recorded.
+    const StoreTraceRecord *Next(const Key &key);
+
+    // Replays the next call for |key|, decoding its payload with |decode|.
+    template <typename T, typename Decode>
+    StoreResult<T> Replay(const Key &key, const char *name, Decode decode);
+    void Wait(const StoreTraceRecord &record) const;
+
+    std::vector<StoreTraceRecord> records_;
+    double speed_;
+    std::chrono::steady_clock::time_point start_;
+    std::mutex mutex_;
+    std::map<Key, std::pair<std::vector<size_t>, size_t>> sequences_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_STORE_TRACE_H_
@@ -0,0 +1,162 @@
+#include "catalog_index.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      StoreProductRecord Product(const std::string &store_id, const std::string &kind, const std::string &title,
+                                 const std::string &price, bool owned = false)
+      {
+        StoreProductRecord product;
+        product.store_id = store_id;
+        product.product_kind = kind;
+        product.title = title;
+        product.formatted_price = price;
+        product.is_in_user_collection = owned;
+        return product;
+      }
+
+      std::vector<std::string> StoreIds(const CatalogPage &page)
+      {
+        std::vector<std::string> store_ids;
+        for (const StoreProductRecord &product : page.products)
+        {
+          store_ids.push_back(product.store_id);
+        }
+        return store_ids;
+      }
+
+      void AddSampleProducts(CatalogIndex &index)
+      {
+        index.Update({"Durable", "Consumable"},
+                     {Product("9NA", "Durable", "Space Pack", "$4.99"),
+                      Product("9NB", "Durable", "Spaceship Skin", "$1.99", true),
+                      Product("9NC", "Consumable", "Gold Coins", "$0.99"),
+                      Product("9ND", "Consumable", "Space Coins", "$9.99"),
+                      Product("9NE", "Durable", "Soundtrack", "Free", true)});
+      }
+
+    } // namespace
+
+    TEST(CatalogIndex, ParsesLocalizedPrices)
+    {
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$1.99"), 1.99);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$1,299.99"), 1299.99);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("1.299,99 \xe2\x82\xac"), 1299.99);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("12,50 \xe2\x82\xac"), 12.5);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("1 299,00 kr"), 1299);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("1\xe2\x80\xaf" "299,00 \xe2\x82\xac"), 1299);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("CHF 1'299.50"), 1299.5);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("\xc2\xa5" "1,200"), 1200);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$1.234.567"), 1234567);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$12"), 12);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("12."), 12);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("Free"), 0);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice(""), 0);
+    }
+
+    TEST(CatalogIndex, ThreeDigitsGroupThousandsUnlessTheCurrencyHasThreeDecimals)
+    {
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$12.000"), 12000);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$12.000", "CLP"), 12000);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("12.000 KWD", "KWD"), 12);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("BD 1,299.500", "BHD"), 1299.5);
+      EXPECT_DOUBLE_EQ(CatalogIndex::ParsePrice("$12.00", "KWD"), 12);
+    }
+
+    TEST(CatalogIndex, SplitsTitlesIntoLowerCaseWords)
+    {
+      EXPECT_EQ(CatalogIndex::Words("Space-Pack: VOL 2"), (std::vector<std::string>{"space", "pack", "vol", "2"}));
+      EXPECT_EQ(CatalogIndex::Words("Caf\xc3\xa9 Pack"), (std::vector<std::string>{"caf\xc3\xa9", "pack"}));
+      EXPECT_TRUE(CatalogIndex::Words(" - ").empty());
+    }
+
+    TEST(CatalogIndex, FiltersAndOrdersByPrice)
+    {
+      CatalogIndex index;
+      AddSampleProducts(index);
+      CatalogQuery query;
+      query.limit = 50;
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NE", "9NC", "9NB", "9NA", "9ND"}));
+
+      query.product_kinds = {"Durable"};
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NE", "9NB", "9NA"}));
+
+      query.product_kinds.clear();
+      query.keyword = "spa";
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NB", "9NA", "9ND"}));
+
+      query.keyword = "space coi";
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9ND"}));
+
+      query.keyword.clear();
+      query.min_price = 1;
+      query.max_price = 5;
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NB", "9NA"}));
+
+      query.min_price.reset();
+      query.max_price.reset();
+      query.ownership = CatalogQuery::Ownership::kNotOwned;
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NC", "9NA", "9ND"}));
+    }
+
+    TEST(CatalogIndex, PagesThroughMatches)
+    {
+      CatalogIndex index;
+      AddSampleProducts(index);
+      CatalogQuery query;
+      query.offset = 1;
+      query.limit = 2;
+      CatalogPage page = index.Query(query);
+      EXPECT_EQ(page.total, 5u);
+      EXPECT_EQ(StoreIds(page), (std::vector<std::string>{"9NC", "9NB"}));
+
+      query.offset = 4;
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9ND"}));
+    }
+
+    TEST(CatalogIndex, ZeroLimitOnlyCounts)
+    {
+      CatalogIndex index;
+      AddSampleProducts(index);
+      CatalogQuery query;
+      query.keyword = "coins";
+      CatalogPage page = index.Query(query);
+      EXPECT_EQ(page.total, 2u);
+      EXPECT_TRUE(page.products.empty());
+    }
+
+    TEST(CatalogIndex, UpdatesIncrementally)
+    {
+      CatalogIndex index;
+      AddSampleProducts(index);
+      EXPECT_TRUE(index.StaleKinds({"Durable", "Consumable"}).empty());
+      EXPECT_EQ(index.StaleKinds({"Game"}), (std::vector<std::string>{"Game"}));
+
+      // 9NC got cheaper and renamed, 9ND is no longer associated. Durables
+      // are not part of the update and stay.
+      index.Update({"Consumable"}, {Product("9NC", "Consumable", "Silver Coins", "$0.49")});
+      CatalogQuery query;
+      query.limit = 50;
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NE", "9NC", "9NB", "9NA"}));
+      query.keyword = "gold";
+      EXPECT_EQ(index.Query(query).total, 0u);
+      query.keyword = "silver";
+      EXPECT_EQ(StoreIds(index.Query(query)), (std::vector<std::string>{"9NC"}));
+
+      index.Invalidate();
+      EXPECT_EQ(index.StaleKinds({"Durable", "Consumable"}), (std::vector<std::string>{"Durable", "Consumable"}));
+      EXPECT_EQ(index.Query(query).total, 1u);
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,256 @@
+#include "collection_sync.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "atomic_file.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // A fresh directory for |name|.
+      std::filesystem::path DirectoryOf(const char *name)
+      {
+        std::filesystem::path directory =
+            std::filesystem::temp_directory_path() / (std::string("windows_store_collection_test_") + name);
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        return directory;
+      }
+
+      StoreProductRecord ProductOf(const std::string &store_id, const std::string &title)
+      {
+        StoreProductRecord product;
+        product.store_id = store_id;
+        product.product_kind = "Durable";
+        product.title = title;
+        product.is_in_user_collection = true;
+        return product;
+      }
+
+      UserCollection CollectionOf(std::vector<StoreProductRecord> products)
+      {
+        UserCollection collection;
+        collection.version = 3;
+        collection.product_kinds = {"Durable", "Game"};
+        collection.field_mask = ProductFieldBit(ProductField::kStoreId) | ProductFieldBit(ProductField::kTitle);
+        collection.products = std::move(products);
+        return collection;
+      }
+
+      void WriteBytes(const std::filesystem::path &path, const std::vector<uint8_t> &bytes)
+      {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+      }
+
+      // The delta as a map of every Store ID of either copy, for comparison.
+      CollectionDelta ReferenceDelta(const std::vector<StoreProductRecord> &from,
+                                     const std::vector<StoreProductRecord> &to)
+      {
+        std::map<std::string, const StoreProductRecord *> old_products;
+        std::map<std::string, const StoreProductRecord *> new_products;
+        for (const StoreProductRecord &product : from)
+        {
+          old_products[product.store_id] = &product;
+        }
+        for (const StoreProductRecord &product : to)
+        {
+          new_products[product.store_id] = &product;
+        }
+        CollectionDelta delta;
+        for (const auto &[store_id, product] : new_products)
+        {
+          auto old_product = old_products.find(store_id);
+          if (old_product == old_products.end() || !(*old_product->second == *product))
+          {
+            delta.changed.push_back(*product);
+          }
+        }
+        for (const auto &[store_id, product] : old_products)
+        {
+          if (new_products.count(store_id) == 0)
+          {
+            delta.removed.push_back(store_id);
+          }
+        }
+        return delta;
+      }
+
+    } // namespace
+
+    TEST(CollectionSync, ComputesDeltas)
+    {
+      std::vector<StoreProductRecord> from = {ProductOf("9NA", "A"), ProductOf("9NB", "B"), ProductOf("9ND", "D")};
+      std::vector<StoreProductRecord> to = {ProductOf("9NB", "B, renamed"), ProductOf("9NC", "C"),
+                                            ProductOf("9ND", "D")};
+      CollectionDelta delta = ComputeCollectionDelta(from, to);
+      EXPECT_EQ(delta.removed, std::vector<std::string>{"9NA"});
+      ASSERT_EQ(delta.changed.size(), 2u);
+      EXPECT_EQ(delta.changed[0], to[0]);
+      EXPECT_EQ(delta.changed[1], to[1]);
+
+      EXPECT_TRUE(ComputeCollectionDelta(to, to).empty());
+      EXPECT_EQ(ComputeCollectionDelta({}, to).changed, to);
+      EXPECT_EQ(ComputeCollectionDelta(to, {}).removed, (std::vector<std::string>{"9NB", "9NC", "9ND"}));
+    }
+
+    TEST(CollectionSync, DeltasMatchTheReference)
+    {
+      std::mt19937 random(20261018);
+      for (int i = 0; i < 2000; i++)
+      {
+        std::vector<StoreProductRecord> copies[2];
+        for (std::vector<StoreProductRecord> &products : copies)
+        {
+          for (int id = 0; id < 40; id++)
+          {
+            if (random() % 3 != 0)
+            {
+              char store_id[8];
+              std::snprintf(store_id, sizeof(store_id), "9N%03d", id);
+              products.push_back(ProductOf(store_id, "Title " + std::to_string(random() % 2)));
+            }
+          }
+        }
+        CollectionDelta delta = ComputeCollectionDelta(copies[0], copies[1]);
+        CollectionDelta expected = ReferenceDelta(copies[0], copies[1]);
+        ASSERT_EQ(delta.changed, expected.changed) << i;
+        ASSERT_EQ(delta.removed, expected.removed) << i;
+      }
+    }
+
+    TEST(CollectionSync, ReadsWhatItWrites)
+    {
+      std::filesystem::path path = DirectoryOf("round_trip") / CollectionSync::kFileName;
+      UserCollection written = CollectionOf({ProductOf("9NA", "A"), ProductOf("9NB", "caf\xc3\xa9")});
+      ASSERT_TRUE(CollectionSync::Write(path, written));
+
+      UserCollection read;
+      ASSERT_TRUE(CollectionSync::Read(path, read));
+      EXPECT_EQ(read.version, written.version);
+      EXPECT_EQ(read.product_kinds, written.product_kinds);
+      EXPECT_EQ(read.field_mask, written.field_mask);
+      EXPECT_EQ(read.products, written.products);
+    }
+
+    TEST(CollectionSync, RejectsDamagedFiles)
+    {
+      std::filesystem::path path = DirectoryOf("damaged") / CollectionSync::kFileName;
+      ASSERT_TRUE(CollectionSync::Write(path, CollectionOf({ProductOf("9NA", "A"), ProductOf("9NB", "B")})));
+      const std::vector<uint8_t> good = ReadFileBytes(path);
+      UserCollection untouched = CollectionOf({ProductOf("9NZ", "Z")});
+      auto expect_rejected = [&path, &untouched](const std::vector<uint8_t> &bytes, const std::string &what)
+      {
+        WriteBytes(path, bytes);
+        UserCollection collection = untouched;
+        EXPECT_FALSE(CollectionSync::Read(path, collection)) << what;
+        EXPECT_EQ(collection.products, untouched.products) << what;
+      };
+
+      // Every truncation, including the empty file.
+      for (size_t size = 0; size < good.size(); size++)
+      {
+        expect_rejected(std::vector<uint8_t>(good.begin(), good.begin() + size), "truncated to " + std::to_string(size));
+      }
+      std::vector<uint8_t> longer = good;
+      longer.push_back(0);
+      expect_rejected(longer, "trailing byte");
+
+      // Any flipped bit fails the checksum or the header, but for the
+      // reserved u16 at offset 6.
+      for (size_t offset = 0; offset < good.size(); offset++)
+      {
+        if (offset == 6 || offset == 7)
+        {
+          continue;
+        }
+        std::vector<uint8_t> flipped = good;
+        flipped[offset] ^= 0x10;
+        expect_rejected(flipped, "bit flipped at " + std::to_string(offset));
+      }
+
+      std::vector<uint8_t> other_version = good;
+      other_version[4] = CollectionSync::kFormatVersion + 1;
+      expect_rejected(other_version, "other format version");
+
+      std::filesystem::remove(path);
+      UserCollection collection;
+      EXPECT_FALSE(CollectionSync::Read(path, collection));
+    }
+
+    TEST(CollectionSync, RejectsProductsOutOfOrder)
+    {
+      std::filesystem::path path = DirectoryOf("order") / CollectionSync::kFileName;
+      UserCollection collection;
+      // Checksummed correctly, but not sorted by Store ID.
+      ASSERT_TRUE(CollectionSync::Write(path, CollectionOf({ProductOf("9NB", "B"), ProductOf("9NA", "A")})));
+      EXPECT_FALSE(CollectionSync::Read(path, collection));
+      ASSERT_TRUE(CollectionSync::Write(path, CollectionOf({ProductOf("9NA", "A"), ProductOf("9NA", "A")})));
+      EXPECT_FALSE(CollectionSync::Read(path, collection));
+    }
+
+    TEST(CollectionSync, KeepsTheCopyAcrossInstances)
+    {
+      std::filesystem::path directory = DirectoryOf("persisted");
+      std::vector<std::string> kinds = {"Durable"};
+      uint64_t mask = ProductFieldBit(ProductField::kTitle);
+      {
+        CollectionSync sync(directory);
+        EXPECT_EQ(sync.Local(kinds, mask)->version, 0u);
+        auto updated = sync.Update(kinds, mask, {ProductOf("9NB", "B"), ProductOf("9NA", "A"), ProductOf("9NA", "A")});
+        EXPECT_EQ(updated->version, 1u);
+        ASSERT_EQ(updated->products.size(), 2u);
+        EXPECT_EQ(updated->products[0].store_id, "9NA");
+        // Unchanged products keep the version.
+        EXPECT_EQ(sync.Update(kinds, mask, {ProductOf("9NA", "A"), ProductOf("9NB", "B")}), updated);
+      }
+
+      // A write interrupted before its rename.
+      std::filesystem::path temp_path = directory / CollectionSync::kFileName;
+      temp_path += ".tmp";
+      WriteBytes(temp_path, {1, 2, 3});
+
+      CollectionSync sync(directory);
+      auto local = sync.Local(kinds, mask);
+      EXPECT_EQ(local->version, 1u);
+      EXPECT_EQ(local->products.size(), 2u);
+      EXPECT_FALSE(std::filesystem::exists(temp_path));
+      // Other kinds or fields start from an empty copy.
+      EXPECT_EQ(sync.Local({"Game"}, mask)->version, 0u);
+      EXPECT_EQ(sync.Local(kinds, mask | ProductFieldBit(ProductField::kDescription))->version, 0u);
+      EXPECT_EQ(sync.Update(kinds, mask, {ProductOf("9NA", "A")})->version, 2u);
+    }
+
+    TEST(CollectionSync, StartsOverFromADamagedFile)
+    {
+      std::filesystem::path directory = DirectoryOf("start_over");
+      std::vector<std::string> kinds = {"Durable"};
+      {
+        CollectionSync sync(directory);
+        sync.Update(kinds, 0, {ProductOf("9NA", "A")});
+      }
+      std::vector<uint8_t> bytes = ReadFileBytes(directory / CollectionSync::kFileName);
+      bytes.back() ^= 1;
+      WriteBytes(directory / CollectionSync::kFileName, bytes);
+
+      CollectionSync sync(directory);
+      EXPECT_EQ(sync.Local(kinds, 0)->version, 0u);
+      EXPECT_TRUE(sync.Local(kinds, 0)->products.empty());
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,79 @@
+#include "fake_image_downloader.h"
+
+#include <algorithm>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    void FakeImageDownloader::SetImage(const std::string &uri, std::vector<uint8_t> body)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      images_[uri] = std::move(body);
+    }
+
+    void FakeImageDownloader::Hold()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      held_ = true;
+    }
+
+    void FakeImageDownloader::Release()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = false;
+      }
+      changed_.notify_all();
+    }
+
+    bool FakeImageDownloader::WaitForStarted(int count, std::chrono::milliseconds timeout)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      return changed_.wait_for(lock, timeout, [this, count]()
+                               { return started_ >= count; });
+    }
+
+    int FakeImageDownloader::Downloads(const std::string &uri) const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = downloads_.find(uri);
+      return found != downloads_.end() ? found->second : 0;
+    }
+
+    int FakeImageDownloader::TotalDownloads() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return started_;
+    }
+
+    int FakeImageDownloader::MaxConcurrentDownloads() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return max_concurrent_;
+    }
+
+    StoreResult<std::vector<uint8_t>> FakeImageDownloader::Download(const std::string &uri)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      downloads_[uri]++;
+      started_++;
+      concurrent_++;
+      max_concurrent_ = std::max(max_concurrent_, concurrent_);
+      changed_.notify_all();
+      changed_.wait(lock, [this]()
+                    { return !held_; });
+      concurrent_--;
+      auto found = images_.find(uri);
+      if (found == images_.end())
+      {
+        return StoreResult<std::vector<uint8_t>>::Failure(kNotFoundHResult, "Not found: " + uri);
+      }
+      StoreResult<std::vector<uint8_t>> result;
+      result.value = found->second;
+      return result;
+    }
+
+  } // namespace test
+} // namespace windows_store
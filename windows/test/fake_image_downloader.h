@@ -0,0 +1,59 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_TEST_FAKE_IMAGE_DOWNLOADER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_TEST_FAKE_IMAGE_DOWNLOADER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "image_cache.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    // ImageDownloader serving bodies set by the test, counting the downloads
+    // made and how many of them overlapped. Downloads can be held back to
+    // keep them in flight.
+    class FakeImageDownloader : public ImageDownloader
+    {
+    public:
+      // HTTP_E_STATUS_NOT_FOUND, for URIs without a body.
+      static constexpr int32_t kNotFoundHResult = static_cast<int32_t>(0x80190194);
+
+      FakeImageDownloader() = default;
+      virtual ~FakeImageDownloader() {}
+
+      void SetImage(const std::string &uri, std::vector<uint8_t> body);
+      // While held, downloads block after they started.
+      void Hold();
+      void Release();
+      // Waits until |count| downloads have started in total.
+      bool WaitForStarted(int count, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+      int Downloads(const std::string &uri) const;
+      int TotalDownloads() const;
+      // The most downloads that were running at the same time.
+      int MaxConcurrentDownloads() const;
+
+      StoreResult<std::vector<uint8_t>> Download(const std::string &uri) override;
+
+    private:
+      mutable std::mutex mutex_;
+      std::condition_variable changed_;
+      std::unordered_map<std::string, std::vector<uint8_t>> images_;
+      std::unordered_map<std::string, int> downloads_;
+      bool held_ = false;
+      int started_ = 0;
+      int concurrent_ = 0;
+      int max_concurrent_ = 0;
+    };
+
+  } // namespace test
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_TEST_FAKE_IMAGE_DOWNLOADER_H_
@@ -0,0 +1,231 @@
+#include "fake_store_backend.h"
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    void FakeStoreBackend::SetLicense(const LicenseSnapshot &license)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      license_ = license;
+    }
+
+    void FakeStoreBackend::SetProducts(std::vector<StoreProductRecord> products)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      products_ = std::move(products);
+    }
+
+    void FakeStoreBackend::SetLatency(std::chrono::microseconds latency)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      latency_ = latency;
+    }
+
+    void FakeStoreBackend::SetFailure(int32_t hresult)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      failure_ = hresult;
+    }
+
+    void FakeStoreBackend::RaiseLicensesChanged()
+    {
+      std::function<void()> handler;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handler = licenses_changed_;
+      }
+      if (handler)
+      {
+        handler();
+      }
+    }
+
+    void FakeStoreBackend::Hold()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      held_ = true;
+    }
+
+    void FakeStoreBackend::Release()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = false;
+      }
+      hold_changed_.notify_all();
+    }
+
+    bool FakeStoreBackend::WaitForHeld(int count, std::chrono::milliseconds timeout)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      return hold_changed_.wait_for(lock, timeout, [this, count]()
+                                    { return held_calls_ >= count; });
+    }
+
+    void FakeStoreBackend::SetLicensesChangedHandler(std::function<void()> handler)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      licenses_changed_ = std::move(handler);
+    }
+
+    StoreResult<LicenseSnapshot> FakeStoreBackend::GetAppLicense(uint64_t field_mask)
+    {
+      last_license_field_mask_ = field_mask;
+      int32_t failure = Enter(StoreApi::kGetAppLicense);
+      StoreResult<LicenseSnapshot> result;
+      if (failure < 0)
+      {
+        result = StoreResult<LicenseSnapshot>::Failure(failure, "fake failure");
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.value = license_;
+      }
+      Leave();
+      return result;
+    }
+
+    StoreResult<std::vector<StoreProductRecord>> FakeStoreBackend::GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask)
+    {
+      int32_t failure = Enter(StoreApi::kGetAssociatedStoreProducts);
+      StoreResult<std::vector<StoreProductRecord>> result;
+      if (failure < 0)
+      {
+        result = StoreResult<std::vector<StoreProductRecord>>::Failure(failure, "fake failure");
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.value = products_;
+      }
+      Leave();
+      return result;
+    }
+
+    StoreResult<ConsumableBalanceRecord> FakeStoreBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+    {
+      int32_t failure = Enter(StoreApi::kGetConsumableBalanceRemaining);
+      StoreResult<ConsumableBalanceRecord> result;
+      if (failure < 0)
+      {
+        result = StoreResult<ConsumableBalanceRecord>::Failure(failure, "fake failure");
+      }
+      else
+      {
+        result.value.balance_remaining = static_cast<uint32_t>(store_id.size());
+        result.value.tracking_id = "tracking-" + store_id;
+      }
+      Leave();
+      return result;
+    }
+
+    StoreResult<bool> FakeStoreBackend::IsInUserCollection(const std::string &store_id)
+    {
+      int32_t failure = Enter(StoreApi::kIsInUserCollection);
+      StoreResult<bool> result;
+      if (failure < 0)
+      {
+        result = StoreResult<bool>::Failure(failure, "fake failure");
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.value = std::any_of(products_.begin(), products_.end(), [&store_id](const StoreProductRecord &product)
+                                   { return product.store_id == store_id && product.is_in_user_collection; });
+      }
+      Leave();
+      return result;
+    }
+
+    StoreResult<std::vector<StoreProductRecord>> FakeStoreBackend::GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask)
+    {
+      int32_t failure = Enter(StoreApi::kGetStoreProducts);
+      StoreResult<std::vector<StoreProductRecord>> result;
+      if (failure < 0)
+      {
+        result = StoreResult<std::vector<StoreProductRecord>>::Failure(failure, "fake failure");
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const StoreProductRecord &product : products_)
+        {
+          if (std::find(store_ids.begin(), store_ids.end(), product.store_id) != store_ids.end())
+          {
+            result.value.push_back(product);
+          }
+        }
+      }
+      Leave();
+      return result;
+    }
+
+    StoreResult<std::vector<StoreProductRecord>> FakeStoreBackend::GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask)
+    {
+      int32_t failure = Enter(StoreApi::kGetUserCollection);
+      StoreResult<std::vector<StoreProductRecord>> result;
+      if (failure < 0)
+      {
+        result = StoreResult<std::vector<StoreProductRecord>>::Failure(failure, "fake failure");
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::copy_if(products_.begin(), products_.end(), std::back_inserter(result.value),
+                     [](const StoreProductRecord &product)
+                     { return product.is_in_user_collection; });
+      }
+      Leave();
+      return result;
+    }
+
+    int32_t FakeStoreBackend::Enter(StoreApi api)
+    {
+      calls_[static_cast<size_t>(api)]++;
+      int concurrent = ++concurrent_calls_;
+      int max = max_concurrent_calls_.load();
+      while (concurrent > max && !max_concurrent_calls_.compare_exchange_weak(max, concurrent))
+      {
+      }
+      std::chrono::microseconds latency;
+      int32_t failure;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latency = latency_;
+        failure = failure_;
+      }
+      if (latency.count() > 0)
+      {
+        std::this_thread::sleep_for(latency);
+      }
+      return failure;
+    }
+
+    void FakeStoreBackend::Leave()
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (held_)
+        {
+          held_calls_++;
+          hold_changed_.notify_all();
+          hold_changed_.wait(lock, [this]()
+                             { return !held_; });
+        }
+      }
+      concurrent_calls_--;
+    }
+
+  } // namespace test
+} // namespace windows_store
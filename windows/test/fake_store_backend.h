@@ -0,0 +1,88 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_TEST_FAKE_STORE_BACKEND_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_TEST_FAKE_STORE_BACKEND_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "store_backend.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    // StoreBackend answering from data set by the test, counting the calls
+    // made to it and how many of them overlapped.
+    class FakeStoreBackend : public StoreBackend
+    {
+    public:
+      explicit FakeStoreBackend(bool requires_package_identity = false)
+          : requires_package_identity_(requires_package_identity) {}
+      virtual ~FakeStoreBackend() {}
+
+      void SetLicense(const LicenseSnapshot &license);
+      void SetProducts(std::vector<StoreProductRecord> products);
+      // Every call blocks for |latency| before answering.
+      void SetLatency(std::chrono::microseconds latency);
+      // Every call fails with |hresult| while it is negative.
+      void SetFailure(int32_t hresult);
+      // Invokes the handler set with SetLicensesChangedHandler.
+      void RaiseLicensesChanged();
+      // While held, calls block once they have their answer, so a test can
+      // change the data under a call in flight.
+      void Hold();
+      void Release();
+      // Waits until |count| calls in total were blocked by Hold.
+      bool WaitForHeld(int count, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+      int Calls(StoreApi api) const { return calls_[static_cast<size_t>(api)].load(); }
+      uint64_t LastLicenseFieldMask() const { return last_license_field_mask_.load(); }
+      // The most calls that were running at the same time.
+      int MaxConcurrentCalls() const { return max_concurrent_calls_.load(); }
+
+      bool RequiresPackageIdentity() const override { return requires_package_identity_; }
+      void SetLicensesChangedHandler(std::function<void()> handler) override;
+
+      StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+      StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+          const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+      StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+      StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+      StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+          const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+          uint64_t field_mask) override;
+      StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+          const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+    private:
+      // Counts a call to |api| and waits out the latency. Returns the
+      // failure to answer with, if any.
+      int32_t Enter(StoreApi api);
+      void Leave();
+
+      const bool requires_package_identity_;
+      mutable std::mutex mutex_;
+      LicenseSnapshot license_;
+      std::vector<StoreProductRecord> products_;
+      std::chrono::microseconds latency_{0};
+      int32_t failure_ = 0;
+      std::function<void()> licenses_changed_;
+      std::condition_variable hold_changed_;
+      bool held_ = false;
+      int held_calls_ = 0;
+      std::atomic<int> calls_[8] = {};
+      std::atomic<uint64_t> last_license_field_mask_{0};
+      std::atomic<int> concurrent_calls_{0};
+      std::atomic<int> max_concurrent_calls_{0};
+    };
+
+  } // namespace test
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_TEST_FAKE_STORE_BACKEND_H_
@@ -0,0 +1,86 @@
+#include "flight_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      template <typename T>
+      T ReadAt(const std::vector<uint8_t> &dump, size_t offset)
+      {
+        T value;
+        std::memcpy(&value, dump.data() + offset, sizeof(value));
+        return value;
+      }
+
+      FlightRecord RecordOf(StoreApi api, uint32_t count)
+      {
+        FlightRecord record{};
+        record.api = static_cast<uint8_t>(api);
+        record.count = count;
+        return record;
+      }
+
+    } // namespace
+
+    TEST(FlightRecorder, DumpsTheLastRecordsOldestFirst)
+    {
+      FlightRecorder recorder(4);
+      for (uint32_t i = 1; i <= 6; i++)
+      {
+        recorder.Record(RecordOf(StoreApi::kGetUserCollection, i));
+      }
+
+      std::vector<uint8_t> dump(recorder.MaxDumpSize());
+      size_t size = recorder.DumpTo(dump.data());
+      ASSERT_EQ(size, FlightRecorder::kHeaderSize + 4 * sizeof(FlightRecord));
+      EXPECT_EQ(ReadAt<uint32_t>(dump, 0), FlightRecorder::kMagic);
+      EXPECT_EQ(ReadAt<uint16_t>(dump, 4), FlightRecorder::kVersion);
+      EXPECT_EQ(ReadAt<uint16_t>(dump, 6), sizeof(FlightRecord));
+      EXPECT_EQ(ReadAt<uint32_t>(dump, 8), 4u);
+      EXPECT_EQ(ReadAt<uint32_t>(dump, 12), 4u);
+      EXPECT_EQ(ReadAt<uint64_t>(dump, 16), 6u);
+      for (size_t i = 0; i < 4; i++)
+      {
+        FlightRecord record = ReadAt<FlightRecord>(dump, FlightRecorder::kHeaderSize + i * sizeof(FlightRecord));
+        EXPECT_EQ(record.sequence, i + 3);
+        EXPECT_EQ(record.count, i + 3);
+        EXPECT_EQ(record.api, static_cast<uint8_t>(StoreApi::kGetUserCollection));
+      }
+    }
+
+    TEST(FlightRecorder, DumpWritesTheSameRecordsToAFile)
+    {
+      FlightRecorder recorder(8);
+      recorder.Record(RecordOf(StoreApi::kGetAppLicense, 2));
+      recorder.Record(RecordOf(StoreApi::kGetStoreProducts, 5));
+      std::vector<uint8_t> expected(recorder.MaxDumpSize());
+      expected.resize(recorder.DumpTo(expected.data()));
+
+      std::filesystem::path path = std::filesystem::temp_directory_path() / "windows_store_flight_recorder_test.bin";
+      ASSERT_TRUE(recorder.Dump(path));
+      std::ifstream file(path, std::ios::binary);
+      std::vector<uint8_t> dump((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      file.close();
+      std::filesystem::remove(path);
+
+      // Identical but for the dump time.
+      ASSERT_EQ(dump.size(), expected.size());
+      std::memset(dump.data() + 24, 0, 8);
+      std::memset(expected.data() + 24, 0, 8);
+      EXPECT_EQ(dump, expected);
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,240 @@
+#include "image_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_image_downloader.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      using namespace std::chrono_literals;
+
+      // A fresh directory, removed with its contents when destroyed.
+      class TempDirectory
+      {
+      public:
+        explicit TempDirectory(const std::string &name)
+            : path_(std::filesystem::temp_directory_path() / ("windows_store_" + name))
+        {
+          std::filesystem::remove_all(path_);
+        }
+        ~TempDirectory()
+        {
+          std::error_code error;
+          std::filesystem::remove_all(path_, error);
+        }
+
+        const std::filesystem::path &path() const { return path_; }
+
+      private:
+        std::filesystem::path path_;
+      };
+
+      std::vector<uint8_t> BodyOf(char fill, size_t size)
+      {
+        return std::vector<uint8_t>(size, static_cast<uint8_t>(fill));
+      }
+
+      std::vector<uint8_t> ReadAll(const std::string &path)
+      {
+        std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+        return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      }
+
+      // Fetches |uri| and waits for its result.
+      StoreResult<std::string> FetchNow(ImageCache &cache, const std::string &uri)
+      {
+        auto promise = std::make_shared<std::promise<StoreResult<std::string>>>();
+        std::future<StoreResult<std::string>> future = promise->get_future();
+        cache.Fetch(uri, [promise](const StoreResult<std::string> &path)
+                    { promise->set_value(path); });
+        if (future.wait_for(5s) != std::future_status::ready)
+        {
+          return StoreResult<std::string>::Failure(-1, "Timed out fetching " + uri);
+        }
+        return future.get();
+      }
+
+    } // namespace
+
+    TEST(ImageCache, JoinsDownloadsInFlight)
+    {
+      TempDirectory directory("image_cache_in_flight");
+      auto downloader = std::make_unique<FakeImageDownloader>();
+      FakeImageDownloader &images = *downloader;
+      images.SetImage("https://example.com/a.png", BodyOf('a', 100));
+      // Another URI for the same image.
+      images.SetImage("https://cdn.example.com/a.png", BodyOf('a', 100));
+      ImageCache cache(directory.path(), std::move(downloader));
+
+      images.Hold();
+      std::vector<std::future<StoreResult<std::string>>> results;
+      for (int i = 0; i < 5; i++)
+      {
+        results.push_back(std::async(std::launch::async, [&cache]()
+                                     { return FetchNow(cache, "https://example.com/a.png"); }));
+      }
+      ASSERT_TRUE(images.WaitForStarted(1));
+      // Let the other fetches join the download before it completes.
+      std::this_thread::sleep_for(50ms);
+      images.Release();
+
+      std::string path;
+      for (auto &result : results)
+      {
+        StoreResult<std::string> fetched = result.get();
+        ASSERT_TRUE(fetched.ok()) << fetched.message;
+        path = fetched.value;
+      }
+      EXPECT_EQ(images.Downloads("https://example.com/a.png"), 1);
+      EXPECT_EQ(ReadAll(path), BodyOf('a', 100));
+
+      StoreResult<std::string> shared = FetchNow(cache, "https://cdn.example.com/a.png");
+      ASSERT_TRUE(shared.ok());
+      EXPECT_EQ(shared.value, path);
+
+      // Cached: no download.
+      ASSERT_TRUE(FetchNow(cache, "https://example.com/a.png").ok());
+      EXPECT_EQ(images.TotalDownloads(), 2);
+    }
+
+    TEST(ImageCache, DoesNotCacheFailedDownloads)
+    {
+      TempDirectory directory("image_cache_failure");
+      auto downloader = std::make_unique<FakeImageDownloader>();
+      FakeImageDownloader &images = *downloader;
+      ImageCache cache(directory.path(), std::move(downloader));
+
+      StoreResult<std::string> fetched = FetchNow(cache, "https://example.com/missing.png");
+      EXPECT_EQ(fetched.hresult, FakeImageDownloader::kNotFoundHResult);
+      EXPECT_TRUE(fetched.value.empty());
+      // Failures are not cached.
+      FetchNow(cache, "https://example.com/missing.png");
+      EXPECT_EQ(images.Downloads("https://example.com/missing.png"), 2);
+    }
+
+    TEST(ImageCache, EvictsTheLeastRecentlyUsedImages)
+    {
+      TempDirectory directory("image_cache_eviction");
+      auto downloader = std::make_unique<FakeImageDownloader>();
+      FakeImageDownloader &images = *downloader;
+      for (char name : {'a', 'b', 'c'})
+      {
+        images.SetImage(std::string("https://example.com/") + name, BodyOf(name, 100));
+      }
+      ImageCache cache(directory.path(), std::move(downloader), 250);
+
+      std::string a = FetchNow(cache, "https://example.com/a").value;
+      std::string b = FetchNow(cache, "https://example.com/b").value;
+      // Makes b the least recently used.
+      ASSERT_EQ(FetchNow(cache, "https://example.com/a").value, a);
+      std::string c = FetchNow(cache, "https://example.com/c").value;
+      EXPECT_TRUE(std::filesystem::exists(std::filesystem::u8path(a)));
+      EXPECT_FALSE(std::filesystem::exists(std::filesystem::u8path(b)));
+      EXPECT_TRUE(std::filesystem::exists(std::filesystem::u8path(c)));
+      EXPECT_EQ(images.TotalDownloads(), 3);
+
+      ASSERT_TRUE(FetchNow(cache, "https://example.com/b").ok());
+      EXPECT_EQ(images.Downloads("https://example.com/b"), 2);
+
+      // A lower limit evicts on a download thread.
+      cache.SetMaxBytes(100);
+      auto deadline = std::chrono::steady_clock::now() + 5s;
+      while (std::filesystem::exists(std::filesystem::u8path(c)) && std::chrono::steady_clock::now() < deadline)
+      {
+        std::this_thread::sleep_for(1ms);
+      }
+      EXPECT_FALSE(std::filesystem::exists(std::filesystem::u8path(a)));
+      EXPECT_FALSE(std::filesystem::exists(std::filesystem::u8path(c)));
+      EXPECT_TRUE(std::filesystem::exists(std::filesystem::u8path(FetchNow(cache, "https://example.com/b").value)));
+    }
+
+    TEST(ImageCache, CleansUpOrphansOnLoad)
+    {
+      TempDirectory directory("image_cache_orphans");
+      std::string a;
+      std::string b;
+      {
+        auto downloader = std::make_unique<FakeImageDownloader>();
+        downloader->SetImage("https://example.com/a", BodyOf('a', 100));
+        downloader->SetImage("https://example.com/b", BodyOf('b', 100));
+        ImageCache cache(directory.path(), std::move(downloader));
+        a = FetchNow(cache, "https://example.com/a").value;
+        b = FetchNow(cache, "https://example.com/b").value;
+        ASSERT_FALSE(a.empty());
+        ASSERT_FALSE(b.empty());
+      }
+
+      // An interrupted write, a file the index does not know, and an
+      // indexed file deleted behind the cache's back.
+      std::filesystem::path objects = directory.path() / "objects";
+      std::ofstream(objects / "0123.7.tmp") << "partial";
+      std::ofstream(objects / "0123") << "unknown";
+      std::filesystem::remove(std::filesystem::u8path(b));
+
+      auto downloader = std::make_unique<FakeImageDownloader>();
+      FakeImageDownloader &images = *downloader;
+      images.SetImage("https://example.com/a", BodyOf('a', 100));
+      images.SetImage("https://example.com/b", BodyOf('b', 100));
+      ImageCache cache(directory.path(), std::move(downloader));
+      EXPECT_EQ(FetchNow(cache, "https://example.com/a").value, a);
+      EXPECT_EQ(images.TotalDownloads(), 0);
+      EXPECT_FALSE(std::filesystem::exists(objects / "0123.7.tmp"));
+      EXPECT_FALSE(std::filesystem::exists(objects / "0123"));
+
+      EXPECT_EQ(FetchNow(cache, "https://example.com/b").value, b);
+      EXPECT_EQ(images.Downloads("https://example.com/b"), 1);
+      EXPECT_EQ(ReadAll(b), BodyOf('b', 100));
+    }
+
+    TEST(ImageCache, RunsAtMostMaxDownloadsAndAtLeastTheMinimum)
+    {
+      for (size_t max_downloads : {1, 3})
+      {
+        TempDirectory directory("image_cache_concurrency");
+        auto downloader = std::make_unique<FakeImageDownloader>();
+        FakeImageDownloader &images = *downloader;
+        ImageCache cache(directory.path(), std::move(downloader), ImageCache::kDefaultMaxBytes, max_downloads);
+        int expected = static_cast<int>(std::max(max_downloads, ImageCache::kMinDownloads));
+
+        images.Hold();
+        std::atomic<int> done{0};
+        for (int i = 0; i < 8; i++)
+        {
+          images.SetImage("https://example.com/" + std::to_string(i), BodyOf('0' + i, 10));
+          cache.Fetch("https://example.com/" + std::to_string(i), [&done](const StoreResult<std::string> &path)
+                      { done++; });
+        }
+        ASSERT_TRUE(images.WaitForStarted(expected));
+        std::this_thread::sleep_for(50ms);
+        EXPECT_EQ(images.TotalDownloads(), expected) << max_downloads;
+        images.Release();
+        auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (done < 8 && std::chrono::steady_clock::now() < deadline)
+        {
+          std::this_thread::sleep_for(1ms);
+        }
+        EXPECT_EQ(done, 8);
+        EXPECT_EQ(images.MaxConcurrentDownloads(), expected) << max_downloads;
+      }
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,226 @@
+#include "json_extractor.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "reference_json.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Object keys as JSON text. Path segments below include each of them,
+      // escaped as JSON Pointers.
+      const char *const kKeys[] = {"\"a\"", "\"b\"", "\"Skus\"", "\"Title\"", "\"0\"", "\"a/b\"", "\"t~n\"",
+                                   "\"\\u00e9t\\u00e9\"", "\"\\\"q\\\"\"", "\"\""};
+
+      const char *const kStrings[] = {
+          "\"\"", "\"Title\"", "\"line\\nbreak\"", "\"tab\\tand \\\"quotes\\\"\"", "\"\\\\\"", "\"\\/slash\"",
+          "\"caf\\u00e9\"", "\"\xc3\xa9t\xc3\xa9\"", "\"emoji \\ud83d\\ude00\"", "\"{not [a] container}\"",
+          "\"a long string that spans more than sixteen bytes, to cross SIMD blocks\""};
+
+      const char *const kNumbers[] = {"0", "-0", "7", "-12", "3.25", "1e3", "-2.5E-3", "6.02e+23", "12345678901234567890",
+                                      "1e400", "0.1"};
+
+      const char *const kSegments[] = {"a", "b", "Skus", "Title", "0", "1", "2", "01", "a~1b", "t~0n", "*", "*",
+                                       "\xc3\xa9t\xc3\xa9", "\"q\"", ""};
+
+      class JsonGenerator
+      {
+      public:
+        explicit JsonGenerator(uint32_t seed) : random_(seed) {}
+
+        std::string Document() { return Value(0); }
+
+        std::vector<JsonExtractor::Field> Fields()
+        {
+          std::vector<JsonExtractor::Field> fields(1 + Next(6));
+          for (JsonExtractor::Field &field : fields)
+          {
+            for (size_t depth = Next(5); depth > 0; depth--)
+            {
+              field.path += "/";
+              field.path += kSegments[Next(std::size(kSegments))];
+            }
+            field.type = static_cast<JsonFieldType>(Next(4));
+          }
+          return fields;
+        }
+
+      private:
+        std::string Value(size_t depth)
+        {
+          size_t kind = Next(depth < 5 ? 7 : 5);
+          switch (kind)
+          {
+          case 0:
+            return kStrings[Next(std::size(kStrings))];
+          case 1:
+            return kNumbers[Next(std::size(kNumbers))];
+          case 2:
+            return Next(2) == 0 ? "true" : "false";
+          case 3:
+            return "null";
+          case 4:
+            return std::to_string(Next(1000));
+          case 5:
+          {
+            std::string json = "{";
+            for (size_t i = 0, count = Next(5); i < count; i++)
+            {
+              json += (i > 0 ? "," : "") + Space() + kKeys[Next(std::size(kKeys))] + Space() + ":" + Space() +
+                      Value(depth + 1) + Space();
+            }
+            return json + "}";
+          }
+          default:
+          {
+            std::string json = "[" + Space();
+            for (size_t i = 0, count = Next(5); i < count; i++)
+            {
+              json += (i > 0 ? "," : "") + Space() + Value(depth + 1) + Space();
+            }
+            return json + "]";
+          }
+          }
+        }
+
+        std::string Space()
+        {
+          static const char *const kSpaces[] = {"", "", "", " ", "\n  ", "\t", "\r\n"};
+          return kSpaces[Next(std::size(kSpaces))];
+        }
+
+        size_t Next(size_t bound) { return random_() % bound; }
+
+        std::mt19937 random_;
+      };
+
+      std::string Describe(const std::vector<JsonExtractor::Field> &fields)
+      {
+        std::string description;
+        for (const JsonExtractor::Field &field : fields)
+        {
+          description += " '" + field.path + "':" + std::to_string(static_cast<int>(field.type));
+        }
+        return description;
+      }
+
+    } // namespace
+
+    TEST(JsonExtractor, ExtractsTypedValues)
+    {
+      JsonExtractor extractor({{"/Skus/0/Sku/Title", JsonFieldType::kString},
+                               {"/Skus/*/Price", JsonFieldType::kNumber},
+                               {"/IsBundle", JsonFieldType::kBool},
+                               {"/Skus/1", JsonFieldType::kRaw},
+                               {"/Missing", JsonFieldType::kString},
+                               {"no leading slash", JsonFieldType::kString}});
+      std::vector<std::optional<JsonValue>> values;
+      ASSERT_TRUE(extractor.Extract(
+          R"({"IsBundle": true, "Skus": [{"Sku": {"Title": "Gold \u00e9dition"}, "Price": "n/a"},)"
+          R"( {"Price": 4.99}]})",
+          values));
+      ASSERT_EQ(values.size(), 6u);
+      EXPECT_EQ(values[0], JsonValue(std::string("Gold \xc3\xa9""dition")));
+      // The first price that is a number.
+      EXPECT_EQ(values[1], JsonValue(4.99));
+      EXPECT_EQ(values[2], JsonValue(true));
+      EXPECT_EQ(values[3], JsonValue(std::string(R"({"Price": 4.99})")));
+      EXPECT_FALSE(values[4].has_value());
+      EXPECT_FALSE(values[5].has_value());
+    }
+
+    TEST(JsonExtractor, RejectsMalformedDocuments)
+    {
+      JsonExtractor extractor({{"/a", JsonFieldType::kString}, {"/b", JsonFieldType::kNumber}});
+      std::vector<std::optional<JsonValue>> values;
+      for (const char *json : {"", "{", R"({"a": "x")", R"({"a": 01})", R"({"a": "\x"})", R"({"a": "\ud800"})",
+                               R"({"a": "x",})", R"({"a" "x"})", R"({"a": tru})", R"({} x)"})
+      {
+        EXPECT_FALSE(extractor.Extract(json, values)) << json;
+      }
+
+      // Values before the error are kept.
+      EXPECT_FALSE(extractor.Extract(R"({"a": "x", "c": [})", values));
+      EXPECT_EQ(values[0], JsonValue(std::string("x")));
+    }
+
+    TEST(JsonExtractor, MatchesTheReferenceParser)
+    {
+      JsonGenerator generator(20261018);
+      for (int i = 0; i < 20000; i++)
+      {
+        std::string json = generator.Document();
+        std::vector<JsonExtractor::Field> fields = generator.Fields();
+        std::vector<std::optional<JsonValue>> expected;
+        ASSERT_TRUE(ReferenceExtract(json, fields, expected)) << json;
+        std::vector<std::optional<JsonValue>> values;
+        ASSERT_TRUE(JsonExtractor(fields).Extract(json, values)) << json;
+        ASSERT_EQ(values, expected) << json << Describe(fields);
+      }
+    }
+
+    TEST(JsonExtractor, MutatedDocumentsMatchTheReferenceWhenWellFormed)
+    {
+      JsonGenerator generator(7);
+      std::mt19937 random(11);
+      const std::string kAlphabet = "{}[]\":,\\ 0-.eu\x01\xc3tfn";
+      int well_formed = 0;
+      for (int i = 0; i < 50000; i++)
+      {
+        std::string json = generator.Document();
+        std::vector<JsonExtractor::Field> fields = generator.Fields();
+        for (size_t edits = 1 + random() % 3; edits > 0 && !json.empty(); edits--)
+        {
+          size_t pos = random() % json.size();
+          switch (random() % 4)
+          {
+          case 0:
+            json.erase(pos, 1);
+            break;
+          case 1:
+            json.insert(json.begin() + pos, kAlphabet[random() % kAlphabet.size()]);
+            break;
+          case 2:
+            json[pos] = kAlphabet[random() % kAlphabet.size()];
+            break;
+          default:
+            json.resize(pos);
+            break;
+          }
+        }
+
+        // Malformed input only has to be survived: skipped subtrees are
+        // not fully validated, and parsing stops once every field is found.
+        std::vector<std::optional<JsonValue>> values;
+        bool ok = JsonExtractor(fields).Extract(json, values);
+        std::vector<std::optional<JsonValue>> expected;
+        if (ReferenceExtract(json, fields, expected))
+        {
+          well_formed++;
+          ASSERT_TRUE(ok) << json;
+          ASSERT_EQ(values, expected) << json << Describe(fields);
+        }
+      }
+      EXPECT_GT(well_formed, 1000);
+    }
+
+    TEST(JsonExtractor, IgnoresFieldsPastTheLimit)
+    {
+      std::vector<JsonExtractor::Field> fields(JsonExtractor::kMaxFields + 1, {"/a", JsonFieldType::kNumber});
+      std::vector<std::optional<JsonValue>> values;
+      ASSERT_TRUE(JsonExtractor(fields).Extract(R"({"a": 1})", values));
+      EXPECT_EQ(values.front(), JsonValue(1.0));
+      EXPECT_FALSE(values.back().has_value());
+    }
+
+  } // namespace test
+} // namespace windows_store
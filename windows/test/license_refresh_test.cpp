@@ -0,0 +1,227 @@
+#include "license_refresh.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      using namespace std::chrono_literals;
+      using Clock = LicenseRefreshScheduler::Clock;
+
+      constexpr int64_t kNowUnixMs = 1700000000000;
+
+      LicenseSnapshot FullLicense()
+      {
+        LicenseSnapshot license;
+        license.is_active = true;
+        license.sku_store_id = "9NPRO/0010";
+        return license;
+      }
+
+      LicenseSnapshot TrialLicense(std::chrono::milliseconds remaining)
+      {
+        LicenseSnapshot license = FullLicense();
+        license.is_trial = true;
+        license.trial_time_remaining_ms = remaining.count();
+        return license;
+      }
+
+      // A scheduler without a timer, on a clock the test advances.
+      class ManualScheduler
+      {
+      public:
+        ManualScheduler()
+            : scheduler_([this](uint64_t generation)
+                         {
+              last_generation_ = generation;
+              revalidations_++; },
+                         [this]()
+                         { return now_; },
+                         false) {}
+
+        LicenseRefreshScheduler &scheduler() { return scheduler_; }
+        int revalidations() const { return revalidations_; }
+        // Generation of the last revalidation started.
+        uint64_t last_generation() const { return last_generation_; }
+        void Advance(Clock::duration duration) { now_ += duration; }
+
+      private:
+        Clock::time_point now_ = Clock::time_point() + 1000h;
+        std::atomic<int> revalidations_{0};
+        std::atomic<uint64_t> last_generation_{0};
+        LicenseRefreshScheduler scheduler_;
+      };
+
+    } // namespace
+
+    TEST(LicenseRefresh, DelayFollowsTheLicense)
+    {
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(FullLicense(), kNowUnixMs),
+                LicenseRefreshScheduler::kFullLicenseDelay);
+
+      LicenseSnapshot inactive = FullLicense();
+      inactive.is_active = false;
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(inactive, kNowUnixMs),
+                LicenseRefreshScheduler::kInactiveLicenseDelay);
+
+      // A quarter of the remaining trial, between one minute and six hours.
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(TrialLicense(8h), kNowUnixMs), 2h);
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(TrialLicense(100h), kNowUnixMs),
+                LicenseRefreshScheduler::kMaxTrialDelay);
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(TrialLicense(30s), kNowUnixMs),
+                LicenseRefreshScheduler::kMinDelay);
+    }
+
+    TEST(LicenseRefresh, DelayEndsWhenAnAddOnExpires)
+    {
+      LicenseSnapshot license = FullLicense();
+      license.add_ons.push_back(AddOnLicenseRecord{"9NADDON/0010", "", true, kNowUnixMs + 10 * 60 * 1000});
+      // Already expired, or inactive: ignored.
+      license.add_ons.push_back(AddOnLicenseRecord{"9NOLD/0010", "", true, kNowUnixMs - 1});
+      license.add_ons.push_back(AddOnLicenseRecord{"9NOFF/0010", "", false, kNowUnixMs + 1000});
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(license, kNowUnixMs), 10min);
+
+      license.add_ons[0].expiration_ms = kNowUnixMs + 1000;
+      EXPECT_EQ(LicenseRefreshScheduler::RefreshDelay(license, kNowUnixMs), LicenseRefreshScheduler::kMinDelay);
+    }
+
+    TEST(LicenseRefresh, ServesStaleLicenseWhileRevalidating)
+    {
+      ManualScheduler manual;
+      LicenseRefreshScheduler &scheduler = manual.scheduler();
+      EXPECT_EQ(scheduler.Get(), nullptr);
+      EXPECT_EQ(manual.revalidations(), 0);
+
+      auto license = std::make_shared<const LicenseSnapshot>(FullLicense());
+      scheduler.Complete(license, scheduler.Generation());
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay - 1ms);
+      scheduler.Tick();
+      EXPECT_EQ(scheduler.Get(), license);
+      EXPECT_EQ(manual.revalidations(), 0);
+
+      // Stale: still served, and revalidated once.
+      manual.Advance(1ms);
+      EXPECT_EQ(scheduler.Get(), license);
+      EXPECT_EQ(scheduler.Get(), license);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 1);
+
+      auto renewed = std::make_shared<const LicenseSnapshot>(TrialLicense(4h));
+      scheduler.Complete(renewed, scheduler.Generation());
+      EXPECT_EQ(scheduler.Get(), renewed);
+      manual.Advance(1h);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 2);
+    }
+
+    TEST(LicenseRefresh, RetriesWithExponentialBackoff)
+    {
+      ManualScheduler manual;
+      LicenseRefreshScheduler &scheduler = manual.scheduler();
+      scheduler.Complete(std::make_shared<const LicenseSnapshot>(FullLicense()), scheduler.Generation());
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay);
+      scheduler.Tick();
+      ASSERT_EQ(manual.revalidations(), 1);
+
+      int expected = 1;
+      for (auto delay : {1min, 2min, 4min, 8min, 16min, 30min, 30min})
+      {
+        scheduler.Fail(manual.last_generation());
+        manual.Advance(delay - 1s);
+        scheduler.Tick();
+        EXPECT_EQ(manual.revalidations(), expected) << delay.count();
+        manual.Advance(1s);
+        scheduler.Tick();
+        EXPECT_EQ(manual.revalidations(), ++expected) << delay.count();
+      }
+
+      // A success resets the backoff.
+      scheduler.Complete(std::make_shared<const LicenseSnapshot>(FullLicense()), scheduler.Generation());
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay);
+      scheduler.Tick();
+      scheduler.Fail(manual.last_generation());
+      manual.Advance(LicenseRefreshScheduler::kMinDelay);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), expected + 2);
+    }
+
+    TEST(LicenseRefresh, PausesWhileTheAppIsInactive)
+    {
+      ManualScheduler manual;
+      LicenseRefreshScheduler &scheduler = manual.scheduler();
+      scheduler.Complete(std::make_shared<const LicenseSnapshot>(FullLicense()), scheduler.Generation());
+      scheduler.SetAppActive(false);
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay * 3);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 0);
+
+      // Catches up once activated.
+      scheduler.SetAppActive(true);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 1);
+    }
+
+    TEST(LicenseRefresh, GetRevalidatesEvenWhileInactive)
+    {
+      ManualScheduler manual;
+      LicenseRefreshScheduler &scheduler = manual.scheduler();
+      scheduler.Complete(std::make_shared<const LicenseSnapshot>(FullLicense()), scheduler.Generation());
+      scheduler.SetAppActive(false);
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay);
+      EXPECT_NE(scheduler.Get(), nullptr);
+      EXPECT_EQ(manual.revalidations(), 1);
+    }
+
+    TEST(LicenseRefresh, InvalidateDropsTheLicense)
+    {
+      ManualScheduler manual;
+      LicenseRefreshScheduler &scheduler = manual.scheduler();
+      scheduler.Complete(std::make_shared<const LicenseSnapshot>(FullLicense()), scheduler.Generation());
+      scheduler.Invalidate();
+      EXPECT_EQ(scheduler.Get(), nullptr);
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 0);
+    }
+
+    TEST(LicenseRefresh, InvalidateDisregardsFetchesInFlight)
+    {
+      ManualScheduler manual;
+      LicenseRefreshScheduler &scheduler = manual.scheduler();
+      auto replaced = std::make_shared<const LicenseSnapshot>(FullLicense());
+      scheduler.Complete(replaced, scheduler.Generation());
+      manual.Advance(LicenseRefreshScheduler::kFullLicenseDelay);
+      scheduler.Tick();
+      ASSERT_EQ(manual.revalidations(), 1);
+      uint64_t started = manual.last_generation();
+
+      // Licenses change while the revalidation runs, which then still
+      // answers with the license they replaced.
+      scheduler.Invalidate();
+      EXPECT_FALSE(scheduler.Complete(replaced, started));
+      EXPECT_EQ(scheduler.Get(), nullptr);
+
+      auto renewed = std::make_shared<const LicenseSnapshot>(TrialLicense(4h));
+      EXPECT_TRUE(scheduler.Complete(renewed, scheduler.Generation()));
+      // Nor does a late failure reschedule the new license.
+      scheduler.Fail(started);
+      EXPECT_EQ(scheduler.Get(), renewed);
+      manual.Advance(1h - 1s);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 1);
+      manual.Advance(1s);
+      scheduler.Tick();
+      EXPECT_EQ(manual.revalidations(), 2);
+    }
+
+  } // namespace test
+} // namespace windows_store
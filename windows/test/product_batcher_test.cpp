@@ -0,0 +1,247 @@
+#include "product_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      using namespace std::chrono_literals;
+
+      // Stand-in for the Store: records every fetch and answers with the
+      // products among a fixed set, or with a failure.
+      class FakeFetch
+      {
+      public:
+        struct Call
+        {
+          std::vector<std::string> store_ids;
+          uint64_t field_mask;
+        };
+
+        explicit FakeFetch(std::vector<std::string> known_ids) : known_ids_(std::move(known_ids)) {}
+
+        ProductBatcher::Fetch fetch()
+        {
+          return [this](const std::vector<std::string> &store_ids, uint64_t field_mask)
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            calls_.push_back({store_ids, field_mask});
+            if (hresult_ < 0)
+            {
+              return StoreResult<std::vector<StoreProductRecord>>::Failure(hresult_, "Store unavailable");
+            }
+            StoreResult<std::vector<StoreProductRecord>> result;
+            for (const std::string &store_id : store_ids)
+            {
+              if (std::find(known_ids_.begin(), known_ids_.end(), store_id) != known_ids_.end())
+              {
+                StoreProductRecord product;
+                product.store_id = store_id;
+                product.title = "Title of " + store_id;
+                result.value.push_back(product);
+              }
+            }
+            return result;
+          };
+        }
+
+        void Fail(int32_t hresult) { hresult_ = hresult; }
+
+        std::vector<Call> calls()
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          return calls_;
+        }
+
+      private:
+        std::vector<std::string> known_ids_;
+        int32_t hresult_ = 0;
+        std::mutex mutex_;
+        std::vector<Call> calls_;
+      };
+
+      // Results of Load calls, by the order they were made in.
+      class Results
+      {
+      public:
+        ProductBatcher::Callback Add()
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          size_t index = results_.size();
+          results_.emplace_back();
+          return [this, index](const StoreResult<const StoreProductRecord *> &result)
+          {
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              Result &entry = results_[index];
+              entry.done = true;
+              entry.hresult = result.hresult;
+              entry.message = result.message;
+              entry.title = result.ok() && result.value != nullptr ? result.value->title : "";
+              entry.found = result.ok() && result.value != nullptr;
+              done_++;
+            }
+            changed_.notify_all();
+          };
+        }
+
+        bool WaitFor(size_t count, std::chrono::milliseconds timeout = 5s)
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          return changed_.wait_for(lock, timeout, [this, count]()
+                                   { return done_ >= count; });
+        }
+
+        struct Result
+        {
+          bool done = false;
+          int32_t hresult = 0;
+          std::string message;
+          bool found = false;
+          std::string title;
+        };
+
+        Result at(size_t index)
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          return results_[index];
+        }
+
+      private:
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        std::vector<Result> results_;
+        size_t done_ = 0;
+      };
+
+      // Runs batches on the thread that dispatches them.
+      void PostInline(std::function<void()> task)
+      {
+        task();
+      }
+
+    } // namespace
+
+    TEST(ProductBatcher, MergesLookupsWithinTheWindow)
+    {
+      FakeFetch fetch({"9NA", "9NB"});
+      Results results;
+      ProductBatcher batcher(fetch.fetch(), PostInline);
+      batcher.SetWindow(50ms, 10);
+      batcher.Load("9NA", ProductFieldBit(ProductField::kTitle), results.Add());
+      batcher.Load("9NB", ProductFieldBit(ProductField::kDescription), results.Add());
+      batcher.Load("9NA", ProductFieldBit(ProductField::kFormattedPrice), results.Add());
+      batcher.Load("9NMISSING", ProductFieldBit(ProductField::kTitle), results.Add());
+      ASSERT_TRUE(results.WaitFor(4));
+
+      std::vector<FakeFetch::Call> calls = fetch.calls();
+      ASSERT_EQ(calls.size(), 1u);
+      EXPECT_EQ(calls[0].store_ids, (std::vector<std::string>{"9NA", "9NB", "9NMISSING"}));
+      EXPECT_EQ(calls[0].field_mask, ProductFieldBit(ProductField::kTitle) |
+                                         ProductFieldBit(ProductField::kDescription) |
+                                         ProductFieldBit(ProductField::kFormattedPrice) |
+                                         ProductFieldBit(ProductField::kStoreId));
+      EXPECT_EQ(results.at(0).title, "Title of 9NA");
+      EXPECT_EQ(results.at(1).title, "Title of 9NB");
+      EXPECT_EQ(results.at(2).title, "Title of 9NA");
+      EXPECT_TRUE(results.at(3).done);
+      EXPECT_FALSE(results.at(3).found);
+    }
+
+    TEST(ProductBatcher, FullBatchIsSentBeforeTheWindowEnds)
+    {
+      FakeFetch fetch({"9NA", "9NB", "9NC", "9ND"});
+      Results results;
+      {
+        ProductBatcher batcher(fetch.fetch(), PostInline);
+        batcher.SetWindow(10s, 3);
+        batcher.Load("9NA", 0, results.Add());
+        batcher.Load("9NB", 0, results.Add());
+        // A repeated ID does not count towards the size.
+        batcher.Load("9NA", 0, results.Add());
+        EXPECT_TRUE(fetch.calls().empty());
+        batcher.Load("9NC", 0, results.Add());
+
+        // Dispatched inline by the Load that filled the batch.
+        ASSERT_EQ(fetch.calls().size(), 1u);
+        EXPECT_EQ(fetch.calls()[0].store_ids, (std::vector<std::string>{"9NA", "9NB", "9NC"}));
+        for (size_t i = 0; i < 4; i++)
+        {
+          EXPECT_TRUE(results.at(i).found) << i;
+        }
+
+        // Still pending when the batcher is destroyed: dropped.
+        batcher.Load("9ND", 0, results.Add());
+      }
+      EXPECT_EQ(fetch.calls().size(), 1u);
+      EXPECT_FALSE(results.at(4).done);
+    }
+
+    TEST(ProductBatcher, ZeroWindowSendsEveryLookup)
+    {
+      FakeFetch fetch({"9NA"});
+      Results results;
+      ProductBatcher batcher(fetch.fetch(), PostInline);
+      batcher.SetWindow(0us, 50);
+      batcher.Load("9NA", 0, results.Add());
+      batcher.Load("9NA", 0, results.Add());
+
+      std::vector<FakeFetch::Call> calls = fetch.calls();
+      ASSERT_EQ(calls.size(), 2u);
+      EXPECT_EQ(calls[0].store_ids, std::vector<std::string>{"9NA"});
+      EXPECT_EQ(calls[1].store_ids, std::vector<std::string>{"9NA"});
+      EXPECT_TRUE(results.at(0).found);
+      EXPECT_TRUE(results.at(1).found);
+    }
+
+    TEST(ProductBatcher, FailureReachesEveryLookup)
+    {
+      FakeFetch fetch({"9NA", "9NB"});
+      fetch.Fail(-2147023838);
+      Results results;
+      ProductBatcher batcher(fetch.fetch(), PostInline);
+      batcher.SetWindow(20ms, 10);
+      batcher.Load("9NA", 0, results.Add());
+      batcher.Load("9NB", 0, results.Add());
+      batcher.Load("9NA", 0, results.Add());
+      ASSERT_TRUE(results.WaitFor(3));
+
+      EXPECT_EQ(fetch.calls().size(), 1u);
+      for (size_t i = 0; i < 3; i++)
+      {
+        EXPECT_EQ(results.at(i).hresult, -2147023838) << i;
+        EXPECT_EQ(results.at(i).message, "Store unavailable") << i;
+        EXPECT_FALSE(results.at(i).found) << i;
+      }
+    }
+
+    TEST(ProductBatcher, LaterLookupsStartANewBatch)
+    {
+      FakeFetch fetch({"9NA", "9NB"});
+      Results results;
+      ProductBatcher batcher(fetch.fetch(), PostInline);
+      batcher.SetWindow(20ms, 10);
+      batcher.Load("9NA", 0, results.Add());
+      ASSERT_TRUE(results.WaitFor(1));
+      batcher.Load("9NB", 0, results.Add());
+      ASSERT_TRUE(results.WaitFor(2));
+
+      std::vector<FakeFetch::Call> calls = fetch.calls();
+      ASSERT_EQ(calls.size(), 2u);
+      EXPECT_EQ(calls[1].store_ids, std::vector<std::string>{"9NB"});
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,434 @@
+#include "reference_json.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      struct Node
+      {
+        enum class Kind
+        {
+          kNull,
+          kBool,
+          kNumber,
+          kString,
+          kArray,
+          kObject,
+        };
+
+        Kind kind = Kind::kNull;
+        bool boolean = false;
+        // Empty if the number does not fit a double.
+        std::optional<double> number;
+        std::string string;
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> members;
+        // The JSON text of the value.
+        size_t begin = 0;
+        size_t end = 0;
+      };
+
+      class Parser
+      {
+      public:
+        explicit Parser(std::string_view json) : json_(json) {}
+
+        std::unique_ptr<Node> ParseDocument()
+        {
+          std::unique_ptr<Node> root = ParseValue(0);
+          SkipWhitespace();
+          if (!root || pos_ != json_.size())
+          {
+            return nullptr;
+          }
+          return root;
+        }
+
+      private:
+        std::unique_ptr<Node> ParseValue(size_t depth)
+        {
+          SkipWhitespace();
+          if (pos_ >= json_.size() || depth > JsonExtractor::kMaxDepth)
+          {
+            return nullptr;
+          }
+          auto node = std::make_unique<Node>();
+          node->begin = pos_;
+          char c = json_[pos_];
+          bool ok;
+          if (c == '{' || c == '[')
+          {
+            node->kind = c == '{' ? Node::Kind::kObject : Node::Kind::kArray;
+            ok = ParseContainer(*node, depth);
+          }
+          else if (c == '"')
+          {
+            node->kind = Node::Kind::kString;
+            ok = ParseString(node->string);
+          }
+          else if (Literal("true") || Literal("false"))
+          {
+            node->kind = Node::Kind::kBool;
+            node->boolean = c == 't';
+            ok = true;
+          }
+          else if (Literal("null"))
+          {
+            ok = true;
+          }
+          else
+          {
+            node->kind = Node::Kind::kNumber;
+            ok = ParseNumber(node->number);
+          }
+          node->end = pos_;
+          return ok ? std::move(node) : nullptr;
+        }
+
+        bool ParseContainer(Node &node, size_t depth)
+        {
+          char close = node.kind == Node::Kind::kObject ? '}' : ']';
+          pos_++;
+          SkipWhitespace();
+          if (Consume(close))
+          {
+            return true;
+          }
+          while (true)
+          {
+            std::string key;
+            if (node.kind == Node::Kind::kObject)
+            {
+              SkipWhitespace();
+              if (pos_ >= json_.size() || json_[pos_] != '"' || !ParseString(key))
+              {
+                return false;
+              }
+              SkipWhitespace();
+              if (!Consume(':'))
+              {
+                return false;
+              }
+            }
+            std::unique_ptr<Node> value = ParseValue(depth + 1);
+            if (!value)
+            {
+              return false;
+            }
+            node.members.emplace_back(std::move(key), std::move(value));
+            SkipWhitespace();
+            if (Consume(close))
+            {
+              return true;
+            }
+            if (!Consume(','))
+            {
+              return false;
+            }
+          }
+        }
+
+        bool ParseString(std::string &out)
+        {
+          pos_++;
+          while (pos_ < json_.size())
+          {
+            unsigned char c = static_cast<unsigned char>(json_[pos_++]);
+            if (c == '"')
+            {
+              return true;
+            }
+            if (c < 0x20)
+            {
+              return false;
+            }
+            if (c != '\\')
+            {
+              out.push_back(static_cast<char>(c));
+              continue;
+            }
+            if (pos_ >= json_.size())
+            {
+              return false;
+            }
+            char escape = json_[pos_++];
+            const std::string_view kEscapes = "\"\"\\\\//b\bf\fn\nr\rt\t";
+            size_t found = kEscapes.find(escape);
+            if (escape != 'u')
+            {
+              if (found == std::string_view::npos || found % 2 != 0)
+              {
+                return false;
+              }
+              out.push_back(kEscapes[found + 1]);
+              continue;
+            }
+            uint32_t code_point;
+            if (!ParseHex4(code_point))
+            {
+              return false;
+            }
+            if (code_point >= 0xDC00 && code_point < 0xE000)
+            {
+              return false;
+            }
+            if (code_point >= 0xD800 && code_point < 0xDC00)
+            {
+              uint32_t low;
+              if (!Consume('\\') || !Consume('u') || !ParseHex4(low) || low < 0xDC00 || low >= 0xE000)
+              {
+                return false;
+              }
+              code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+            }
+            AppendUtf8(code_point, out);
+          }
+          return false;
+        }
+
+        bool ParseHex4(uint32_t &value)
+        {
+          if (pos_ + 4 > json_.size())
+          {
+            return false;
+          }
+          std::string digits(json_.substr(pos_, 4));
+          if (digits.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+          {
+            return false;
+          }
+          value = static_cast<uint32_t>(std::stoul(digits, nullptr, 16));
+          pos_ += 4;
+          return true;
+        }
+
+        static void AppendUtf8(uint32_t code_point, std::string &out)
+        {
+          if (code_point < 0x80)
+          {
+            out.push_back(static_cast<char>(code_point));
+            return;
+          }
+          int continuation = code_point < 0x800 ? 1 : code_point < 0x10000 ? 2 : 3;
+          static const unsigned char kLead[] = {0, 0xC0, 0xE0, 0xF0};
+          out.push_back(static_cast<char>(kLead[continuation] | (code_point >> (6 * continuation))));
+          for (int i = continuation - 1; i >= 0; i--)
+          {
+            out.push_back(static_cast<char>(0x80 | ((code_point >> (6 * i)) & 0x3F)));
+          }
+        }
+
+        // Number grammar of RFC 8259, section 6.
+        bool ParseNumber(std::optional<double> &value)
+        {
+          size_t start = pos_;
+          Consume('-');
+          size_t digits = Digits();
+          if (digits == 0 || (digits > 1 && json_[pos_ - digits] == '0'))
+          {
+            return false;
+          }
+          if (Consume('.') && Digits() == 0)
+          {
+            return false;
+          }
+          if (Consume('e') || Consume('E'))
+          {
+            if (!Consume('+'))
+            {
+              Consume('-');
+            }
+            if (Digits() == 0)
+            {
+              return false;
+            }
+          }
+          std::string text(json_.substr(start, pos_ - start));
+          errno = 0;
+          double number = std::strtod(text.c_str(), nullptr);
+          if (errno != ERANGE)
+          {
+            value = number;
+          }
+          return true;
+        }
+
+        size_t Digits()
+        {
+          size_t start = pos_;
+          while (pos_ < json_.size() && json_[pos_] >= '0' && json_[pos_] <= '9')
+          {
+            pos_++;
+          }
+          return pos_ - start;
+        }
+
+        bool Literal(std::string_view literal)
+        {
+          if (json_.compare(pos_, literal.size(), literal) != 0)
+          {
+            return false;
+          }
+          pos_ += literal.size();
+          return true;
+        }
+
+        bool Consume(char c)
+        {
+          if (pos_ < json_.size() && json_[pos_] == c)
+          {
+            pos_++;
+            return true;
+          }
+          return false;
+        }
+
+        void SkipWhitespace()
+        {
+          while (pos_ < json_.size() &&
+                 (json_[pos_] == ' ' || json_[pos_] == '\n' || json_[pos_] == '\r' || json_[pos_] == '\t'))
+          {
+            pos_++;
+          }
+        }
+
+        std::string_view json_;
+        size_t pos_ = 0;
+      };
+
+      // Splits a JSON Pointer into unescaped segments. Returns false if it
+      // is not one.
+      bool SplitPointer(const std::string &path, std::vector<std::string> &segments)
+      {
+        if (path.empty())
+        {
+          return true;
+        }
+        if (path[0] != '/')
+        {
+          return false;
+        }
+        size_t start = 1;
+        while (true)
+        {
+          size_t end = path.find('/', start);
+          std::string raw = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+          std::string segment;
+          for (size_t i = 0; i < raw.size(); i++)
+          {
+            if (raw[i] != '~')
+            {
+              segment.push_back(raw[i]);
+            }
+            else if (i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1'))
+            {
+              segment.push_back(raw[++i] == '0' ? '~' : '/');
+            }
+            else
+            {
+              return false;
+            }
+          }
+          segments.push_back(std::move(segment));
+          if (end == std::string::npos)
+          {
+            return true;
+          }
+          start = end + 1;
+        }
+      }
+
+      // An array index segment: decimal digits without a leading zero.
+      bool MatchesIndex(const std::string &segment, size_t index)
+      {
+        if (segment.empty() || segment.size() > 9 || (segment.size() > 1 && segment[0] == '0') ||
+            segment.find_first_not_of("0123456789") != std::string::npos)
+        {
+          return false;
+        }
+        return std::stoul(segment) == index;
+      }
+
+      // Returns the first value at |segments| below |node|, in document
+      // order, that has |type|.
+      std::optional<JsonValue> Find(std::string_view json, const Node &node,
+                                    const std::vector<std::string> &segments, size_t depth, JsonFieldType type)
+      {
+        if (depth == segments.size())
+        {
+          switch (type)
+          {
+          case JsonFieldType::kString:
+            if (node.kind == Node::Kind::kString)
+            {
+              return JsonValue(node.string);
+            }
+            break;
+          case JsonFieldType::kNumber:
+            if (node.kind == Node::Kind::kNumber && node.number)
+            {
+              return JsonValue(*node.number);
+            }
+            break;
+          case JsonFieldType::kBool:
+            if (node.kind == Node::Kind::kBool)
+            {
+              return JsonValue(node.boolean);
+            }
+            break;
+          case JsonFieldType::kRaw:
+            return JsonValue(std::string(json.substr(node.begin, node.end - node.begin)));
+          }
+          return std::nullopt;
+        }
+        const std::string &segment = segments[depth];
+        for (size_t i = 0; i < node.members.size(); i++)
+        {
+          bool matches = segment == "*" ||
+                         (node.kind == Node::Kind::kObject ? node.members[i].first == segment
+                                                           : MatchesIndex(segment, i));
+          if (!matches)
+          {
+            continue;
+          }
+          if (std::optional<JsonValue> value = Find(json, *node.members[i].second, segments, depth + 1, type))
+          {
+            return value;
+          }
+        }
+        return std::nullopt;
+      }
+
+    } // namespace
+
+    bool ReferenceExtract(std::string_view json, const std::vector<JsonExtractor::Field> &fields,
+                          std::vector<std::optional<JsonValue>> &values)
+    {
+      values.assign(fields.size(), std::nullopt);
+      std::unique_ptr<Node> root = Parser(json).ParseDocument();
+      if (!root)
+      {
+        return false;
+      }
+      for (size_t i = 0; i < fields.size() && i < JsonExtractor::kMaxFields; i++)
+      {
+        std::vector<std::string> segments;
+        if (SplitPointer(fields[i].path, segments) && segments.size() <= JsonExtractor::kMaxDepth)
+        {
+          values[i] = Find(json, *root, segments, 0, fields[i].type);
+        }
+      }
+      return true;
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,25 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_TEST_REFERENCE_JSON_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_TEST_REFERENCE_JSON_H_
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "json_extractor.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    // What JsonExtractor::Extract returns for a well-formed document, done
+    // the straightforward way: the whole document is parsed into a tree and
+    // validated, then each field's path is looked up in document order.
+    // Returns false, with no values, if |json| is malformed.
+    bool ReferenceExtract(std::string_view json, const std::vector<JsonExtractor::Field> &fields,
+                          std::vector<std::optional<JsonValue>> &values);
+
+  } // namespace test
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_TEST_REFERENCE_JSON_H_
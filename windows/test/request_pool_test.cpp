@@ -0,0 +1,110 @@
+#include "request_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      std::atomic<int> g_created{0};
+      std::atomic<int> g_destroyed{0};
+
+      struct CountedContext
+      {
+        CountedContext() { g_created++; }
+        ~CountedContext() { g_destroyed++; }
+
+        int uses = 0;
+      };
+
+    } // namespace
+
+    TEST(RequestPool, ReusesReleasedContexts)
+    {
+      g_created = 0;
+      g_destroyed = 0;
+      {
+        RequestPool<CountedContext> pool(2);
+        for (int i = 0; i < 100; i++)
+        {
+          CountedContext *context = pool.Acquire();
+          context->uses++;
+          pool.Release(context);
+        }
+        EXPECT_EQ(g_created, 1);
+
+        // State is kept; callers reset what they use.
+        CountedContext *context = pool.Acquire();
+        EXPECT_EQ(context->uses, 100);
+        pool.Release(context);
+      }
+      EXPECT_EQ(g_destroyed, 1);
+    }
+
+    TEST(RequestPool, KeepsAtMostMaxIdle)
+    {
+      g_created = 0;
+      g_destroyed = 0;
+      {
+        RequestPool<CountedContext> pool(2);
+        std::vector<CountedContext *> contexts;
+        for (int i = 0; i < 5; i++)
+        {
+          contexts.push_back(pool.Acquire());
+        }
+        EXPECT_EQ(g_created, 5);
+        for (CountedContext *context : contexts)
+        {
+          pool.Release(context);
+        }
+        EXPECT_EQ(g_destroyed, 3);
+
+        for (int i = 0; i < 2; i++)
+        {
+          contexts[i] = pool.Acquire();
+        }
+        EXPECT_EQ(g_created, 5);
+        pool.Release(contexts[0]);
+        pool.Release(contexts[1]);
+      }
+      EXPECT_EQ(g_destroyed, 5);
+    }
+
+    TEST(RequestPool, ConcurrentRequestsAllocateOnlyUpToTheirConcurrency)
+    {
+      constexpr int kThreads = 4;
+      g_created = 0;
+      g_destroyed = 0;
+      {
+        RequestPool<CountedContext> pool(kThreads);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; i++)
+        {
+          threads.emplace_back([&pool]()
+                               {
+            for (int request = 0; request < 10000; request++)
+            {
+              CountedContext *context = pool.Acquire();
+              pool.Release(context);
+            } });
+        }
+        for (std::thread &thread : threads)
+        {
+          thread.join();
+        }
+        EXPECT_LE(g_created, kThreads);
+        EXPECT_EQ(g_destroyed, 0);
+      }
+      EXPECT_EQ(g_destroyed, g_created);
+    }
+
+  } // namespace test
+} // namespace windows_store
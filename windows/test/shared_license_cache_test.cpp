@@ -0,0 +1,200 @@
+#include "shared_license_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      using namespace std::chrono_literals;
+
+      // A license whose every field follows from |tag|, so a reader can tell
+      // whether it saw one publish or a mix of several.
+      LicenseSnapshot TaggedLicense(uint32_t tag, size_t add_ons)
+      {
+        LicenseSnapshot license;
+        license.is_active = tag % 2 == 0;
+        license.is_trial = tag % 3 == 0;
+        license.sku_store_id = "9NTAG" + std::to_string(tag);
+        license.trial_unique_id = "trial-" + std::to_string(tag);
+        license.trial_time_remaining_ms = tag * 1000;
+        for (size_t i = 0; i < add_ons; i++)
+        {
+          std::string id = std::to_string(tag) + "/" + std::to_string(i);
+          license.add_ons.push_back(
+              AddOnLicenseRecord{"9NADDON" + id, "offer-token-" + id + std::string(32, 'x'), i % 2 == 0,
+                                 static_cast<int64_t>(tag) * 1000 + static_cast<int64_t>(i)});
+        }
+        return license;
+      }
+
+      bool IsTaggedLicense(const LicenseSnapshot &license, size_t add_ons)
+      {
+        uint32_t tag = static_cast<uint32_t>(license.trial_time_remaining_ms / 1000);
+        return license == TaggedLicense(tag, add_ons);
+      }
+
+      // A region name no other test run uses, removed again on destruction.
+      class UniqueRegion
+      {
+      public:
+        explicit UniqueRegion(const std::string &test)
+            : name_("windows_store_test_" + test + "_" + std::to_string(std::random_device()()))
+        {
+          SharedMemoryRegion::Unlink(name_);
+        }
+        ~UniqueRegion() { SharedMemoryRegion::Unlink(name_); }
+
+        const std::string &name() const { return name_; }
+
+      private:
+        std::string name_;
+      };
+
+    } // namespace
+
+    TEST(SharedLicenseCache, PublishesToOtherInstances)
+    {
+      UniqueRegion region("publish");
+      std::unique_ptr<SharedLicenseCache> writer = SharedLicenseCache::Open(region.name());
+      std::unique_ptr<SharedLicenseCache> reader = SharedLicenseCache::Open(region.name());
+      ASSERT_NE(writer, nullptr);
+      ASSERT_NE(reader, nullptr);
+      EXPECT_FALSE(reader->Read(1h).has_value());
+
+      LicenseSnapshot license = TaggedLicense(7, 3);
+      ASSERT_TRUE(writer->Publish(license));
+      EXPECT_EQ(reader->Read(1h), license);
+      std::this_thread::sleep_for(20ms);
+      EXPECT_FALSE(reader->Read(10ms).has_value());
+
+      reader->Invalidate();
+      EXPECT_FALSE(writer->Read(1h).has_value());
+    }
+
+    TEST(SharedLicenseCache, RejectsLicensesThatDoNotFit)
+    {
+      UniqueRegion region("capacity");
+      std::unique_ptr<SharedLicenseCache> cache = SharedLicenseCache::Open(region.name());
+      ASSERT_NE(cache, nullptr);
+      EXPECT_FALSE(cache->Publish(TaggedLicense(1, 2000)));
+      EXPECT_FALSE(cache->Read(1h).has_value());
+    }
+
+#ifndef _WIN32
+
+    TEST(SharedLicenseCache, ConcurrentWritersNeverTearReads)
+    {
+      // About 60 KB per license, so writes are slow enough to overlap.
+      constexpr size_t kAddOns = 650;
+      constexpr int kWriters = 3;
+      constexpr int kReaders = 3;
+      constexpr auto kDuration = 500ms;
+
+      UniqueRegion region("stress");
+      std::vector<pid_t> children;
+      for (int process = 0; process < kWriters + kReaders; process++)
+      {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid != 0)
+        {
+          children.push_back(pid);
+          continue;
+        }
+
+        // A stale timeout of zero makes every writer take over any write in
+        // progress, the worst case for writers that are only slow.
+        std::unique_ptr<SharedLicenseCache> cache = SharedLicenseCache::Open(region.name(), 0ms);
+        std::vector<LicenseSnapshot> licenses;
+        for (uint32_t tag = 1; tag <= 4; tag++)
+        {
+          licenses.push_back(TaggedLicense(100 + process * 10 + tag, kAddOns));
+        }
+        int succeeded = 0;
+        auto end = std::chrono::steady_clock::now() + kDuration;
+        while (std::chrono::steady_clock::now() < end)
+        {
+          if (process < kWriters)
+          {
+            succeeded += cache->Publish(licenses[succeeded % licenses.size()]) ? 1 : 0;
+            continue;
+          }
+          std::optional<LicenseSnapshot> license = cache->Read(1h);
+          if (license && !IsTaggedLicense(*license, kAddOns))
+          {
+            _exit(1);
+          }
+          succeeded += license ? 1 : 0;
+        }
+        _exit(succeeded > 0 ? 0 : 2);
+      }
+
+      for (pid_t pid : children)
+      {
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0) << (WEXITSTATUS(status) == 1 ? "torn read" : "no publish or read succeeded");
+      }
+    }
+
+    TEST(SharedLicenseCache, KilledWriterIsTakenOver)
+    {
+      constexpr size_t kAddOns = 650;
+      constexpr auto kStaleWriteTimeout = 50ms;
+      UniqueRegion region("killed");
+      std::unique_ptr<SharedLicenseCache> cache = SharedLicenseCache::Open(region.name(), kStaleWriteTimeout);
+      ASSERT_NE(cache, nullptr);
+      std::mt19937 random(7);
+      for (uint32_t round = 1; round <= 20; round++)
+      {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0)
+        {
+          std::unique_ptr<SharedLicenseCache> child = SharedLicenseCache::Open(region.name(), kStaleWriteTimeout);
+          for (uint32_t tag = 100000 * round;; tag++)
+          {
+            child->Publish(TaggedLicense(tag, kAddOns));
+          }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(random() % 5000));
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+
+        // Whatever the child was doing when it died, the cache is usable
+        // again within the stale write timeout.
+        LicenseSnapshot license = TaggedLicense(round, kAddOns);
+        auto deadline = std::chrono::steady_clock::now() + kStaleWriteTimeout * 4;
+        bool published = false;
+        while (!(published = cache->Publish(license)) && std::chrono::steady_clock::now() < deadline)
+        {
+          std::this_thread::sleep_for(1ms);
+        }
+        ASSERT_TRUE(published) << "round " << round;
+        EXPECT_EQ(cache->Read(1h), license) << "round " << round;
+      }
+    }
+
+#endif
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,140 @@
+#include "store_availability.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      constexpr int32_t kNoPackageHResult = static_cast<int32_t>(0x80073D54);
+      constexpr int32_t kClassNotRegisteredHResult = static_cast<int32_t>(0x80040154);
+      constexpr int32_t kNotAssociatedHResult = static_cast<int32_t>(0x803F6107);
+      // WININET_E_CANNOT_CONNECT, e.g. offline.
+      constexpr int32_t kCannotConnectHResult = static_cast<int32_t>(0x80072EE7);
+
+      StoreAppLicenseInner SimulatedLicense()
+      {
+        return StoreAppLicenseInner(true, false, "9NSIMULATED0/0010", "", 0);
+      }
+
+    } // namespace
+
+    TEST(StoreAvailability, ClassifiesPermanentStoreErrors)
+    {
+      EXPECT_TRUE(IsPermanentStoreError(kNoPackageHResult));
+      EXPECT_TRUE(IsPermanentStoreError(kClassNotRegisteredHResult));
+      EXPECT_TRUE(IsPermanentStoreError(kNotAssociatedHResult));
+      EXPECT_FALSE(IsPermanentStoreError(0));
+      EXPECT_FALSE(IsPermanentStoreError(kCannotConnectHResult));
+      EXPECT_FALSE(IsPermanentStoreError(static_cast<int32_t>(0x80004005)));
+    }
+
+    TEST(StoreAvailability, CallsStoreWithPackageIdentity)
+    {
+      StoreAvailability availability(true);
+      EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kCallStore);
+      EXPECT_FALSE(availability.ShortCircuitLicense().has_value());
+      EXPECT_FALSE(availability.ShortCircuitError().has_value());
+    }
+
+    TEST(StoreAvailability, FailsFastWithoutPackageIdentity)
+    {
+      StoreAvailability availability(false);
+      EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kFailFast);
+
+      auto license = availability.ShortCircuitLicense();
+      ASSERT_TRUE(license.has_value());
+      ASSERT_TRUE(license->has_error());
+      EXPECT_EQ(license->error().code(), kNoPackageIdentityErrorCode);
+
+      auto error = availability.ShortCircuitError();
+      ASSERT_TRUE(error.has_value());
+      EXPECT_EQ(error->code(), kNoPackageIdentityErrorCode);
+    }
+
+    TEST(StoreAvailability, SimulatesLicenseWithoutPackageIdentity)
+    {
+      StoreAvailability availability(false);
+      StoreAppLicenseInner simulated = SimulatedLicense();
+      availability.SetSimulatedLicense(&simulated);
+      EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kSimulate);
+
+      auto license = availability.ShortCircuitLicense();
+      ASSERT_TRUE(license.has_value());
+      ASSERT_FALSE(license->has_error());
+      EXPECT_TRUE(license->value().is_active());
+      EXPECT_EQ(license->value().sku_store_id(), "9NSIMULATED0/0010");
+
+      // Requests with nothing to simulate still fail fast.
+      auto error = availability.ShortCircuitError();
+      ASSERT_TRUE(error.has_value());
+      EXPECT_EQ(error->code(), kNoPackageIdentityErrorCode);
+
+      availability.SetSimulatedLicense(nullptr);
+      EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kFailFast);
+    }
+
+    TEST(StoreAvailability, IgnoresSimulatedLicenseWhileStoreIsAvailable)
+    {
+      StoreAvailability availability(true);
+      StoreAppLicenseInner simulated = SimulatedLicense();
+      availability.SetSimulatedLicense(&simulated);
+      EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kCallStore);
+      EXPECT_FALSE(availability.ShortCircuitLicense().has_value());
+    }
+
+    TEST(StoreAvailability, RemembersPermanentErrors)
+    {
+      for (int32_t hresult : {kNoPackageHResult, kClassNotRegisteredHResult, kNotAssociatedHResult})
+      {
+        StoreAvailability availability(true);
+        availability.RecordFailure(hresult, "permanent");
+        EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kFailFast);
+
+        auto error = availability.ShortCircuitError();
+        ASSERT_TRUE(error.has_value());
+        EXPECT_EQ(error->code(), std::to_string(hresult));
+        EXPECT_EQ(error->message(), "permanent");
+
+        auto license = availability.ShortCircuitLicense();
+        ASSERT_TRUE(license.has_value());
+        ASSERT_TRUE(license->has_error());
+        EXPECT_EQ(license->error().code(), std::to_string(hresult));
+
+        // A simulated license is returned instead once the Store failed
+        // for good.
+        StoreAppLicenseInner simulated = SimulatedLicense();
+        availability.SetSimulatedLicense(&simulated);
+        EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kSimulate);
+      }
+    }
+
+    TEST(StoreAvailability, KeepsFirstPermanentError)
+    {
+      StoreAvailability availability(true);
+      availability.RecordFailure(kNotAssociatedHResult, "first");
+      availability.RecordFailure(kClassNotRegisteredHResult, "second");
+      auto error = availability.ShortCircuitError();
+      ASSERT_TRUE(error.has_value());
+      EXPECT_EQ(error->code(), std::to_string(kNotAssociatedHResult));
+      EXPECT_EQ(error->message(), "first");
+    }
+
+    TEST(StoreAvailability, RetriesTransientErrors)
+    {
+      StoreAvailability availability(true);
+      availability.RecordFailure(kCannotConnectHResult, "offline");
+      availability.RecordFailure(static_cast<int32_t>(0x80004005), "failed");
+      EXPECT_EQ(availability.Decide(), StoreAvailability::Decision::kCallStore);
+      EXPECT_FALSE(availability.ShortCircuitError().has_value());
+    }
+
+  } // namespace test
+} // namespace windows_store
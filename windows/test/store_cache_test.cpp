@@ -0,0 +1,203 @@
+#include "store_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      constexpr uint64_t kTitle = ProductFieldBit(ProductField::kTitle);
+      constexpr uint64_t kDescription = ProductFieldBit(ProductField::kDescription);
+
+      std::shared_ptr<const StoreProductRecord> ProductOf(size_t index, size_t description_size)
+      {
+        auto product = std::make_shared<StoreProductRecord>();
+        product->store_id = "9N" + std::to_string(100000 + index);
+        product->title = "Expansion pack " + std::to_string(index);
+        product->description = std::string(description_size, 'd');
+        return product;
+      }
+
+      std::shared_ptr<const LicenseSnapshot> LicenseOf(size_t add_ons)
+      {
+        auto license = std::make_shared<LicenseSnapshot>();
+        license->is_active = true;
+        license->sku_store_id = "9NAPP/0010";
+        for (size_t i = 0; i < add_ons; i++)
+        {
+          license->add_ons.push_back({"9NADDON" + std::to_string(i) + "/0010", "token of add-on " + std::to_string(i),
+                                      true, 0});
+        }
+        return license;
+      }
+
+      // Bytes a cache charges for |product|, measured on a cache of its own.
+      size_t ChargeOf(const std::shared_ptr<const StoreProductRecord> &product)
+      {
+        StoreCache cache(1024 * 1024);
+        cache.PutProduct(product, kTitle);
+        return cache.GetStats().bytes;
+      }
+
+    } // namespace
+
+    TEST(StoreCache, PromotesOnSecondHitAndEvictsProbationFirst)
+    {
+      auto first = ProductOf(0, 1000);
+      size_t charge = ChargeOf(first);
+      // Room for four products.
+      StoreCache cache(charge * 4 + charge / 2);
+      std::vector<std::shared_ptr<const StoreProductRecord>> products = {first};
+      for (size_t i = 1; i < 8; i++)
+      {
+        products.push_back(ProductOf(i, 1000));
+      }
+      for (size_t i = 0; i < 4; i++)
+      {
+        cache.PutProduct(products[i], kTitle);
+      }
+      ASSERT_NE(cache.GetProduct(products[0]->store_id, kTitle), nullptr);
+      EXPECT_EQ(cache.GetStats().protected_bytes, charge);
+
+      // A pass over other products evicts everything but the protected one.
+      for (size_t i = 4; i < 8; i++)
+      {
+        cache.PutProduct(products[i], kTitle);
+      }
+      EXPECT_NE(cache.GetProduct(products[0]->store_id, kTitle), nullptr);
+      EXPECT_EQ(cache.GetProduct(products[1]->store_id, kTitle), nullptr);
+      EXPECT_NE(cache.GetProduct(products[7]->store_id, kTitle), nullptr);
+      // Cached, but without the description.
+      EXPECT_EQ(cache.GetProduct(products[7]->store_id, kTitle | kDescription), nullptr);
+      StoreCache::Stats stats = cache.GetStats();
+      EXPECT_EQ(stats.entries, 4u);
+      EXPECT_EQ(stats.evictions, 4u);
+      EXPECT_EQ(stats.bytes, 4 * charge);
+    }
+
+    TEST(StoreCache, PinnedLicenseSurvivesEviction)
+    {
+      auto license = LicenseOf(20);
+      size_t license_bytes = StoreCache::ByteSize(*license);
+      auto first = ProductOf(0, 500);
+      size_t charge = ChargeOf(first);
+      StoreCache cache(license_bytes + 10 * charge);
+      cache.PinLicense(license);
+      cache.PutProduct(first, kTitle);
+      for (size_t i = 1; i < 40; i++)
+      {
+        cache.PutProduct(ProductOf(i, 500), kTitle);
+      }
+      StoreCache::Stats stats = cache.GetStats();
+      EXPECT_EQ(stats.entries, 10u);
+      EXPECT_EQ(stats.evictions, 30u);
+      EXPECT_EQ(stats.pinned_bytes, license_bytes);
+      EXPECT_EQ(stats.bytes, license_bytes + 10 * charge);
+
+      // A budget below the license evicts every product but keeps it.
+      cache.SetBudget(license_bytes / 2);
+      stats = cache.GetStats();
+      EXPECT_EQ(stats.entries, 0u);
+      EXPECT_EQ(stats.bytes, license_bytes);
+      EXPECT_EQ(stats.pinned_bytes, license_bytes);
+      EXPECT_EQ(stats.protected_bytes, 0u);
+      cache.PutProduct(first, kTitle);
+      EXPECT_EQ(cache.GetStats().entries, 0u);
+
+      // A larger license makes room for itself.
+      cache.SetBudget(license_bytes + 10 * charge);
+      for (size_t i = 0; i < 10; i++)
+      {
+        cache.PutProduct(ProductOf(i, 500), kTitle);
+      }
+      EXPECT_EQ(cache.GetStats().entries, 10u);
+      auto larger = LicenseOf(40);
+      cache.PinLicense(larger);
+      stats = cache.GetStats();
+      EXPECT_EQ(stats.pinned_bytes, StoreCache::ByteSize(*larger));
+      EXPECT_LE(stats.bytes, stats.budget_bytes);
+      EXPECT_EQ(stats.bytes, stats.pinned_bytes + stats.entries * charge);
+    }
+
+    TEST(StoreCache, ByteCountsMatchTheCachedProducts)
+    {
+      std::mt19937 random(20261018);
+      constexpr size_t kProducts = 200;
+      std::vector<std::shared_ptr<const StoreProductRecord>> products;
+      std::vector<size_t> charges;
+      for (size_t i = 0; i < kProducts; i++)
+      {
+        products.push_back(ProductOf(i, random() % 3000));
+        charges.push_back(ChargeOf(products.back()));
+      }
+      std::vector<std::shared_ptr<const LicenseSnapshot>> licenses = {nullptr, LicenseOf(0), LicenseOf(30)};
+
+      StoreCache cache(64 * 1024);
+      for (int step = 0; step < 20000; step++)
+      {
+        size_t index = random() % kProducts;
+        uint64_t mask = random() % 2 == 0 ? kTitle : kTitle | kDescription;
+        switch (random() % 100)
+        {
+        case 0:
+          cache.SetBudget(8 * 1024 + random() % (128 * 1024));
+          break;
+        case 1:
+          cache.PinLicense(licenses[random() % licenses.size()]);
+          break;
+        case 2:
+          cache.InvalidateProducts();
+          break;
+        default:
+          if (random() % 2 == 0)
+          {
+            cache.PutProduct(products[index], mask);
+          }
+          else
+          {
+            cache.GetProduct(products[index]->store_id, mask);
+          }
+          break;
+        }
+
+        StoreCache::Stats stats = cache.GetStats();
+        ASSERT_TRUE(stats.bytes <= stats.budget_bytes || stats.entries == 0) << step;
+        ASSERT_LE(stats.protected_bytes, stats.budget_bytes / 100 * StoreCache::kProtectedShare) << step;
+        if (step % 500 == 0)
+        {
+          // Hits promote, but neither evict nor change the charges.
+          size_t cached = 0;
+          size_t cached_bytes = 0;
+          for (size_t i = 0; i < kProducts; i++)
+          {
+            if (cache.GetProduct(products[i]->store_id, 0) != nullptr)
+            {
+              cached++;
+              cached_bytes += charges[i];
+            }
+          }
+          stats = cache.GetStats();
+          ASSERT_EQ(stats.entries, cached) << step;
+          ASSERT_EQ(stats.bytes, stats.pinned_bytes + cached_bytes) << step;
+        }
+      }
+
+      // Evicting everything must bring both segments back to zero.
+      cache.SetBudget(0);
+      StoreCache::Stats stats = cache.GetStats();
+      EXPECT_EQ(stats.entries, 0u);
+      EXPECT_EQ(stats.bytes, stats.pinned_bytes);
+      EXPECT_EQ(stats.protected_bytes, 0u);
+    }
+
+  } // namespace test
+} // namespace windows_store
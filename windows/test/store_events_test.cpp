@@ -0,0 +1,86 @@
+#include "store_events.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Records the messages sent and the threads they were sent from.
+      class RecordingMessenger : public flutter::BinaryMessenger
+      {
+      public:
+        void Send(const std::string &channel, const uint8_t *message, size_t message_size,
+                  flutter::BinaryReply reply = nullptr) const override
+        {
+          messages.emplace_back(message, message + message_size);
+          threads.push_back(std::this_thread::get_id());
+        }
+        void SetMessageHandler(const std::string &channel, flutter::BinaryMessageHandler handler) override {}
+
+        mutable std::vector<std::vector<uint8_t>> messages;
+        mutable std::vector<std::thread::id> threads;
+      };
+
+      ByteWriter BatchItemEvent(uint32_t index)
+      {
+        ByteWriter event = StoreEventChannel::Begin(StoreEventChannel::kBatchItem);
+        event.WriteU32(7);
+        event.WriteU32(index);
+        return event;
+      }
+
+    } // namespace
+
+    TEST(StoreEvents, SendsOnThePlatformThread)
+    {
+      RecordingMessenger messenger;
+      // Tasks posted to the "platform thread" run when the test drains them.
+      std::vector<std::function<void()>> posted;
+      StoreEventChannel channel(&messenger, [&posted](std::function<void()> task)
+                                { posted.push_back(std::move(task)); });
+
+      std::vector<std::vector<uint8_t>> sent;
+      std::thread worker([&channel, &sent]()
+                         {
+        for (uint32_t index = 0; index < 3; index++)
+        {
+          ByteWriter event = BatchItemEvent(index);
+          sent.push_back(event.bytes());
+          channel.Send(event);
+        } });
+      worker.join();
+      EXPECT_TRUE(messenger.messages.empty());
+      ASSERT_EQ(posted.size(), 3u);
+
+      for (const std::function<void()> &task : posted)
+      {
+        task();
+      }
+      EXPECT_EQ(messenger.messages, sent);
+      EXPECT_EQ(messenger.threads, std::vector<std::thread::id>(3, std::this_thread::get_id()));
+    }
+
+    TEST(StoreEvents, SendsInlineWithoutAPoster)
+    {
+      RecordingMessenger messenger;
+      StoreEventChannel channel(&messenger, nullptr);
+      ByteWriter event = BatchItemEvent(0);
+      channel.Send(event);
+      ASSERT_EQ(messenger.messages.size(), 1u);
+      EXPECT_EQ(messenger.messages[0], event.bytes());
+      EXPECT_EQ(messenger.messages[0].size(), StoreEventChannel::kHeaderSize + 8);
+    }
+
+  } // namespace test
+} // namespace windows_store
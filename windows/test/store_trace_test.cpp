@@ -0,0 +1,233 @@
+#include "store_trace.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "byte_buffer.h"
+#include "fake_store_backend.h"
+#include "store_serialization.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      std::string TracePath(const char *name)
+      {
+        return (std::filesystem::temp_directory_path() /
+                (std::string("windows_store_trace_test_") + name + ".wstr"))
+            .string();
+      }
+
+      std::string ToString(const ByteWriter &writer)
+      {
+        return std::string(reinterpret_cast<const char *>(writer.data()), writer.size());
+      }
+
+      // Writes a trace of |version| holding |records| as they are, so that
+      // payloads can be encoded the way older versions did.
+      void WriteTrace(const std::string &path, uint16_t version, const std::vector<StoreTraceRecord> &records)
+      {
+        ByteWriter file;
+        file.WriteU32(StoreTraceFile::kMagic);
+        file.WriteU16(version);
+        file.WriteU16(0);
+        for (const StoreTraceRecord &record : records)
+        {
+          ByteWriter body;
+          body.WriteU8(static_cast<uint8_t>(record.api));
+          body.WriteU64(record.start_us);
+          body.WriteU32(record.latency_us);
+          body.WriteI32(record.hresult);
+          body.WriteString(record.message);
+          body.WriteString(record.arguments);
+          body.WriteString(record.payload);
+          file.WriteU32(static_cast<uint32_t>(body.size()));
+          file.WriteRaw(body.data(), body.size());
+        }
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(reinterpret_cast<const char *>(file.data()), file.size());
+      }
+
+      StoreProductRecord Product(const std::string &store_id)
+      {
+        StoreProductRecord product;
+        product.store_id = store_id;
+        product.product_kind = "Durable";
+        product.title = "Title of " + store_id;
+        product.formatted_price = "$1.99";
+        product.extended_json_data = "{\"id\":\"" + store_id + "\"}";
+        product.images.push_back(StoreImageRecord{"https://example.com/" + store_id + ".png", "Logo", 64, 64});
+        return product;
+      }
+
+    } // namespace
+
+    TEST(StoreTrace, ReplaysRecordedCalls)
+    {
+      std::string path = TracePath("round_trip");
+      auto backend = std::make_unique<FakeStoreBackend>();
+      LicenseSnapshot license;
+      license.is_active = true;
+      license.sku_store_id = "9NPRO/0010";
+      license.extended_json_data = "{\"a\":1}";
+      backend->SetLicense(license);
+      backend->SetProducts({Product("9NA"), Product("9NB")});
+      {
+        RecordingStoreBackend recording(std::move(backend), path);
+        ASSERT_TRUE(recording.GetAppLicense(~0ull).ok());
+        ASSERT_EQ(recording.GetStoreProducts({"Durable"}, {"9NB"}, ~0ull).value.size(), 1u);
+      }
+
+      std::vector<StoreTraceRecord> records;
+      ASSERT_TRUE(StoreTraceFile::Read(path, records));
+      ASSERT_EQ(records.size(), 2u);
+      ReplayStoreBackend replay(std::move(records), 0);
+
+      StoreResult<LicenseSnapshot> replayed_license = replay.GetAppLicense(~0ull);
+      ASSERT_TRUE(replayed_license.ok());
+      EXPECT_EQ(replayed_license.value.sku_store_id, "9NPRO/0010");
+      EXPECT_EQ(replayed_license.value.extended_json_data, "{\"a\":1}");
+
+      StoreResult<std::vector<StoreProductRecord>> products = replay.GetStoreProducts({"Durable"}, {"9NB"}, ~0ull);
+      ASSERT_TRUE(products.ok());
+      ASSERT_EQ(products.value.size(), 1u);
+      EXPECT_EQ(products.value[0].store_id, "9NB");
+      ASSERT_EQ(products.value[0].images.size(), 1u);
+      EXPECT_EQ(products.value[0].images[0].uri, "https://example.com/9NB.png");
+
+      EXPECT_FALSE(replay.IsInUserCollection("9NA").ok());
+      std::filesystem::remove(path);
+    }
+
+    TEST(StoreTrace, ReadsOlderVersions)
+    {
+      // Version 1: no ExtendedJsonData. Version 2: no product images.
+      for (uint16_t version : {kRecordFormatBase, kRecordFormatExtendedJson})
+      {
+        ByteWriter license;
+        license.WriteU8(1);
+        license.WriteU8(0);
+        license.WriteString("9NPRO/0010");
+        license.WriteString("");
+        license.WriteI64(0);
+        license.WriteU32(0);
+        if (version >= kRecordFormatExtendedJson)
+        {
+          license.WriteString("{}");
+        }
+
+        ByteWriter products;
+        products.WriteU32(2);
+        for (const char *store_id : {"9NA", "9NB"})
+        {
+          for (const char *value : {store_id, "Durable", "Title", "", "$1.99", "$1.99", "USD"})
+          {
+            products.WriteString(value);
+          }
+          products.WriteU8(1);
+          products.WriteU8(0);
+          products.WriteString("");
+          products.WriteString("");
+          if (version >= kRecordFormatExtendedJson)
+          {
+            products.WriteString("{\"id\":1}");
+          }
+        }
+
+        StoreTraceRecord license_record;
+        license_record.api = StoreApi::kGetAppLicense;
+        license_record.payload = ToString(license);
+        StoreTraceRecord products_record;
+        products_record.api = StoreApi::kGetUserCollection;
+        products_record.payload = ToString(products);
+
+        std::string path = TracePath("older_version");
+        WriteTrace(path, version, {license_record, products_record});
+        std::vector<StoreTraceRecord> records;
+        ASSERT_TRUE(StoreTraceFile::Read(path, records));
+        std::filesystem::remove(path);
+        ASSERT_EQ(records.size(), 2u);
+        EXPECT_EQ(records[0].format, version);
+
+        ReplayStoreBackend replay(std::move(records), 0);
+        StoreResult<LicenseSnapshot> replayed_license = replay.GetAppLicense(~0ull);
+        ASSERT_TRUE(replayed_license.ok());
+        EXPECT_TRUE(replayed_license.value.is_active);
+        EXPECT_EQ(replayed_license.value.sku_store_id, "9NPRO/0010");
+        EXPECT_EQ(replayed_license.value.extended_json_data, version >= kRecordFormatExtendedJson ? "{}" : "");
+
+        StoreResult<std::vector<StoreProductRecord>> collection = replay.GetUserCollection({"Durable"}, ~0ull);
+        ASSERT_TRUE(collection.ok());
+        ASSERT_EQ(collection.value.size(), 2u);
+        EXPECT_EQ(collection.value[1].store_id, "9NB");
+        EXPECT_EQ(collection.value[1].currency_code, "USD");
+        EXPECT_TRUE(collection.value[1].is_in_user_collection);
+        EXPECT_TRUE(collection.value[1].images.empty());
+      }
+    }
+
+    TEST(StoreTrace, RejectsNewerVersions)
+    {
+      std::string path = TracePath("newer_version");
+      WriteTrace(path, StoreTraceFile::kVersion + 1, {});
+      std::vector<StoreTraceRecord> records;
+      EXPECT_FALSE(StoreTraceFile::Read(path, records));
+      WriteTrace(path, 0, {});
+      EXPECT_FALSE(StoreTraceFile::Read(path, records));
+      std::filesystem::remove(path);
+    }
+
+    TEST(StoreTrace, IgnoresTruncatedLastRecord)
+    {
+      std::string path = TracePath("truncated");
+      StoreTraceRecord record;
+      record.api = StoreApi::kIsInUserCollection;
+      record.payload = std::string(1, '\1');
+      WriteTrace(path, StoreTraceFile::kVersion, {record, record});
+      std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+      std::vector<StoreTraceRecord> records;
+      ASSERT_TRUE(StoreTraceFile::Read(path, records));
+      EXPECT_EQ(records.size(), 1u);
+      std::filesystem::remove(path);
+    }
+
+    TEST(StoreTrace, ReplayKeepsRecordedStartTimes)
+    {
+      using namespace std::chrono;
+      StoreTraceRecord first;
+      first.api = StoreApi::kIsInUserCollection;
+      first.payload = std::string(1, '\1');
+      StoreTraceRecord second = first;
+      second.start_us = 400000;
+      second.latency_us = 1000;
+
+      // At speed 2 the second call completes 200.5 ms after the replay
+      // starts, even though the app asks for it right away.
+      auto start = steady_clock::now();
+      ReplayStoreBackend replay({first, second}, 2);
+      ASSERT_TRUE(replay.IsInUserCollection("9NA").ok());
+      EXPECT_LT(steady_clock::now() - start, milliseconds(100));
+      ASSERT_TRUE(replay.IsInUserCollection("9NA").ok());
+      EXPECT_GE(steady_clock::now() - start, microseconds(200500));
+
+      // Once past the recorded start, a call only takes its latency.
+      ReplayStoreBackend late({second}, 2);
+      std::this_thread::sleep_for(milliseconds(250));
+      auto before = steady_clock::now();
+      ASSERT_TRUE(late.IsInUserCollection("9NA").ok());
+      EXPECT_LT(steady_clock::now() - before, milliseconds(100));
+    }
+
+  } // namespace test
+} // namespace windows_store
@@ -0,0 +1,311 @@
+#include "windows_store_api_instance.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fake_store_backend.h"
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Unlocked by any SKU of the product.
+      constexpr char kProFeature[] = "pro";
+      constexpr char kBasicFeature[] = "basic";
+
+      LicenseSnapshot LicenseFor(const std::string &sku_store_id)
+      {
+        LicenseSnapshot license;
+        license.is_active = true;
+        license.sku_store_id = sku_store_id;
+        return license;
+      }
+
+      void RegisterFeatures(WindowsStoreApiInstance &plugin)
+      {
+        flutter::EncodableMap features;
+        features.emplace(flutter::EncodableValue(kProFeature),
+                         flutter::EncodableList{flutter::EncodableValue("9NPRO")});
+        features.emplace(flutter::EncodableValue(kBasicFeature),
+                         flutter::EncodableList{flutter::EncodableValue("9NBASIC")});
+        ASSERT_FALSE(plugin.RegisterFeatures(features).has_value());
+      }
+
+      ErrorOr<bool> IsFeatureEnabled(WindowsStoreApiInstance &plugin, const std::string &feature)
+      {
+        std::promise<ErrorOr<bool>> reply;
+        plugin.IsFeatureEnabledAsync(feature, [&reply](ErrorOr<bool> enabled)
+                                     { reply.set_value(std::move(enabled)); });
+        return reply.get_future().get();
+      }
+
+      // The flags of kProFeature and kBasicFeature, checked with both
+      // IsFeatureEnabledAsync and AreFeaturesEnabledAsync.
+      std::pair<bool, bool> EnabledFeatures(WindowsStoreApiInstance &plugin)
+      {
+        ErrorOr<bool> pro = IsFeatureEnabled(plugin, kProFeature);
+        ErrorOr<bool> basic = IsFeatureEnabled(plugin, kBasicFeature);
+        EXPECT_FALSE(pro.has_error());
+        EXPECT_FALSE(basic.has_error());
+
+        std::promise<ErrorOr<flutter::EncodableList>> reply;
+        plugin.AreFeaturesEnabledAsync(
+            flutter::EncodableList{flutter::EncodableValue(kProFeature), flutter::EncodableValue(kBasicFeature)},
+            [&reply](ErrorOr<flutter::EncodableList> enabled)
+            { reply.set_value(std::move(enabled)); });
+        ErrorOr<flutter::EncodableList> both = reply.get_future().get();
+        EXPECT_FALSE(both.has_error());
+        if (pro.has_error() || basic.has_error() || both.has_error())
+        {
+          return {false, false};
+        }
+        EXPECT_EQ(std::get<bool>(both.value()[0]), pro.value());
+        EXPECT_EQ(std::get<bool>(both.value()[1]), basic.value());
+        return {pro.value(), basic.value()};
+      }
+
+      ErrorOr<std::shared_ptr<const LicenseSnapshot>> GetLicenseFields(WindowsStoreApiInstance &plugin,
+                                                                       uint64_t field_mask)
+      {
+        std::promise<ErrorOr<std::shared_ptr<const LicenseSnapshot>>> reply;
+        plugin.GetAppLicenseFieldsAsync(field_mask, [&reply](ErrorOr<std::shared_ptr<const LicenseSnapshot>> license)
+                                        { reply.set_value(std::move(license)); });
+        return reply.get_future().get();
+      }
+
+    } // namespace
+
+    TEST(WindowsStoreApiInstance, RegisterFeaturesRejectsMalformedEntries)
+    {
+      auto backend = std::make_unique<FakeStoreBackend>();
+      backend->SetLicense(LicenseFor("9NPRO/0010"));
+      WindowsStoreApiInstance plugin(std::move(backend), false);
+      RegisterFeatures(plugin);
+
+      auto expect_rejected = [&plugin](flutter::EncodableValue feature, flutter::EncodableValue ids,
+                                       const std::string &message)
+      {
+        flutter::EncodableMap features;
+        features.emplace(flutter::EncodableValue("valid"), flutter::EncodableList{flutter::EncodableValue("9NPRO")});
+        features.emplace(std::move(feature), std::move(ids));
+        std::optional<FlutterError> error = plugin.RegisterFeatures(features);
+        ASSERT_TRUE(error.has_value()) << message;
+        EXPECT_EQ(error->code(), "invalid-feature-map");
+        EXPECT_EQ(error->message(), message);
+      };
+      expect_rejected(flutter::EncodableValue(7), flutter::EncodableList{}, "Feature names must be strings");
+      expect_rejected(flutter::EncodableValue("extra"), flutter::EncodableValue("9NPRO"),
+                      "Feature 'extra' must map to a list of Store IDs");
+      expect_rejected(flutter::EncodableValue("extra"),
+                      flutter::EncodableList{flutter::EncodableValue("9NPRO"), flutter::EncodableValue(7)},
+                      "Store ID 1 of feature 'extra' is not a string");
+
+      // The features registered before are kept.
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(true, false));
+      EXPECT_TRUE(IsFeatureEnabled(plugin, "valid").has_error());
+    }
+
+    TEST(WindowsStoreApiInstance, FeatureChecksFollowSimulatedLicense)
+    {
+      auto backend = std::make_unique<FakeStoreBackend>(true);
+      FakeStoreBackend *store = backend.get();
+      WindowsStoreApiInstance plugin(std::move(backend), false);
+      RegisterFeatures(plugin);
+
+      StoreAppLicenseInner pro = LicenseFor("9NPRO/0010").ToInner();
+      plugin.SetSimulatedLicense(&pro);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(true, false));
+
+      StoreAppLicenseInner basic = LicenseFor("9NBASIC/0010").ToInner();
+      plugin.SetSimulatedLicense(&basic);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(false, true));
+
+      StoreAppLicenseInner expired = LicenseFor("9NBASIC/0010").ToInner();
+      expired.set_is_active(false);
+      plugin.SetSimulatedLicense(&expired);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(false, false));
+
+      plugin.SetSimulatedLicense(nullptr);
+      ErrorOr<bool> unavailable = IsFeatureEnabled(plugin, kProFeature);
+      ASSERT_TRUE(unavailable.has_error());
+      EXPECT_EQ(unavailable.error().code(), kNoPackageIdentityErrorCode);
+
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 0);
+    }
+
+    TEST(WindowsStoreApiInstance, SimulatedLicenseReplacesStoreLicenseAfterPermanentError)
+    {
+      auto backend = std::make_unique<FakeStoreBackend>();
+      FakeStoreBackend *store = backend.get();
+      store->SetLicense(LicenseFor("9NPRO/0010"));
+      WindowsStoreApiInstance plugin(std::move(backend), true);
+      RegisterFeatures(plugin);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(true, false));
+
+      // The app is no longer associated with the Store: the license cached
+      // from the Store must not keep answering once a simulated one is set.
+      store->SetFailure(static_cast<int32_t>(0x803F6107));
+      store->RaiseLicensesChanged();
+      EXPECT_TRUE(IsFeatureEnabled(plugin, kProFeature).has_error());
+      StoreAppLicenseInner basic = LicenseFor("9NBASIC/0010").ToInner();
+      plugin.SetSimulatedLicense(&basic);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(false, true));
+    }
+
+    TEST(WindowsStoreApiInstance, FeatureChecksFollowLicenseChanges)
+    {
+      auto backend = std::make_unique<FakeStoreBackend>();
+      FakeStoreBackend *store = backend.get();
+      store->SetLicense(LicenseFor("9NPRO/0010"));
+      WindowsStoreApiInstance plugin(std::move(backend), true);
+      RegisterFeatures(plugin);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(true, false));
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(true, false));
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 1);
+
+      store->SetLicense(LicenseFor("9NBASIC/0010"));
+      store->RaiseLicensesChanged();
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(false, true));
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 2);
+    }
+
+    TEST(WindowsStoreApiInstance, LicenseFetchRacingALicenseChangeIsNotCached)
+    {
+      auto backend = std::make_unique<FakeStoreBackend>();
+      FakeStoreBackend *store = backend.get();
+      store->SetLicense(LicenseFor("9NPRO/0010"));
+      WindowsStoreApiInstance plugin(std::move(backend), false);
+      RegisterFeatures(plugin);
+
+      // The fetch has read the old license when licenses change.
+      store->Hold();
+      auto fetched = std::async(std::launch::async, [&plugin]()
+                                { return GetLicenseFields(plugin, kAllLicenseFields); });
+      ASSERT_TRUE(store->WaitForHeld(1));
+      store->SetLicense(LicenseFor("9NBASIC/0010"));
+      store->RaiseLicensesChanged();
+      store->Release();
+
+      ErrorOr<std::shared_ptr<const LicenseSnapshot>> license = fetched.get();
+      ASSERT_FALSE(license.has_error());
+      EXPECT_EQ(license.value()->sku_store_id, "9NBASIC/0010");
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 2);
+      EXPECT_EQ(EnabledFeatures(plugin), std::make_pair(false, true));
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 2);
+    }
+
+    TEST(WindowsStoreApiInstance, DestructionWaitsForStoreCallsInFlight)
+    {
+      using namespace std::chrono_literals;
+      auto backend = std::make_unique<FakeStoreBackend>();
+      FakeStoreBackend *store = backend.get();
+      store->SetLicense(LicenseFor("9NPRO/0010"));
+      auto plugin = std::make_unique<WindowsStoreApiInstance>(std::move(backend), false);
+
+      store->Hold();
+      auto fetched = std::async(std::launch::async, [&plugin]()
+                                { return GetLicenseFields(*plugin, kAllLicenseFields); });
+      ASSERT_TRUE(store->WaitForHeld(1));
+      // The fetch completes into the license scheduler and the cache once
+      // released, so they must outlive it.
+      std::thread destroy([&plugin]()
+                          { plugin.reset(); });
+      std::this_thread::sleep_for(50ms);
+      store->Release();
+      destroy.join();
+
+      ErrorOr<std::shared_ptr<const LicenseSnapshot>> license = fetched.get();
+      ASSERT_FALSE(license.has_error());
+      EXPECT_EQ(license.value()->sku_store_id, "9NPRO/0010");
+    }
+
+    TEST(WindowsStoreApiInstance, BatchQueriesRunAtTheParallelismAskedFor)
+    {
+      // Past the work queue's background cap; 32 is clamped to the maximum.
+      for (uint32_t max_parallel : {8u, 16u, 32u})
+      {
+        auto backend = std::make_unique<FakeStoreBackend>();
+        FakeStoreBackend *store = backend.get();
+        store->SetLatency(std::chrono::milliseconds(20));
+        WindowsStoreApiInstance plugin(std::move(backend), false);
+        std::vector<std::string> store_ids;
+        for (int i = 0; i < 64; i++)
+        {
+          store_ids.push_back("9N" + std::to_string(100 + i));
+        }
+
+        std::promise<ErrorOr<std::vector<BatchItemResult>>> reply;
+        plugin.RunBatchQueryAsync(BatchQuery::kUserCollection, store_ids, max_parallel, 0,
+                                  [&reply](ErrorOr<std::vector<BatchItemResult>> items)
+                                  { reply.set_value(std::move(items)); });
+        ErrorOr<std::vector<BatchItemResult>> items = reply.get_future().get();
+        ASSERT_FALSE(items.has_error());
+        ASSERT_EQ(items.value().size(), store_ids.size());
+        EXPECT_EQ(items.value().back().store_id, store_ids.back());
+        EXPECT_EQ(store->Calls(StoreApi::kIsInUserCollection), 64);
+        EXPECT_EQ(store->MaxConcurrentCalls(), static_cast<int>(std::min(max_parallel, 16u))) << max_parallel;
+      }
+    }
+
+    TEST(WindowsStoreApiInstance, NarrowLicenseQueriesShareTheCachedLicense)
+    {
+      auto backend = std::make_unique<FakeStoreBackend>();
+      FakeStoreBackend *store = backend.get();
+      LicenseSnapshot license = LicenseFor("9NPRO/0010");
+      license.trial_unique_id = "trial";
+      license.add_ons.push_back(AddOnLicenseRecord{"9NADDON/0010", "addon", true, 0});
+      store->SetLicense(license);
+      store->SetLatency(std::chrono::milliseconds(50));
+      WindowsStoreApiInstance plugin(std::move(backend), true);
+
+      // Concurrent narrow queries join one full fetch.
+      uint64_t sku_only = LicenseFieldBit(LicenseField::kSkuStoreId);
+      std::vector<std::future<ErrorOr<std::shared_ptr<const LicenseSnapshot>>>> replies;
+      for (int i = 0; i < 4; i++)
+      {
+        replies.push_back(std::async(std::launch::async, [&plugin, sku_only]()
+                                     { return GetLicenseFields(plugin, sku_only); }));
+      }
+      for (auto &reply : replies)
+      {
+        ErrorOr<std::shared_ptr<const LicenseSnapshot>> narrow = reply.get();
+        ASSERT_FALSE(narrow.has_error());
+        EXPECT_EQ(narrow.value()->sku_store_id, "9NPRO/0010");
+        EXPECT_FALSE(narrow.value()->is_active);
+        EXPECT_TRUE(narrow.value()->trial_unique_id.empty());
+        EXPECT_TRUE(narrow.value()->add_ons.empty());
+      }
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 1);
+      EXPECT_EQ(store->LastLicenseFieldMask(), kAllLicenseFields);
+
+      // Later ones are answered from the cache.
+      uint64_t add_ons = LicenseFieldBit(LicenseField::kIsActive) | LicenseFieldBit(LicenseField::kAddOnLicenses);
+      ErrorOr<std::shared_ptr<const LicenseSnapshot>> cached = GetLicenseFields(plugin, add_ons);
+      ASSERT_FALSE(cached.has_error());
+      EXPECT_TRUE(cached.value()->is_active);
+      EXPECT_TRUE(cached.value()->sku_store_id.empty());
+      ASSERT_EQ(cached.value()->add_ons.size(), 1u);
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 1);
+
+      // ExtendedJsonData is never cached, so it is read from the Store.
+      uint64_t extended = sku_only | LicenseFieldBit(LicenseField::kExtendedJsonData);
+      ASSERT_FALSE(GetLicenseFields(plugin, extended).has_error());
+      EXPECT_EQ(store->Calls(StoreApi::kGetAppLicense), 2);
+      EXPECT_EQ(store->LastLicenseFieldMask(), extended);
+    }
+
+  } // namespace test
+} // namespace windows_store
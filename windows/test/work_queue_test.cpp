@@ -0,0 +1,319 @@
+#include "work_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace windows_store
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      using namespace std::chrono_literals;
+
+      // Blocks the tasks waiting on it until opened.
+      class Gate
+      {
+      public:
+        void Open()
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+          }
+          changed_.notify_all();
+        }
+
+        void Wait()
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          changed_.wait(lock, [this]()
+                        { return open_; });
+        }
+
+      private:
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        bool open_ = false;
+      };
+
+      // Counts started tasks, so a test can wait until workers are busy.
+      class Started
+      {
+      public:
+        void Add()
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count_++;
+          }
+          changed_.notify_all();
+        }
+
+        bool WaitFor(int count, std::chrono::milliseconds timeout = 5s)
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          return changed_.wait_for(lock, timeout, [this, count]()
+                                   { return count_ >= count; });
+        }
+
+        int count()
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          return count_;
+        }
+
+      private:
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        int count_ = 0;
+      };
+
+      // Execution order of labelled tasks.
+      class Order
+      {
+      public:
+        void Add(const std::string &label)
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          labels_.push_back(label);
+        }
+
+        std::vector<std::string> labels()
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          return labels_;
+        }
+
+      private:
+        std::mutex mutex_;
+        std::vector<std::string> labels_;
+      };
+
+    } // namespace
+
+    TEST(WorkQueue, BackgroundWorkLeavesOneWorkerFree)
+    {
+      for (size_t workers : {2u, 4u})
+      {
+        Gate gate;
+        Started background;
+        Started interactive;
+        {
+          WorkQueue queue(workers, 10s);
+          for (size_t i = 0; i < workers + 2; i++)
+          {
+            queue.Post(WorkPriority::kBackground, [&gate, &background]()
+                       {
+              background.Add();
+              gate.Wait(); });
+          }
+          ASSERT_TRUE(background.WaitFor(static_cast<int>(workers - 1)));
+          std::this_thread::sleep_for(50ms);
+          EXPECT_EQ(background.count(), static_cast<int>(workers - 1));
+
+          // The free worker takes interactive work while the syncs run.
+          queue.Post(WorkPriority::kInteractive, [&interactive]()
+                     { interactive.Add(); });
+          EXPECT_TRUE(interactive.WaitFor(1, 1s));
+          gate.Open();
+          EXPECT_TRUE(background.WaitFor(static_cast<int>(workers + 2)));
+        }
+      }
+    }
+
+    TEST(WorkQueue, RunsByPriorityThenFifo)
+    {
+      Gate hold;
+      Gate release;
+      Started busy;
+      Order order;
+      WorkQueue queue(2, 10s);
+      // One worker stays busy; the other runs the queued tasks one by one
+      // once released.
+      queue.Post(WorkPriority::kInteractive, [&hold, &busy]()
+                 {
+        busy.Add();
+        hold.Wait(); });
+      queue.Post(WorkPriority::kInteractive, [&release, &busy]()
+                 {
+        busy.Add();
+        release.Wait(); });
+      ASSERT_TRUE(busy.WaitFor(2));
+      queue.Post(WorkPriority::kBackground, [&order]()
+                 { order.Add("background 1"); });
+      queue.Post(WorkPriority::kPurchase, [&order]()
+                 { order.Add("purchase"); });
+      queue.Post(WorkPriority::kBackground, [&order]()
+                 { order.Add("background 2"); });
+      queue.Post(WorkPriority::kInteractive, [&order]()
+                 { order.Add("interactive 1"); });
+      queue.Post(WorkPriority::kInteractive, [&order]()
+                 { order.Add("interactive 2"); });
+      release.Open();
+      while (order.labels().size() < 5)
+      {
+        std::this_thread::sleep_for(1ms);
+      }
+      EXPECT_EQ(order.labels(), (std::vector<std::string>{"interactive 1", "interactive 2", "purchase",
+                                                          "background 1", "background 2"}));
+      hold.Open();
+    }
+
+    TEST(WorkQueue, WaitingWorkIsPromoted)
+    {
+      for (bool aged : {false, true})
+      {
+        Gate hold;
+        Gate release;
+        Started busy;
+        Order order;
+        WorkQueue queue(2, 40ms);
+        queue.Post(WorkPriority::kInteractive, [&hold, &busy]()
+                   {
+          busy.Add();
+          hold.Wait(); });
+        queue.Post(WorkPriority::kInteractive, [&release, &busy]()
+                   {
+          busy.Add();
+          release.Wait(); });
+        ASSERT_TRUE(busy.WaitFor(2));
+        queue.Post(WorkPriority::kBackground, [&order]()
+                   { order.Add("background"); });
+        if (aged)
+        {
+          // More than two aging intervals: the background task now ranks
+          // above new interactive work.
+          std::this_thread::sleep_for(120ms);
+        }
+        queue.Post(WorkPriority::kInteractive, [&order]()
+                   { order.Add("interactive"); });
+        release.Open();
+        while (order.labels().size() < 2)
+        {
+          std::this_thread::sleep_for(1ms);
+        }
+        if (aged)
+        {
+          EXPECT_EQ(order.labels(), (std::vector<std::string>{"background", "interactive"}));
+        }
+        else
+        {
+          EXPECT_EQ(order.labels(), (std::vector<std::string>{"interactive", "background"}));
+        }
+        hold.Open();
+      }
+    }
+
+    TEST(WorkQueue, BackgroundWorkProgressesUnderInteractiveLoad)
+    {
+      std::atomic<bool> stop(false);
+      std::atomic<int> interactive(0);
+      Started background;
+      WorkQueue queue(2, 20ms);
+      // Keeps more interactive work queued than the workers can run.
+      std::thread load([&queue, &stop, &interactive]()
+                       {
+        while (!stop)
+        {
+          for (int i = 0; i < 4; i++)
+          {
+            queue.Post(WorkPriority::kInteractive, [&interactive]()
+                       {
+              std::this_thread::sleep_for(2ms);
+              interactive++; });
+          }
+          std::this_thread::sleep_for(2ms);
+        } });
+      std::this_thread::sleep_for(50ms);
+
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < 5; i++)
+      {
+        queue.Post(WorkPriority::kBackground, [&background]()
+                   { background.Add(); });
+      }
+      EXPECT_TRUE(background.WaitFor(5, 2s));
+      auto waited = std::chrono::steady_clock::now() - start;
+      int interactive_done = interactive;
+      stop = true;
+      load.join();
+
+      // Each background task waits about two aging intervals for its turn,
+      // while the interactive work keeps running.
+      EXPECT_LT(waited, 1s);
+      EXPECT_GT(interactive_done, 20);
+    }
+
+    TEST(WorkQueue, ParallelForVisitsEveryIndexOnce)
+    {
+      WorkQueue queue(4, 10s);
+      std::vector<std::atomic<int>> visits(100);
+      queue.ParallelFor(WorkPriority::kBackground, visits.size(), 4, [&visits](size_t index)
+                        { visits[index]++; });
+      for (const std::atomic<int> &count : visits)
+      {
+        EXPECT_EQ(count.load(), 1);
+      }
+    }
+
+    TEST(WorkQueue, ParallelForRunsUnderTheBackgroundCap)
+    {
+      constexpr auto kItem = 20ms;
+      // Three background workers and the calling thread, whatever
+      // |max_parallel| asks for: batch queries run their lanes on a pool of
+      // their own for that reason.
+      constexpr size_t kLanes = 4;
+      WorkQueue queue(4, 10s);
+      for (size_t count : {12u, 48u})
+      {
+        std::mutex mutex;
+        size_t running = 0;
+        size_t max_running = 0;
+        auto start = std::chrono::steady_clock::now();
+        queue.ParallelFor(WorkPriority::kBackground, count, 16, [&](size_t index)
+                          {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            max_running = std::max(max_running, ++running);
+          }
+          std::this_thread::sleep_for(kItem);
+          std::lock_guard<std::mutex> lock(mutex);
+          running--; });
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Wall time follows the cap, not the item count or |max_parallel|.
+        EXPECT_EQ(max_running, kLanes) << count;
+        EXPECT_GE(elapsed, kItem * (count / kLanes)) << count;
+        EXPECT_LT(elapsed, kItem * count / 2) << count;
+      }
+    }
+
+    TEST(WorkQueue, ParallelForFromBackgroundWorkAtTheCap)
+    {
+      // The only background slot runs the caller, so its lanes never start
+      // and it runs every index itself.
+      WorkQueue queue(2, 10s);
+      std::atomic<int> visits(0);
+      Started done;
+      queue.Post(WorkPriority::kBackground, [&queue, &visits, &done]()
+                 {
+        queue.ParallelFor(WorkPriority::kBackground, 10, 4, [&visits](size_t index)
+                          { visits++; });
+        done.Add(); });
+      EXPECT_TRUE(done.WaitFor(1));
+      EXPECT_EQ(visits.load(), 10);
+    }
+
+  } // namespace test
+} // namespace windows_store
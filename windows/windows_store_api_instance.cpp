@@ -0,0 +1,767 @@
+#include "windows_store_api_instance.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <unordered_map>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    // Store calls block, so enough workers are kept for a sync and a license
+    // check to overlap.
+    constexpr size_t kWorkerCount = 4;
+    constexpr std::chrono::milliseconds kAgingInterval(250);
+
+    // Upper bound of the parallelism a batch query may ask for. The query
+    // runs one lane on the work queue and the others on a pool of their own,
+    // so they are not held to the work queue's background cap.
+    constexpr uint32_t kMaxBatchParallelism = 16;
+
+    // Kinds indexed when a catalog query does not name any, and looked up by
+    // GetStoreProductAsync.
+    const std::vector<std::string> kAllProductKinds = {
+        "Application", "Game", "Consumable", "UnmanagedConsumable", "Durable"};
+
+    // Written to the temp directory when DumpFlightRecorder is given no path.
+    constexpr char kFlightRecorderDumpName[] = "windows_store_flight_recorder.wsfr";
+
+    FlutterError ImageCacheUnavailableError()
+    {
+      return FlutterError("image-cache-unavailable", "The image cache is not enabled");
+    }
+
+    FlutterError CollectionSyncUnavailableError()
+    {
+      return FlutterError("collection-sync-unavailable", "The collection sync is not enabled");
+    }
+
+    FlutterError UnknownFeatureError(const std::string &feature)
+    {
+      return FlutterError("unknown-feature", "Feature '" + feature + "' was not registered with registerFeatures");
+    }
+
+    FlutterError InvalidFeatureMapError(const std::string &message)
+    {
+      return FlutterError("invalid-feature-map", message);
+    }
+
+  } // namespace
+
+  WindowsStoreApiInstance::WindowsStoreApiInstance(std::unique_ptr<StoreBackend> backend, bool has_package_identity)
+      : backend_(std::move(backend)),
+        availability_(has_package_identity || !backend_->RequiresPackageIdentity()),
+        queue_(kWorkerCount, kAgingInterval),
+        batch_lanes_(kMaxBatchParallelism - 1, kAgingInterval),
+        license_refresh_([this](uint64_t generation)
+                         { queue_.Post(WorkPriority::kBackground, [this, generation]()
+                                       { RevalidateLicense(generation); }); }),
+        product_batcher_([this](const std::vector<std::string> &store_ids, uint64_t field_mask)
+                         { return backend_->GetStoreProducts(kAllProductKinds, store_ids, field_mask); },
+                         [this](std::function<void()> task)
+                         { queue_.Post(WorkPriority::kInteractive, std::move(task)); })
+  {
+    backend_->SetLicensesChangedHandler([this]()
+                                        {
+      license_refresh_.Invalidate();
+      entitlements_.Invalidate();
+      catalog_.Invalidate();
+      cache_.InvalidateProducts(); });
+  }
+
+  WindowsStoreApiInstance::~WindowsStoreApiInstance()
+  {
+    // Tasks still running use every member, and queue_ is destroyed after
+    // the schedulers, so it cannot be left to its destructor.
+    queue_.Stop();
+  }
+
+  void WindowsStoreApiInstance::SetAppActive(bool active)
+  {
+    license_refresh_.SetAppActive(active);
+  }
+
+  void WindowsStoreApiInstance::SetEventChannel(std::unique_ptr<StoreEventChannel> events)
+  {
+    events_ = std::move(events);
+  }
+
+  void WindowsStoreApiInstance::WarmUp(WarmUpPolicy policy)
+  {
+    if (policy == WarmUpPolicy::kNone || availability_.ShortCircuitError())
+    {
+      return;
+    }
+    if (policy == WarmUpPolicy::kLicense)
+    {
+      FetchLicense(nullptr);
+      return;
+    }
+    queue_.Post(WorkPriority::kInteractive, [this]()
+                { backend_->WarmUp(); });
+  }
+
+  void WindowsStoreApiInstance::SetFlightRecorder(const FlightRecorder *recorder)
+  {
+    flight_recorder_ = recorder;
+  }
+
+  void WindowsStoreApiInstance::SetImageCache(std::unique_ptr<ImageCache> image_cache)
+  {
+    image_cache_ = std::move(image_cache);
+  }
+
+  void WindowsStoreApiInstance::SetCollectionSync(std::unique_ptr<CollectionSync> collection_sync)
+  {
+    collection_sync_ = std::move(collection_sync);
+  }
+
+  void WindowsStoreApiInstance::GetAppLicenseAsync(std::function<void(ErrorOr<StoreAppLicenseInner> reply)> result)
+  {
+    LoadLicense([result = std::move(result)](ErrorOr<std::shared_ptr<const LicenseSnapshot>> license)
+                {
+      if (license.has_error())
+      {
+        result(license.error());
+        return;
+      }
+      result(license.value()->ToInner()); });
+  }
+
+  std::optional<FlutterError> WindowsStoreApiInstance::SetSimulatedLicense(const StoreAppLicenseInner *license)
+  {
+    availability_.SetSimulatedLicense(license);
+    // The entitlements and the cached license may come from the license
+    // this one replaces.
+    license_refresh_.Invalidate();
+    entitlements_.Invalidate();
+    return std::nullopt;
+  }
+
+  std::optional<FlutterError> WindowsStoreApiInstance::RegisterFeatures(const flutter::EncodableMap &features)
+  {
+    FeatureEntitlements::FeatureMap feature_map;
+    feature_map.reserve(features.size());
+    // The map comes from Dart untyped; a bad entry leaves the registered
+    // features as they were.
+    for (const auto &[feature, ids] : features)
+    {
+      const std::string *name = std::get_if<std::string>(&feature);
+      if (name == nullptr)
+      {
+        return InvalidFeatureMapError("Feature names must be strings");
+      }
+      const flutter::EncodableList *id_list = std::get_if<flutter::EncodableList>(&ids);
+      if (id_list == nullptr)
+      {
+        return InvalidFeatureMapError("Feature '" + *name + "' must map to a list of Store IDs");
+      }
+      std::vector<std::string> store_ids;
+      store_ids.reserve(id_list->size());
+      for (size_t i = 0; i < id_list->size(); i++)
+      {
+        const std::string *id = std::get_if<std::string>(&(*id_list)[i]);
+        if (id == nullptr)
+        {
+          return InvalidFeatureMapError("Store ID " + std::to_string(i) + " of feature '" + *name +
+                                        "' is not a string");
+        }
+        store_ids.push_back(*id);
+      }
+      feature_map.emplace_back(*name, std::move(store_ids));
+    }
+    entitlements_.Register(feature_map);
+    return std::nullopt;
+  }
+
+  void WindowsStoreApiInstance::IsFeatureEnabledAsync(const std::string &feature,
+                                                      std::function<void(ErrorOr<bool> reply)> result)
+  {
+    // The common case is answered without copying |feature| or |result|.
+    if (entitlements_.IsValid())
+    {
+      ReplyFeatureEnabled(feature, result);
+      return;
+    }
+    WithEntitlements([this, feature, result = std::move(result)](std::optional<FlutterError> error)
+                     {
+      if (error)
+      {
+        result(*error);
+        return;
+      }
+      ReplyFeatureEnabled(feature, result); });
+  }
+
+  void WindowsStoreApiInstance::AreFeaturesEnabledAsync(const flutter::EncodableList &features,
+                                                        std::function<void(ErrorOr<flutter::EncodableList> reply)> result)
+  {
+    if (entitlements_.IsValid())
+    {
+      ReplyFeaturesEnabled(features, result);
+      return;
+    }
+    WithEntitlements([this, features, result = std::move(result)](std::optional<FlutterError> error)
+                     {
+      if (error)
+      {
+        result(*error);
+        return;
+      }
+      ReplyFeaturesEnabled(features, result); });
+  }
+
+  std::optional<FlutterError> WindowsStoreApiInstance::SetProductBatchWindow(int64_t window_microseconds,
+                                                                            int64_t max_batch_size)
+  {
+    if (window_microseconds < 0 || max_batch_size < 1)
+    {
+      return FlutterError("invalid-product-batch-window",
+                          "The window must not be negative and batches must hold at least one product");
+    }
+    product_batcher_.SetWindow(std::chrono::microseconds(window_microseconds), static_cast<size_t>(max_batch_size));
+    return std::nullopt;
+  }
+
+  std::optional<FlutterError> WindowsStoreApiInstance::SetCacheBudget(int64_t budget_bytes)
+  {
+    if (budget_bytes < 0)
+    {
+      return FlutterError("invalid-cache-budget", "The cache budget must not be negative");
+    }
+    cache_.SetBudget(static_cast<size_t>(budget_bytes));
+    return std::nullopt;
+  }
+
+  ErrorOr<flutter::EncodableList> WindowsStoreApiInstance::GetCacheStats()
+  {
+    StoreCache::Stats stats = cache_.GetStats();
+    return flutter::EncodableList{
+        flutter::EncodableValue(static_cast<int64_t>(stats.hits)),
+        flutter::EncodableValue(static_cast<int64_t>(stats.misses)),
+        flutter::EncodableValue(static_cast<int64_t>(stats.evictions)),
+        flutter::EncodableValue(static_cast<int64_t>(stats.entries)),
+        flutter::EncodableValue(static_cast<int64_t>(stats.bytes)),
+        flutter::EncodableValue(static_cast<int64_t>(stats.pinned_bytes)),
+        flutter::EncodableValue(static_cast<int64_t>(stats.budget_bytes)),
+    };
+  }
+
+  std::optional<FlutterError> WindowsStoreApiInstance::SetImageCacheLimit(int64_t max_bytes)
+  {
+    if (!image_cache_)
+    {
+      return ImageCacheUnavailableError();
+    }
+    if (max_bytes < 0)
+    {
+      return FlutterError("invalid-image-cache-limit", "The image cache limit must not be negative");
+    }
+    image_cache_->SetMaxBytes(static_cast<uint64_t>(max_bytes));
+    return std::nullopt;
+  }
+
+  ErrorOr<std::string> WindowsStoreApiInstance::DumpFlightRecorder(const std::string *path)
+  {
+    if (flight_recorder_ == nullptr)
+    {
+      return FlutterError("flight-recorder-unavailable", "The flight recorder is not enabled");
+    }
+    std::error_code error;
+    std::filesystem::path dump_path = path != nullptr
+                                          ? std::filesystem::u8path(*path)
+                                          : std::filesystem::temp_directory_path(error) / kFlightRecorderDumpName;
+    if (error || !flight_recorder_->Dump(dump_path))
+    {
+      return FlutterError("flight-recorder-dump-failed", "Cannot write " + dump_path.u8string());
+    }
+    return dump_path.u8string();
+  }
+
+  void WindowsStoreApiInstance::GetAssociatedStoreProductsAsync(
+      const std::vector<std::string> &product_kinds,
+      uint64_t field_mask,
+      std::function<void(ErrorOr<std::vector<StoreProductRecord>> reply)> result)
+  {
+    if (auto error = availability_.ShortCircuitError())
+    {
+      result(*error);
+      return;
+    }
+    queue_.Post(WorkPriority::kBackground, [this, product_kinds, field_mask, result]()
+                                           {
+      auto products = backend_->GetAssociatedStoreProducts(product_kinds, field_mask);
+      if (!products.ok())
+      {
+        result(ErrorFrom(products));
+        return;
+      }
+      // Products carrying ExtendedJsonData would bloat the index, which
+      // never serves it.
+      if ((field_mask & CatalogIndex::kIndexedFields) == CatalogIndex::kIndexedFields &&
+          (field_mask & ProductFieldBit(ProductField::kExtendedJsonData)) == 0)
+      {
+        catalog_.Update(product_kinds, products.value);
+      }
+      result(std::move(products.value)); });
+  }
+
+  void WindowsStoreApiInstance::QueryCatalogAsync(
+      const CatalogQuery &query,
+      std::function<void(ErrorOr<CatalogPage> reply)> result)
+  {
+    if (auto error = availability_.ShortCircuitError())
+    {
+      result(*error);
+      return;
+    }
+    queue_.Post(WorkPriority::kBackground, [this, query, result]()
+                                           {
+      // Only kinds that were never loaded or went stale are fetched; the
+      // index then only reposts the products that changed.
+      std::vector<std::string> stale = catalog_.StaleKinds(
+          query.product_kinds.empty() ? kAllProductKinds : query.product_kinds);
+      if (!stale.empty())
+      {
+        auto products = backend_->GetAssociatedStoreProducts(stale, kAllProductFields);
+        if (!products.ok())
+        {
+          result(ErrorFrom(products));
+          return;
+        }
+        catalog_.Update(stale, products.value);
+      }
+      result(catalog_.Query(query)); });
+  }
+
+  void WindowsStoreApiInstance::RunBatchQueryAsync(
+      BatchQuery query,
+      const std::vector<std::string> &store_ids,
+      uint32_t max_parallel,
+      uint32_t stream_id,
+      std::function<void(ErrorOr<std::vector<BatchItemResult>> reply)> result)
+  {
+    if (auto error = availability_.ShortCircuitError())
+    {
+      result(*error);
+      return;
+    }
+    queue_.Post(WorkPriority::kBackground, [this, query, store_ids, max_parallel, stream_id, result]()
+                                           {
+      std::vector<BatchItemResult> items(store_ids.size());
+      // Lanes finish items concurrently; their events are sent one at a time.
+      std::mutex send_mutex;
+      batch_lanes_.ParallelFor(WorkPriority::kInteractive, store_ids.size(),
+                               std::min(max_parallel, kMaxBatchParallelism), [&](size_t index)
+                               {
+        BatchItemResult &item = items[index];
+        item = RunBatchItem(*backend_, query, store_ids[index]);
+        if (item.hresult < 0)
+        {
+          availability_.RecordFailure(item.hresult, item.message);
+        }
+        if (stream_id != 0 && events_)
+        {
+          ByteWriter event = StoreEventChannel::Begin(StoreEventChannel::kBatchItem);
+          event.WriteU32(stream_id);
+          event.WriteU32(static_cast<uint32_t>(index));
+          EncodeBatchResults(query, {item}, event);
+          std::lock_guard<std::mutex> lock(send_mutex);
+          events_->Send(event);
+        } });
+      result(std::move(items)); });
+  }
+
+  void WindowsStoreApiInstance::GetStoreProductAsync(
+      const std::string &store_id,
+      uint64_t field_mask,
+      std::function<void(ErrorOr<std::vector<StoreProductRecord>> reply)> result)
+  {
+    if (auto error = availability_.ShortCircuitError())
+    {
+      result(*error);
+      return;
+    }
+    if (std::shared_ptr<const StoreProductRecord> cached = cache_.GetProduct(store_id, field_mask))
+    {
+      result(std::vector<StoreProductRecord>{*cached});
+      return;
+    }
+    product_batcher_.Load(store_id, field_mask, [this, field_mask, result = std::move(result)](const StoreResult<const StoreProductRecord *> &product)
+                          {
+      if (!product.ok())
+      {
+        result(ErrorFrom(product));
+        return;
+      }
+      std::vector<StoreProductRecord> products;
+      if (product.value != nullptr)
+      {
+        products.push_back(*product.value);
+        cache_.PutProduct(std::make_shared<const StoreProductRecord>(products.back()), field_mask);
+      }
+      result(std::move(products)); });
+  }
+
+  void WindowsStoreApiInstance::GetProductImagesAsync(
+      const std::vector<std::string> &store_ids,
+      const std::string &purpose_tag,
+      std::function<void(ErrorOr<std::vector<ProductImageResult>> reply)> result)
+  {
+    if (!image_cache_)
+    {
+      result(ImageCacheUnavailableError());
+      return;
+    }
+    if (auto error = availability_.ShortCircuitError())
+    {
+      result(*error);
+      return;
+    }
+    queue_.Post(WorkPriority::kInteractive, [this, store_ids, purpose_tag, result]()
+                                            {
+      constexpr uint64_t kImageFields = ProductFieldBit(ProductField::kStoreId) |
+                                        ProductFieldBit(ProductField::kImages);
+      std::unordered_map<std::string, std::shared_ptr<const StoreProductRecord>> products;
+      std::vector<std::string> missing;
+      for (const std::string &store_id : store_ids)
+      {
+        if (std::shared_ptr<const StoreProductRecord> cached = cache_.GetProduct(store_id, kImageFields))
+        {
+          products.emplace(store_id, std::move(cached));
+        }
+        else
+        {
+          missing.push_back(store_id);
+        }
+      }
+      if (!missing.empty())
+      {
+        auto fetched = backend_->GetStoreProducts(kAllProductKinds, missing, kImageFields);
+        if (!fetched.ok())
+        {
+          result(ErrorFrom(fetched));
+          return;
+        }
+        for (StoreProductRecord &record : fetched.value)
+        {
+          auto product = std::make_shared<const StoreProductRecord>(std::move(record));
+          cache_.PutProduct(product, kImageFields);
+          products.emplace(product->store_id, product);
+        }
+      }
+
+      // Answered once the last image is cached; every fetch fills its own
+      // item.
+      struct Pending
+      {
+        std::vector<ProductImageResult> items;
+        std::atomic<size_t> remaining{0};
+        std::function<void(ErrorOr<std::vector<ProductImageResult>> reply)> result;
+      };
+      auto pending = std::make_shared<Pending>();
+      pending->result = result;
+      for (const std::string &store_id : store_ids)
+      {
+        auto product = products.find(store_id);
+        if (product == products.end())
+        {
+          continue;
+        }
+        for (const StoreImageRecord &image : product->second->images)
+        {
+          if (purpose_tag.empty() || image.purpose_tag == purpose_tag)
+          {
+            ProductImageResult item;
+            item.store_id = store_id;
+            item.image = image;
+            pending->items.push_back(std::move(item));
+          }
+        }
+      }
+      if (pending->items.empty())
+      {
+        result(std::vector<ProductImageResult>());
+        return;
+      }
+      pending->remaining = pending->items.size();
+      for (size_t i = 0; i < pending->items.size(); i++)
+      {
+        image_cache_->Fetch(pending->items[i].image.uri, [pending, i](const StoreResult<std::string> &path)
+                            {
+          ProductImageResult &item = pending->items[i];
+          item.hresult = path.hresult;
+          item.message = path.message;
+          item.path = path.value;
+          if (--pending->remaining == 0)
+          {
+            pending->result(std::move(pending->items));
+          } });
+      } });
+  }
+
+  void WindowsStoreApiInstance::SyncUserCollectionAsync(
+      const std::vector<std::string> &product_kinds,
+      uint64_t field_mask,
+      uint32_t stream_id,
+      std::function<void(ErrorOr<std::shared_ptr<const UserCollection>> reply)> result)
+  {
+    if (!collection_sync_)
+    {
+      result(CollectionSyncUnavailableError());
+      return;
+    }
+    if (auto error = availability_.ShortCircuitError())
+    {
+      result(*error);
+      return;
+    }
+    // The local copy is matched by its kinds, in whatever order they come.
+    std::vector<std::string> kinds = product_kinds.empty() ? kAllProductKinds : product_kinds;
+    std::sort(kinds.begin(), kinds.end());
+    kinds.erase(std::unique(kinds.begin(), kinds.end()), kinds.end());
+    queue_.Post(WorkPriority::kInteractive, [this, kinds, field_mask, stream_id, result]()
+                                            {
+      std::shared_ptr<const UserCollection> local = collection_sync_->Local(kinds, field_mask);
+      result(local);
+      // The Store call may take seconds for a large collection, so it does
+      // not hold up interactive requests.
+      queue_.Post(WorkPriority::kBackground, [this, local, stream_id]()
+                  {
+        auto products = backend_->GetUserCollection(local->product_kinds, local->field_mask);
+        ByteWriter event = StoreEventChannel::Begin(StoreEventChannel::kCollectionDelta);
+        if (!products.ok())
+        {
+          availability_.RecordFailure(products.hresult, products.message);
+          EncodeCollectionDelta(stream_id, products.hresult, products.message, local->version, local->version,
+                                CollectionDelta(), local->field_mask, event);
+        }
+        else
+        {
+          // Saved before the delta is sent, so a later launch starts from
+          // the synced copy even if this one exits right away.
+          std::shared_ptr<const UserCollection> synced = collection_sync_->Update(
+              local->product_kinds, local->field_mask, std::move(products.value));
+          EncodeCollectionDelta(stream_id, 0, std::string(), local->version, synced->version,
+                                ComputeCollectionDelta(local->products, synced->products), local->field_mask, event);
+        }
+        if (events_)
+        {
+          events_->Send(event);
+        } }); });
+  }
+
+  void WindowsStoreApiInstance::GetAppLicenseFieldsAsync(
+      uint64_t field_mask,
+      std::function<void(ErrorOr<std::shared_ptr<const LicenseSnapshot>> reply)> result)
+  {
+    // Full licenses also refresh the feature entitlements. Narrower ones are
+    // cut from the same cached or single-flight license.
+    if (field_mask == kAllLicenseFields)
+    {
+      LoadLicense(std::move(result));
+      return;
+    }
+    if ((field_mask & ~kAllLicenseFields) == 0)
+    {
+      LoadLicense([field_mask, result = std::move(result)](ErrorOr<std::shared_ptr<const LicenseSnapshot>> license)
+                  {
+        if (license.has_error())
+        {
+          result(license.error());
+          return;
+        }
+        result(std::make_shared<const LicenseSnapshot>(ProjectLicenseSnapshot(*license.value(), field_mask))); });
+      return;
+    }
+    // The cached license never holds ExtendedJsonData.
+    if (auto reply = availability_.ShortCircuitLicense())
+    {
+      if (reply->has_error())
+      {
+        result(reply->error());
+        return;
+      }
+      result(std::make_shared<const LicenseSnapshot>(LicenseSnapshot::FromInner(reply->value())));
+      return;
+    }
+    queue_.Post(WorkPriority::kInteractive, [this, field_mask, result]()
+                                            {
+      auto license = backend_->GetAppLicense(field_mask);
+      if (!license.ok())
+      {
+        result(ErrorFrom(license));
+        return;
+      }
+      result(std::make_shared<const LicenseSnapshot>(std::move(license.value))); });
+  }
+
+  template <typename T>
+  FlutterError WindowsStoreApiInstance::ErrorFrom(const StoreResult<T> &result)
+  {
+    availability_.RecordFailure(result.hresult, result.message);
+    return FlutterError(std::to_string(result.hresult), result.message, flutter::EncodableValue(""));
+  }
+
+  template <typename Callback>
+  void WindowsStoreApiInstance::LoadLicense(Callback &&result)
+  {
+    if (auto reply = availability_.ShortCircuitLicense())
+    {
+      if (reply->has_error())
+      {
+        result(reply->error());
+        return;
+      }
+      auto snapshot = std::make_shared<const LicenseSnapshot>(LicenseSnapshot::FromInner(reply->value()));
+      entitlements_.Update(*snapshot);
+      result(std::move(snapshot));
+      return;
+    }
+    // Served from the cache while it revalidates in the background. The
+    // entitlements were computed from the cached license when it was
+    // fetched, unless features were registered since.
+    if (std::shared_ptr<const LicenseSnapshot> cached = license_refresh_.Get())
+    {
+      if (!entitlements_.IsValid())
+      {
+        entitlements_.Update(*cached);
+      }
+      result(std::move(cached));
+      return;
+    }
+    FetchLicense(LicenseCallback(std::forward<Callback>(result)));
+  }
+
+  void WindowsStoreApiInstance::FetchLicense(LicenseCallback result)
+  {
+    {
+      std::lock_guard<std::mutex> lock(license_fetch_mutex_);
+      if (result)
+      {
+        license_fetch_waiters_.push_back(std::move(result));
+      }
+      if (license_fetch_in_flight_)
+      {
+        return;
+      }
+      license_fetch_in_flight_ = true;
+    }
+    queue_.Post(WorkPriority::kInteractive, [this]()
+                {
+      std::optional<FlutterError> error;
+      std::shared_ptr<const LicenseSnapshot> snapshot;
+      while (true)
+      {
+        uint64_t generation = license_refresh_.Generation();
+        auto license = backend_->GetAppLicense(kAllLicenseFields);
+        if (!license.ok())
+        {
+          error = ErrorFrom(license);
+          break;
+        }
+        snapshot = std::make_shared<const LicenseSnapshot>(std::move(license.value));
+        entitlements_.Update(*snapshot);
+        if (license_refresh_.Complete(snapshot, generation))
+        {
+          cache_.PinLicense(snapshot);
+          break;
+        }
+        // Licenses changed while it ran, so it may be the license they
+        // replaced; waiters get the new one.
+        entitlements_.Invalidate();
+      }
+      // Requests arriving from here on hit the cache or start a new fetch.
+      std::vector<LicenseCallback> waiters;
+      {
+        std::lock_guard<std::mutex> lock(license_fetch_mutex_);
+        waiters.swap(license_fetch_waiters_);
+        license_fetch_in_flight_ = false;
+      }
+      for (const auto &waiter : waiters)
+      {
+        if (error)
+        {
+          waiter(*error);
+        }
+        else
+        {
+          waiter(snapshot);
+        }
+      } });
+  }
+
+  void WindowsStoreApiInstance::RevalidateLicense(uint64_t generation)
+  {
+    auto license = backend_->GetAppLicense(kAllLicenseFields);
+    if (!license.ok())
+    {
+      availability_.RecordFailure(license.hresult, license.message);
+      license_refresh_.Fail(generation);
+      return;
+    }
+    auto snapshot = std::make_shared<const LicenseSnapshot>(std::move(license.value));
+    entitlements_.Update(*snapshot);
+    if (!license_refresh_.Complete(snapshot, generation))
+    {
+      // Licenses changed while it ran; the next request fetches them.
+      entitlements_.Invalidate();
+      return;
+    }
+    cache_.PinLicense(snapshot);
+  }
+
+  template <typename Callback>
+  void WindowsStoreApiInstance::WithEntitlements(Callback &&callback)
+  {
+    if (entitlements_.IsValid())
+    {
+      callback(std::nullopt);
+      return;
+    }
+    LoadLicense([callback = std::forward<Callback>(callback)](ErrorOr<std::shared_ptr<const LicenseSnapshot>> license)
+                {
+      if (license.has_error())
+      {
+        callback(license.error());
+        return;
+      }
+      callback(std::nullopt); });
+  }
+
+  void WindowsStoreApiInstance::ReplyFeatureEnabled(const std::string &feature,
+                                                    const std::function<void(ErrorOr<bool> reply)> &result)
+  {
+    std::optional<bool> enabled = entitlements_.IsEnabled(feature);
+    if (!enabled)
+    {
+      result(UnknownFeatureError(feature));
+      return;
+    }
+    result(*enabled);
+  }
+
+  void WindowsStoreApiInstance::ReplyFeaturesEnabled(
+      const flutter::EncodableList &features,
+      const std::function<void(ErrorOr<flutter::EncodableList> reply)> &result)
+  {
+    flutter::EncodableList enabled;
+    enabled.reserve(features.size());
+    for (const flutter::EncodableValue &feature : features)
+    {
+      const std::string &name = std::get<std::string>(feature);
+      std::optional<bool> value = entitlements_.IsEnabled(name);
+      if (!value)
+      {
+        result(UnknownFeatureError(name));
+        return;
+      }
+      enabled.push_back(flutter::EncodableValue(*value));
+    }
+    result(enabled);
+  }
+
+} // namespace windows_store
@@ -0,0 +1,175 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_WINDOWS_STORE_API_INSTANCE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_WINDOWS_STORE_API_INSTANCE_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "bulk_channel.h"
+#include "catalog_index.h"
+#include "collection_sync.h"
+#include "feature_entitlements.h"
+#include "flight_recorder.h"
+#include "image_cache.h"
+#include "license_refresh.h"
+#include "license_snapshot.h"
+#include "pigeon/messages.g.h"
+#include "product_batcher.h"
+#include "store_availability.h"
+#include "store_backend.h"
+#include "store_cache.h"
+#include "store_events.h"
+#include "work_queue.h"
+
+namespace windows_store
+{
+
+  // What the plugin prepares at registration, before the first Dart call.
+  enum class WarmUpPolicy
+  {
+    kNone,
+    // Starts the Store session.
+    kSession,
+    // Starts the Store session and fetches the app license.
+    kLicense,
+  };
+
+  // Handles the plugin's channels on top of a StoreBackend. Nothing in here
+  // depends on WinRT, so the whole request path runs against recorded or
+  // simulated backends as well.
+  class WindowsStoreApiInstance : public WindowsStoreApi, public BulkStoreApi
+  {
+  public:
+    WindowsStoreApiInstance(std::unique_ptr<StoreBackend> backend, bool has_package_identity);
+    virtual ~WindowsStoreApiInstance();
+
+    // Pauses background license revalidation while the app is inactive.
+    void SetAppActive(bool active);
+
+    // Sets the channel streamed batch results are sent on.
+    void SetEventChannel(std::unique_ptr<StoreEventChannel> events);
+
+    // Starts warming up as per |policy| on a worker and returns right away.
+    // A license request made while the license is being prefetched waits for
+    // that fetch instead of calling the Store again.
+    void WarmUp(WarmUpPolicy policy);
+
+    // Sets the recorder DumpFlightRecorder writes out. It must outlive this
+    // instance.
+    void SetFlightRecorder(const FlightRecorder *recorder);
+
+    // Sets the cache GetProductImagesAsync downloads images into. Must be
+    // called before the first request.
+    void SetImageCache(std::unique_ptr<ImageCache> image_cache);
+
+    // Sets where SyncUserCollectionAsync keeps the local copy of the
+    // collection. Must be called before the first request.
+    void SetCollectionSync(std::unique_ptr<CollectionSync> collection_sync);
+
+    // WindowsStoreApi:
+    void GetAppLicenseAsync(std::function<void(ErrorOr<StoreAppLicenseInner> reply)> result) override;
+    std::optional<FlutterError> SetSimulatedLicense(const StoreAppLicenseInner *license) override;
+    std::optional<FlutterError> RegisterFeatures(const flutter::EncodableMap &features) override;
+    void IsFeatureEnabledAsync(const std::string &feature,
+                               std::function<void(ErrorOr<bool> reply)> result) override;
+    void AreFeaturesEnabledAsync(const flutter::EncodableList &features,
+                                 std::function<void(ErrorOr<flutter::EncodableList> reply)> result) override;
+    ErrorOr<std::string> DumpFlightRecorder(const std::string *path) override;
+    std::optional<FlutterError> SetProductBatchWindow(int64_t window_microseconds, int64_t max_batch_size) override;
+    std::optional<FlutterError> SetCacheBudget(int64_t budget_bytes) override;
+    ErrorOr<flutter::EncodableList> GetCacheStats() override;
+    std::optional<FlutterError> SetImageCacheLimit(int64_t max_bytes) override;
+
+    // BulkStoreApi:
+    void GetAssociatedStoreProductsAsync(
+        const std::vector<std::string> &product_kinds,
+        uint64_t field_mask,
+        std::function<void(ErrorOr<std::vector<StoreProductRecord>> reply)> result) override;
+    void GetAppLicenseFieldsAsync(
+        uint64_t field_mask,
+        std::function<void(ErrorOr<std::shared_ptr<const LicenseSnapshot>> reply)> result) override;
+    void QueryCatalogAsync(
+        const CatalogQuery &query,
+        std::function<void(ErrorOr<CatalogPage> reply)> result) override;
+    void RunBatchQueryAsync(
+        BatchQuery query,
+        const std::vector<std::string> &store_ids,
+        uint32_t max_parallel,
+        uint32_t stream_id,
+        std::function<void(ErrorOr<std::vector<BatchItemResult>> reply)> result) override;
+    void GetStoreProductAsync(
+        const std::string &store_id,
+        uint64_t field_mask,
+        std::function<void(ErrorOr<std::vector<StoreProductRecord>> reply)> result) override;
+    void GetProductImagesAsync(
+        const std::vector<std::string> &store_ids,
+        const std::string &purpose_tag,
+        std::function<void(ErrorOr<std::vector<ProductImageResult>> reply)> result) override;
+    void SyncUserCollectionAsync(
+        const std::vector<std::string> &product_kinds,
+        uint64_t field_mask,
+        uint32_t stream_id,
+        std::function<void(ErrorOr<std::shared_ptr<const UserCollection>> reply)> result) override;
+
+  private:
+    // Converts a failed backend call to a FlutterError, remembering
+    // permanent errors.
+    template <typename T>
+    FlutterError ErrorFrom(const StoreResult<T> &result);
+
+    using LicenseCallback = std::function<void(ErrorOr<std::shared_ptr<const LicenseSnapshot>> reply)>;
+
+    // Fetches the app license, or takes it from the refresh cache, and
+    // refreshes the feature entitlements from it. |result| is called in
+    // place when the license is cached, and only converted to a
+    // LicenseCallback, which may allocate, when it has to wait for a fetch.
+    template <typename Callback>
+    void LoadLicense(Callback &&result);
+
+    // Fetches the license from the Store and passes it to |result|, which
+    // may be empty. Joins the fetch in flight, if any.
+    void FetchLicense(LicenseCallback result);
+
+    // Background refetch of the cached license, run by license_refresh_ for
+    // its |generation|.
+    void RevalidateLicense(uint64_t generation);
+
+    // Runs |callback| once the feature entitlements are valid, loading the
+    // license first if needed. Called in place if they already are.
+    template <typename Callback>
+    void WithEntitlements(Callback &&callback);
+
+    // Replies to IsFeatureEnabledAsync and AreFeaturesEnabledAsync from
+    // valid entitlements.
+    void ReplyFeatureEnabled(const std::string &feature, const std::function<void(ErrorOr<bool> reply)> &result);
+    void ReplyFeaturesEnabled(const flutter::EncodableList &features,
+                              const std::function<void(ErrorOr<flutter::EncodableList> reply)> &result);
+
+    std::unique_ptr<StoreBackend> backend_;
+    StoreAvailability availability_;
+    FeatureEntitlements entitlements_;
+    CatalogIndex catalog_;
+    StoreCache cache_;
+    std::unique_ptr<StoreEventChannel> events_;
+    const FlightRecorder *flight_recorder_ = nullptr;
+    std::unique_ptr<ImageCache> image_cache_;
+    std::unique_ptr<CollectionSync> collection_sync_;
+    std::mutex license_fetch_mutex_;
+    bool license_fetch_in_flight_ = false;
+    std::vector<LicenseCallback> license_fetch_waiters_;
+    // Last, so their threads are joined before the state they use is
+    // destroyed. The destructor stops queue_ before any member goes, since
+    // its tasks use all of them; the schedulers' posts are then dropped.
+    WorkQueue queue_;
+    // Runs every lane of a batch query but the one on queue_.
+    WorkQueue batch_lanes_;
+    LicenseRefreshScheduler license_refresh_;
+    ProductBatcher product_batcher_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_WINDOWS_STORE_API_INSTANCE_H_
@@ -2,64 +2,282 @@
 
 // This must be included before many other Windows headers.
 #include <windows.h>
+#include <appmodel.h>
 
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include <winrt/Windows.Storage.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include <iostream>
-#include <ppltasks.h>
-#include <winrt/Windows.Services.Store.h>
-#include <winrt/Windows.Foundation.Collections.h>
 
+#include "bulk_channel.h"
+#include "flight_recorder.h"
 #include "pigeon/messages.g.h"
-
-using namespace winrt;
-using namespace Windows::Services;
-using namespace Windows::Foundation;
-using namespace Concurrency;
+#include "shared_license_cache.h"
+#include "store_trace.h"
+#include "winrt_image_downloader.h"
+#include "windows_store_api_instance.h"
+#include "winrt_store_backend.h"
 
 namespace windows_store
 {
 
-  class WindowsStoreApiInstance : public WindowsStoreApi
+  namespace
   {
-  public:
-    WindowsStoreApiInstance() {}
-    virtual ~WindowsStoreApiInstance() {}
 
-    void GetAppLicenseAsync(std::function<void(ErrorOr<StoreAppLicenseInner> reply)> result)
+    // Unpackaged processes have no package identity and every Store call
+    // fails, so this is checked once at registration.
+    bool HasPackageIdentity()
+    {
+      UINT32 length = 0;
+      return GetCurrentPackageFullName(&length, nullptr) != APPMODEL_ERROR_NO_PACKAGE;
+    }
+
+    // How long a license published by another process of the app is used
+    // instead of calling the Store.
+    constexpr std::chrono::minutes kSharedLicenseMaxAge(5);
+
+    // Name of the license cache shared by the processes of this package, or
+    // an empty string without package identity.
+    std::string SharedLicenseCacheName()
+    {
+      UINT32 length = 0;
+      if (GetCurrentPackageFamilyName(&length, nullptr) != ERROR_INSUFFICIENT_BUFFER)
+      {
+        return std::string();
+      }
+      std::wstring family_name(length, L'\0');
+      if (GetCurrentPackageFamilyName(&length, family_name.data()) != ERROR_SUCCESS)
+      {
+        return std::string();
+      }
+      family_name.resize(length - 1);
+      return "Local\\windows_store_license_" + winrt::to_string(family_name);
+    }
+
+    std::string GetEnvironmentString(const char *name)
+    {
+      DWORD size = GetEnvironmentVariableA(name, nullptr, 0);
+      if (size == 0)
+      {
+        return std::string();
+      }
+      std::string value(size, '\0');
+      value.resize(GetEnvironmentVariableA(name, value.data(), size));
+      return value;
+    }
+
+    constexpr char kImageCacheDirectoryName[] = "windows_store_images";
+    constexpr char kCollectionDirectoryName[] = "windows_store_collection";
+
+    // Packaged apps keep caches in their LocalCache folder, which Windows
+    // removes with the app; unpackaged runs use the temp directory.
+    std::filesystem::path CacheDirectory(const char *name)
+    {
+      if (HasPackageIdentity())
+      {
+        try
+        {
+          std::filesystem::path folder(
+              winrt::Windows::Storage::ApplicationData::Current().LocalCacheFolder().Path().c_str());
+          return folder / name;
+        }
+        catch (winrt::hresult_error const &)
+        {
+        }
+      }
+      std::error_code error;
+      return std::filesystem::temp_directory_path(error) / name;
+    }
+
+    WarmUpPolicy g_warm_up_policy = WarmUpPolicy::kNone;
+
+    // Store calls kept by the flight recorder.
+    constexpr size_t kFlightRecorderCapacity = 256;
+
+    const FlightRecorder *g_exit_dump_recorder = nullptr;
+    std::filesystem::path g_exit_dump_path;
+    LPTOP_LEVEL_EXCEPTION_FILTER g_previous_exception_filter = nullptr;
+    // Allocated up front: the heap may be what crashed.
+    std::vector<uint8_t> g_crash_dump_buffer;
+
+    LONG WINAPI DumpFlightRecorderOnCrash(EXCEPTION_POINTERS *exception)
+    {
+      size_t size = g_exit_dump_recorder->DumpTo(g_crash_dump_buffer.data());
+      HANDLE file = CreateFileW(g_exit_dump_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file != INVALID_HANDLE_VALUE)
+      {
+        DWORD written = 0;
+        WriteFile(file, g_crash_dump_buffer.data(), static_cast<DWORD>(size), &written, nullptr);
+        CloseHandle(file);
+      }
+      return g_previous_exception_filter != nullptr ? g_previous_exception_filter(exception)
+                                                    : EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    // WINDOWS_STORE_FLIGHT_RECORDER=<path> dumps |recorder| to <path> when
+    // the process exits or dies of an unhandled exception.
+    bool InstallFlightRecorderDump(const FlightRecorder &recorder)
     {
-      concurrency::create_task([result]
-                               {
-		  try {
-        Store::StoreContext storeContext = Store::StoreContext::GetDefault();
-        auto licenseAsync = storeContext.GetAppLicenseAsync();
-        auto license = licenseAsync.get();
-
-        std::string skuStoreId = winrt::to_string(license.SkuStoreId());
-        std::string trialUniqueId = winrt::to_string(license.TrialUniqueId());
-
-        result(StoreAppLicenseInner(license.IsActive(), license.IsTrial(), skuStoreId, trialUniqueId, license.TrialTimeRemaining().count() / 10000));
-		  }  catch (winrt::hresult_error const& ex)
+      std::string path = GetEnvironmentString("WINDOWS_STORE_FLIGHT_RECORDER");
+      if (path.empty())
+      {
+        return false;
+      }
+      g_exit_dump_recorder = &recorder;
+      g_exit_dump_path = std::filesystem::u8path(path);
+      g_crash_dump_buffer.resize(recorder.MaxDumpSize());
+      std::atexit([]()
+                  { g_exit_dump_recorder->Dump(g_exit_dump_path); });
+      g_previous_exception_filter = SetUnhandledExceptionFilter(DumpFlightRecorderOnCrash);
+      return true;
+    }
+
+    // WINDOWS_STORE_TRACE_RECORD=<path> records every Store call to a trace
+    // file. WINDOWS_STORE_TRACE_REPLAY=<path> answers Store calls from such a
+    // trace instead, at WINDOWS_STORE_TRACE_SPEED times the recorded latency
+    // (default 1, 0 for no delay). Either way, |flight_recorder| sees every
+    // call.
+    std::unique_ptr<StoreBackend> CreateBackend(FlightRecorder &flight_recorder)
+    {
+      std::string replay_path = GetEnvironmentString("WINDOWS_STORE_TRACE_REPLAY");
+      if (!replay_path.empty())
+      {
+        std::vector<StoreTraceRecord> records;
+        if (StoreTraceFile::Read(replay_path, records))
+        {
+          std::string speed = GetEnvironmentString("WINDOWS_STORE_TRACE_SPEED");
+          return std::make_unique<FlightRecordingBackend>(
+              std::make_unique<ReplayStoreBackend>(std::move(records), speed.empty() ? 1.0 : std::atof(speed.c_str())),
+              flight_recorder);
+        }
+        std::cerr << "windows_store: cannot read trace " << replay_path << std::endl;
+      }
+
+      std::unique_ptr<StoreBackend> backend =
+          std::make_unique<FlightRecordingBackend>(std::make_unique<WinRtStoreBackend>(), flight_recorder);
+      std::string record_path = GetEnvironmentString("WINDOWS_STORE_TRACE_RECORD");
+      if (!record_path.empty())
+      {
+        backend = std::make_unique<RecordingStoreBackend>(std::move(backend), record_path);
+      }
+
+      std::string cache_name = SharedLicenseCacheName();
+      if (!cache_name.empty())
+      {
+        if (auto cache = SharedLicenseCache::Open(cache_name))
+        {
+          backend = std::make_unique<SharedLicenseBackend>(std::move(backend), std::move(cache), kSharedLicenseMaxAge);
+        }
+      }
+      return backend;
+    }
+
+    // Runs tasks on the thread that created it, through a message-only
+    // window. Created on the platform thread for the event channel, whose
+    // events are produced on the work queue's threads.
+    class PlatformThreadDispatcher
+    {
+    public:
+      PlatformThreadDispatcher()
+      {
+        HINSTANCE instance = GetModuleHandleW(nullptr);
+        WNDCLASSW window_class = {};
+        window_class.lpfnWndProc = WindowProc;
+        window_class.hInstance = instance;
+        window_class.lpszClassName = kWindowClassName;
+        RegisterClassW(&window_class);
+        window_ = CreateWindowExW(0, kWindowClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, instance, nullptr);
+      }
+
+      PlatformThreadDispatcher(const PlatformThreadDispatcher &) = delete;
+      PlatformThreadDispatcher &operator=(const PlatformThreadDispatcher &) = delete;
+
+      // Tasks run in the order posted. May be called from any thread.
+      void Post(std::function<void()> task) const
+      {
+        auto *posted = new std::function<void()>(std::move(task));
+        if (window_ == nullptr || !PostMessageW(window_, kRunTask, 0, reinterpret_cast<LPARAM>(posted)))
         {
-            winrt::hresult hr = ex.code();
-            winrt::hstring message = ex.message();
-            result(FlutterError(std::to_string(hr.value), winrt::to_string(message), ""));
-        } });
+          delete posted;
+        }
+      }
+
+    private:
+      static constexpr wchar_t kWindowClassName[] = L"WindowsStorePluginDispatcher";
+      static constexpr UINT kRunTask = WM_APP;
+
+      static LRESULT CALLBACK WindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam)
+      {
+        if (message == kRunTask)
+        {
+          std::unique_ptr<std::function<void()>> task(reinterpret_cast<std::function<void()> *>(lparam));
+          (*task)();
+          return 0;
+        }
+        return DefWindowProcW(hwnd, message, wparam, lparam);
+      }
+
+      HWND window_ = nullptr;
+    };
+
+    // Creates the instance shared by every engine of the process, and the
+    // process-wide state that goes with it.
+    std::unique_ptr<WindowsStoreApiInstance> CreateInstance(FlightRecorder &flight_recorder)
+    {
+      auto plugin = std::make_unique<WindowsStoreApiInstance>(CreateBackend(flight_recorder), HasPackageIdentity());
+      InstallFlightRecorderDump(flight_recorder);
+      plugin->WarmUp(g_warm_up_policy);
+      plugin->SetImageCache(std::make_unique<ImageCache>(CacheDirectory(kImageCacheDirectoryName),
+                                                         std::make_unique<WinRtImageDownloader>()));
+      plugin->SetCollectionSync(std::make_unique<CollectionSync>(CacheDirectory(kCollectionDirectoryName)));
+      plugin->SetFlightRecorder(&flight_recorder);
+      return plugin;
     }
-  };
+
+  } // namespace
 
   // static
   void WindowsStorePlugin::RegisterWithRegistrar(
       flutter::PluginRegistrarWindows *registrar)
   {
-    static auto plugin = std::make_unique<WindowsStoreApiInstance>();
+    // Declared first so it outlives the backend recording into it.
+    static FlightRecorder flight_recorder(kFlightRecorderCapacity);
+    static std::unique_ptr<WindowsStoreApiInstance> plugin = CreateInstance(flight_recorder);
+    registrar->RegisterTopLevelWindowProcDelegate(
+        [](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) -> std::optional<LRESULT>
+        {
+          if (message == WM_ACTIVATEAPP)
+          {
+            plugin->SetAppActive(wparam != FALSE);
+          }
+          return std::nullopt;
+        });
     WindowsStoreApi::SetUp(registrar->messenger(),
                            plugin.get());
+    BulkStoreApi::SetUp(registrar->messenger(), plugin.get());
+    static PlatformThreadDispatcher dispatcher;
+    plugin->SetEventChannel(std::make_unique<StoreEventChannel>(registrar->messenger(), [](std::function<void()> task)
+                                                                { dispatcher.Post(std::move(task)); }));
+  }
+
+  // static
+  void WindowsStorePlugin::SetWarmUpPolicy(WarmUpPolicy policy)
+  {
+    g_warm_up_policy = policy;
   }
 
 } // namespace windows_store
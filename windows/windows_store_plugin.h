@@ -6,6 +6,8 @@
 
 #include <memory>
 
+#include "windows_store_api_instance.h"
+
 namespace windows_store
 {
 
@@ -13,6 +15,9 @@ namespace windows_store
     {
     public:
         static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
+
+        // Applied when the plugin first registers.
+        static void SetWarmUpPolicy(WarmUpPolicy policy);
     };
 
 } // namespace windows_store
@@ -11,3 +11,12 @@ void WindowsStorePluginCApiRegisterWithRegistrar(
         flutter::PluginRegistrarManager::GetInstance()
             ->GetRegistrar<flutter::PluginRegistrarWindows>(registrar));
 }
+
+void WindowsStorePluginCApiSetWarmUpPolicy(
+    WindowsStoreWarmUpPolicy policy)
+{
+    windows_store::WindowsStorePlugin::SetWarmUpPolicy(
+        policy == kWindowsStoreWarmUpLicense   ? windows_store::WarmUpPolicy::kLicense
+        : policy == kWindowsStoreWarmUpSession ? windows_store::WarmUpPolicy::kSession
+                                               : windows_store::WarmUpPolicy::kNone);
+}
@@ -0,0 +1,30 @@
+#include "winrt_image_downloader.h"
+
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Storage.Streams.h>
+
+using namespace winrt;
+using namespace Windows::Foundation;
+using namespace Windows::Web::Http;
+
+namespace windows_store
+{
+
+  StoreResult<std::vector<uint8_t>> WinRtImageDownloader::Download(const std::string &uri)
+  {
+    try
+    {
+      HttpResponseMessage response = client_.GetAsync(Uri(winrt::to_hstring(uri))).get();
+      response.EnsureSuccessStatusCode();
+      Windows::Storage::Streams::IBuffer buffer = response.Content().ReadAsBufferAsync().get();
+      StoreResult<std::vector<uint8_t>> result;
+      result.value.assign(buffer.data(), buffer.data() + buffer.Length());
+      return result;
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return StoreResult<std::vector<uint8_t>>::Failure(ex.code().value, winrt::to_string(ex.message()));
+    }
+  }
+
+} // namespace windows_store
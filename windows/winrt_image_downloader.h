@@ -0,0 +1,27 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_WINRT_IMAGE_DOWNLOADER_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_WINRT_IMAGE_DOWNLOADER_H_
+
+#include <winrt/Windows.Web.Http.h>
+
+#include "image_cache.h"
+
+namespace windows_store
+{
+
+  // ImageDownloader that uses Windows.Web.Http. One HttpClient is shared by
+  // all downloads so they reuse its connections.
+  class WinRtImageDownloader : public ImageDownloader
+  {
+  public:
+    WinRtImageDownloader() {}
+    virtual ~WinRtImageDownloader() {}
+
+    StoreResult<std::vector<uint8_t>> Download(const std::string &uri) override;
+
+  private:
+    winrt::Windows::Web::Http::HttpClient client_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_WINRT_IMAGE_DOWNLOADER_H_
@@ -0,0 +1,314 @@
+#include "winrt_store_backend.h"
+
+#include <winrt/Windows.Foundation.Collections.h>
+
+#include <chrono>
+
+using namespace winrt;
+using namespace Windows::Services;
+using namespace Windows::Foundation;
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr uint64_t kPriceFields = ProductFieldBit(ProductField::kFormattedPrice) |
+                                      ProductFieldBit(ProductField::kFormattedBasePrice) |
+                                      ProductFieldBit(ProductField::kCurrencyCode);
+
+    // HRESULT_FROM_WIN32(ERROR_NOT_FOUND)
+    constexpr int32_t kNotFoundHResult = static_cast<int32_t>(0x80070490);
+
+    template <typename T>
+    StoreResult<T> FailureFrom(winrt::hresult_error const &ex)
+    {
+      return StoreResult<T>::Failure(ex.code().value, winrt::to_string(ex.message()));
+    }
+
+    Collections::IVector<winrt::hstring> ToHStrings(const std::vector<std::string> &values)
+    {
+      std::vector<winrt::hstring> strings;
+      strings.reserve(values.size());
+      for (const std::string &value : values)
+      {
+        strings.push_back(winrt::to_hstring(value));
+      }
+      return winrt::single_threaded_vector(std::move(strings));
+    }
+
+    StoreProductRecord RecordFrom(Store::StoreProduct const &product, uint64_t field_mask)
+    {
+      auto requested = [field_mask](ProductField field)
+      { return (field_mask & ProductFieldBit(field)) != 0; };
+      StoreProductRecord record;
+      if (requested(ProductField::kStoreId))
+      {
+        record.store_id = winrt::to_string(product.StoreId());
+      }
+      if (requested(ProductField::kProductKind))
+      {
+        record.product_kind = winrt::to_string(product.ProductKind());
+      }
+      if (requested(ProductField::kTitle))
+      {
+        record.title = winrt::to_string(product.Title());
+      }
+      if (requested(ProductField::kDescription))
+      {
+        record.description = winrt::to_string(product.Description());
+      }
+      if (field_mask & kPriceFields)
+      {
+        Store::StorePrice price = product.Price();
+        if (requested(ProductField::kFormattedPrice))
+        {
+          record.formatted_price = winrt::to_string(price.FormattedPrice());
+        }
+        if (requested(ProductField::kFormattedBasePrice))
+        {
+          record.formatted_base_price = winrt::to_string(price.FormattedBasePrice());
+        }
+        if (requested(ProductField::kCurrencyCode))
+        {
+          record.currency_code = winrt::to_string(price.CurrencyCode());
+        }
+      }
+      if (requested(ProductField::kIsInUserCollection))
+      {
+        record.is_in_user_collection = product.IsInUserCollection();
+      }
+      if (requested(ProductField::kHasDigitalDownload))
+      {
+        record.has_digital_download = product.HasDigitalDownload();
+      }
+      if (requested(ProductField::kInAppOfferToken))
+      {
+        record.in_app_offer_token = winrt::to_string(product.InAppOfferToken());
+      }
+      if (requested(ProductField::kLinkUri))
+      {
+        if (Uri linkUri = product.LinkUri())
+        {
+          record.link_uri = winrt::to_string(linkUri.AbsoluteUri());
+        }
+      }
+      if (requested(ProductField::kExtendedJsonData))
+      {
+        record.extended_json_data = winrt::to_string(product.ExtendedJsonData());
+      }
+      if (requested(ProductField::kImages))
+      {
+        for (Store::StoreImage const &image : product.Images())
+        {
+          StoreImageRecord image_record;
+          image_record.uri = winrt::to_string(image.Uri().AbsoluteUri());
+          image_record.purpose_tag = winrt::to_string(image.ImagePurposeTag());
+          image_record.width = image.Width();
+          image_record.height = image.Height();
+          record.images.push_back(std::move(image_record));
+        }
+      }
+      return record;
+    }
+
+    StoreResult<std::vector<StoreProductRecord>> RecordsFrom(
+        Collections::IMapView<winrt::hstring, Store::StoreProduct> const &products,
+        uint64_t field_mask)
+    {
+      StoreResult<std::vector<StoreProductRecord>> result;
+      result.value.reserve(products.Size());
+      for (auto const &entry : products)
+      {
+        result.value.push_back(RecordFrom(entry.Value(), field_mask));
+      }
+      return result;
+    }
+
+  } // namespace
+
+  void WinRtStoreBackend::SetLicensesChangedHandler(std::function<void()> handler)
+  {
+    licenses_changed_ = std::move(handler);
+  }
+
+  Store::StoreContext WinRtStoreBackend::Context()
+  {
+    std::call_once(context_once_, [this]()
+                   {
+      context_ = Store::StoreContext::GetDefault();
+      context_.OfflineLicensesChanged([this](auto &&, auto &&)
+                                      {
+        if (licenses_changed_)
+        {
+          licenses_changed_();
+        } }); });
+    return context_;
+  }
+
+  void WinRtStoreBackend::WarmUp()
+  {
+    try
+    {
+      // Activates StoreContext and its license change subscription.
+      Context();
+    }
+    catch (winrt::hresult_error const &)
+    {
+    }
+  }
+
+  StoreResult<LicenseSnapshot> WinRtStoreBackend::GetAppLicense(uint64_t field_mask)
+  {
+    auto requested = [field_mask](LicenseField field)
+    { return (field_mask & LicenseFieldBit(field)) != 0; };
+    try
+    {
+      auto license = Context().GetAppLicenseAsync().get();
+
+      StoreResult<LicenseSnapshot> result;
+      LicenseSnapshot &snapshot = result.value;
+      if (requested(LicenseField::kIsActive))
+      {
+        snapshot.is_active = license.IsActive();
+      }
+      if (requested(LicenseField::kIsTrial))
+      {
+        snapshot.is_trial = license.IsTrial();
+      }
+      if (requested(LicenseField::kSkuStoreId))
+      {
+        snapshot.sku_store_id = winrt::to_string(license.SkuStoreId());
+      }
+      if (requested(LicenseField::kTrialUniqueId))
+      {
+        snapshot.trial_unique_id = winrt::to_string(license.TrialUniqueId());
+      }
+      if (requested(LicenseField::kTrialTimeRemaining))
+      {
+        snapshot.trial_time_remaining_ms = license.TrialTimeRemaining().count() / 10000;
+      }
+      if (requested(LicenseField::kExtendedJsonData))
+      {
+        snapshot.extended_json_data = winrt::to_string(license.ExtendedJsonData());
+      }
+      if (!requested(LicenseField::kAddOnLicenses))
+      {
+        return result;
+      }
+      for (auto const &entry : license.AddOnLicenses())
+      {
+        Store::StoreLicense addOn = entry.Value();
+        AddOnLicenseRecord record;
+        record.sku_store_id = winrt::to_string(addOn.SkuStoreId());
+        record.in_app_offer_token = winrt::to_string(addOn.InAppOfferToken());
+        record.is_active = addOn.IsActive();
+        record.expiration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   winrt::clock::to_sys(addOn.ExpirationDate()).time_since_epoch())
+                                   .count();
+        snapshot.add_ons.push_back(std::move(record));
+      }
+      return result;
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return FailureFrom<LicenseSnapshot>(ex);
+    }
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> WinRtStoreBackend::GetAssociatedStoreProducts(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    try
+    {
+      auto queryResult = Context().GetAssociatedStoreProductsAsync(ToHStrings(product_kinds)).get();
+      winrt::check_hresult(queryResult.ExtendedError());
+      return RecordsFrom(queryResult.Products(), field_mask);
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return FailureFrom<std::vector<StoreProductRecord>>(ex);
+    }
+  }
+
+  StoreResult<ConsumableBalanceRecord> WinRtStoreBackend::GetConsumableBalanceRemaining(const std::string &store_id)
+  {
+    try
+    {
+      auto balance = Context().GetConsumableBalanceRemainingAsync(winrt::to_hstring(store_id)).get();
+      Store::StoreConsumableStatus status = balance.Status();
+      if (status == Store::StoreConsumableStatus::NetworkError || status == Store::StoreConsumableStatus::ServerError)
+      {
+        winrt::check_hresult(balance.ExtendedError());
+      }
+
+      StoreResult<ConsumableBalanceRecord> result;
+      result.value.status = static_cast<uint8_t>(status);
+      result.value.balance_remaining = balance.BalanceRemaining();
+      result.value.tracking_id = winrt::to_string(winrt::to_hstring(balance.TrackingId()));
+      return result;
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return FailureFrom<ConsumableBalanceRecord>(ex);
+    }
+  }
+
+  StoreResult<bool> WinRtStoreBackend::IsInUserCollection(const std::string &store_id)
+  {
+    try
+    {
+      winrt::hstring id = winrt::to_hstring(store_id);
+      auto kinds = winrt::single_threaded_vector<winrt::hstring>(
+          {L"Application", L"Game", L"Consumable", L"UnmanagedConsumable", L"Durable"});
+      auto queryResult = Context().GetStoreProductsAsync(kinds, winrt::single_threaded_vector<winrt::hstring>({id})).get();
+      winrt::check_hresult(queryResult.ExtendedError());
+      Store::StoreProduct product = queryResult.Products().TryLookup(id);
+      if (!product)
+      {
+        return StoreResult<bool>::Failure(kNotFoundHResult, "No product with Store ID " + store_id);
+      }
+
+      StoreResult<bool> result;
+      result.value = product.IsInUserCollection();
+      return result;
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return FailureFrom<bool>(ex);
+    }
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> WinRtStoreBackend::GetStoreProducts(
+      const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+      uint64_t field_mask)
+  {
+    try
+    {
+      auto queryResult = Context().GetStoreProductsAsync(ToHStrings(product_kinds), ToHStrings(store_ids)).get();
+      winrt::check_hresult(queryResult.ExtendedError());
+      return RecordsFrom(queryResult.Products(), field_mask);
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return FailureFrom<std::vector<StoreProductRecord>>(ex);
+    }
+  }
+
+  StoreResult<std::vector<StoreProductRecord>> WinRtStoreBackend::GetUserCollection(
+      const std::vector<std::string> &product_kinds, uint64_t field_mask)
+  {
+    try
+    {
+      auto queryResult = Context().GetUserCollectionAsync(ToHStrings(product_kinds)).get();
+      winrt::check_hresult(queryResult.ExtendedError());
+      return RecordsFrom(queryResult.Products(), field_mask);
+    }
+    catch (winrt::hresult_error const &ex)
+    {
+      return FailureFrom<std::vector<StoreProductRecord>>(ex);
+    }
+  }
+
+} // namespace windows_store
@@ -0,0 +1,47 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_WINRT_STORE_BACKEND_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_WINRT_STORE_BACKEND_H_
+
+#include <winrt/Windows.Services.Store.h>
+
+#include <functional>
+#include <mutex>
+
+#include "store_backend.h"
+
+namespace windows_store
+{
+
+  // StoreBackend that calls Windows.Services.Store.
+  class WinRtStoreBackend : public StoreBackend
+  {
+  public:
+    WinRtStoreBackend() {}
+    virtual ~WinRtStoreBackend() {}
+
+    void SetLicensesChangedHandler(std::function<void()> handler) override;
+    void WarmUp() override;
+
+    StoreResult<LicenseSnapshot> GetAppLicense(uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetAssociatedStoreProducts(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+    StoreResult<ConsumableBalanceRecord> GetConsumableBalanceRemaining(const std::string &store_id) override;
+    StoreResult<bool> IsInUserCollection(const std::string &store_id) override;
+    StoreResult<std::vector<StoreProductRecord>> GetStoreProducts(
+        const std::vector<std::string> &product_kinds, const std::vector<std::string> &store_ids,
+        uint64_t field_mask) override;
+    StoreResult<std::vector<StoreProductRecord>> GetUserCollection(
+        const std::vector<std::string> &product_kinds, uint64_t field_mask) override;
+
+  private:
+    // The Store context is created on first use and kept, so the license
+    // change subscription stays attached to the context that is queried.
+    winrt::Windows::Services::Store::StoreContext Context();
+
+    std::function<void()> licenses_changed_;
+    std::once_flag context_once_;
+    winrt::Windows::Services::Store::StoreContext context_{nullptr};
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_WINRT_STORE_BACKEND_H_
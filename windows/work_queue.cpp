@@ -0,0 +1,166 @@
+#include "work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace windows_store
+{
+
+  namespace
+  {
+
+    constexpr size_t kBackground = static_cast<size_t>(WorkPriority::kBackground);
+
+  } // namespace
+
+  WorkQueue::WorkQueue(size_t worker_count, std::chrono::milliseconds aging_interval)
+      : worker_count_(std::max<size_t>(worker_count, 2)), aging_interval_(aging_interval)
+  {
+    workers_.reserve(worker_count_);
+    for (size_t i = 0; i < worker_count_; i++)
+    {
+      workers_.emplace_back([this]()
+                            { Run(); });
+    }
+  }
+
+  WorkQueue::~WorkQueue()
+  {
+    Stop();
+  }
+
+  void WorkQueue::Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread &worker : workers_)
+    {
+      if (worker.joinable())
+      {
+        worker.join();
+      }
+    }
+  }
+
+  void WorkQueue::Post(WorkPriority priority, std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queues_[static_cast<size_t>(priority)].push_back({std::move(task), Clock::now()});
+    }
+    ready_.notify_one();
+  }
+
+  void WorkQueue::Run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      size_t priority = kPriorityCount;
+      ready_.wait(lock, [this, &priority]()
+                  {
+        priority = NextPriority(Clock::now());
+        return stopping_ || priority < kPriorityCount; });
+      if (stopping_)
+      {
+        return;
+      }
+
+      Item item = std::move(queues_[priority].front());
+      queues_[priority].pop_front();
+      if (priority == kBackground)
+      {
+        running_background_++;
+      }
+      lock.unlock();
+      item.task();
+      item.task = nullptr;
+      lock.lock();
+      if (priority == kBackground)
+      {
+        running_background_--;
+      }
+    }
+  }
+
+  size_t WorkQueue::NextPriority(Clock::time_point now) const
+  {
+    size_t best = kPriorityCount;
+    int64_t best_rank = 0;
+    for (size_t priority = 0; priority < kPriorityCount; priority++)
+    {
+      if (queues_[priority].empty())
+      {
+        continue;
+      }
+      if (priority == kBackground && running_background_ + 1 >= worker_count_)
+      {
+        continue;
+      }
+      // Each aging interval waited counts as one class higher. Ties go to
+      // the higher class.
+      int64_t waited = (now - queues_[priority].front().queued) / aging_interval_;
+      int64_t rank = static_cast<int64_t>(priority) - waited;
+      if (best == kPriorityCount || rank < best_rank)
+      {
+        best = priority;
+        best_rank = rank;
+      }
+    }
+    return best;
+  }
+
+  void WorkQueue::ParallelFor(WorkPriority priority, size_t count, size_t max_parallel,
+                              const std::function<void(size_t index)> &body)
+  {
+    // Shared with the posted lanes, which may only start after this returned.
+    struct State
+    {
+      std::atomic<size_t> next{0};
+      std::mutex mutex;
+      std::condition_variable idle;
+      size_t active = 0;
+      bool finished = false;
+    };
+    auto state = std::make_shared<State>();
+    auto lane = [state, count, &body]()
+    {
+      for (size_t index = state->next++; index < count; index = state->next++)
+      {
+        body(index);
+      }
+    };
+
+    size_t lanes = std::min(count, std::max<size_t>(max_parallel, 1));
+    for (size_t i = 1; i < lanes; i++)
+    {
+      Post(priority, [state, lane]()
+           {
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (state->finished)
+          {
+            return;
+          }
+          state->active++;
+        }
+        lane();
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->active--;
+        }
+        state->idle.notify_all(); });
+    }
+    lane();
+
+    // Every index was claimed; lanes that have not started yet are skipped.
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished = true;
+    state->idle.wait(lock, [&state]()
+                     { return state->active == 0; });
+  }
+
+} // namespace windows_store
@@ -0,0 +1,87 @@
+#ifndef FLUTTER_PLUGIN_WINDOWS_STORE_WORK_QUEUE_H_
+#define FLUTTER_PLUGIN_WINDOWS_STORE_WORK_QUEUE_H_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace windows_store
+{
+
+  // Priority classes of Store calls, highest first.
+  enum class WorkPriority : uint8_t
+  {
+    // License and entitlement checks that gate UI.
+    kInteractive = 0,
+    kPurchase = 1,
+    // Catalog and collection syncs.
+    kBackground = 2,
+  };
+
+  // Worker pool that runs the blocking Store calls off the platform thread.
+  // Queued work runs by priority class, FIFO within a class. Waiting work is
+  // promoted one class per |aging_interval| so background work is never
+  // starved, and background work never occupies the last worker, so an
+  // interactive call does not wait behind a long sync.
+  class WorkQueue
+  {
+  public:
+    static constexpr size_t kPriorityCount = 3;
+
+    WorkQueue(size_t worker_count, std::chrono::milliseconds aging_interval);
+    ~WorkQueue();
+
+    WorkQueue(const WorkQueue &) = delete;
+    WorkQueue &operator=(const WorkQueue &) = delete;
+
+    void Post(WorkPriority priority, std::function<void()> task);
+
+    // Waits for the tasks running to return and stops the workers. Queued
+    // and later tasks never run. Called by the destructor; an owner calls it
+    // first when the tasks use state destroyed before the queue.
+    void Stop();
+
+    // Runs |body| for every index below |count| on the calling thread and up
+    // to |max_parallel| - 1 tasks posted at |priority|, and returns once all
+    // are done. The posted tasks are subject to the same limits as other
+    // work, so at most the background cap of them runs at once; the calling
+    // thread does whatever they do not get to, so this may be called from a
+    // task of this queue.
+    void ParallelFor(WorkPriority priority, size_t count, size_t max_parallel,
+                     const std::function<void(size_t index)> &body);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Item
+    {
+      std::function<void()> task;
+      Clock::time_point queued;
+    };
+
+    void Run();
+
+    // Returns the class whose oldest item should run next, or
+    // kPriorityCount if none can run now. Requires |mutex_|.
+    size_t NextPriority(Clock::time_point now) const;
+
+    const size_t worker_count_;
+    const std::chrono::milliseconds aging_interval_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::array<std::deque<Item>, kPriorityCount> queues_;
+    size_t running_background_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+  };
+
+} // namespace windows_store
+
+#endif // FLUTTER_PLUGIN_WINDOWS_STORE_WORK_QUEUE_H_